@@ -0,0 +1,158 @@
+#include "includes/arena.h"
+#include "includes/medicion.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+struct BloqueArena {
+    struct BloqueArena* siguiente;  // Bloques anteriores (ya llenos) o adoptados.
+    size_t tamanio;                 // Bytes de datos del bloque.
+    uint64_t datos[];               // Los datos, alineados a 8.
+};
+
+// --- Funciones Estáticas ---
+
+static size_t alinear_8(size_t bytes) {
+    return (bytes + 7) & ~(size_t)7;
+}
+
+static struct BloqueArena* nuevo_bloque(Arena* arena, size_t tamanio) {
+    struct BloqueArena* bloque = (struct BloqueArena*)malloc(sizeof(struct BloqueArena) + tamanio);
+    if (!bloque) {
+        perror("[ARENA] Fallo malloc para un bloque de la arena");
+        return NULL;
+    }
+    bloque->tamanio = tamanio;
+    arena->bytes_reservados += sizeof(struct BloqueArena) + tamanio;
+    MEDIR_ASIGNACION(sizeof(struct BloqueArena) + tamanio);
+    return bloque;
+}
+
+// Clase del pool para una capacidad (potencia de 2 entre 2 y CAPACIDAD_MAXIMA_POOL).
+static unsigned clase_pool(uint32_t capacidad) {
+    unsigned clase = 0;
+    while ((2u << clase) < capacidad) {
+        clase++;
+    }
+    return clase;
+}
+
+// --- Implementación de Funciones Públicas (declaradas en arena.h) ---
+
+void iniciar_arena(Arena* arena, size_t tamanio_bloque) {
+    if (!arena) return;
+    arena->bloques = NULL;
+    arena->usado = 0;
+    arena->tamanio_bloque = alinear_8(tamanio_bloque > 0 ? tamanio_bloque : TAMANIO_BLOQUE_TEXTOS);
+    arena->bytes_reservados = 0;
+}
+
+void* reservar_en_arena(Arena* arena, size_t bytes) {
+    if (!arena) return NULL;
+    bytes = alinear_8(bytes > 0 ? bytes : 1);
+
+    if (bytes > arena->tamanio_bloque) {
+        // Pedido grande: bloque propio, enganchado detras del actual para no perder lo que le queda.
+        struct BloqueArena* grande = nuevo_bloque(arena, bytes);
+        if (!grande) return NULL;
+        if (arena->bloques) {
+            grande->siguiente = arena->bloques->siguiente;
+            arena->bloques->siguiente = grande;
+        } else {
+            grande->siguiente = NULL;
+            arena->bloques = grande;
+            arena->usado = bytes;
+        }
+        return grande->datos;
+    }
+
+    if (!arena->bloques || arena->bloques->tamanio - arena->usado < bytes) {
+        struct BloqueArena* bloque = nuevo_bloque(arena, arena->tamanio_bloque);
+        if (!bloque) return NULL;
+        bloque->siguiente = arena->bloques;
+        arena->bloques = bloque;
+        arena->usado = 0;
+    }
+    void* memoria = (char*)arena->bloques->datos + arena->usado;
+    arena->usado += bytes;
+    return memoria;
+}
+
+char* copiar_texto_en_arena(Arena* arena, const char* texto, size_t largo) {
+    if (!texto) return NULL;
+    char* copia = (char*)reservar_en_arena(arena, largo + 1);
+    if (!copia) return NULL;
+    memcpy(copia, texto, largo);
+    copia[largo] = '\0';
+    return copia;
+}
+
+void adoptar_arena(Arena* destino, Arena* origen) {
+    if (!destino || !origen || destino == origen || !origen->bloques) return;
+    if (!destino->bloques) {
+        // Sin bloques propios, destino sigue llenando el bloque actual de origen.
+        destino->bloques = origen->bloques;
+        destino->usado = origen->usado;
+    } else {
+        // Los bloques de origen quedan detras del actual de destino, que sigue siendo donde se reparte.
+        struct BloqueArena* ultimo = origen->bloques;
+        while (ultimo->siguiente) {
+            ultimo = ultimo->siguiente;
+        }
+        ultimo->siguiente = destino->bloques->siguiente;
+        destino->bloques->siguiente = origen->bloques;
+    }
+    destino->bytes_reservados += origen->bytes_reservados;
+    origen->bloques = NULL;
+    origen->usado = 0;
+    origen->bytes_reservados = 0;
+}
+
+void liberar_arena(Arena* arena) {
+    if (!arena) return;
+    struct BloqueArena* bloque = arena->bloques;
+    while (bloque) {
+        struct BloqueArena* siguiente = bloque->siguiente;
+        free(bloque);
+        bloque = siguiente;
+    }
+    arena->bloques = NULL;
+    arena->usado = 0;
+    arena->bytes_reservados = 0;
+}
+
+void iniciar_pool_posteos(PoolPosteos* pool) {
+    if (!pool) return;
+    iniciar_arena(&pool->arena, TAMANIO_BLOQUE_POSTEOS);
+    pool->bytes_fuera_del_pool = 0;
+    for (unsigned i = 0; i < CLASES_POOL_POSTEOS; i++) {
+        pool->libres[i] = NULL;
+    }
+}
+
+uint32_t* pedir_bloque_posteos(PoolPosteos* pool, uint32_t capacidad) {
+    if (!pool || capacidad == 0 || capacidad > CAPACIDAD_MAXIMA_POOL) return NULL;
+    unsigned clase = clase_pool(capacidad);
+    void* bloque = pool->libres[clase];
+    if (bloque) {
+        memcpy(&pool->libres[clase], bloque, sizeof(void*)); // El primer puntero del bloque es el siguiente libre.
+        return (uint32_t*)bloque;
+    }
+    return (uint32_t*)reservar_en_arena(&pool->arena, (size_t)(2u << clase) * 2 * sizeof(uint32_t));
+}
+
+void devolver_bloque_posteos(PoolPosteos* pool, uint32_t* bloque, uint32_t capacidad) {
+    if (!pool || !bloque || capacidad == 0 || capacidad > CAPACIDAD_MAXIMA_POOL) return;
+    unsigned clase = clase_pool(capacidad);
+    memcpy(bloque, &pool->libres[clase], sizeof(void*));
+    pool->libres[clase] = bloque;
+}
+
+void liberar_pool_posteos(PoolPosteos* pool) {
+    if (!pool) return;
+    liberar_arena(&pool->arena);
+    for (unsigned i = 0; i < CLASES_POOL_POSTEOS; i++) {
+        pool->libres[i] = NULL;
+    }
+}
@@ -0,0 +1,324 @@
+// Suite de benchmarks del buscador (make bench): ingesta, busqueda en el vocabulario, interseccion
+// de listas y consultas de punta a punta (en memoria y con el indice guardado en disco).
+// Escribe un archivo TSV "prueba<TAB>metrica<TAB>valor<TAB>unidad" para comparar entre commits;
+// la primera linea (comentario) dice de que version del codigo y de que corpus salio.
+// Uso: ./bench_buscador <corpus.dat> <stopwords> <resultados.tsv> [hilos]
+//      (el corpus se arma con ./generar_corpus; hilos se usa para la ingesta y las consultas)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+
+#include "includes/stopwords.h"
+#include "includes/inverted_index.h"
+#include "includes/parser.h"
+#include "includes/indice_disco.h"
+#include "includes/ranking.h"
+#include "includes/consultas.h"
+
+#ifndef VERSION_CODIGO
+#define VERSION_CODIGO "desconocida" // El Makefile pasa el commit con -DVERSION_CODIGO=...
+#endif
+
+#define TIEMPO_MINIMO_SEG 0.2     // Cada medicion repite hasta juntar al menos este tiempo.
+#define PARES_INTERSECCION 1000
+#define CONSULTAS_BENCH 2000
+#define RANGO_MAXIMO_CONSULTAS 10000 // Los terminos de las consultas salen de los mas frecuentes.
+#define K_BENCH 10
+
+static double segundos_ahora(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// xorshift32: reproducible entre maquinas, a diferencia de rand().
+static uint32_t g_semilla = 2463534242u;
+static uint32_t aleatorio(void) {
+    g_semilla ^= g_semilla << 13;
+    g_semilla ^= g_semilla >> 17;
+    g_semilla ^= g_semilla << 5;
+    return g_semilla;
+}
+
+static double aleatorio_unitario(void) {
+    return (double)aleatorio() / 4294967296.0;
+}
+
+static FILE* g_resultados = NULL;
+
+// Una linea del TSV de resultados (y la misma en pantalla).
+static void anotar(const char* prueba, const char* metrica, double valor, const char* unidad) {
+    fprintf(g_resultados, "%s\t%s\t%.6g\t%s\n", prueba, metrica, valor, unidad);
+    printf("  %-24s %-26s %14.6g %s\n", prueba, metrica, valor, unidad);
+}
+
+static const indiceInvertido* g_indice_orden = NULL;
+static int comparar_por_frecuencia(const void* a, const void* b) {
+    uint32_t da = g_indice_orden->entradas[*(const size_t*)a].lista_documentos.cantidad;
+    uint32_t db = g_indice_orden->entradas[*(const size_t*)b].lista_documentos.cantidad;
+    return (da < db) - (da > db); // De mas a menos documentos.
+}
+
+// Rango log-uniforme en [0, limite): mezcla terminos muy comunes con otros raros, como las consultas reales.
+static size_t rango_log_uniforme(size_t limite) {
+    size_t rango = (size_t)pow((double)limite, aleatorio_unitario());
+    return rango > 0 ? rango - 1 : 0;
+}
+
+static long tamanio_archivo(const char* ruta) {
+    FILE* f = fopen(ruta, "rb");
+    if (!f) return -1;
+    fseek(f, 0, SEEK_END);
+    long tamanio = ftell(f);
+    fclose(f);
+    return tamanio;
+}
+
+static void medir_ingesta(const char* prueba, const char* ruta_corpus, double megabytes, int hilos, indiceInvertido** indice) {
+    *indice = crear_indice_silencioso(1024);
+    if (!*indice) return;
+    double inicio = segundos_ahora();
+    bool ok = procesar_archivo_documento_paralelo(ruta_corpus, *indice, hilos);
+    double segundos = segundos_ahora() - inicio;
+    if (!ok) {
+        destruir_indice(*indice);
+        *indice = NULL;
+        return;
+    }
+    anotar(prueba, "segundos", segundos, "s");
+    anotar(prueba, "mb_por_segundo", megabytes / segundos, "MB/s");
+    anotar(prueba, "documentos_por_segundo", (*indice)->documentos->cantidad / segundos, "docs/s");
+}
+
+// Busquedas en el vocabulario: todos los terminos en orden aleatorio y otros tantos que no estan.
+static void medir_vocabulario(const indiceInvertido* indice) {
+    size_t n = indice->cantidad;
+    const char** palabras = malloc(n * sizeof(char*));
+    char (*ausentes)[24] = malloc(n * sizeof(*ausentes));
+    if (!palabras || !ausentes) {
+        free(palabras);
+        free(ausentes);
+        return;
+    }
+    for (size_t i = 0; i < n; i++) {
+        palabras[i] = indice->entradas[i].palabra;
+        snprintf(ausentes[i], sizeof(ausentes[i]), "zq%zu", i); // Las stopwords y los terminos del corpus nunca empiezan asi.
+    }
+    for (size_t i = n; i > 1; i--) {
+        size_t j = aleatorio() % i;
+        const char* t = palabras[i - 1];
+        palabras[i - 1] = palabras[j];
+        palabras[j] = t;
+    }
+    uint64_t control = 0;
+    uint64_t busquedas = 0;
+    double inicio = segundos_ahora(), transcurrido;
+    do {
+        for (size_t i = 0; i < n; i++) {
+            ListaPosteo vista;
+            if (buscar_lista_posteo_termino(indice, palabras[i], &vista)) control += vista.cantidad;
+        }
+        busquedas += n;
+        transcurrido = segundos_ahora() - inicio;
+    } while (transcurrido < TIEMPO_MINIMO_SEG);
+    anotar("vocabulario", "ns_por_acierto", 1e9 * transcurrido / (double)busquedas, "ns");
+
+    busquedas = 0;
+    inicio = segundos_ahora();
+    do {
+        for (size_t i = 0; i < n; i++) {
+            ListaPosteo vista;
+            if (buscar_lista_posteo_termino(indice, ausentes[i], &vista)) control++;
+        }
+        busquedas += n;
+        transcurrido = segundos_ahora() - inicio;
+    } while (transcurrido < TIEMPO_MINIMO_SEG);
+    anotar("vocabulario", "ns_por_fallo", 1e9 * transcurrido / (double)busquedas, "ns");
+    if (control == 0) printf("  (ningun termino encontrado)\n");
+    free(palabras);
+    free(ausentes);
+}
+
+// Pares de terminos frecuentes con listas en arrays (intersectar_listas_posteo) y con cursores.
+static void medir_interseccion(const indiceInvertido* indice, const size_t* por_frecuencia, size_t limite) {
+    size_t pares[PARES_INTERSECCION][2];
+    uint64_t posteos = 0;
+    for (int p = 0; p < PARES_INTERSECCION; p++) {
+        pares[p][0] = por_frecuencia[rango_log_uniforme(limite)];
+        pares[p][1] = por_frecuencia[rango_log_uniforme(limite)];
+        posteos += indice->entradas[pares[p][0]].lista_documentos.cantidad +
+                   indice->entradas[pares[p][1]].lista_documentos.cantidad;
+    }
+
+    uint64_t control = 0;
+    int rondas = 0;
+    double inicio = segundos_ahora(), transcurrido;
+    do {
+        for (int p = 0; p < PARES_INTERSECCION; p++) {
+            ListaPosteo r = intersectar_listas_posteo(&indice->entradas[pares[p][0]].lista_documentos,
+                                                      &indice->entradas[pares[p][1]].lista_documentos);
+            control += r.cantidad;
+            free_list(&r);
+        }
+        rondas++;
+        transcurrido = segundos_ahora() - inicio;
+    } while (transcurrido < TIEMPO_MINIMO_SEG);
+    anotar("interseccion_listas", "us_por_par", 1e6 * transcurrido / ((double)rondas * PARES_INTERSECCION), "us");
+    anotar("interseccion_listas", "mposteos_por_segundo", (double)posteos * rondas / transcurrido / 1e6, "Mposteos/s");
+
+    static CursorPosteo cursores[2];
+    CursorPosteo* abiertos[2] = { &cursores[0], &cursores[1] };
+    rondas = 0;
+    inicio = segundos_ahora();
+    do {
+        for (int p = 0; p < PARES_INTERSECCION; p++) {
+            if (!abrir_cursor_termino(indice, indice->entradas[pares[p][0]].palabra, &cursores[0]) ||
+                !abrir_cursor_termino(indice, indice->entradas[pares[p][1]].palabra, &cursores[1])) {
+                continue;
+            }
+            ListaPosteo r = intersectar_cursores_posteo(abiertos, 2);
+            control += r.cantidad;
+            free_list(&r);
+        }
+        rondas++;
+        transcurrido = segundos_ahora() - inicio;
+    } while (transcurrido < TIEMPO_MINIMO_SEG);
+    anotar("interseccion_cursores", "us_por_par", 1e6 * transcurrido / ((double)rondas * PARES_INTERSECCION), "us");
+    anotar("interseccion_cursores", "mposteos_por_segundo", (double)posteos * rondas / transcurrido / 1e6, "Mposteos/s");
+    if (control == 0) printf("  (ninguna interseccion tuvo documentos)\n");
+}
+
+// Consultas de 2 a 4 terminos frecuentes, una por linea (el formato de --consultas).
+static bool escribir_consultas(const char* ruta, const indiceInvertido* indice, const size_t* por_frecuencia, size_t limite) {
+    FILE* f = fopen(ruta, "w");
+    if (!f) return false;
+    for (int q = 0; q < CONSULTAS_BENCH; q++) {
+        int terminos = 2 + (int)(aleatorio() % 3);
+        for (int t = 0; t < terminos; t++) {
+            fprintf(f, "%s%s", t ? " " : "", indice->entradas[por_frecuencia[rango_log_uniforme(limite)]].palabra);
+        }
+        fputc('\n', f);
+    }
+    return fclose(f) == 0;
+}
+
+static void medir_consultas(const char* prueba, const indiceInvertido* indice, const char* ruta_consultas,
+                            bool disyuntiva, int hilos) {
+    FILE* descarte = tmpfile();
+    EstadisticasLote lote;
+    if (!descarte || !correr_lote_consultas(indice, ruta_consultas, descarte, FORMATO_TSV, disyuntiva, K_BENCH, hilos, &lote)) {
+        fprintf(stderr, "[BENCH] No se pudieron correr las consultas de '%s'.\n", prueba);
+        if (descarte) fclose(descarte);
+        return;
+    }
+    fclose(descarte);
+    anotar(prueba, "consultas_por_segundo", lote.segundos_totales > 0 ? lote.consultas / lote.segundos_totales : 0.0, "qps");
+    anotar(prueba, "latencia_p50", lote.latencia_p50_ms, "ms");
+    anotar(prueba, "latencia_p95", lote.latencia_p95_ms, "ms");
+    anotar(prueba, "latencia_p99", lote.latencia_p99_ms, "ms");
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        fprintf(stderr, "Uso: %s <corpus.dat> <stopwords> <resultados.tsv> [hilos]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char* ruta_corpus = argv[1];
+    const char* ruta_stopwords = argv[2];
+    const char* ruta_resultados = argv[3];
+    int hilos = argc > 4 ? atoi(argv[4]) : 1;
+    if (hilos < 1) hilos = 1;
+
+    long bytes_corpus = tamanio_archivo(ruta_corpus);
+    if (bytes_corpus < 0 || !cargar_stopwords(ruta_stopwords)) {
+        fprintf(stderr, "[BENCH] No se pudo abrir el corpus '%s' o las stopwords '%s'.\n", ruta_corpus, ruta_stopwords);
+        return EXIT_FAILURE;
+    }
+    g_resultados = fopen(ruta_resultados, "w");
+    if (!g_resultados) {
+        fprintf(stderr, "[BENCH] No se pudo crear '%s'.\n", ruta_resultados);
+        free_stopwords();
+        return EXIT_FAILURE;
+    }
+    double megabytes = (double)bytes_corpus / (1024.0 * 1024.0);
+    fprintf(g_resultados, "# bench_buscador version=%s corpus=%s bytes=%ld hilos=%d\n", VERSION_CODIGO, ruta_corpus,
+            bytes_corpus, hilos);
+    fprintf(g_resultados, "prueba\tmetrica\tvalor\tunidad\n");
+
+    indiceInvertido* indice = NULL;
+    printf("[BENCH] Ingesta de '%s' (%.1f MB) con 1 hilo...\n", ruta_corpus, megabytes);
+    medir_ingesta("ingesta", ruta_corpus, megabytes, 1, &indice);
+    if (indice && hilos > 1) {
+        indiceInvertido* paralelo = NULL;
+        printf("[BENCH] Ingesta con %d hilos...\n", hilos);
+        medir_ingesta("ingesta_paralela", ruta_corpus, megabytes, hilos, &paralelo);
+        destruir_indice(paralelo);
+    }
+    if (!indice || indice->cantidad == 0) {
+        fprintf(stderr, "[BENCH] No se pudo indexar el corpus.\n");
+        destruir_indice(indice);
+        fclose(g_resultados);
+        free_stopwords();
+        return EXIT_FAILURE;
+    }
+    anotar("indice", "documentos", indice->documentos->cantidad, "docs");
+    anotar("indice", "vocabulario", (double)indice->cantidad, "terminos");
+
+    size_t* por_frecuencia = malloc(indice->cantidad * sizeof(size_t));
+    if (!por_frecuencia) {
+        fprintf(stderr, "[BENCH] Sin memoria para ordenar el vocabulario.\n");
+        destruir_indice(indice);
+        fclose(g_resultados);
+        free_stopwords();
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < indice->cantidad; i++) por_frecuencia[i] = i;
+    g_indice_orden = indice;
+    qsort(por_frecuencia, indice->cantidad, sizeof(size_t), comparar_por_frecuencia);
+    size_t limite = indice->cantidad < RANGO_MAXIMO_CONSULTAS ? indice->cantidad : RANGO_MAXIMO_CONSULTAS;
+
+    printf("[BENCH] Vocabulario e interseccion...\n");
+    medir_vocabulario(indice);
+    medir_interseccion(indice, por_frecuencia, limite);
+
+    // Consultas sobre el indice en memoria y sobre el mismo indice guardado y abierto como con --servir.
+    char ruta_consultas[1024], ruta_indice[1024];
+    snprintf(ruta_consultas, sizeof(ruta_consultas), "%s.consultas.txt", ruta_resultados);
+    snprintf(ruta_indice, sizeof(ruta_indice), "%s.idx", ruta_resultados);
+    if (escribir_consultas(ruta_consultas, indice, por_frecuencia, limite)) {
+        printf("[BENCH] %d consultas de punta a punta (top-%d)...\n", CONSULTAS_BENCH, K_BENCH);
+        medir_consultas("consultas_and_memoria", indice, ruta_consultas, false, hilos);
+        if (preparar_cotas_bm25(indice)) {
+            medir_consultas("consultas_or_memoria", indice, ruta_consultas, true, hilos);
+        }
+        double inicio = segundos_ahora();
+        bool guardado = guardar_indice(indice, ruta_indice);
+        double segundos_guardar = segundos_ahora() - inicio;
+        destruir_indice(indice);
+        indice = NULL;
+        if (guardado) {
+            anotar("indice_disco", "segundos_guardar", segundos_guardar, "s");
+            anotar("indice_disco", "mb", (double)tamanio_archivo(ruta_indice) / (1024.0 * 1024.0), "MB");
+            inicio = segundos_ahora();
+            indice = cargar_indice(ruta_indice);
+            if (indice) {
+                anotar("indice_disco", "ms_abrir", 1000.0 * (segundos_ahora() - inicio), "ms");
+                medir_consultas("consultas_and_disco", indice, ruta_consultas, false, hilos);
+                medir_consultas("consultas_or_disco", indice, ruta_consultas, true, hilos);
+            }
+        }
+        remove(ruta_consultas);
+    }
+
+    destruir_indice(indice);
+    remove(ruta_indice);
+    free(por_frecuencia);
+    fclose(g_resultados);
+    free_stopwords();
+    printf("[BENCH] Resultados en '%s'.\n", ruta_resultados);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,92 @@
+// Micro-benchmark del motor de interseccion (interseccion.c).
+// Mide postings/segundo de interseccion_adaptativa con cada implementacion soportada por la CPU
+// (escalar, SSE4.2, AVX2) para distintas relaciones de largo entre la lista corta y la larga.
+// Uso: ./bench_interseccion [largo_lista_larga]   (por defecto 1.000.000)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "includes/interseccion.h"
+
+#define LARGO_POR_DEFECTO 1000000
+#define TIEMPO_MINIMO_SEG 0.2 // Cada medicion repite hasta juntar al menos este tiempo.
+
+static double segundos_ahora(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// xorshift32: reproducible entre maquinas, a diferencia de rand().
+static uint32_t g_semilla = 2463534242u;
+static uint32_t aleatorio(void) {
+    g_semilla ^= g_semilla << 13;
+    g_semilla ^= g_semilla >> 17;
+    g_semilla ^= g_semilla << 5;
+    return g_semilla;
+}
+
+// Llena 'ids' con 'n' IDs crecientes con saltos aleatorios de 1 a 2*salto_medio-1.
+static void generar_lista(uint32_t* ids, size_t n, uint32_t salto_medio) {
+    uint32_t actual = 0;
+    for (size_t i = 0; i < n; i++) {
+        actual += 1 + aleatorio() % (2 * salto_medio - 1);
+        ids[i] = actual;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t largo = (argc > 1) ? (size_t)strtoull(argv[1], NULL, 10) : LARGO_POR_DEFECTO;
+    if (largo < 1024) largo = 1024;
+
+    const size_t relaciones[] = { 1, 4, 16, 32, 128, 1024 };
+    const size_t num_relaciones = sizeof(relaciones) / sizeof(relaciones[0]);
+    const ImplementacionInterseccion implementaciones[] = { INTERSECCION_ESCALAR, INTERSECCION_SSE42, INTERSECCION_AVX2 };
+
+    uint32_t* larga = malloc(largo * sizeof(uint32_t));
+    uint32_t* corta = malloc(largo * sizeof(uint32_t));
+    uint32_t* pos_a = malloc(largo * sizeof(uint32_t));
+    uint32_t* pos_b = malloc(largo * sizeof(uint32_t));
+    if (!larga || !corta || !pos_a || !pos_b) {
+        fprintf(stderr, "[BENCH] No hay memoria para listas de %zu IDs.\n", largo);
+        return EXIT_FAILURE;
+    }
+    // La lista larga cubre un rango de ~4*largo IDs (densidad 1/4, como un termino frecuente).
+    generar_lista(larga, largo, 4);
+    uint32_t rango = larga[largo - 1];
+
+    printf("[BENCH] Interseccion de una lista de %zu IDs con listas cortas de largo/relacion.\n", largo);
+    printf("[BENCH] Implementacion detectada por defecto: %s\n\n", interseccion_nombre(interseccion_implementacion_activa()));
+    printf("%-10s %10s %10s %12s %16s\n", "impl", "relacion", "corta", "comunes", "postings/seg");
+
+    for (size_t r = 0; r < num_relaciones; r++) {
+        size_t largo_corta = largo / relaciones[r];
+        generar_lista(corta, largo_corta, (uint32_t)(rango / largo_corta));
+
+        for (size_t k = 0; k < sizeof(implementaciones) / sizeof(implementaciones[0]); k++) {
+            if (!interseccion_fijar_implementacion(implementaciones[k])) continue;
+
+            size_t comunes = 0;
+            size_t repeticiones = 0;
+            double inicio = segundos_ahora();
+            double transcurrido;
+            do {
+                comunes = interseccion_adaptativa(corta, largo_corta, larga, largo, pos_a, pos_b);
+                repeticiones++;
+                transcurrido = segundos_ahora() - inicio;
+            } while (transcurrido < TIEMPO_MINIMO_SEG);
+
+            double postings_por_seg = (double)(largo + largo_corta) * (double)repeticiones / transcurrido;
+            printf("%-10s %9zu:1 %10zu %12zu %16.3e\n", interseccion_nombre(implementaciones[k]),
+                   relaciones[r], largo_corta, comunes, postings_por_seg);
+        }
+    }
+
+    free(larga);
+    free(corta);
+    free(pos_a);
+    free(pos_b);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,227 @@
+// Benchmark de la busqueda disyuntiva (OR) con ranking BM25 (ranking.c).
+// Compara Block-Max WAND contra puntuar todos los documentos: verifica que den el mismo top-k y mide
+// que fraccion de los posteos y documentos se salta la poda y cuanto tarda cada una.
+// Uso: ./bench_ranking [k]                                  (corpus sintetico con terminos Zipf)
+//      ./bench_ranking <indice.idx> <consultas.txt> [k]     (indice de --construir; una consulta por linea,
+//                                                            terminos ya normalizados separados por espacios)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+
+#include "includes/inverted_index.h"
+#include "includes/indice_disco.h"
+#include "includes/ranking.h"
+
+#define K_POR_DEFECTO 10
+#define DOCUMENTOS_SINTETICOS 100000
+#define VOCABULARIO_SINTETICO 20000
+#define CONSULTAS_SINTETICAS 300
+#define MAX_TERMINOS_BENCH 8
+#define MAX_LARGO_LINEA 1024
+
+static double segundos_ahora(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// xorshift32: reproducible entre maquinas, a diferencia de rand().
+static uint32_t g_semilla = 2463534242u;
+static uint32_t aleatorio(void) {
+    g_semilla ^= g_semilla << 13;
+    g_semilla ^= g_semilla >> 17;
+    g_semilla ^= g_semilla << 5;
+    return g_semilla;
+}
+
+static double aleatorio_unitario(void) {
+    return (double)aleatorio() / 4294967296.0;
+}
+
+// Rango Zipf (s = 1) por busqueda binaria sobre la distribucion acumulada.
+static uint32_t rango_zipf(const double* acumulada, uint32_t vocabulario) {
+    double u = aleatorio_unitario() * acumulada[vocabulario - 1];
+    uint32_t bajo = 0, alto = vocabulario - 1;
+    while (bajo < alto) {
+        uint32_t medio = bajo + (alto - bajo) / 2;
+        if (acumulada[medio] < u) bajo = medio + 1; else alto = medio;
+    }
+    return bajo;
+}
+
+// Documentos de 20 a 400 terminos sacados de una Zipf: pocas palabras muy comunes y una cola larga.
+static indiceInvertido* construir_indice_sintetico(void) {
+    double* acumulada = malloc(VOCABULARIO_SINTETICO * sizeof(double));
+    indiceInvertido* indice = crear_indice_silencioso(VOCABULARIO_SINTETICO);
+    if (!acumulada || !indice) {
+        free(acumulada);
+        destruir_indice(indice);
+        return NULL;
+    }
+    double suma = 0.0;
+    for (uint32_t r = 0; r < VOCABULARIO_SINTETICO; r++) {
+        suma += 1.0 / (r + 1);
+        acumulada[r] = suma;
+    }
+    char palabra[16];
+    char url[32];
+    for (uint32_t d = 0; d < DOCUMENTOS_SINTETICOS; d++) {
+        snprintf(url, sizeof(url), "doc%u", (unsigned)d);
+        uint32_t id = registrar_documento(indice->documentos, url, strlen(url));
+        uint32_t largo = 20 + aleatorio() % 381;
+        for (uint32_t i = 0; i < largo; i++) {
+            snprintf(palabra, sizeof(palabra), "t%u", (unsigned)rango_zipf(acumulada, VOCABULARIO_SINTETICO));
+            anadir_termino(indice, palabra, id);
+        }
+        fijar_largo_documento(indice->documentos, id, largo);
+    }
+    free(acumulada);
+    if (!preparar_cotas_bm25(indice)) {
+        destruir_indice(indice);
+        return NULL;
+    }
+    return indice;
+}
+
+// Consulta sintetica: 2 a 5 terminos con rango log-uniforme entre 10 y el vocabulario
+// (mezcla terminos comunes con otros raros, como las consultas reales sin stopwords).
+static int consulta_sintetica(char terminos[][16]) {
+    int cantidad = 2 + (int)(aleatorio() % 4);
+    for (int i = 0; i < cantidad; i++) {
+        double rango = 10.0 * pow(VOCABULARIO_SINTETICO / 10.0, aleatorio_unitario());
+        snprintf(terminos[i], 16, "t%u", (unsigned)rango);
+    }
+    return cantidad;
+}
+
+typedef struct {
+    int consultas;
+    int distintas;
+    uint64_t posteos_totales;
+    uint64_t posteos_decodificados;
+    uint64_t documentos_exhaustivo;
+    uint64_t documentos_poda;
+    double segundos_exhaustivo;
+    double segundos_poda;
+} Totales;
+
+static void correr_consulta(const indiceInvertido* indice, char* terminos[], int cantidad, size_t k,
+                            ResultadoBusqueda* exhaustivo, ResultadoBusqueda* podado, Totales* totales) {
+    static CursorPosteo cursores_a[MAX_TERMINOS_BENCH], cursores_b[MAX_TERMINOS_BENCH];
+    CursorPosteo* lista_a[MAX_TERMINOS_BENCH];
+    CursorPosteo* lista_b[MAX_TERMINOS_BENCH];
+    size_t n = 0;
+    for (int i = 0; i < cantidad; i++) {
+        if (abrir_cursor_termino(indice, terminos[i], &cursores_a[n]) &&
+            abrir_cursor_termino(indice, terminos[i], &cursores_b[n])) {
+            lista_a[n] = &cursores_a[n];
+            lista_b[n] = &cursores_b[n];
+            n++;
+        }
+    }
+    if (n == 0) return;
+
+    EstadisticasBusqueda est_exhaustivo, est_poda;
+    double inicio = segundos_ahora();
+    size_t n_exhaustivo = buscar_mejores_disyuntivo_exhaustivo(indice, lista_a, n, exhaustivo, k, &est_exhaustivo);
+    double medio = segundos_ahora();
+    size_t n_poda = buscar_mejores_disyuntivo(indice, lista_b, n, podado, k, &est_poda);
+    double fin = segundos_ahora();
+
+    bool iguales = n_exhaustivo == n_poda;
+    for (size_t i = 0; iguales && i < n_poda; i++) {
+        iguales = exhaustivo[i].doc_id == podado[i].doc_id && exhaustivo[i].puntaje == podado[i].puntaje;
+    }
+    totales->consultas++;
+    if (!iguales) totales->distintas++;
+    totales->posteos_totales += est_poda.posteos_totales;
+    totales->posteos_decodificados += est_poda.posteos_decodificados;
+    totales->documentos_exhaustivo += est_exhaustivo.documentos_puntuados;
+    totales->documentos_poda += est_poda.documentos_puntuados;
+    totales->segundos_exhaustivo += medio - inicio;
+    totales->segundos_poda += fin - medio;
+}
+
+int main(int argc, char* argv[]) {
+    const char* ruta_indice = NULL;
+    const char* ruta_consultas = NULL;
+    size_t k = K_POR_DEFECTO;
+    if (argc >= 3) {
+        ruta_indice = argv[1];
+        ruta_consultas = argv[2];
+        if (argc > 3) k = (size_t)strtoull(argv[3], NULL, 10);
+    } else if (argc == 2) {
+        k = (size_t)strtoull(argv[1], NULL, 10);
+    }
+    if (k == 0) k = K_POR_DEFECTO;
+
+    indiceInvertido* indice;
+    if (ruta_indice) {
+        indice = cargar_indice(ruta_indice);
+    } else {
+        printf("[BENCH] Construyendo corpus sintetico: %d documentos, vocabulario Zipf de %d terminos...\n",
+               DOCUMENTOS_SINTETICOS, VOCABULARIO_SINTETICO);
+        indice = construir_indice_sintetico();
+    }
+    ResultadoBusqueda* exhaustivo = malloc(k * sizeof(ResultadoBusqueda));
+    ResultadoBusqueda* podado = malloc(k * sizeof(ResultadoBusqueda));
+    if (!indice || !exhaustivo || !podado) {
+        fprintf(stderr, "[BENCH] No se pudo preparar el indice o la memoria de resultados.\n");
+        return EXIT_FAILURE;
+    }
+
+    Totales totales;
+    memset(&totales, 0, sizeof(totales));
+    if (ruta_consultas) {
+        FILE* archivo = fopen(ruta_consultas, "r");
+        if (!archivo) {
+            fprintf(stderr, "[BENCH] No se pudo abrir '%s'.\n", ruta_consultas);
+            return EXIT_FAILURE;
+        }
+        char linea[MAX_LARGO_LINEA];
+        while (fgets(linea, sizeof(linea), archivo)) {
+            char* terminos[MAX_TERMINOS_BENCH];
+            int cantidad = 0;
+            for (char* t = strtok(linea, " \t\r\n"); t && cantidad < MAX_TERMINOS_BENCH; t = strtok(NULL, " \t\r\n")) {
+                terminos[cantidad++] = t;
+            }
+            if (cantidad > 0) correr_consulta(indice, terminos, cantidad, k, exhaustivo, podado, &totales);
+        }
+        fclose(archivo);
+    } else {
+        char buffer[MAX_TERMINOS_BENCH][16];
+        char* terminos[MAX_TERMINOS_BENCH];
+        for (int i = 0; i < MAX_TERMINOS_BENCH; i++) terminos[i] = buffer[i];
+        for (int q = 0; q < CONSULTAS_SINTETICAS; q++) {
+            int cantidad = consulta_sintetica(buffer);
+            correr_consulta(indice, terminos, cantidad, k, exhaustivo, podado, &totales);
+        }
+    }
+
+    if (totales.consultas == 0) {
+        fprintf(stderr, "[BENCH] Ninguna consulta tenia terminos del indice.\n");
+        return EXIT_FAILURE;
+    }
+    double saltados = totales.posteos_totales > 0
+                          ? 1.0 - (double)totales.posteos_decodificados / (double)totales.posteos_totales : 0.0;
+    double no_puntuados = totales.documentos_exhaustivo > 0
+                              ? 1.0 - (double)totales.documentos_poda / (double)totales.documentos_exhaustivo : 0.0;
+    printf("[BENCH] %d consultas OR, top-%zu. Resultados distintos a los exhaustivos: %d\n",
+           totales.consultas, k, totales.distintas);
+    printf("%-14s %14s %14s %12s\n", "modo", "docs puntuados", "ms/consulta", "posteos");
+    printf("%-14s %14llu %14.3f %12llu\n", "exhaustivo", (unsigned long long)totales.documentos_exhaustivo,
+           1000.0 * totales.segundos_exhaustivo / totales.consultas, (unsigned long long)totales.posteos_totales);
+    printf("%-14s %14llu %14.3f %12llu\n", "block-max wand", (unsigned long long)totales.documentos_poda,
+           1000.0 * totales.segundos_poda / totales.consultas, (unsigned long long)totales.posteos_decodificados);
+    printf("[BENCH] Posteos saltados sin decodificar: %.1f%%. Documentos sin puntuar: %.1f%%.\n",
+           100.0 * saltados, 100.0 * no_puntuados);
+
+    destruir_indice(indice);
+    free(exhaustivo);
+    free(podado);
+    return totales.distintas == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,346 @@
+#include "includes/cache_consultas.h"
+#include "includes/posteo_comprimido.h"
+#include "includes/medicion.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BYTES_POR_CUBETA 512          // Una cubeta por cada tantos bytes de presupuesto.
+#define MIN_CUBETAS 16
+#define MAX_CUBETAS (1u << 20)
+
+typedef enum { RESULTADO_LISTA, RESULTADO_MEJORES } TipoResultado;
+
+// Una consulta guardada: cabecera, clave y resultado en un solo bloque de malloc.
+// Lista: doc_ids en deltas VByte seguidos de las frecuencias en VByte. Mejores: ResultadoBusqueda[cantidad].
+struct EntradaCache {
+    struct EntradaCache* siguiente_cubeta;
+    struct EntradaCache* anterior;     // Mas reciente (lista LRU).
+    struct EntradaCache* siguiente;    // Menos reciente.
+    uint64_t hash;
+    size_t largo_clave;
+    size_t largo_datos;
+    size_t bytes;                      // Todo el bloque (lo que se cuenta contra el presupuesto).
+    TipoResultado tipo;
+    uint32_t cantidad;
+    uint64_t datos[2];
+    uint64_t contenido[];              // Clave y luego el resultado; alineado a 8 para los ResultadoBusqueda.
+};
+
+// --- Funciones Estáticas ---
+
+// FNV-1a de 64 bits.
+static uint64_t hash_clave(const char* clave, size_t largo) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < largo; i++) {
+        hash ^= (unsigned char)clave[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static size_t alinear_8(size_t bytes) {
+    return (bytes + 7) & ~(size_t)7;
+}
+
+static const char* clave_de(const struct EntradaCache* entrada) {
+    return (const char*)entrada->contenido;
+}
+
+static unsigned char* datos_de(struct EntradaCache* entrada) {
+    return (unsigned char*)entrada->contenido + alinear_8(entrada->largo_clave);
+}
+
+static void sacar_de_lru(CacheConsultas* cache, struct EntradaCache* entrada) {
+    if (entrada->anterior) entrada->anterior->siguiente = entrada->siguiente;
+    else cache->mas_reciente = entrada->siguiente;
+    if (entrada->siguiente) entrada->siguiente->anterior = entrada->anterior;
+    else cache->menos_reciente = entrada->anterior;
+}
+
+static void poner_al_frente(CacheConsultas* cache, struct EntradaCache* entrada) {
+    entrada->anterior = NULL;
+    entrada->siguiente = cache->mas_reciente;
+    if (cache->mas_reciente) cache->mas_reciente->anterior = entrada;
+    cache->mas_reciente = entrada;
+    if (!cache->menos_reciente) cache->menos_reciente = entrada;
+}
+
+static void eliminar_entrada(CacheConsultas* cache, struct EntradaCache* entrada) {
+    struct EntradaCache** enlace = &cache->cubetas[entrada->hash & (cache->num_cubetas - 1)];
+    while (*enlace != entrada) {
+        enlace = &(*enlace)->siguiente_cubeta;
+    }
+    *enlace = entrada->siguiente_cubeta;
+    sacar_de_lru(cache, entrada);
+    cache->entradas--;
+    cache->bytes_usados -= entrada->bytes;
+    free(entrada);
+}
+
+static void vaciar_cache(CacheConsultas* cache) {
+    while (cache->menos_reciente) {
+        eliminar_entrada(cache, cache->menos_reciente);
+    }
+}
+
+// Si el indice no es el mismo (u otra version del mismo) con que se lleno la cache, la vacia.
+// Con 'indice' en NULL vale lo que dejo validar_cache_segmentos (si no se llamo, no hay cache).
+static bool validar_indice(CacheConsultas* cache, const indiceInvertido* indice) {
+    if (!indice) return cache->por_segmentos;
+    if (!cache->por_segmentos && cache->indice == indice && cache->identidad_indice == indice->identidad &&
+        cache->version_indice == indice->version && cache->documentos_indice == indice->documentos->cantidad &&
+        cache->suma_largos_indice == indice->documentos->suma_largos) {
+        return true;
+    }
+    if (cache->entradas > 0) {
+        vaciar_cache(cache);
+        cache->invalidaciones++;
+    }
+    cache->por_segmentos = false;
+    cache->indice = indice;
+    cache->identidad_indice = indice->identidad;
+    cache->version_indice = indice->version;
+    cache->documentos_indice = indice->documentos->cantidad;
+    cache->suma_largos_indice = indice->documentos->suma_largos;
+    return true;
+}
+
+// Busca la clave; cuenta el acierto o el fallo y, si esta, la pasa al frente de la LRU.
+static struct EntradaCache* buscar_entrada(CacheConsultas* cache, const indiceInvertido* indice, const char* clave,
+                                           size_t largo_clave, TipoResultado tipo) {
+    if (!cache || !cache->cubetas || !clave || !validar_indice(cache, indice)) return NULL;
+    uint64_t hash = hash_clave(clave, largo_clave);
+    struct EntradaCache* entrada = cache->cubetas[hash & (cache->num_cubetas - 1)];
+    while (entrada && !(entrada->hash == hash && entrada->largo_clave == largo_clave && entrada->tipo == tipo &&
+                        memcmp(clave_de(entrada), clave, largo_clave) == 0)) {
+        entrada = entrada->siguiente_cubeta;
+    }
+    if (!entrada) {
+        cache->fallos++;
+        MEDIR_CONTAR(CONTADOR_CACHE_FALLOS, 1);
+        return NULL;
+    }
+    cache->aciertos++;
+    MEDIR_CONTAR(CONTADOR_CACHE_ACIERTOS, 1);
+    sacar_de_lru(cache, entrada);
+    poner_al_frente(cache, entrada);
+    return entrada;
+}
+
+// Crea la entrada (reemplaza la que tuviera la misma clave) y desaloja las menos recientes hasta que quepa.
+// Devuelve NULL si no entra en el presupuesto o falla la memoria.
+static struct EntradaCache* nueva_entrada(CacheConsultas* cache, const indiceInvertido* indice, const char* clave,
+                                          size_t largo_clave, TipoResultado tipo, size_t largo_datos) {
+    if (!cache || !cache->cubetas || !clave) return NULL;
+    size_t bytes = sizeof(struct EntradaCache) + alinear_8(largo_clave) + largo_datos;
+    if (bytes > cache->presupuesto_bytes || !validar_indice(cache, indice)) return NULL;
+
+    uint64_t hash = hash_clave(clave, largo_clave);
+    for (struct EntradaCache* vieja = cache->cubetas[hash & (cache->num_cubetas - 1)]; vieja; vieja = vieja->siguiente_cubeta) {
+        if (vieja->hash == hash && vieja->largo_clave == largo_clave && vieja->tipo == tipo &&
+            memcmp(clave_de(vieja), clave, largo_clave) == 0) {
+            eliminar_entrada(cache, vieja);
+            break;
+        }
+    }
+    while (cache->bytes_usados + bytes > cache->presupuesto_bytes && cache->menos_reciente) {
+        eliminar_entrada(cache, cache->menos_reciente);
+        cache->desalojos++;
+    }
+
+    struct EntradaCache* entrada = (struct EntradaCache*)malloc(bytes);
+    if (!entrada) {
+        perror("[CACHE] Fallo malloc para una entrada de la cache");
+        return NULL;
+    }
+    entrada->hash = hash;
+    entrada->largo_clave = largo_clave;
+    entrada->largo_datos = largo_datos;
+    entrada->bytes = bytes;
+    entrada->tipo = tipo;
+    entrada->cantidad = 0;
+    entrada->datos[0] = entrada->datos[1] = 0;
+    memcpy(entrada->contenido, clave, largo_clave);
+
+    size_t cubeta = hash & (cache->num_cubetas - 1);
+    entrada->siguiente_cubeta = cache->cubetas[cubeta];
+    cache->cubetas[cubeta] = entrada;
+    poner_al_frente(cache, entrada);
+    cache->entradas++;
+    cache->bytes_usados += bytes;
+    return entrada;
+}
+
+// Ordena los terminos de la clave (son a lo mas MAX_TERMINOS_CONSULTA: insercion directa).
+static void ordenar_terminos(const char* terminos[], int cantidad) {
+    for (int i = 1; i < cantidad; i++) {
+        const char* termino = terminos[i];
+        int j = i - 1;
+        while (j >= 0 && strcmp(terminos[j], termino) > 0) {
+            terminos[j + 1] = terminos[j];
+            j--;
+        }
+        terminos[j + 1] = termino;
+    }
+}
+
+// --- Implementación de Funciones Públicas (declaradas en cache_consultas.h) ---
+
+bool iniciar_cache_consultas(CacheConsultas* cache, size_t presupuesto_bytes) {
+    if (!cache) return false;
+    memset(cache, 0, sizeof(*cache));
+    cache->presupuesto_bytes = presupuesto_bytes;
+    if (presupuesto_bytes == 0) {
+        return true; // Sin tabla: buscar y guardar no hacen nada (ni cuentan fallos).
+    }
+    size_t cubetas = MIN_CUBETAS;
+    while (cubetas < MAX_CUBETAS && cubetas * BYTES_POR_CUBETA < presupuesto_bytes) {
+        cubetas *= 2;
+    }
+    cache->cubetas = (struct EntradaCache**)calloc(cubetas, sizeof(struct EntradaCache*));
+    if (!cache->cubetas) {
+        perror("[CACHE] Fallo calloc para la tabla de la cache");
+        cache->presupuesto_bytes = 0;
+        return false;
+    }
+    cache->num_cubetas = cubetas;
+    return true;
+}
+
+void liberar_cache_consultas(CacheConsultas* cache) {
+    if (!cache || !cache->cubetas) return;
+    vaciar_cache(cache);
+    free(cache->cubetas);
+    cache->cubetas = NULL;
+    cache->num_cubetas = 0;
+    cache->presupuesto_bytes = 0;
+}
+
+size_t armar_clave_consulta(const ConsultaAnalizada* consulta, ModoCache modo, size_t k, int num_frases, char* clave) {
+    const char* terminos[MAX_TERMINOS_CONSULTA];
+    int cantidad = consulta->cantidad < MAX_TERMINOS_CONSULTA ? consulta->cantidad : MAX_TERMINOS_CONSULTA;
+    for (int i = 0; i < cantidad; i++) {
+        terminos[i] = consulta->terminos[i];
+    }
+    ordenar_terminos(terminos, cantidad);
+
+    // Los terminos no tienen espacios ni comillas (los separa el tokenizador), asi que sirven de separadores.
+    char* p = clave;
+    if (modo == MODO_CACHE_CONJUNTIVO) {
+        p += sprintf(p, "Y|");
+    } else {
+        p += sprintf(p, "%c%zu|", modo == MODO_CACHE_DISYUNTIVO ? 'O' : 'R', k);
+    }
+    for (int i = 0; i < cantidad; i++) {
+        size_t largo = strlen(terminos[i]);
+        if (i > 0) *p++ = ' ';
+        memcpy(p, terminos[i], largo);
+        p += largo;
+    }
+    if (modo == MODO_CACHE_CONJUNTIVO) {
+        for (int f = 0; f < num_frases && f < consulta->num_frases; f++) {
+            const FraseConsulta* frase = &consulta->frases[f];
+            p += sprintf(p, "|\"");
+            for (size_t i = 0; i < frase->cantidad; i++) {
+                p += sprintf(p, "%s%s@%u", i > 0 ? " " : "", frase->terminos[i], (unsigned)frase->desplazamientos[i]);
+            }
+            *p++ = '"';
+        }
+    }
+    *p = '\0';
+    return (size_t)(p - clave);
+}
+
+void validar_cache_segmentos(CacheConsultas* cache, uint64_t generacion, uint32_t total_documentos, uint64_t suma_largos) {
+    if (!cache) return;
+    if (cache->por_segmentos && cache->generacion_segmentos == generacion &&
+        cache->documentos_indice == total_documentos && cache->suma_largos_indice == suma_largos) {
+        return;
+    }
+    if (cache->entradas > 0) {
+        vaciar_cache(cache);
+        cache->invalidaciones++;
+    }
+    cache->por_segmentos = true;
+    cache->indice = NULL;
+    cache->identidad_indice = 0;
+    cache->version_indice = 0;
+    cache->generacion_segmentos = generacion;
+    cache->documentos_indice = total_documentos;
+    cache->suma_largos_indice = suma_largos;
+}
+
+bool buscar_lista_en_cache(CacheConsultas* cache, const indiceInvertido* indice, const char* clave, size_t largo_clave,
+                           ListaPosteo* resultado) {
+    struct EntradaCache* entrada = buscar_entrada(cache, indice, clave, largo_clave, RESULTADO_LISTA);
+    if (!entrada || !resultado) return false;
+    ListaPosteo lista = LISTA_POSTEO_VACIA;
+    if (entrada->cantidad > 0 && !reservar_lista(&lista, entrada->cantidad)) {
+        return false;
+    }
+    const uint8_t* p = datos_de(entrada);
+    const uint8_t* fin = p + entrada->largo_datos;
+    p = leer_vbytes(p, fin, lista.doc_ids, entrada->cantidad);
+    p = p ? leer_vbytes(p, fin, lista.frecuencias, entrada->cantidad) : NULL;
+    if (!p) {
+        free_list(&lista); // No deberia pasar: la entrada la escribio guardar_lista_en_cache.
+        return false;
+    }
+    for (uint32_t i = 1; i < entrada->cantidad; i++) {
+        lista.doc_ids[i] += lista.doc_ids[i - 1];
+    }
+    lista.cantidad = entrada->cantidad;
+    *resultado = lista;
+    return true;
+}
+
+bool guardar_lista_en_cache(CacheConsultas* cache, const indiceInvertido* indice, const char* clave, size_t largo_clave,
+                            const ListaPosteo* resultado) {
+    if (!resultado) return false;
+    size_t largo_datos = 0;
+    for (uint32_t i = 0; i < resultado->cantidad; i++) {
+        uint32_t delta = i > 0 ? resultado->doc_ids[i] - resultado->doc_ids[i - 1] : resultado->doc_ids[0];
+        largo_datos += largo_vbyte(delta) + largo_vbyte(resultado->frecuencias[i]);
+    }
+    struct EntradaCache* entrada = nueva_entrada(cache, indice, clave, largo_clave, RESULTADO_LISTA, largo_datos);
+    if (!entrada) return false;
+    uint8_t* p = datos_de(entrada);
+    for (uint32_t i = 0; i < resultado->cantidad; i++) {
+        p = escribir_vbyte(p, i > 0 ? resultado->doc_ids[i] - resultado->doc_ids[i - 1] : resultado->doc_ids[0]);
+    }
+    for (uint32_t i = 0; i < resultado->cantidad; i++) {
+        p = escribir_vbyte(p, resultado->frecuencias[i]);
+    }
+    entrada->cantidad = resultado->cantidad;
+    return true;
+}
+
+bool buscar_mejores_en_cache(CacheConsultas* cache, const indiceInvertido* indice, const char* clave, size_t largo_clave,
+                             ResultadoBusqueda* mejores, size_t* cantidad, uint64_t datos[2]) {
+    struct EntradaCache* entrada = buscar_entrada(cache, indice, clave, largo_clave, RESULTADO_MEJORES);
+    if (!entrada || !mejores || !cantidad) return false;
+    memcpy(mejores, datos_de(entrada), entrada->cantidad * sizeof(ResultadoBusqueda));
+    *cantidad = entrada->cantidad;
+    if (datos) {
+        datos[0] = entrada->datos[0];
+        datos[1] = entrada->datos[1];
+    }
+    return true;
+}
+
+bool guardar_mejores_en_cache(CacheConsultas* cache, const indiceInvertido* indice, const char* clave, size_t largo_clave,
+                              const ResultadoBusqueda* mejores, size_t cantidad, const uint64_t datos[2]) {
+    if (!mejores && cantidad > 0) return false;
+    struct EntradaCache* entrada = nueva_entrada(cache, indice, clave, largo_clave, RESULTADO_MEJORES,
+                                                 cantidad * sizeof(ResultadoBusqueda));
+    if (!entrada) return false;
+    if (cantidad > 0) memcpy(datos_de(entrada), mejores, cantidad * sizeof(ResultadoBusqueda));
+    entrada->cantidad = (uint32_t)cantidad;
+    if (datos) {
+        entrada->datos[0] = datos[0];
+        entrada->datos[1] = datos[1];
+    }
+    return true;
+}
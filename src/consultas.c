@@ -0,0 +1,360 @@
+#include "includes/consultas.h"
+#include "includes/segmentos.h"
+#include "includes/stopwords.h"
+#include "includes/lector_lineas.h"
+#include "includes/arena.h"
+#include "includes/medicion.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define CAPACIDAD_INICIAL_LATENCIAS 1024
+#define CONSULTAS_POR_TANDA 4096           // Consultas que se leen antes de repartirlas entre los hilos.
+#define RESULTADOS_POR_TANDA (1u << 20)    // Tope de resultados guardados por tanda (limita la tanda con k grande).
+
+// Una tanda de consultas leidas del archivo: los hilos toman la siguiente sin locks (contador atomico)
+// y dejan sus resultados en el lugar de cada consulta, asi se escriben en el orden del archivo.
+typedef struct {
+    const indiceInvertido* indice;
+    const VistaSegmentos* vista;    // En vez de 'indice', con un directorio de segmentos.
+    bool disyuntiva;
+    size_t k;
+    char** ids;
+    char** textos;
+    size_t cantidad;
+    ResultadoBusqueda* resultados;  // k lugares por consulta.
+    size_t* encontrados;            // Resultados de cada consulta.
+    double* latencias;              // Segundos de cada consulta.
+    atomic_size_t siguiente;        // Proxima consulta sin tomar.
+} TandaConsultas;
+
+// Lo propio de cada hilo: su memoria de trabajo, reservada una vez para toda la corrida.
+typedef struct {
+    TandaConsultas* tanda;
+    EspacioConsulta espacio;
+    ConsultaAnalizada consulta;
+    pthread_t hilo;
+} TrabajadorConsultas;
+
+// --- Funciones Estáticas ---
+
+static double segundos_ahora(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Ubica las frases entre comillas dobles; una comilla sin cerrar llega hasta el final de la consulta.
+static int buscar_frases(const char* consulta, FraseConsulta frases[]) {
+    int cantidad = 0;
+    const char* p = strchr(consulta, '"');
+    while (p && cantidad < MAX_FRASES_CONSULTA) {
+        FraseConsulta* frase = &frases[cantidad++];
+        frase->inicio = p + 1;
+        const char* cierre = strchr(frase->inicio, '"');
+        frase->fin = cierre ? cierre : consulta + strlen(consulta);
+        frase->cantidad = 0;
+        frase->tokens = 0;
+        p = cierre ? strchr(cierre + 1, '"') : NULL;
+    }
+    return cantidad;
+}
+
+// Frase que contiene al token (por su lugar en el texto de la consulta), o NULL si esta fuera de comillas.
+static FraseConsulta* frase_del_token(FraseConsulta frases[], int cantidad, const Token* token) {
+    for (int i = 0; i < cantidad; i++) {
+        if (token->inicio >= frases[i].inicio && token->inicio < frases[i].fin) {
+            return &frases[i];
+        }
+    }
+    return NULL;
+}
+
+static int comparar_latencias(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Percentil por rango mas cercano sobre latencias ya ordenadas.
+static double percentil(const double* ordenadas, size_t cantidad, double fraccion) {
+    if (cantidad == 0) return 0.0;
+    size_t rango = (size_t)ceil(fraccion * (double)cantidad);
+    return ordenadas[rango > 0 ? rango - 1 : 0];
+}
+
+// En el formato TREC los campos van separados por espacios: los de la URL se cambian por '_'.
+static void escribir_docno(FILE* salida, const char* url) {
+    for (const char* c = url; *c; c++) {
+        fputc(isspace((unsigned char)*c) ? '_' : *c, salida);
+    }
+}
+
+static void escribir_resultados(FILE* salida, FormatoResultados formato, const char* id_consulta,
+                                const ResultadoBusqueda* mejores, size_t cantidad, const TandaConsultas* tanda) {
+    for (size_t i = 0; i < cantidad; i++) {
+        const char* url = tanda->vista ? url_documento_segmentos(tanda->vista, mejores[i].doc_id)
+                                       : url_documento(tanda->indice->documentos, mejores[i].doc_id);
+        if (!url) url = "";
+        if (formato == FORMATO_TREC) {
+            fprintf(salida, "%s Q0 ", id_consulta);
+            escribir_docno(salida, url);
+            fprintf(salida, " %zu %.6f buscador\n", i + 1, mejores[i].puntaje);
+        } else {
+            fprintf(salida, "%s\t%zu\t%u\t%s\t%.6f\n", id_consulta, i + 1, (unsigned)mejores[i].doc_id, url, mejores[i].puntaje);
+        }
+    }
+}
+
+// --- Funciones Públicas ---
+
+void analizar_consulta(const char* texto, ConsultaAnalizada* consulta) {
+    consulta->cantidad = 0;
+    consulta->num_frases = 0;
+    if (!texto) return;
+
+    int num_frases = buscar_frases(texto, consulta->frases);
+    Tokenizador tokenizador;
+    iniciar_tokenizador(&tokenizador, texto, strlen(texto));
+
+    while (consulta->cantidad < MAX_TERMINOS_CONSULTA && siguiente_token(&tokenizador, &consulta->tokens[consulta->cantidad])) {
+        Token* token = &consulta->tokens[consulta->cantidad];
+        FraseConsulta* frase = frase_del_token(consulta->frases, num_frases, token);
+        if (!es_stopword_largo(token->texto, token->largo_texto)) {
+            consulta->terminos[consulta->cantidad] = token->texto;
+            consulta->cantidad++;
+            if (frase && frase->cantidad < MAX_TERMINOS_FRASE) {
+                frase->terminos[frase->cantidad] = token->texto;
+                frase->desplazamientos[frase->cantidad] = frase->tokens;
+                frase->cantidad++;
+            }
+        }
+        if (frase) frase->tokens++;
+    }
+
+    // Los desplazamientos se cuentan desde el primer termino de la frase; las de un solo termino no filtran nada.
+    for (int i = 0; i < num_frases; i++) {
+        FraseConsulta* frase = &consulta->frases[i];
+        if (frase->cantidad < 2) continue;
+        for (size_t j = frase->cantidad; j-- > 0;) {
+            frase->desplazamientos[j] -= frase->desplazamientos[0];
+        }
+        consulta->frases[consulta->num_frases++] = *frase;
+    }
+}
+
+
+size_t buscar_mejores_consulta(const indiceInvertido* indice, const ConsultaAnalizada* consulta, bool disyuntiva,
+                               EspacioConsulta* espacio, ResultadoBusqueda* mejores, size_t k) {
+    if (!indice || !consulta || !espacio || !mejores || k == 0) {
+        return 0;
+    }
+    size_t abiertos = 0;
+    for (int i = 0; i < consulta->cantidad; i++) {
+        if (abrir_cursor_termino(indice, consulta->terminos[i], &espacio->cursores[abiertos])) {
+            espacio->abiertos[abiertos] = &espacio->cursores[abiertos];
+            abiertos++;
+        } else if (!disyuntiva) {
+            return 0; // AND: falta un termino, no hay nada que intersectar.
+        }
+    }
+    if (abiertos == 0) {
+        return 0;
+    }
+    if (disyuntiva) {
+        return buscar_mejores_disyuntivo(indice, espacio->abiertos, abiertos, mejores, k, NULL);
+    }
+    return buscar_mejores_conjuntivo_con(indice, espacio->abiertos, abiertos, &espacio->interseccion, mejores, k, NULL);
+}
+
+
+static void* atender_consultas(void* argumento) {
+    TrabajadorConsultas* trabajador = (TrabajadorConsultas*)argumento;
+    TandaConsultas* tanda = trabajador->tanda;
+    for (;;) {
+        size_t i = atomic_fetch_add_explicit(&tanda->siguiente, 1, memory_order_relaxed);
+        if (i >= tanda->cantidad) break;
+        double antes = segundos_ahora();
+        analizar_consulta(tanda->textos[i], &trabajador->consulta);
+        MEDIR_DESDE(marca);
+        ResultadoBusqueda* mejores = tanda->resultados + i * tanda->k;
+        if (tanda->vista) {
+            tanda->encontrados[i] = buscar_mejores_segmentos(tanda->vista, &trabajador->consulta, tanda->disyuntiva,
+                                                             &trabajador->espacio, mejores, tanda->k, NULL, NULL);
+        } else {
+            tanda->encontrados[i] = buscar_mejores_consulta(tanda->indice, &trabajador->consulta, tanda->disyuntiva,
+                                                            &trabajador->espacio, mejores, tanda->k);
+        }
+        MEDIR_FASE(FASE_INTERSECTAR, marca);
+        tanda->latencias[i] = segundos_ahora() - antes;
+        MEDIR_CONTAR(CONTADOR_CONSULTAS, 1);
+    }
+    return NULL;
+}
+
+// Reparte la tanda entre los trabajadores: el hilo que llama atiende como el primero.
+// Si no se puede crear algun hilo, los que hay (al menos el que llama) se hacen cargo de todo.
+static void correr_tanda(TandaConsultas* tanda, TrabajadorConsultas* trabajadores, int num_hilos) {
+    atomic_store(&tanda->siguiente, 0);
+    int creados = 0;
+    for (int h = 1; h < num_hilos && (size_t)h < tanda->cantidad; h++) {
+        trabajadores[h].tanda = tanda;
+        if (pthread_create(&trabajadores[h].hilo, NULL, atender_consultas, &trabajadores[h]) != 0) {
+            break;
+        }
+        creados = h;
+    }
+    trabajadores[0].tanda = tanda;
+    atender_consultas(&trabajadores[0]);
+    for (int h = 1; h <= creados; h++) {
+        pthread_join(trabajadores[h].hilo, NULL);
+    }
+}
+
+// Lee la proxima tanda de consultas (sin las lineas vacias); sus textos quedan en 'textos_tanda'.
+static size_t leer_tanda(LectorLineas* lector, TandaConsultas* tanda, size_t maximo, size_t numeradas, Arena* textos_tanda) {
+    char* linea;
+    size_t largo;
+    size_t cantidad = 0;
+    while (cantidad < maximo && siguiente_linea(lector, &linea, &largo)) {
+        char* texto = linea;
+        char* tabulador = strchr(linea, '\t');
+        char id_numerico[24];
+        const char* id_consulta = id_numerico;
+        if (tabulador) {
+            *tabulador = '\0';
+            id_consulta = linea;
+            texto = tabulador + 1;
+        } else {
+            snprintf(id_numerico, sizeof(id_numerico), "%zu", numeradas + cantidad + 1);
+        }
+        if (*texto == '\0') continue;
+        tanda->ids[cantidad] = copiar_texto_en_arena(textos_tanda, id_consulta, strlen(id_consulta));
+        tanda->textos[cantidad] = copiar_texto_en_arena(textos_tanda, texto, strlen(texto));
+        if (!tanda->ids[cantidad] || !tanda->textos[cantidad]) break;
+        cantidad++;
+    }
+    return cantidad;
+}
+
+// El modo por lotes sobre un indice o (si 'segmentado' no es NULL) sobre un directorio de segmentos.
+static bool correr_lote(const indiceInvertido* indice, IndiceSegmentado* segmentado, const char* ruta_consultas,
+                        FILE* salida, FormatoResultados formato, bool disyuntiva, size_t k, int num_hilos,
+                        EstadisticasLote* estadisticas) {
+    if ((!indice && !segmentado) || !ruta_consultas || !salida || k == 0) {
+        return false;
+    }
+    if (num_hilos < 1) num_hilos = 1;
+    LectorLineas lector;
+    if (!abrir_lector_lineas(&lector, ruta_consultas)) {
+        return false;
+    }
+    size_t por_tanda = RESULTADOS_POR_TANDA / k;
+    if (por_tanda > CONSULTAS_POR_TANDA) por_tanda = CONSULTAS_POR_TANDA;
+    if (por_tanda < (size_t)num_hilos) por_tanda = (size_t)num_hilos;
+
+    TandaConsultas tanda;
+    memset(&tanda, 0, sizeof(tanda));
+    tanda.indice = indice;
+    tanda.disyuntiva = disyuntiva;
+    tanda.k = k;
+    tanda.ids = (char**)malloc(por_tanda * sizeof(char*));
+    tanda.textos = (char**)malloc(por_tanda * sizeof(char*));
+    tanda.resultados = (ResultadoBusqueda*)malloc(por_tanda * k * sizeof(ResultadoBusqueda));
+    tanda.encontrados = (size_t*)malloc(por_tanda * sizeof(size_t));
+    TrabajadorConsultas* trabajadores = (TrabajadorConsultas*)malloc((size_t)num_hilos * sizeof(TrabajadorConsultas));
+    size_t capacidad_latencias = CAPACIDAD_INICIAL_LATENCIAS;
+    double* latencias = (double*)malloc(capacidad_latencias * sizeof(double));
+    bool ok = tanda.ids && tanda.textos && tanda.resultados && tanda.encontrados && trabajadores && latencias;
+    if (!ok) {
+        perror("[CONSULTAS] Fallo malloc para el modo por lotes");
+    }
+
+    EstadisticasLote resumen;
+    memset(&resumen, 0, sizeof(resumen));
+    resumen.hilos = num_hilos;
+    Arena textos_tanda;
+    iniciar_arena(&textos_tanda, TAMANIO_BLOQUE_TEXTOS);
+    double inicio = segundos_ahora();
+    while (ok) {
+        tanda.cantidad = leer_tanda(&lector, &tanda, por_tanda, resumen.consultas, &textos_tanda);
+        if (tanda.cantidad == 0) break;
+        while (resumen.consultas + tanda.cantidad > capacidad_latencias) {
+            double* nuevas = (double*)realloc(latencias, 2 * capacidad_latencias * sizeof(double));
+            if (!nuevas) {
+                perror("[CONSULTAS] Fallo realloc para las latencias");
+                ok = false;
+                break;
+            }
+            latencias = nuevas;
+            capacidad_latencias *= 2;
+        }
+        if (!ok) break;
+        tanda.latencias = latencias + resumen.consultas;
+        // Una vista por tanda: los hilos la comparten y la fusion que termine mientras tanto se ve en la proxima.
+        VistaSegmentos vista;
+        if (segmentado) {
+            if (!tomar_vista_segmentos(segmentado, &vista)) {
+                ok = false;
+                break;
+            }
+            tanda.vista = &vista;
+        }
+
+        correr_tanda(&tanda, trabajadores, num_hilos);
+
+        MEDIR_DESDE(marca);
+        for (size_t i = 0; i < tanda.cantidad; i++) {
+            if (tanda.encontrados[i] == 0) resumen.sin_resultados++;
+            escribir_resultados(salida, formato, tanda.ids[i], tanda.resultados + i * k, tanda.encontrados[i], &tanda);
+        }
+        MEDIR_FASE(FASE_IMPRIMIR, marca);
+        if (segmentado) {
+            soltar_vista_segmentos(segmentado, &vista);
+            tanda.vista = NULL;
+        }
+        resumen.consultas += tanda.cantidad;
+        liberar_arena(&textos_tanda); // Queda vacia y lista para la proxima tanda.
+    }
+    resumen.segundos_totales = segundos_ahora() - inicio;
+    ok = ok && !lector.error_lectura;
+
+    if (ok && resumen.consultas > 0) {
+        qsort(latencias, resumen.consultas, sizeof(double), comparar_latencias);
+        resumen.latencia_p50_ms = 1000.0 * percentil(latencias, resumen.consultas, 0.50);
+        resumen.latencia_p95_ms = 1000.0 * percentil(latencias, resumen.consultas, 0.95);
+        resumen.latencia_p99_ms = 1000.0 * percentil(latencias, resumen.consultas, 0.99);
+        resumen.latencia_max_ms = 1000.0 * latencias[resumen.consultas - 1];
+    }
+    if (estadisticas) {
+        *estadisticas = resumen;
+    }
+    liberar_arena(&textos_tanda);
+    cerrar_lector_lineas(&lector);
+    free(latencias);
+    free(trabajadores);
+    free(tanda.encontrados);
+    free(tanda.resultados);
+    free(tanda.textos);
+    free(tanda.ids);
+    return ok;
+}
+
+bool correr_lote_consultas(const indiceInvertido* indice, const char* ruta_consultas, FILE* salida,
+                           FormatoResultados formato, bool disyuntiva, size_t k, int num_hilos,
+                           EstadisticasLote* estadisticas) {
+    if (!indice) return false;
+    return correr_lote(indice, NULL, ruta_consultas, salida, formato, disyuntiva, k, num_hilos, estadisticas);
+}
+
+bool correr_lote_consultas_segmentos(IndiceSegmentado* segmentado, const char* ruta_consultas, FILE* salida,
+                                     FormatoResultados formato, bool disyuntiva, size_t k, int num_hilos,
+                                     EstadisticasLote* estadisticas) {
+    if (!segmentado) return false;
+    return correr_lote(NULL, segmentado, ruta_consultas, salida, formato, disyuntiva, k, num_hilos, estadisticas);
+}
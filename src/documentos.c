@@ -0,0 +1,118 @@
+#include "includes/documentos.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+// --- Funciones Estáticas ---
+static bool aumentar_capacidad_documentos(TablaDocumentos* tabla) {
+    size_t nueva_capacidad = (tabla->capacidad == 0) ? 1024 : (size_t)tabla->capacidad * 2;
+    if (nueva_capacidad > DOC_ID_INVALIDO) {
+        // El ultimo valor de 32 bits esta reservado para DOC_ID_INVALIDO.
+        nueva_capacidad = DOC_ID_INVALIDO;
+        if (nueva_capacidad <= tabla->capacidad) {
+            fprintf(stderr, "[DOCS] Error: Se alcanzo el maximo de documentos que caben en un ID de 32 bits.\n");
+            return false;
+        }
+    }
+    char** nuevas_urls = (char**)realloc(tabla->urls, sizeof(char*) * nueva_capacidad);
+    if (!nuevas_urls) {
+        fprintf(stderr, "[DOCS] Error: Fallo al reasignar memoria para las URLs de la tabla de documentos.\n");
+        return false;
+    }
+    tabla->urls = nuevas_urls;
+    uint32_t* nuevos_largos = (uint32_t*)realloc(tabla->largos, sizeof(uint32_t) * nueva_capacidad);
+    if (!nuevos_largos) {
+        fprintf(stderr, "[DOCS] Error: Fallo al reasignar memoria para los largos de la tabla de documentos.\n");
+        return false;
+    }
+    tabla->largos = nuevos_largos;
+    tabla->capacidad = (uint32_t)nueva_capacidad;
+    return true;
+}
+
+// --- Implementación de Funciones Públicas (declaradas en documentos.h) ---
+
+TablaDocumentos* crear_tabla_documentos(size_t capacidad_inicial) {
+    TablaDocumentos* tabla = (TablaDocumentos*)calloc(1, sizeof(TablaDocumentos));
+    if (!tabla) {
+        perror("[DOCS] Fallo calloc para la tabla de documentos");
+        return NULL;
+    }
+    if (capacidad_inicial > 0) {
+        tabla->urls = (char**)malloc(sizeof(char*) * capacidad_inicial);
+        tabla->largos = (uint32_t*)malloc(sizeof(uint32_t) * capacidad_inicial);
+        if (!tabla->urls || !tabla->largos) {
+            perror("[DOCS] Fallo malloc para los arrays de la tabla de documentos");
+            free(tabla->urls);
+            free(tabla->largos);
+            free(tabla);
+            return NULL;
+        }
+        tabla->capacidad = (uint32_t)capacidad_inicial;
+    }
+    iniciar_arena(&tabla->textos, TAMANIO_BLOQUE_TEXTOS);
+    return tabla;
+}
+
+TablaDocumentos* crear_tabla_documentos_mapeada(uint32_t cantidad, const uint32_t* largos, const char* texto_urls,
+                                                const uint64_t* offsets_urls, uint64_t suma_largos) {
+    TablaDocumentos* tabla = (TablaDocumentos*)calloc(1, sizeof(TablaDocumentos));
+    if (!tabla) {
+        perror("[DOCS] Fallo calloc para la tabla de documentos mapeada");
+        return NULL;
+    }
+    // "largos" apunta a memoria de solo lectura; las funciones que escriben revisan texto_urls antes.
+    tabla->largos = (uint32_t*)largos;
+    tabla->cantidad = cantidad;
+    tabla->capacidad = cantidad;
+    tabla->suma_largos = suma_largos;
+    tabla->texto_urls = texto_urls;
+    tabla->offsets_urls = offsets_urls;
+    return tabla;
+}
+
+void destruir_tabla_documentos(TablaDocumentos* tabla) {
+    if (!tabla) return;
+    if (tabla->texto_urls) {
+        free(tabla); // Los datos son del archivo mapeado.
+        return;
+    }
+    liberar_arena(&tabla->textos); // Todas las URLs juntas.
+    free(tabla->urls);
+    free(tabla->largos);
+    free(tabla);
+}
+
+uint32_t registrar_documento(TablaDocumentos* tabla, const char* url, size_t largo_url) {
+    if (!tabla || !url || tabla->texto_urls) {
+        return DOC_ID_INVALIDO;
+    }
+    if (tabla->cantidad >= tabla->capacidad && !aumentar_capacidad_documentos(tabla)) {
+        return DOC_ID_INVALIDO;
+    }
+    char* copia = copiar_texto_en_arena(&tabla->textos, url, largo_url);
+    if (!copia) {
+        fprintf(stderr, "[DOCS] Error: Fallo la copia de la URL del documento.\n");
+        return DOC_ID_INVALIDO;
+    }
+
+    uint32_t id = tabla->cantidad++;
+    tabla->urls[id] = copia;
+    tabla->largos[id] = 0;
+    return id;
+}
+
+void fijar_largo_documento(TablaDocumentos* tabla, uint32_t doc_id, uint32_t largo) {
+    if (!tabla || doc_id >= tabla->cantidad || tabla->texto_urls) return;
+    tabla->suma_largos -= tabla->largos[doc_id];
+    tabla->largos[doc_id] = largo;
+    tabla->suma_largos += largo;
+}
+
+const char* url_documento(const TablaDocumentos* tabla, uint32_t doc_id) {
+    if (!tabla || doc_id >= tabla->cantidad) return NULL;
+    if (tabla->texto_urls) return tabla->texto_urls + tabla->offsets_urls[doc_id];
+    return tabla->urls[doc_id];
+}
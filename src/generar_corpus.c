@@ -0,0 +1,140 @@
+// Generador de corpus sinteticos para los benchmarks (make bench).
+// Escribe documentos en el formato de siempre, "URL|| contenido", con terminos sacados de una Zipf
+// (pocas palabras muy comunes y una cola larga) mezclados con stopwords, y largos log-normales
+// (la mayoria cerca de la mediana y algunos muy largos). Con la misma semilla sale el mismo archivo.
+// Uso: ./generar_corpus <salida.dat> [--documentos N] [--vocabulario V] [--zipf S] [--largo-medio L]
+//                                     [--stopwords P] [--semilla X]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#define DOCUMENTOS_POR_DEFECTO 100000
+#define VOCABULARIO_POR_DEFECTO 50000
+#define ZIPF_POR_DEFECTO 1.0
+#define LARGO_MEDIO_POR_DEFECTO 150      // Mediana de terminos por documento.
+#define DISPERSION_LARGO 0.7             // Sigma del logaritmo del largo.
+#define STOPWORDS_POR_DEFECTO 0.3        // Fraccion de tokens que son stopwords.
+#define SEMILLA_POR_DEFECTO 2463534242u
+#define HOSTS 1000                       // Documentos repartidos en s0.example.org ... s999.example.org.
+
+// Stopwords comunes del ingles (todas estan en data/stopwords_english.dat.txt).
+static const char* const STOPWORDS[] = { "the", "of", "and", "to", "in", "is", "for", "on", "a" };
+#define NUM_STOPWORDS (sizeof(STOPWORDS) / sizeof(STOPWORDS[0]))
+
+// xorshift32: reproducible entre maquinas, a diferencia de rand().
+static uint32_t g_semilla = SEMILLA_POR_DEFECTO;
+static uint32_t aleatorio(void) {
+    g_semilla ^= g_semilla << 13;
+    g_semilla ^= g_semilla >> 17;
+    g_semilla ^= g_semilla << 5;
+    return g_semilla;
+}
+
+// Uniforme en (0, 1): nunca 0, asi se le puede sacar el logaritmo.
+static double aleatorio_unitario(void) {
+    return ((double)aleatorio() + 1.0) / 4294967297.0;
+}
+
+// Normal estandar por Box-Muller.
+static double aleatorio_normal(void) {
+    double u = aleatorio_unitario();
+    double v = aleatorio_unitario();
+    return sqrt(-2.0 * log(u)) * cos(6.283185307179586 * v);
+}
+
+// Rango Zipf por busqueda binaria sobre la distribucion acumulada.
+static uint32_t rango_zipf(const double* acumulada, uint32_t vocabulario) {
+    double u = aleatorio_unitario() * acumulada[vocabulario - 1];
+    uint32_t bajo = 0, alto = vocabulario - 1;
+    while (bajo < alto) {
+        uint32_t medio = bajo + (alto - bajo) / 2;
+        if (acumulada[medio] < u) bajo = medio + 1; else alto = medio;
+    }
+    return bajo;
+}
+
+static void imprimir_uso(const char* programa) {
+    fprintf(stderr, "Uso: %s <salida.dat> [--documentos N] [--vocabulario V] [--zipf S] [--largo-medio L]\n", programa);
+    fprintf(stderr, "       [--stopwords P] [--semilla X]\n");
+    fprintf(stderr, "  Por defecto: %d documentos, vocabulario de %d terminos, Zipf %.1f, mediana de %d terminos,\n",
+            DOCUMENTOS_POR_DEFECTO, VOCABULARIO_POR_DEFECTO, ZIPF_POR_DEFECTO, LARGO_MEDIO_POR_DEFECTO);
+    fprintf(stderr, "  %.0f%% de stopwords.\n", 100.0 * STOPWORDS_POR_DEFECTO);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argv[1][0] == '-') {
+        imprimir_uso(argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char* ruta_salida = argv[1];
+    unsigned long documentos = DOCUMENTOS_POR_DEFECTO;
+    unsigned long vocabulario = VOCABULARIO_POR_DEFECTO;
+    double zipf = ZIPF_POR_DEFECTO;
+    double largo_medio = LARGO_MEDIO_POR_DEFECTO;
+    double fraccion_stopwords = STOPWORDS_POR_DEFECTO;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--documentos") == 0) {
+            documentos = strtoul(argv[i + 1], NULL, 10);
+        } else if (strcmp(argv[i], "--vocabulario") == 0) {
+            vocabulario = strtoul(argv[i + 1], NULL, 10);
+        } else if (strcmp(argv[i], "--zipf") == 0) {
+            zipf = strtod(argv[i + 1], NULL);
+        } else if (strcmp(argv[i], "--largo-medio") == 0) {
+            largo_medio = strtod(argv[i + 1], NULL);
+        } else if (strcmp(argv[i], "--stopwords") == 0) {
+            fraccion_stopwords = strtod(argv[i + 1], NULL);
+        } else if (strcmp(argv[i], "--semilla") == 0) {
+            g_semilla = (uint32_t)strtoul(argv[i + 1], NULL, 10);
+            if (g_semilla == 0) g_semilla = SEMILLA_POR_DEFECTO; // xorshift no sale nunca del 0.
+        } else {
+            imprimir_uso(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (documentos == 0 || vocabulario == 0 || vocabulario > UINT32_MAX || zipf < 0.0 || largo_medio < 1.0 ||
+        fraccion_stopwords < 0.0 || fraccion_stopwords >= 1.0) {
+        fprintf(stderr, "[GENERAR] Parametros fuera de rango.\n");
+        return EXIT_FAILURE;
+    }
+
+    double* acumulada = malloc(vocabulario * sizeof(double));
+    FILE* salida = fopen(ruta_salida, "w");
+    if (!acumulada || !salida) {
+        fprintf(stderr, "[GENERAR] No se pudo preparar '%s' o la memoria de la distribucion.\n", ruta_salida);
+        free(acumulada);
+        if (salida) fclose(salida);
+        return EXIT_FAILURE;
+    }
+    double suma = 0.0;
+    for (unsigned long r = 0; r < vocabulario; r++) {
+        suma += 1.0 / pow((double)(r + 1), zipf);
+        acumulada[r] = suma;
+    }
+
+    unsigned long long tokens = 0;
+    const uint32_t largo_maximo = (uint32_t)(20.0 * largo_medio);
+    for (unsigned long d = 0; d < documentos; d++) {
+        double largo_real = exp(log(largo_medio) + DISPERSION_LARGO * aleatorio_normal());
+        uint32_t largo = largo_real < 1.0 ? 1 : largo_real > largo_maximo ? largo_maximo : (uint32_t)largo_real;
+        fprintf(salida, "http://s%lu.example.org/p/%lu||", d % HOSTS, d);
+        for (uint32_t i = 0; i < largo; i++) {
+            if (aleatorio_unitario() < fraccion_stopwords) {
+                fprintf(salida, " %s", STOPWORDS[aleatorio() % NUM_STOPWORDS]);
+            } else {
+                fprintf(salida, " t%u", (unsigned)rango_zipf(acumulada, (uint32_t)vocabulario));
+            }
+        }
+        fputc('\n', salida);
+        tokens += largo;
+    }
+    free(acumulada);
+    if (fclose(salida) != 0) {
+        fprintf(stderr, "[GENERAR] Error escribiendo '%s'.\n", ruta_salida);
+        return EXIT_FAILURE;
+    }
+    printf("[GENERAR] %lu documentos y %llu tokens escritos en '%s'.\n", documentos, tokens, ruta_salida);
+    return EXIT_SUCCESS;
+}
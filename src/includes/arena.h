@@ -0,0 +1,120 @@
+#ifndef arena_H_
+#define arena_H_
+
+#include <stdbool.h>
+#include <stddef.h>     // Para size_t
+#include <stdint.h>     // Para uint32_t
+
+/** @brief Bytes de cada bloque de la arena de textos (palabras del vocabulario y URLs). */
+#define TAMANIO_BLOQUE_TEXTOS (64u << 10)
+/** @brief Bytes de cada bloque de la arena que reparte el pool de posteos. */
+#define TAMANIO_BLOQUE_POSTEOS (256u << 10)
+
+/** @brief Bloque de una arena: cabecera seguida de los datos (definido en arena.c). */
+struct BloqueArena;
+
+/**
+ * @brief Arena (asignador por avance): reparte memoria de bloques grandes moviendo un puntero y
+ * no libera nada por separado; todo se suelta junto con liberar_arena.
+ * Sirve para datos que viven lo mismo que su dueño, como las palabras del vocabulario.
+**/
+typedef struct {
+    struct BloqueArena* bloques;  // Bloque actual (el primero de la cadena); NULL si la arena esta vacia.
+    size_t usado;                 // Bytes ya entregados del bloque actual.
+    size_t tamanio_bloque;        // Bytes de datos de cada bloque nuevo.
+    size_t bytes_reservados;      // Total pedido al sistema (para informes de memoria).
+} Arena;
+
+/**
+ * @brief Clases de tamanio del pool: bloques de 2^(clase+1) pares (doc_id, frecuencia), de 2 a 16.
+ * Alcanza para la gran mayoria de los terminos, que aparecen en muy pocos documentos. Con clases mas
+ * grandes, los bloques que sueltan las listas largas al pasar a malloc quedan sin reutilizar.
+**/
+#define CLASES_POOL_POSTEOS 4
+/** @brief Capacidad maxima de una lista de posteo que vive en el pool; las mas grandes usan malloc. */
+#define CAPACIDAD_MAXIMA_POOL (2u << (CLASES_POOL_POSTEOS - 1))
+
+/**
+ * @brief Pool de arrays de posteo: los saca de una arena y reutiliza los que se sueltan al crecer
+ * una lista, con una lista de libres por clase de tamanio (potencias de 2).
+ * Cada bloque guarda los doc_ids seguidos de las frecuencias de una lista.
+**/
+typedef struct {
+    Arena arena;                             // De donde salen los bloques nuevos.
+    void* libres[CLASES_POOL_POSTEOS];       // Bloques sueltos de cada clase, encadenados por su primer puntero.
+    size_t bytes_fuera_del_pool;             // Bytes con malloc de las listas que crecieron mas alla del pool (para informes de memoria).
+} PoolPosteos;
+
+// --- Prototipos de Funciones de la Arena ---
+
+/**
+ * @brief Prepara una arena vacia (no reserva nada hasta el primer pedido).
+ * @param arena La arena.
+ * @param tamanio_bloque Bytes de datos de cada bloque que se pida al sistema.
+ */
+void iniciar_arena(Arena* arena, size_t tamanio_bloque);
+
+/**
+ * @brief Entrega 'bytes' bytes alineados a 8 de la arena. Un pedido mas grande que el bloque
+ * recibe un bloque propio.
+ * @param arena La arena.
+ * @param bytes Cantidad de bytes.
+ * @return void* La memoria (vive hasta liberar_arena) o NULL si falla la memoria.
+ */
+void* reservar_en_arena(Arena* arena, size_t bytes);
+
+/**
+ * @brief Copia 'largo' caracteres de 'texto' en la arena y agrega el '\0'.
+ * @param arena La arena.
+ * @param texto El texto (no necesita terminar en '\0').
+ * @param largo Cantidad de caracteres a copiar.
+ * @return char* La copia o NULL si falla la memoria.
+ */
+char* copiar_texto_en_arena(Arena* arena, const char* texto, size_t largo);
+
+/**
+ * @brief Pasa todos los bloques de 'origen' a 'destino', que desde ahi es dueña de esa memoria.
+ * Lo que se haya entregado desde 'origen' sigue siendo valido; 'origen' queda vacia.
+ * @param destino Arena que se queda con los bloques.
+ * @param origen Arena que se vacia.
+ */
+void adoptar_arena(Arena* destino, Arena* origen);
+
+/**
+ * @brief Libera todos los bloques de la arena (unos pocos free) y la deja vacia.
+ * @param arena La arena.
+ */
+void liberar_arena(Arena* arena);
+
+// --- Prototipos de Funciones del Pool de Posteos ---
+
+/**
+ * @brief Prepara un pool de posteos vacio.
+ * @param pool El pool.
+ */
+void iniciar_pool_posteos(PoolPosteos* pool);
+
+/**
+ * @brief Entrega un bloque para 'capacidad' pares (doc_id, frecuencia).
+ * @param pool El pool.
+ * @param capacidad Una potencia de 2 entre 2 y CAPACIDAD_MAXIMA_POOL.
+ * @return uint32_t* El bloque (2 * capacidad enteros) o NULL si falla la memoria.
+ */
+uint32_t* pedir_bloque_posteos(PoolPosteos* pool, uint32_t capacidad);
+
+/**
+ * @brief Devuelve al pool un bloque entregado por pedir_bloque_posteos (de este pool o de uno
+ * cuya arena adopto) para reutilizarlo.
+ * @param pool El pool.
+ * @param bloque El bloque.
+ * @param capacidad La capacidad con que se pidio.
+ */
+void devolver_bloque_posteos(PoolPosteos* pool, uint32_t* bloque, uint32_t capacidad);
+
+/**
+ * @brief Libera toda la memoria del pool.
+ * @param pool El pool.
+ */
+void liberar_pool_posteos(PoolPosteos* pool);
+
+#endif // arena_H_
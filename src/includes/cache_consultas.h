@@ -0,0 +1,145 @@
+#ifndef cache_consultas_H_
+#define cache_consultas_H_
+
+#include <stdbool.h>
+#include <stddef.h>     // Para size_t
+#include <stdint.h>     // Para uint64_t
+#include "inverted_index.h"
+#include "list.h"
+#include "ranking.h"
+#include "consultas.h"
+#include "tokenizador.h"
+#include "posiciones.h"
+
+/** @brief Bytes que usa la cache del main si no se da --cache-bytes. */
+#define CACHE_BYTES_POR_DEFECTO (8u << 20)
+
+/**
+ * @brief Largo maximo de una clave: el modo, k, los terminos y las frases con sus desplazamientos.
+**/
+#define MAX_LARGO_CLAVE_CACHE (32 + MAX_TERMINOS_CONSULTA * (MAX_LARGO_TERMINO + 1) + \
+                               MAX_FRASES_CONSULTA * (3 + MAX_TERMINOS_FRASE * (MAX_LARGO_TERMINO + 12)))
+
+/** @brief Como se resolvio la consulta (va en la clave: la misma consulta da otra cosa en otro modo). */
+typedef enum {
+    MODO_CACHE_CONJUNTIVO,          // AND sin ranking: la lista completa (con frases, si se filtraron).
+    MODO_CACHE_CONJUNTIVO_RANKING,  // AND con los k mejores por BM25.
+    MODO_CACHE_DISYUNTIVO           // OR con los k mejores por BM25.
+} ModoCache;
+
+/** @brief Una consulta guardada (definida en cache_consultas.c). */
+struct EntradaCache;
+
+/**
+ * @brief Cache de resultados de consultas con reemplazo LRU y un presupuesto de bytes.
+ * La clave es la consulta normalizada (terminos sin stopwords, ordenados) y el valor, el resultado:
+ * la lista de documentos comprimida (deltas en VByte) o los k mejores con su puntaje.
+ * La cache recuerda el indice con que se lleno (identidad, version y tabla de documentos); si el indice
+ * cambia o es otro, se vacia antes de responder, asi nunca entrega un resultado viejo. Con un directorio
+ * de segmentos recuerda la generacion de la vista (ver validar_cache_segmentos).
+ * No es segura entre hilos: cada hilo que atiende consultas necesita la suya.
+**/
+typedef struct {
+    struct EntradaCache** cubetas;   // Tabla hash (encadenada) de las entradas.
+    size_t num_cubetas;              // Potencia de 2.
+    struct EntradaCache* mas_reciente;   // Cabeza de la lista LRU.
+    struct EntradaCache* menos_reciente; // Cola: la primera que se desaloja.
+    size_t entradas;
+    size_t bytes_usados;             // Entradas completas (cabecera, clave y resultado).
+    size_t presupuesto_bytes;
+
+    uint64_t aciertos;
+    uint64_t fallos;
+    uint64_t desalojos;              // Entradas sacadas para hacer lugar.
+    uint64_t invalidaciones;         // Veces que se vacio porque el indice cambio.
+
+    // Con que indice se lleno.
+    const indiceInvertido* indice;
+    uint64_t identidad_indice;
+    uint64_t version_indice;
+    uint32_t documentos_indice;
+    uint64_t suma_largos_indice;
+    bool por_segmentos;              // Se lleno con vistas de segmentos (entonces 'indice' es NULL).
+    uint64_t generacion_segmentos;   // La de la vista con que se lleno.
+} CacheConsultas;
+
+// --- Prototipos de Funciones de la Cache ---
+
+/**
+ * @brief Prepara una cache vacia.
+ * @param cache La cache.
+ * @param presupuesto_bytes Bytes maximos de las entradas (0: la cache no guarda nada).
+ * @return bool false si falla la memoria de la tabla.
+ */
+bool iniciar_cache_consultas(CacheConsultas* cache, size_t presupuesto_bytes);
+
+/**
+ * @brief Libera todas las entradas y la tabla (la cache queda vacia y sin presupuesto).
+ * @param cache La cache.
+ */
+void liberar_cache_consultas(CacheConsultas* cache);
+
+/**
+ * @brief Arma la clave de una consulta: el modo, k (si hay ranking), los terminos ordenados (con
+ * repeticiones, que cambian el resultado) y, en modo conjuntivo, las primeras 'num_frases' frases.
+ * "b a" y "a b" dan la misma clave; "a a" y "a", no.
+ * @param consulta La consulta analizada.
+ * @param modo Como se va a resolver.
+ * @param k Resultados pedidos (se ignora en MODO_CACHE_CONJUNTIVO).
+ * @param num_frases Frases que se filtran (0 si se buscan como terminos sueltos).
+ * @param clave Buffer de al menos MAX_LARGO_CLAVE_CACHE bytes.
+ * @return size_t Largo de la clave (sin '\0').
+ */
+size_t armar_clave_consulta(const ConsultaAnalizada* consulta, ModoCache modo, size_t k, int num_frases, char* clave);
+
+/**
+ * @brief Prepara la cache para responder con una vista de un directorio de segmentos: si se lleno con un
+ * indice o con otra generacion de los segmentos (una fusion o un segmento agregado la cambian), se vacia.
+ * Se llama con cada vista nueva, antes de buscar o guardar con 'indice' en NULL. La cache sirve a un
+ * solo directorio de segmentos.
+ * @param cache La cache.
+ * @param generacion La generacion de la vista (VistaSegmentos.generacion).
+ * @param total_documentos Los documentos de la vista.
+ * @param suma_largos La suma de los largos de la vista.
+ */
+void validar_cache_segmentos(CacheConsultas* cache, uint64_t generacion, uint32_t total_documentos, uint64_t suma_largos);
+
+/**
+ * @brief Busca el resultado de una consulta conjuntiva sin ranking.
+ * @param cache La cache.
+ * @param indice El indice con el que se va a responder (si cambio, la cache se vacia), o NULL con
+ * segmentos despues de validar_cache_segmentos.
+ * @param clave La clave de armar_clave_consulta.
+ * @param largo_clave Su largo.
+ * @param resultado Recibe una copia de la lista (liberar con free_list) si hay acierto.
+ * @return bool true si estaba (acierto).
+ */
+bool buscar_lista_en_cache(CacheConsultas* cache, const indiceInvertido* indice, const char* clave, size_t largo_clave,
+                           ListaPosteo* resultado);
+
+/**
+ * @brief Guarda el resultado de una consulta conjuntiva sin ranking (si cabe en el presupuesto).
+ * @return bool true si quedo guardado.
+ */
+bool guardar_lista_en_cache(CacheConsultas* cache, const indiceInvertido* indice, const char* clave, size_t largo_clave,
+                            const ListaPosteo* resultado);
+
+/**
+ * @brief Busca los mejores resultados de una consulta con ranking.
+ * @param mejores Array de al menos k elementos (el k de la clave).
+ * @param cantidad Recibe cuantos resultados se copiaron.
+ * @param datos Recibe los dos numeros que se guardaron con el resultado (puede ser NULL).
+ * @return bool true si estaba (acierto).
+ */
+bool buscar_mejores_en_cache(CacheConsultas* cache, const indiceInvertido* indice, const char* clave, size_t largo_clave,
+                             ResultadoBusqueda* mejores, size_t* cantidad, uint64_t datos[2]);
+
+/**
+ * @brief Guarda los mejores resultados de una consulta con ranking, junto con dos numeros que el
+ * que llama quiera recuperar (por ejemplo, los posteos leidos y los totales).
+ * @return bool true si quedo guardado.
+ */
+bool guardar_mejores_en_cache(CacheConsultas* cache, const indiceInvertido* indice, const char* clave, size_t largo_clave,
+                              const ResultadoBusqueda* mejores, size_t cantidad, const uint64_t datos[2]);
+
+#endif // cache_consultas_H_
@@ -0,0 +1,133 @@
+#ifndef consultas_H_
+#define consultas_H_
+
+#include <stdbool.h>
+#include <stddef.h>     // Para size_t
+#include <stdint.h>     // Para uint32_t
+#include <stdio.h>      // Para FILE
+#include "inverted_index.h"
+#include "tokenizador.h"
+#include "ranking.h"
+
+#define MAX_TERMINOS_CONSULTA 20 // Maximo de palabras "utiles" en una consulta.
+#define MAX_FRASES_CONSULTA 4    // Maximo de frases entre comillas en una consulta.
+
+/**
+ * @brief Una frase entre comillas de la consulta: sus terminos (sin stopwords) y el lugar de cada uno.
+**/
+typedef struct {
+    const char* inicio;                              // Primer caracter despues de la comilla que abre.
+    const char* fin;                                 // La comilla que cierra (o el final de la consulta).
+    const char* terminos[MAX_TERMINOS_FRASE];
+    uint32_t desplazamientos[MAX_TERMINOS_FRASE];    // Tokens desde el primer termino de la frase, con stopwords.
+    size_t cantidad;
+    uint32_t tokens;                                 // Tokens de la frase vistos hasta ahora.
+} FraseConsulta;
+
+/**
+ * @brief Una consulta ya normalizada con el mismo tokenizador que el parser: sus terminos sin
+ * stopwords y las frases entre comillas que hay que comprobar con posiciones.
+ * Los terminos apuntan a los tokens de la misma estructura, asi que no se debe copiar.
+**/
+typedef struct {
+    Token tokens[MAX_TERMINOS_CONSULTA];
+    char* terminos[MAX_TERMINOS_CONSULTA];   // Terminos de la consulta (los de las frases tambien).
+    int cantidad;
+    FraseConsulta frases[MAX_FRASES_CONSULTA]; // Solo las de dos o mas terminos.
+    int num_frases;
+} ConsultaAnalizada;
+
+/**
+ * @brief Memoria de trabajo para ejecutar consultas: los cursores de cada termino (traen los
+ * buffers de bloque, por eso no van en el stack) y el estado de la interseccion. Se reutiliza de
+ * una consulta a otra, asi buscar no pide memoria; cada hilo que atiende consultas tiene el suyo.
+**/
+typedef struct {
+    CursorPosteo cursores[MAX_TERMINOS_CONSULTA];
+    CursorPosteo* abiertos[MAX_TERMINOS_CONSULTA];
+    InterseccionCursores interseccion;
+} EspacioConsulta;
+
+typedef struct IndiceSegmentado IndiceSegmentado; // Directorio de segmentos (ver segmentos.h).
+
+/** @brief Formato de los resultados del modo por lotes. */
+typedef enum {
+    FORMATO_TSV,   // id_consulta, rango, doc_id, url y puntaje separados por tabuladores.
+    FORMATO_TREC   // "id_consulta Q0 url rango puntaje buscador" (formato run de TREC).
+} FormatoResultados;
+
+/**
+ * @brief Resumen de una corrida por lotes. Las latencias se miden por consulta (analisis y
+ * busqueda, sin escribir los resultados).
+**/
+typedef struct {
+    int hilos;                // Hilos que atendieron las consultas.
+    size_t consultas;         // Consultas ejecutadas (lineas no vacias).
+    size_t sin_resultados;    // Consultas que no encontraron ningun documento.
+    double segundos_totales;  // Tiempo de reloj de toda la corrida.
+    double latencia_p50_ms;
+    double latencia_p95_ms;
+    double latencia_p99_ms;
+    double latencia_max_ms;
+} EstadisticasLote;
+
+// --- Prototipos de Funciones de Consultas ---
+
+/**
+ * @brief Normaliza una consulta: tokeniza, saca stopwords y ubica las frases entre comillas dobles
+ * (una comilla sin cerrar llega hasta el final). Los terminos de las frases tambien quedan en
+ * 'terminos'; el lugar de cada uno dentro de su frase cuenta las stopwords, como las posiciones del parser.
+ * Las stopwords ya deben estar cargadas.
+ * @param texto La consulta (terminada en '\0'; debe seguir existiendo mientras se use 'consulta').
+ * @param consulta Donde se deja la consulta analizada.
+ */
+void analizar_consulta(const char* texto, ConsultaAnalizada* consulta);
+
+/**
+ * @brief Ejecuta una consulta con ranking BM25 y deja las k mejores en 'mejores'.
+ * AND: si falta un termino no hay resultados. OR (disyuntiva): los terminos que faltan no aportan.
+ * Las frases se buscan como terminos sueltos (la busqueda de frases es solo sin ranking).
+ * @param indice El indice (solo se lee).
+ * @param consulta La consulta analizada.
+ * @param disyuntiva true para OR con Block-Max WAND, false para AND.
+ * @param espacio Memoria de trabajo (ver EspacioConsulta).
+ * @param mejores Array de al menos k elementos; queda ordenado de mejor a peor.
+ * @param k Cuantos resultados se quieren.
+ * @return size_t Resultados escritos en 'mejores'.
+ */
+size_t buscar_mejores_consulta(const indiceInvertido* indice, const ConsultaAnalizada* consulta, bool disyuntiva,
+                               EspacioConsulta* espacio, ResultadoBusqueda* mejores, size_t k);
+
+/**
+ * @brief Modo por lotes: ejecuta cada linea de 'ruta_consultas' como una consulta con ranking y
+ * escribe sus k mejores resultados en 'salida'. Una linea "id<TAB>consulta" trae su propio ID;
+ * si no, el ID es el numero de consulta (1, 2, ...). Las lineas vacias se saltan.
+ * Las consultas se leen por tandas y los hilos se las reparten sobre el mismo indice, que nadie
+ * modifica mientras tanto; cada hilo usa su propio EspacioConsulta, asi no hay locks ni malloc
+ * por consulta. Los resultados se escriben en el orden del archivo, con cualquier numero de hilos.
+ * @param indice El indice (solo se lee).
+ * @param ruta_consultas Archivo con una consulta por linea.
+ * @param salida Donde se escriben los resultados.
+ * @param formato FORMATO_TSV o FORMATO_TREC.
+ * @param disyuntiva true para OR, false para AND.
+ * @param k Resultados por consulta.
+ * @param num_hilos Hilos que atienden las consultas (1: todo en el hilo que llama).
+ * @param estadisticas Recibe el resumen de latencias (puede ser NULL).
+ * @return bool false si no se pudo abrir el archivo o falla la memoria.
+ */
+bool correr_lote_consultas(const indiceInvertido* indice, const char* ruta_consultas, FILE* salida,
+                           FormatoResultados formato, bool disyuntiva, size_t k, int num_hilos,
+                           EstadisticasLote* estadisticas);
+
+/**
+ * @brief Como correr_lote_consultas, pero sobre un directorio de segmentos (ver segmentos.h). Cada
+ * tanda toma su propia vista de los segmentos, asi las fusiones en segundo plano no esperan al lote
+ * ni lo cambian a mitad de una tanda; los doc_id de los resultados son los de la coleccion.
+ * @param segmentado El directorio de segmentos abierto.
+ * (Los demas parametros y el resultado, como en correr_lote_consultas.)
+ */
+bool correr_lote_consultas_segmentos(IndiceSegmentado* segmentado, const char* ruta_consultas, FILE* salida,
+                                     FormatoResultados formato, bool disyuntiva, size_t k, int num_hilos,
+                                     EstadisticasLote* estadisticas);
+
+#endif // consultas_H_
@@ -0,0 +1,86 @@
+#ifndef documentos_H_
+#define documentos_H_
+
+#include <stddef.h>     // Para size_t
+#include <stdint.h>     // Para uint32_t, uint64_t
+#include "arena.h"
+
+/** @brief Valor que devuelve registrar_documento cuando no pudo asignar un ID. */
+#define DOC_ID_INVALIDO UINT32_MAX
+
+/**
+ * @brief Tabla de documentos: traduce el ID numerico de cada documento (su posicion en la tabla)
+ * a su URL, y guarda datos por documento como su largo en terminos.
+ * Las listas de posteo guardan solo el ID de 32 bits; la URL se busca aqui al momento de mostrarla.
+ * Una tabla de solo lectura (ver crear_tabla_documentos_mapeada) no tiene "urls": sus URLs y largos
+ * viven en un archivo de indice mapeado en memoria y la tabla no los copia ni los libera.
+**/
+typedef struct {
+    char** urls;          // urls[id] es la URL del documento 'id' (copia en "textos"). NULL si es de solo lectura.
+    uint32_t* largos;     // largos[id] es la cantidad de terminos indexados del documento 'id'.
+    uint32_t cantidad;    // Numero de documentos registrados (el proximo ID a entregar).
+    uint32_t capacidad;   // Capacidad actual de los arrays "urls" y "largos".
+    uint64_t suma_largos; // Suma de todos los largos, para sacar el largo promedio.
+
+    const char* texto_urls;        // Solo lectura: la URL de 'id' es el texto terminado en '\0' en texto_urls + offsets_urls[id].
+    const uint64_t* offsets_urls;  // Solo lectura: desplazamiento de cada URL dentro de "texto_urls".
+    Arena textos;                  // Arena donde se copian las URLs registradas (vacia si es de solo lectura).
+} TablaDocumentos;
+
+// --- Prototipos de funciones de TablaDocumentos ---
+
+/**
+ * @brief Crea una tabla de documentos vacia.
+ * @param capacidad_inicial Capacidad inicial de los arrays (si es 0 se usa un valor por defecto).
+ * @return TablaDocumentos* Puntero a la nueva tabla o NULL si falla la memoria.
+**/
+TablaDocumentos* crear_tabla_documentos(size_t capacidad_inicial);
+
+/**
+ * @brief Crea una tabla de solo lectura sobre datos que ya estan en memoria (un archivo de indice mapeado).
+ * No copia nada: los arrays deben vivir mas que la tabla. registrar_documento y fijar_largo_documento
+ * no hacen nada sobre esta tabla.
+ * @param cantidad Numero de documentos.
+ * @param largos largos[id] para cada documento.
+ * @param texto_urls Base de los textos de las URLs.
+ * @param offsets_urls Desplazamiento de la URL de cada documento desde "texto_urls".
+ * @param suma_largos Suma de todos los largos.
+ * @return TablaDocumentos* Puntero a la nueva tabla o NULL si falla la memoria.
+**/
+TablaDocumentos* crear_tabla_documentos_mapeada(uint32_t cantidad, const uint32_t* largos, const char* texto_urls,
+                                                const uint64_t* offsets_urls, uint64_t suma_largos);
+
+/**
+ * @brief Libera la tabla de documentos y todas las URLs que guarda.
+ * @param tabla Puntero a la tabla a destruir (puede ser NULL).
+**/
+void destruir_tabla_documentos(TablaDocumentos* tabla);
+
+/**
+ * @brief Registra un documento nuevo y le asigna el siguiente ID (0, 1, 2, ...).
+ * Copia los 'largo_url' primeros caracteres de 'url' dentro de la tabla. El largo del documento
+ * parte en 0 y se fija despues con fijar_largo_documento.
+ * @param tabla Tabla donde se registra el documento.
+ * @param url URL del documento (no necesita terminar en '\0').
+ * @param largo_url Cantidad de caracteres de 'url' a copiar.
+ * @return uint32_t El ID asignado, o DOC_ID_INVALIDO si falla la memoria.
+**/
+uint32_t registrar_documento(TablaDocumentos* tabla, const char* url, size_t largo_url);
+
+/**
+ * @brief Fija el largo (numero de terminos indexados) de un documento ya registrado.
+ * @param tabla Tabla de documentos.
+ * @param doc_id ID del documento.
+ * @param largo Cantidad de terminos indexados para ese documento.
+**/
+void fijar_largo_documento(TablaDocumentos* tabla, uint32_t doc_id, uint32_t largo);
+
+/**
+ * @brief Devuelve la URL de un documento a partir de su ID.
+ * @param tabla Tabla de documentos.
+ * @param doc_id ID del documento.
+ * @return const char* La URL, o NULL si el ID no existe en la tabla.
+**/
+const char* url_documento(const TablaDocumentos* tabla, uint32_t doc_id);
+
+#endif // documentos_H_
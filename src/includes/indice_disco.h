@@ -0,0 +1,120 @@
+#ifndef indice_disco_H_
+#define indice_disco_H_
+
+#include "inverted_index.h"
+#include "posteo_comprimido.h"
+#include <stdbool.h>
+#include <stdint.h>     // Para uint32_t
+#include <stdio.h>      // Para FILE
+
+/**
+ * @brief Formato binario del archivo de indice (version FORMATO_INDICE_VERSION).
+ * Esta pensado para mapearse en memoria y usarse tal cual, sin copiar ni reservar nada por termino:
+ * todos los enteros van en el orden de bytes de la maquina que lo escribio, cada seccion queda
+ * alineada a 8 bytes y todos los desplazamientos son desde el inicio del archivo.
+ *
+ *   cabecera:      ver CabeceraIndice en indice_disco.c (magia "PEDDIDX\0", version, cantidades y desplazamientos)
+ *   largos:        u32[num_documentos], largo en terminos de cada documento
+ *   offsets_urls:  u64[num_documentos], donde empieza la URL de cada documento
+ *   terminos:      registros de 40 bytes {hash u32, cantidad u32, offset_palabra u64, offset_posteo u64, largo_posteo u64,
+ *                  cota_bm25 float, relleno u32}
+ *   tabla hash:    u32[tabla_tamanio] (potencia de 2), posicion+1 del termino o 0 si el slot esta vacio;
+ *                  sondeo lineal desde hash & (tabla_tamanio - 1), igual que la tabla en memoria
+ *   textos:        URLs y palabras terminadas en '\0'
+ *   posteos:       por cada termino, su tabla de saltos (con la cota BM25 de cada bloque) y su lista comprimida
+ *                  en bloques (ver posteo_comprimido.h), sin alinear
+**/
+#define FORMATO_INDICE_MAGIA "PEDDIDX"
+#define FORMATO_INDICE_VERSION 5
+
+// --- Prototipos de Funciones de Persistencia del Indice ---
+
+/**
+ * @brief Escribe el vocabulario, la tabla de documentos y las listas de posteo del indice en un archivo.
+ * Se escribe primero a "<ruta>.tmp" y se renombra al final, asi un fallo a medias no deja un indice roto.
+ * @param indice El indice a guardar.
+ * @param ruta Ruta del archivo de indice a crear (se reemplaza si existe).
+ * @return bool true si el archivo quedo completo, false si hubo un error de escritura.
+ */
+bool guardar_indice(const indiceInvertido* indice, const char* ruta);
+
+/**
+ * @brief Abre un archivo escrito por guardar_indice como un indice de solo lectura.
+ * El archivo se mapea en memoria (de solo lectura y compartido, asi varios procesos de busqueda
+ * usan las mismas paginas) y no se copia ni se reserva nada por termino ni por documento:
+ * el costo de abrirlo no depende del tamanio del corpus. En sistemas sin mmap se lee entero a memoria.
+ * @param ruta Ruta del archivo de indice.
+ * @return indiceInvertido* El indice (se libera con destruir_indice, que tambien cierra el mapeo) o NULL
+ * si el archivo no existe, no tiene el formato/version esperados, esta truncado o falla la memoria.
+ */
+indiceInvertido* cargar_indice(const char* ruta);
+
+/**
+ * @brief Copia un indice abierto con cargar_indice a un indice en memoria nuevo, con los mismos
+ * documentos (en el mismo orden de ID) y las mismas listas, ya descomprimidas. Asi se puede fusionar
+ * con otros (fusionar_indice) y volver a guardar; lo usan las fusiones de segmentos (segmentos.h).
+ * Cuesta memoria del orden del indice completo.
+ * @param indice El indice abierto desde un archivo.
+ * @return indiceInvertido* El indice en memoria (silencioso, sin cotas ni posiciones; se libera con
+ * destruir_indice) o NULL si el indice no es de un archivo, alguna lista esta corrupta o falla la memoria.
+ */
+indiceInvertido* leer_indice_en_memoria(const indiceInvertido* indice);
+
+/**
+ * @brief Escritor del archivo de indice termino a termino, para armarlo sin tener el indice entero en
+ * memoria (lo usa la construccion por corridas, ver indice_externo.h). El archivo tiene el mismo
+ * formato que el de guardar_indice; los terminos quedan en el orden en que se escriben.
+**/
+typedef struct EscritorIndice EscritorIndice;
+
+/**
+ * @brief Empieza a escribir un indice en "<ruta>.tmp": deja escritas todas las secciones salvo los
+ * registros de los terminos y los posteos, que se escriben con escribir_termino_indice.
+ * @param ruta Ruta del archivo de indice (se reemplaza al cerrar el escritor).
+ * @param documentos Cantidad, largos y suma de largos de los documentos (no se usan sus URLs); debe
+ * vivir hasta cerrar el escritor, porque las cotas BM25 se calculan con ella.
+ * @param textos Archivo con las URLs de los documentos (en orden de ID) seguidas de las palabras de los
+ * terminos (en el orden en que se van a escribir), cada una terminada en '\0'. Se lee desde el principio.
+ * @param largo_textos Bytes de 'textos'.
+ * @param hashes hashes[i] es hash_termino de la palabra i.
+ * @param num_terminos Terminos que se van a escribir.
+ * @return EscritorIndice* El escritor (se termina con cerrar_escritor_indice) o NULL si no se pudo crear el archivo.
+ */
+EscritorIndice* abrir_escritor_indice(const char* ruta, const TablaDocumentos* documentos, FILE* textos,
+                                      uint64_t largo_textos, const uint32_t* hashes, uint64_t num_terminos);
+
+/**
+ * @brief Comprime la lista del siguiente termino (con sus cotas BM25) y escribe su registro.
+ * @param escritor El escritor.
+ * @param palabra La palabra; debe ser la siguiente de las que se dieron en 'textos'.
+ * @param lista Su lista de posteo completa, ordenada por ID.
+ * @return bool false si falla la escritura o la memoria (el escritor ya no sirve y se cierra sin guardar).
+ */
+bool escribir_termino_indice(EscritorIndice* escritor, const char* palabra, const ListaPosteo* lista);
+
+/**
+ * @brief Termina el archivo (escribe la cabecera) y lo renombra a la ruta final, o lo borra.
+ * @param escritor El escritor (queda liberado; puede ser NULL).
+ * @param completo true para guardarlo; false para descartarlo (por ejemplo, si fallo la entrada).
+ * @return bool true si el indice quedo guardado: 'completo' y se escribieron todos los terminos.
+ */
+bool cerrar_escritor_indice(EscritorIndice* escritor, bool completo);
+
+/**
+ * @brief Busca una palabra en el vocabulario mapeado y abre un cursor sobre su lista comprimida,
+ * que se decodifica directo desde el archivo. La usa abrir_cursor_termino.
+ * @param mapeado El archivo de indice mapeado.
+ * @param palabra La palabra a buscar.
+ * @param hash Hash de la palabra (el mismo que guarda EntradaVocabulario).
+ * @param cursor Donde se abre el cursor.
+ * @return bool true si la palabra esta en el vocabulario.
+ */
+bool buscar_cursor_mapeado(const struct IndiceMapeado* mapeado, const char* palabra, uint32_t hash, CursorPosteo* cursor);
+
+/**
+ * @brief Deshace el mapeo de un archivo de indice y libera su descriptor. La usa destruir_indice.
+ * @param mapeado El archivo de indice mapeado (puede ser NULL).
+ */
+void cerrar_indice_mapeado(struct IndiceMapeado* mapeado);
+
+#endif // indice_disco_H_
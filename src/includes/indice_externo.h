@@ -0,0 +1,44 @@
+#ifndef indice_externo_H_
+#define indice_externo_H_
+
+#include <stdbool.h>
+#include <stddef.h>     // Para size_t
+
+/**
+ * @brief Construccion del archivo de indice con memoria acotada (SPIMI: un indice en memoria por vez,
+ * de una sola pasada). Los documentos se indexan en un indice parcial; cuando su memoria llega al
+ * presupuesto, sus terminos se ordenan y se escriben a una corrida en disco (con los doc_id de toda
+ * la coleccion) y se empieza otro parcial. Al final las corridas se fusionan (k-way, en orden de
+ * palabra) directo al archivo de indice de indice_disco.h, termino a termino.
+ * Lo unico que crece con la coleccion es el largo de cada documento (4 bytes por documento, que
+ * tambien cuenta para el presupuesto) y, al fusionar, la lista del termino que se esta escribiendo.
+ *
+ * Cada corrida son dos archivos junto al indice:
+ *   "<indice>.corrida<N>.voc": cabecera {magia "PEDDRUN\0", num_terminos u64} y, por termino en orden
+ *                             de strcmp, {largo_palabra u32, cantidad u32, bytes_posteo u64, palabra}
+ *   "<indice>.corrida<N>.pos": por termino, las diferencias entre doc_id (la primera desde 0) y despues
+ *                             las frecuencias, en VByte (ver posteo_comprimido.h)
+ * Si hay mas de CORRIDAS_POR_FUSION corridas, se fusionan de a grupos en corridas mas grandes antes
+ * de escribir el indice, asi nunca hay demasiados archivos abiertos.
+**/
+
+/** @brief Maximo de corridas que se leen a la vez en una fusion. */
+#define CORRIDAS_POR_FUSION 64
+
+// --- Prototipos de Funciones de la Construccion por Corridas ---
+
+/**
+ * @brief Indexa un archivo de documentos (formato "URL || Contenido", con el mismo parser que el
+ * indice en memoria) y guarda el indice en 'ruta_indice' sin tenerlo nunca entero en memoria.
+ * El archivo resultante es equivalente al de indexar en memoria y llamar a guardar_indice: mismos
+ * documentos, IDs, listas y cotas (solo cambia el orden de los registros de los terminos).
+ * Los archivos de las corridas se borran al terminar, salga bien o mal.
+ * @param archivo_documentos Archivo con los documentos.
+ * @param ruta_indice Ruta del archivo de indice a crear (se reemplaza si existe).
+ * @param memoria_bytes Presupuesto para el indice parcial, el lector y los largos de los documentos.
+ * Con un presupuesto muy chico cada documento es una corrida: funciona, pero es lento.
+ * @return bool true si el archivo de documentos se leyo entero y el indice quedo guardado.
+ */
+bool construir_indice_externo(const char* archivo_documentos, const char* ruta_indice, size_t memoria_bytes);
+
+#endif // indice_externo_H_
@@ -0,0 +1,76 @@
+#ifndef interseccion_H_
+#define interseccion_H_
+
+#include <stdbool.h>
+#include <stddef.h>     // Para size_t
+#include <stdint.h>     // Para uint32_t
+
+/**
+ * @brief Relacion de largos a partir de la cual conviene galopar en vez de mezclar:
+ * si la lista larga tiene al menos UMBRAL_GALOPE veces los elementos de la corta,
+ * interseccion_adaptativa usa busqueda exponencial.
+**/
+#define UMBRAL_GALOPE 32
+
+/**
+ * @brief Implementaciones del nucleo de interseccion. Las vectoriales comparan bloques de 4 (SSE4.2)
+ * u 8 (AVX2) IDs a la vez; se elige la mejor que soporte la CPU la primera vez que se intersecta.
+**/
+typedef enum {
+    INTERSECCION_ESCALAR = 0,
+    INTERSECCION_SSE42,
+    INTERSECCION_AVX2
+} ImplementacionInterseccion;
+
+// --- Prototipos del motor de interseccion de IDs ordenados ---
+// Todas las funciones reciben dos arrays de IDs ordenados de menor a mayor y sin repetidos.
+// Por cada ID comun escriben su posicion en 'a' (pos_a) y en 'b' (pos_b), en orden creciente,
+// y devuelven cuantos IDs comunes encontraron. pos_a y pos_b deben tener espacio para min(na, nb).
+
+/**
+ * @brief Interseccion escalar por mezcla lineal: recorre ambos arrays una vez, O(na + nb).
+ * Es la mejor opcion cuando los largos son parecidos.
+**/
+size_t interseccion_mezcla(const uint32_t* a, size_t na, const uint32_t* b, size_t nb,
+                           uint32_t* pos_a, uint32_t* pos_b);
+
+/**
+ * @brief Interseccion escalar por galope: por cada ID de 'a' (el array corto) busca en 'b' con
+ * busqueda exponencial desde la ultima posicion y luego binaria, O(na * log(nb / na)).
+**/
+size_t interseccion_galope(const uint32_t* a, size_t na, const uint32_t* b, size_t nb,
+                           uint32_t* pos_a, uint32_t* pos_b);
+
+/**
+ * @brief Elige mezcla o galope segun la relacion de largos (ver UMBRAL_GALOPE) y los ejecuta
+ * con la implementacion activa (ver interseccion_implementacion_activa).
+ * Acepta los arrays en cualquier orden; internamente galopa con el corto sobre el largo.
+**/
+size_t interseccion_adaptativa(const uint32_t* a, size_t na, const uint32_t* b, size_t nb,
+                               uint32_t* pos_a, uint32_t* pos_b);
+
+// --- Seleccion de implementacion ---
+
+/**
+ * @brief Indica si esta compilacion y la CPU actual pueden usar la implementacion dada.
+**/
+bool interseccion_soportada(ImplementacionInterseccion implementacion);
+
+/**
+ * @brief Devuelve la implementacion en uso. La primera llamada detecta la CPU y elige
+ * AVX2, luego SSE4.2 y si no la escalar.
+**/
+ImplementacionInterseccion interseccion_implementacion_activa(void);
+
+/**
+ * @brief Fuerza una implementacion (para pruebas y benchmarks).
+ * @return bool false si no esta soportada; en ese caso no cambia nada.
+**/
+bool interseccion_fijar_implementacion(ImplementacionInterseccion implementacion);
+
+/**
+ * @brief Nombre corto de una implementacion ("escalar", "sse4.2", "avx2").
+**/
+const char* interseccion_nombre(ImplementacionInterseccion implementacion);
+
+#endif // interseccion_H_
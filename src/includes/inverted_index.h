@@ -2,42 +2,114 @@
 #define inverted_index_H_
 
 #include "list.h"       
+#include "documentos.h"
+#include "arena.h"
+#include "posteo_comprimido.h"
+#include "posiciones.h"
+#include <stdbool.h>
 #include <stddef.h>     // Para size_t
+#include <stdint.h>     // Para uint32_t
 
 #define ssize_t ptrdiff_t
 
 /**
  * @brief Define una entrada del vocabulario: mapea una palabra (termino)
- * a la cabeza de su lista de documentos (lista_documentos_cabeza).
+ * a su lista de posteo (lista_documentos).
 **/
 typedef struct {
-    char* palabra;                  // El termino (palabra) del vocabulario.
-    nodePtr list_documentos_cabeza; // Puntero a la cabeza de la lista de docs donde aparezca la palabra.
+    char* palabra;                  // El termino (palabra) del vocabulario (vive en la arena "textos" del indice).
+    uint32_t hash;                  // Hash de la palabra, guardado para no recalcularlo al migrar la tabla.
+    float cota_bm25;                // Cota BM25 de la lista (ver preparar_cotas_bm25 en ranking.h).
+    float* cotas_bloque;            // Cota BM25 de cada bloque; NULL si la lista tiene un solo bloque o no hay cotas.
+    ListaPosteo lista_documentos;   // Lista de posteo (docs ordenados por ID) donde aparece la palabra.
+    ListaPosiciones* posiciones;    // Posiciones de la palabra en cada documento; NULL si el indice no es posicional.
 } EntradaVocabulario; 
 
+/** @brief Vocabulario y posteos de solo lectura sobre un archivo mapeado (definido en indice_disco.c). */
+struct IndiceMapeado;
+
 /**
  * @brief Define la estructura principal del indice invertido que contiene un array dinamico
  * de entradas del vocabulario.
+ * Las palabras se buscan con una tabla hash de direccionamiento abierto (sondeo lineal) cuyos
+ * slots guardan la posicion+1 de la entrada en "entradas" (0 = slot vacio). Cuando "entradas"
+ * crece, la tabla nueva se llena de a poco (migracion incremental) en vez de rehashear todo de golpe.
+ * Las palabras y las listas de posteo chicas salen de arenas propias del indice, asi construirlo casi
+ * no llama a malloc y destruir_indice lo suelta todo con unos pocos free.
+ * Un indice abierto con cargar_indice es de solo lectura: "entradas" y las tablas hash quedan en NULL,
+ * "cantidad" es el tamanio del vocabulario y las busquedas van directo al archivo mapeado ("mapeado").
 **/
 typedef struct {
     EntradaVocabulario* entradas; // Array dinamico de las entradas del vocabulario. (Usa el nuevo nombre de tipo)
     size_t cantidad;              // Numero actual de entradas (palabras unicas) en el indice.
     size_t capacidad;             // Capacidad actual del array "entradas".
+
+    uint32_t* tabla_hash;         // Slots de la tabla hash actual (tamanio potencia de 2).
+    size_t tabla_tamanio;         // Numero de slots de "tabla_hash".
+    uint32_t* tabla_vieja;        // Tabla anterior mientras dura la migracion (NULL si no hay migracion).
+    size_t tabla_vieja_tamanio;   // Numero de slots de "tabla_vieja".
+    size_t migracion_siguiente;   // Proxima entrada de "entradas" que falta copiar a la tabla nueva.
+    size_t migracion_limite;      // Cantidad de entradas que habia cuando empezo la migracion.
+
+    TablaDocumentos* documentos;  // Tabla de documentos (ID -> URL y largo) a la que apuntan las listas de posteo.
+
+    Arena textos;                 // Arena de las palabras del vocabulario.
+    PoolPosteos posteos;          // Pool de los arrays de las listas de posteo chicas (ver ListaPosteo).
+
+    double largo_promedio_cotas;  // Largo promedio con que se calcularon las cotas BM25; 0 si no hay o quedaron viejas.
+
+    struct IndiceMapeado* mapeado; // Archivo de indice mapeado (ver indice_disco.h); NULL si el indice vive en memoria.
+    bool silencioso;              // true en los indices parciales de la ingesta en paralelo: no imprime progreso.
+    bool con_posiciones;          // Indice posicional: guarda la posicion de cada termino (ver activar_posiciones).
+
+    uint64_t identidad;           // Distinta para cada indice creado o abierto en el proceso.
+    uint64_t version;             // Sube con cada cambio de las listas; las caches de resultados la comparan.
 } indiceInvertido; 
 
 // --- Prototipo de funciones de indiceInvertido ---
 
 /**
  * @brief Crea y inicializa una nueva estructura de indice invertido.
- * Asigna memoria para la estructura del indice y para el array inicial de entradas
- * del vocabulario segun la capacidad especifica.
+ * Asigna memoria para la estructura del indice, para el array inicial de entradas
+ * del vocabulario segun la capacidad especifica y para una tabla de documentos vacia.
  * @param capacidad_inicial Capacidad inicial para el array de entradas.
  * @return indiceInvertido* Puntero al nuevo indice o NULL si falla.
 **/
 indiceInvertido* crear_indice(size_t capacidad_inicial);
 
 /**
- * @brief Libera memoria a un indice asociado.
+ * @brief Entrega una identidad nueva para un indice (un contador del proceso, seguro entre hilos).
+ * La usan los que crean indices, para que una cache no confunda un indice con otro que ocupe la misma memoria.
+ * @return uint64_t La identidad (nunca 0).
+ */
+uint64_t nueva_identidad_indice(void);
+
+/**
+ * @brief Igual que crear_indice, pero el indice no imprime mensajes al crearse, crecer ni destruirse.
+ * Lo usa la ingesta en paralelo para los indices parciales de cada bloque del archivo.
+ * @param capacidad_inicial Capacidad inicial para el array de entradas.
+ * @return indiceInvertido* Puntero al nuevo indice o NULL si falla.
+**/
+indiceInvertido* crear_indice_silencioso(size_t capacidad_inicial);
+
+/**
+ * @brief Hash de una palabra, el mismo que guarda EntradaVocabulario (y el archivo de indice).
+ * @param palabra La palabra.
+ * @return uint32_t El hash.
+**/
+uint32_t hash_termino(const char* palabra);
+
+/**
+ * @brief Estima la memoria de un indice en memoria sin recorrerlo: lo pedido por sus arenas, el array
+ * de entradas, las tablas hash, las listas que crecieron fuera del pool y la tabla de documentos
+ * (sin las posiciones ni las cotas). Cuesta O(1), asi se puede mirar despues de cada documento.
+ * @param indice El indice.
+ * @return size_t Bytes aproximados (0 si es NULL o de solo lectura).
+**/
+size_t memoria_indice(const indiceInvertido* indice);
+
+/**
+ * @brief Libera memoria a un indice asociado (incluida su tabla de documentos).
  * NO retorna nada porque avisa unicamente si se pudo lograr.
  * @param indice Puntero al índice invertido a destruir.
  */
@@ -49,31 +121,159 @@ void destruir_indice(indiceInvertido* indice);
  * (o suma a la frecuencia si el documento ya existia en la lista).
  * Si el termino no existe lo suma al vocabulario, crea una nueva lista de documentos
  * para el y anniade el doc a la lista.
+ * Los documentos deben llegar en orden creciente de ID para que la insercion sea O(1).
+ * No hace nada sobre un indice de solo lectura (abierto con cargar_indice).
  * @param index puntero hacia el indice invertido que se modifica.
  * @param palabra el termino (palabra) que se encontro.
- * @param documento el identificado de documento en el que se encontro la palabra.
+ * @param doc_id el ID (de indice->documentos) del documento en el que se encontro la palabra.
+**/
+
+void anadir_termino(indiceInvertido* indice, const char* palabra, uint32_t doc_id);
+
+/**
+ * @brief Igual que anadir_termino, y si el indice es posicional guarda tambien la posicion del
+ * termino en el documento (ver ListaPosiciones).
+ * @param indice puntero hacia el indice invertido que se modifica.
+ * @param palabra el termino (palabra) que se encontro.
+ * @param doc_id el ID del documento en el que se encontro la palabra.
+ * @param posicion numero de orden del token en el contenido del documento (contando stopwords);
+ * dentro de un documento deben llegar en orden creciente.
+**/
+void anadir_termino_en_posicion(indiceInvertido* indice, const char* palabra, uint32_t doc_id, uint32_t posicion);
+
+/**
+ * @brief Vuelve posicional a un indice todavia vacio: desde ahi anadir_termino_en_posicion guarda
+ * las posiciones y se pueden buscar frases (filtrar_por_frase). Ocupa mas memoria, por eso es opcional.
+ * Un indice abierto con cargar_indice no guarda posiciones.
+ * @param indice El indice (en memoria y sin terminos).
+ * @return bool false si el indice ya tiene terminos o es de solo lectura.
 **/
+bool activar_posiciones(indiceInvertido* indice);
 
-void anadir_termino(indiceInvertido* indice, const char* palabra, const char* documento);
+/**
+ * @brief Anniade al vocabulario un termino nuevo junto con una lista de posteo ya armada
+ * (por ejemplo, leida desde un archivo de indice).
+ * El indice se queda con los arrays de la lista: al volver, *lista queda como LISTA_POSTEO_VACIA.
+ * @param indice puntero hacia el indice invertido que se modifica.
+ * @param palabra el termino a agregar; no debe existir en el vocabulario.
+ * @param lista lista de posteo (ordenada por ID) del termino.
+ * @return bool true si se agrego, false si el termino ya existia, si el indice es de solo lectura o si falla la memoria
+ * (en ese caso la lista sigue siendo de quien llama).
+**/
+bool anadir_lista_termino(indiceInvertido* indice, const char* palabra, ListaPosteo* lista);
+
+/**
+ * @brief Agrega al final de 'destino' todos los documentos y posteos de 'parcial'.
+ * Los documentos de 'parcial' reciben los IDs siguientes a los de 'destino', en el mismo orden,
+ * asi que fusionar parciales en el orden del archivo da los mismos IDs que indexarlo de corrido.
+ * Las listas de los terminos nuevos para 'destino' se traspasan sin copiarlas: 'parcial' queda
+ * vacio de posteos y solo sirve para destruirlo.
+ * @param destino Indice que recibe los documentos (en memoria, no de solo lectura).
+ * @param parcial Indice con los documentos a agregar.
+ * @return bool true si se fusiono todo, false si falla la memoria (destino puede quedar a medias).
+**/
+bool fusionar_indice(indiceInvertido* destino, indiceInvertido* parcial);
 
 /**
- * @brief busca un termino en el indice y devuelve el puntero de la cabeza de su lista de posteo.
+ * @brief busca un termino en el indice y deja en 'vista' su lista de posteo.
+ * La vista apunta a los arrays del indice: no se modifica ni se libera, y sirve mientras el indice exista.
+ * Solo sirve para indices en memoria; un indice abierto con cargar_indice guarda las listas comprimidas
+ * y se recorre con abrir_cursor_termino.
  ** @param index es el puntero al indice invertido que hay que buscar.
  ** @param termino la palabra que se busca en el vocabulario del indice.
- * @return nodePtr puntero de la lista enlazada de documentos
- * devuelve NULL si el termino no se encuentra en el indice.
+ * @param vista donde se deja la lista encontrada (queda como LISTA_POSTEO_VACIA si no esta).
+ * @return bool true si el termino esta en el indice, false si no se encuentra.
 **/
 
-nodePtr buscar_lista_posteo_termino(const indiceInvertido* indice, const char* palabra);
+bool buscar_lista_posteo_termino(const indiceInvertido* indice, const char* palabra, ListaPosteo* vista);
 
 /**
- * @brief Calcula la interseccion de dos lista de posteo y devuelve un puntero cabeza de su lista de posteo.
+ * @brief Calcula la interseccion de dos lista de posteo y la devuelve como una lista nueva.
+ * Usa el motor de interseccion.h: mezcla lineal si los largos son parecidos, o galope
+ * (busqueda exponencial) de la lista corta sobre la larga si una es mucho mas corta.
+ * La frecuencia de cada documento del resultado es la suma de sus frecuencias en ambas listas.
 * ! IMPORTANTE: esta funcion CREA y DEVUELVE una NUEVA LISTA. El que llama esta funcion debe de liberar bien
  * la memoria que se devuelve usan la funcion free_list() para no modificar las listas originales.
- ** @param list1 Puntero a la cabeza de la primera lista de posteo.
- * @param list2 Puntero a la cabeza de la segunda lista de posteo.
- * Devuelve NULL si la interseccion es vacia o si ocurre un error en memoria. 
+ ** @param list1 Puntero a la primera lista de posteo.
+ * @param list2 Puntero a la segunda lista de posteo.
+ * Devuelve una lista vacia (cantidad 0) si la interseccion es vacia o si ocurre un error en memoria. 
+**/
+ListaPosteo intersectar_listas_posteo(const ListaPosteo* lista1, const ListaPosteo* lista2);
+
+/**
+ * @brief Busca un termino y abre un cursor sobre su lista de posteo, sea el indice en memoria
+ * (bloques sobre sus arrays) o abierto con cargar_indice (bloques decodificados del archivo).
+ * @param indice El indice.
+ * @param palabra La palabra que se busca.
+ * @param cursor Donde se abre el cursor (no se copia por valor despues, ver CursorPosteo).
+ * @return bool true si el termino esta en el indice, false si no se encuentra.
+**/
+bool abrir_cursor_termino(const indiceInvertido* indice, const char* palabra, CursorPosteo* cursor);
+
+/**
+ * @brief Se queda con los documentos de 'candidatos' donde aparece la frase (los terminos seguidos,
+ * cada uno en su desplazamiento). Solo mira las posiciones de los candidatos, que normalmente salen
+ * de intersectar los terminos de la frase, asi cuesta poco mas que esa interseccion.
+ * ! IMPORTANTE: devuelve una NUEVA LISTA que se libera con free_list().
+ * @param indice Indice posicional (ver activar_posiciones).
+ * @param terminos Terminos de la frase, sin las stopwords.
+ * @param desplazamientos Lugar de cada termino dentro de la frase, contando las stopwords (el primero es 0).
+ * @param cantidad Numero de terminos (hasta MAX_TERMINOS_FRASE).
+ * @param candidatos Documentos a revisar, ordenados por ID.
+ * @return ListaPosteo Los documentos con la frase; su frecuencia es cuantas veces aparece. Vacia si no hay,
+ * si el indice no es posicional o si falla la memoria.
+**/
+ListaPosteo filtrar_por_frase(const indiceInvertido* indice, const char* const terminos[], const uint32_t desplazamientos[],
+                              size_t cantidad, const ListaPosteo* candidatos);
+
+/** @brief Maximo de listas que se pueden intersectar juntas con InterseccionCursores. */
+#define MAX_TERMINOS_INTERSECCION 32
+
+/**
+ * @brief Estado de una interseccion (AND) de varias listas recorridas con cursores, que entrega
+ * de a un bloque los documentos que estan en todas, con la frecuencia de cada termino por separado
+ * (la necesita el ranking). Ver intersectar_cursores_posteo para el recorrido.
+ * Ocupa unos 16 KB: conviene reservarla una vez y reutilizarla.
+**/
+typedef struct {
+    CursorPosteo** cursores;      // Cursores de los terminos (los avanza la interseccion).
+    size_t cantidad;              // Numero de cursores.
+    size_t guia;                  // Cursor de la lista mas corta, cuyos bloques son los candidatos.
+    bool agotado;                 // Alguna lista se acabo: no hay mas bloques.
+    uint32_t vivos;               // Documentos del bloque entregado.
+    uint32_t doc_ids[POSTEOS_POR_BLOQUE];  // Documentos del bloque entregado, de menor a mayor.
+    uint32_t frecuencias[MAX_TERMINOS_INTERSECCION][POSTEOS_POR_BLOQUE]; // [t][i]: frecuencia del termino t en doc_ids[i].
+} InterseccionCursores;
+
+/**
+ * @brief Prepara una interseccion sobre cursores recien abiertos.
+ * @param interseccion El estado a preparar.
+ * @param cursores Los cursores (el orden se respeta en "frecuencias").
+ * @param cantidad Numero de cursores (entre 1 y MAX_TERMINOS_INTERSECCION).
+ * @return bool false si no hay cursores o son demasiados (la interseccion queda vacia).
+**/
+bool iniciar_interseccion(InterseccionCursores* interseccion, CursorPosteo* cursores[], size_t cantidad);
+
+/**
+ * @brief Entrega el siguiente bloque no vacio de documentos que estan en todas las listas.
+ * @param interseccion El estado de la interseccion.
+ * @return bool true si dejo documentos en doc_ids[0..vivos), false cuando ya no hay mas.
+**/
+bool siguiente_bloque_interseccion(InterseccionCursores* interseccion);
+
+/**
+ * @brief Interseccion de varias listas recorridas con cursores, bloque a bloque: toma cada bloque
+ * de la lista mas corta, salta en las demas (con saltar_a_doc) hasta los bloques que pueden tener
+ * esos documentos y los intersecta con el motor de interseccion.h. La lista corta tambien salta
+ * los bloques que quedan antes de lo que las demas todavia pueden tener. Ninguna lista se
+ * descomprime entera: una consulta de un termino raro con uno muy comun solo decodifica unos
+ * pocos bloques del comun.
+ * La frecuencia de cada documento del resultado es la suma de sus frecuencias en todas las listas.
+ * Con un solo cursor devuelve una copia de su lista. Usa InterseccionCursores.
+ * @param cursores Cursores recien abiertos (quedan consumidos).
+ * @param cantidad Numero de cursores.
+ * @return ListaPosteo Lista nueva que se libera con free_list() (vacia si no hay documentos en comun).
 **/
-nodePtr intersectar_listas_posteo(nodePtr lista1, nodePtr lista2);
+ListaPosteo intersectar_cursores_posteo(CursorPosteo* cursores[], size_t cantidad);
 
 #endif // inverted_index_H_
\ No newline at end of file
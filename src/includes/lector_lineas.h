@@ -0,0 +1,56 @@
+#ifndef lector_lineas_H_
+#define lector_lineas_H_
+
+#include <stdbool.h>
+#include <stddef.h>     // Para size_t
+#include <stdint.h>     // Para uint64_t
+#include <stdio.h>      // Para FILE
+
+/** @brief Bytes que se piden en cada lectura (y tamanio inicial del buffer). */
+#define TAMANIO_LECTURA_LINEAS (1u << 20)
+
+/**
+ * @brief Lector de lineas con un buffer grande propio.
+ * Lee el archivo en bloques de TAMANIO_LECTURA_LINEAS y entrega cada linea apuntando dentro del
+ * buffer, sin copiarla. Las lineas pueden tener cualquier largo: si una no cabe, el buffer crece.
+**/
+typedef struct {
+    FILE* archivo;
+    char* buffer;
+    size_t capacidad;       // Bytes reservados en "buffer".
+    size_t inicio;          // Donde empieza la proxima linea.
+    size_t fin;             // Bytes validos en "buffer".
+    size_t revisado;        // Hasta donde ya se busco un '\n' sin encontrarlo (para no volver a mirar).
+    bool fin_archivo;       // Ya no hay mas que leer del archivo.
+    bool error_lectura;     // Hubo un error de E/S (ademas de fin_archivo).
+    uint64_t bytes_leidos;  // Total de bytes leidos del archivo.
+} LectorLineas;
+
+// --- Prototipos de Funciones del Lector de Lineas ---
+
+/**
+ * @brief Abre un archivo para leerlo linea por linea.
+ * @param lector El lector a preparar.
+ * @param ruta Ruta del archivo.
+ * @return bool true si se abrio, false si no existe o falla la memoria (avisa por stderr).
+ */
+bool abrir_lector_lineas(LectorLineas* lector, const char* ruta);
+
+/**
+ * @brief Entrega la proxima linea completa, sin el '\n' (ni un '\r' final) y terminada en '\0'.
+ * La linea vive dentro del buffer del lector: se puede modificar, pero deja de servir con la
+ * siguiente llamada.
+ * @param lector El lector.
+ * @param linea Donde se deja el puntero a la linea.
+ * @param largo Donde se deja el largo de la linea (puede ser NULL).
+ * @return bool true si hay linea, false al llegar al final del archivo (o si falla la memoria).
+ */
+bool siguiente_linea(LectorLineas* lector, char** linea, size_t* largo);
+
+/**
+ * @brief Cierra el archivo y libera el buffer.
+ * @param lector El lector a cerrar.
+ */
+void cerrar_lector_lineas(LectorLineas* lector);
+
+#endif // lector_lineas_H_
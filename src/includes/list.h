@@ -2,63 +2,108 @@
 #define list_H
 
 #include <stdbool.h> // Necesario para el tipo bool
+#include <stddef.h>  // Para size_t
+#include <stdint.h>  // Para uint32_t
+#include "documentos.h"
+#include "arena.h"
 
 /**
- * @brief Define la estructura de un nodo para la lista enlazada de documentos (lista de posteo).
- * Cada nodo representa un documento donde aparece un término específico del índice.
+ * @brief Define una lista de posteo como dos arrays contiguos y crecientes (doc_ids y frecuencias).
+ * Los documentos se guardan ordenados por ID de menor a mayor. Como procesar_archivo_documento
+ * entrega los documentos en orden, cada insercion solo mira el ultimo elemento: si es el mismo
+ * documento suma la frecuencia, si no lo agrega al final.
+ * Una lista vacia tiene los punteros en NULL (ver LISTA_POSTEO_VACIA).
+ * Las listas de un indice en memoria usan las variantes "_en_pool": mientras su capacidad no pasa de
+ * CAPACIDAD_MAXIMA_POOL, doc_ids y frecuencias van juntos en un bloque del PoolPosteos del indice
+ * (y no se liberan con free, sino con liberar_lista_en_pool o junto con el pool); las mas grandes usan malloc.
+ * Las listas que entrega buscar_lista_posteo_termino son vistas sobre los arrays del indice: se leen,
+ * pero no se modifican ni se liberan con free_list. En el archivo de indice las listas van comprimidas
+ * (ver posteo_comprimido.h) y se recorren con un CursorPosteo.
  */
-typedef struct node {
-    /** @brief Identificador del documento (ej. URL). Cadena asignada dinámicamente. */
-    char* documento;
-    /** @brief Frecuencia de aparición del término en este documento. */
-    int frecuencia;
-    /** @brief Puntero al siguiente nodo en la lista, o NULL si es el último. */
-    struct node * next;
-} node;
+typedef struct {
+    /** @brief IDs de los documentos donde aparece el termino, ordenados de menor a mayor. */
+    uint32_t* doc_ids;
+    /** @brief frecuencias[i] es la frecuencia del termino en el documento doc_ids[i]. */
+    uint32_t* frecuencias;
+    /** @brief Numero de documentos en la lista. */
+    uint32_t cantidad;
+    /** @brief Capacidad actual de los arrays. */
+    uint32_t capacidad;
+} ListaPosteo;
 
-/** @brief Define un alias para un puntero a la estructura 'node' para conveniencia. */
-typedef node* nodePtr;
+/** @brief Inicializador de una lista de posteo vacia. */
+#define LISTA_POSTEO_VACIA ((ListaPosteo){ NULL, NULL, 0, 0 })
 
-// ---- Prototipos de Funciones de la lista enlazada de posteo ----
+// ---- Prototipos de Funciones de la lista de posteo ----
 
 /**
- * @brief Crea un nuevo nodo para la lista de posteo.
- * Asigna memoria para el nodo y para una copia del ID del documento.
- * Inicializa la frecuencia a 1 y el puntero 'next' a NULL.
- * @param documento El identificador del documento para este nodo. Se creará una copia interna.
- * @return nodePtr Puntero al nodo recién creado, o NULL si falla la asignación de memoria.
+ * @brief Reserva espacio en la lista para al menos 'capacidad' documentos.
+ * No cambia el contenido de la lista; sirve para evitar reasignaciones cuando se sabe el tamaño.
+ * @param lista Lista de posteo a preparar.
+ * @param capacidad Cantidad de documentos que debe poder guardar sin crecer.
+ * @return bool true si la lista ya tenia o pudo conseguir el espacio, false si falla la memoria.
  */
-nodePtr crear_nodo(const char* documento);
+bool reservar_lista(ListaPosteo* lista, size_t capacidad);
 
 /**
- * @brief Inserta un nuevo documento en la lista de posteo o incrementa la frecuencia si ya existe.
- * Busca el 'documento' en la lista referenciada por 'head'.
- * Si lo encuentra, incrementa el campo 'frecuencia' de ese nodo y retorna false.
- * Si no lo encuentra, crea un nuevo nodo usando crear_nodo() y lo inserta
- * al principio de la lista (modificando *head), retornando true.
- * @param head Puntero al puntero de la cabeza de la lista (nodePtr*). Se necesita para modificar
- * la cabeza de la lista si se inserta un nuevo nodo al principio.
- * @param documento El identificador del documento a insertar o cuya frecuencia incrementar.
- * @return bool Devuelve true si se insertó un nuevo nodo, false si solo se incrementó
- * la frecuencia o si ocurrió un error en crear_nodo().
+ * @brief Inserta un documento en la lista de posteo o incrementa la frecuencia si ya existe.
+ * Si 'doc_id' es el ultimo documento de la lista, incrementa su frecuencia y retorna false.
+ * Si es mayor que el ultimo, lo agrega al final con frecuencia 1 y retorna true (caso normal, O(1)).
+ * Si llegara un ID menor (documentos fuera de orden), se ubica con busqueda binaria para
+ * mantener la lista ordenada.
+ * @param lista Puntero a la lista de posteo a modificar.
+ * @param doc_id El ID del documento a insertar o cuya frecuencia incrementar.
+ * @return bool Devuelve true si se insertó un nuevo documento, false si solo se incrementó
+ * la frecuencia o si ocurrió un error de memoria.
  */
-bool insertar_o_sumar_node(nodePtr* head, const char* documento);
+bool insertar_o_sumar_posteo(ListaPosteo* lista, uint32_t doc_id);
 
 /**
- * @brief Libera toda la memoria asociada a una lista de posteo.
- * Recorre la lista desde la cabeza (*head), liberando la memoria de la cadena 'documento'
- * y la memoria del nodo mismo para cada elemento de la lista.
- * Finalmente, establece *head a NULL.
- * @param head Puntero al puntero de la cabeza de la lista (nodePtr*) a liberar.
- * Después de la llamada, *head será NULL.
+ * @brief Agrega al final un documento con su frecuencia, sin buscar repetidos.
+ * Quien llama debe asegurar que 'doc_id' es mayor que el ultimo de la lista.
+ * @param lista Puntero a la lista de posteo a modificar.
+ * @param doc_id ID del documento a agregar.
+ * @param frecuencia Frecuencia a guardar para ese documento.
+ * @return bool true si se agrego, false si falla la memoria.
  */
-void free_list(nodePtr* head);
+bool agregar_posteo(ListaPosteo* lista, uint32_t doc_id, uint32_t frecuencia);
+
+/**
+ * @brief Variantes de reservar_lista, agregar_posteo e insertar_o_sumar_posteo para listas cuyos
+ * arrays pueden vivir en un pool (ver ListaPosteo). Con pool NULL son identicas a las de arriba.
+ * Una lista siempre se debe manejar con el mismo pool.
+ */
+bool reservar_lista_en_pool(ListaPosteo* lista, size_t capacidad, PoolPosteos* pool);
+bool agregar_posteo_en_pool(ListaPosteo* lista, uint32_t doc_id, uint32_t frecuencia, PoolPosteos* pool);
+bool insertar_o_sumar_posteo_en_pool(ListaPosteo* lista, uint32_t doc_id, PoolPosteos* pool);
+
+/**
+ * @brief Crea una copia independiente de una lista de posteo.
+ * @param origen Lista a copiar.
+ * @return ListaPosteo La copia (vacia si 'origen' es NULL/vacia o si falla la memoria).
+ * Se debe liberar con free_list().
+ */
+ListaPosteo copiar_lista(const ListaPosteo* origen);
+
+/**
+ * @brief Libera la memoria de los arrays de una lista de posteo y la deja vacia.
+ * @param lista Puntero a la lista a liberar. Despues de la llamada queda como LISTA_POSTEO_VACIA.
+ */
+void free_list(ListaPosteo* lista);
+
+/**
+ * @brief Como free_list, pero si los arrays estan en el pool los devuelve a el para reutilizarlos.
+ * @param lista Puntero a la lista a liberar. Queda como LISTA_POSTEO_VACIA.
+ * @param pool El pool con que se armo la lista (NULL si se armo con malloc).
+ */
+void liberar_lista_en_pool(ListaPosteo* lista, PoolPosteos* pool);
 
 /**
  * @brief Imprime el contenido de una lista de posteo (para depuración).
- * Recorre la lista e imprime el ID del documento y la frecuencia de cada nodo.
- * @param head Puntero a la cabeza de la lista a imprimir.
+ * Recorre la lista e imprime la URL del documento (buscada en 'documentos') y la frecuencia de cada uno.
+ * @param lista Puntero a la lista a imprimir (puede ser NULL).
+ * @param documentos Tabla de documentos con la que se traducen los IDs a URLs.
  */
-void print_list(nodePtr head);
+void print_list(const ListaPosteo* lista, const TablaDocumentos* documentos);
 
-#endif // list_H
\ No newline at end of file
+#endif // list_H
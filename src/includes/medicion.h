@@ -0,0 +1,167 @@
+#ifndef medicion_H_
+#define medicion_H_
+
+#include <stdbool.h>
+#include <stdint.h>     // Para uint64_t
+#include <stdio.h>      // Para FILE
+
+// Instrumentacion de los caminos calientes: cronometros por fase (reloj monotono) y contadores por hilo.
+// Solo existe si se compila con -DCON_MEDICION (el Makefile lo pone salvo con "make MEDICION=0"; los
+// benchmarks optimizados no lo llevan). Sin esa bandera las macros MEDIR_* no generan codigo.
+// Aun compilada, no mide nada hasta que se llama a activar_medicion (la opcion --stats del main).
+
+/** @brief Fases que se cronometran. */
+typedef enum {
+    FASE_LEER,          // Leer lineas (o bloques) del archivo de documentos.
+    FASE_PARSEAR,       // Separar la URL del contenido.
+    FASE_TOKENIZAR,     // Sacar el siguiente token del contenido (*).
+    FASE_STOPWORDS,     // Descartar las stopwords (*).
+    FASE_INSERTAR,      // Agregar el termino al indice (*).
+    FASE_FUSIONAR,      // Fusionar los indices parciales de la ingesta en paralelo.
+    FASE_INTERSECTAR,   // Resolver una consulta (cursores, interseccion o ranking).
+    FASE_IMPRIMIR,      // Mostrar o escribir los resultados.
+    NUM_FASES
+} FaseMedicion;
+// (*) Por token: se miden solo en uno de cada MUESTREO_DETALLE documentos y se multiplica (tiempo y veces).
+
+/** @brief Contadores de cada hilo. */
+typedef enum {
+    CONTADOR_LINEAS,            // Lineas de documentos leidas.
+    CONTADOR_BYTES_LEIDOS,      // Bytes leidos del archivo de documentos.
+    CONTADOR_TOKENS,            // Tokens vistos (con stopwords).
+    CONTADOR_STOPWORDS,         // Tokens descartados por ser stopwords.
+    CONTADOR_POSTEOS,           // Posteos nuevos (primera aparicion de un termino en un documento).
+    CONTADOR_TERMINOS,          // Palabras nuevas en algun vocabulario (tambien los parciales).
+    CONTADOR_ASIGNACIONES,      // Pedidos de memoria al sistema de arenas, listas, posiciones y vocabulario.
+    CONTADOR_BYTES_RESERVADOS,  // Bytes de esos pedidos.
+    CONTADOR_CONSULTAS,         // Consultas resueltas.
+    CONTADOR_CACHE_ACIERTOS,    // Consultas respondidas por la cache de resultados.
+    CONTADOR_CACHE_FALLOS,      // Consultas que se buscaron en la cache y no estaban.
+    NUM_CONTADORES
+} ContadorMedicion;
+
+/** @brief Cada cuantos documentos se cronometran los pasos por token. */
+#define MUESTREO_DETALLE 16
+
+/**
+ * @brief Lo medido por un hilo. Solo lo escribe su hilo; se lee al final, con los hilos ya terminados.
+**/
+typedef struct MedicionHilo {
+    uint64_t nanos[NUM_FASES];
+    uint64_t veces[NUM_FASES];
+    uint64_t contadores[NUM_CONTADORES];
+    struct MedicionHilo* siguiente;   // Todos los hilos que midieron algo, en una lista global.
+} MedicionHilo;
+
+#ifdef CON_MEDICION
+
+extern bool g_medicion_activa;
+extern uint64_t g_costo_reloj_nanos;   // Lo que tarda una lectura del reloj (se descuenta en los pasos por token).
+extern _Thread_local MedicionHilo* t_medicion;
+
+/** @brief Crea y registra la medicion del hilo actual (la primera vez que mide algo). */
+MedicionHilo* registrar_medicion_hilo(void);
+
+/** @brief Nanosegundos del reloj monotono. */
+uint64_t medicion_nanos(void);
+
+static inline MedicionHilo* medicion_del_hilo(void) {
+    return t_medicion ? t_medicion : registrar_medicion_hilo();
+}
+
+static inline void medicion_sumar_fase(FaseMedicion fase, uint64_t nanos) {
+    MedicionHilo* medicion = medicion_del_hilo();
+    if (!medicion) return;
+    medicion->nanos[fase] += nanos;
+    medicion->veces[fase]++;
+}
+
+static inline void medicion_sumar_contador(ContadorMedicion contador, uint64_t cantidad) {
+    MedicionHilo* medicion = medicion_del_hilo();
+    if (medicion) medicion->contadores[contador] += cantidad;
+}
+
+// Marca de inicio de una fase (0 si no se esta midiendo).
+#define MEDIR_DESDE(marca) uint64_t marca = g_medicion_activa ? medicion_nanos() : 0
+// Suma a 'fase' lo que paso desde 'marca' y deja 'marca' en ahora, para encadenar fases seguidas.
+#define MEDIR_FASE(fase, marca) \
+    do { \
+        if (g_medicion_activa) { \
+            uint64_t medir_ahora_ = medicion_nanos(); \
+            medicion_sumar_fase((fase), medir_ahora_ - (marca)); \
+            (marca) = medir_ahora_; \
+        } \
+    } while (0)
+// Deja 'marca' en ahora sin sumarle nada a ninguna fase.
+#define MEDIR_REINICIAR(marca) \
+    do { if (g_medicion_activa) (marca) = medicion_nanos(); } while (0)
+#define MEDIR_CONTAR(contador, cantidad) \
+    do { if (g_medicion_activa) medicion_sumar_contador((contador), (uint64_t)(cantidad)); } while (0)
+#define MEDIR_ASIGNACION(bytes) \
+    do { \
+        if (g_medicion_activa) { \
+            medicion_sumar_contador(CONTADOR_ASIGNACIONES, 1); \
+            medicion_sumar_contador(CONTADOR_BYTES_RESERVADOS, (uint64_t)(bytes)); \
+        } \
+    } while (0)
+// Pasos por token: 'detallar' dice si este documento entra en la muestra.
+#define MEDIR_DETALLE_DESDE(detallar, marca, numero) \
+    bool detallar = g_medicion_activa && (numero) % MUESTREO_DETALLE == 0; \
+    uint64_t marca = detallar ? medicion_nanos() : 0
+#define MEDIR_DETALLE(detallar, fase, marca) \
+    do { \
+        if (detallar) { \
+            uint64_t medir_ahora_ = medicion_nanos(); \
+            uint64_t medir_paso_ = medir_ahora_ - (marca); \
+            medir_paso_ = medir_paso_ > g_costo_reloj_nanos ? medir_paso_ - g_costo_reloj_nanos : 0; \
+            MedicionHilo* medir_hilo_ = medicion_del_hilo(); \
+            if (medir_hilo_) { \
+                medir_hilo_->nanos[(fase)] += medir_paso_ * MUESTREO_DETALLE; \
+                medir_hilo_->veces[(fase)] += MUESTREO_DETALLE; \
+            } \
+            (marca) = medir_ahora_; \
+        } \
+    } while (0)
+
+#else
+
+#define MEDIR_DESDE(marca) ((void)0)
+#define MEDIR_FASE(fase, marca) ((void)0)
+#define MEDIR_REINICIAR(marca) ((void)0)
+#define MEDIR_CONTAR(contador, cantidad) ((void)0)
+#define MEDIR_ASIGNACION(bytes) ((void)0)
+#define MEDIR_DETALLE_DESDE(detallar, marca, numero) ((void)0)
+#define MEDIR_DETALLE(detallar, fase, marca) ((void)0)
+
+#endif // CON_MEDICION
+
+// --- Prototipos de Funciones de Medicion ---
+
+/**
+ * @brief Indica si el programa se compilo con la instrumentacion (-DCON_MEDICION).
+ * @return bool false si activar_medicion no tendria efecto.
+ */
+bool medicion_disponible(void);
+
+/**
+ * @brief Empieza a medir (o deja de hacerlo) en todos los hilos. Al activarla se mide cuanto cuesta
+ * leer el reloj, para descontarlo de los pasos por token. Sin CON_MEDICION no hace nada.
+ * @param activa true para medir.
+ */
+void activar_medicion(bool activa);
+
+/**
+ * @brief Escribe lo medido como un objeto JSON: los totales de todos los hilos (fases en segundos y
+ * veces, contadores) y el detalle de cada hilo. Sin CON_MEDICION escribe {"disponible": false}.
+ * Se debe llamar con los demas hilos ya terminados.
+ * @param salida Donde se escribe.
+ */
+void escribir_medicion_json(FILE* salida);
+
+/**
+ * @brief Pone en cero todo lo medido y libera la medicion de los hilos que ya terminaron.
+ * Se debe llamar con los demas hilos ya terminados (los que sigan vivos vuelven a registrarse).
+ */
+void reiniciar_medicion(void);
+
+#endif // medicion_H_
@@ -3,25 +3,64 @@
 
 #include "inverted_index.h"
 #include <stdbool.h>       
+#include <stddef.h>     // Para size_t
+
+/**
+ * @brief Partes de una línea "URL || Contenido", como segmentos dentro de la misma línea (sin copias).
+ * Ninguno de los dos segmentos termina en '\0' por sí mismo.
+ */
+typedef struct {
+    const char* url;          // Inicio de la URL (el inicio de la línea).
+    size_t largo_url;         // Caracteres de la URL, hasta el último "||".
+    const char* contenido;    // Inicio del contenido, ya sin los espacios iniciales.
+    size_t largo_contenido;   // Caracteres del contenido hasta el fin de la línea.
+} LineaDocumento;
 
 // --- Prototipos de Funciones para el Parseo de Documentos ---
 
 /**
  * @brief Procesa un archivo completo de documentos para construir/llenar el índice invertido.
- * Lee el archivo línea por línea, donde cada línea representa un documento.
+ * Lee el archivo línea por línea (con un lector de buffer grande, ver lector_lineas.h), donde cada
+ * línea representa un documento; las líneas se leen enteras, sin importar su largo.
  * Para cada línea, extrae la URL (ID del documento) y el contenido de texto.
- * Luego, tokeniza el contenido y añade los términos válidos (no stopwords) al índice.
+ * Cada documento se registra una sola vez en la tabla de documentos del índice (que le asigna su ID)
+ * y luego se tokeniza el contenido y se añaden los términos válidos (no stopwords) al índice.
  * Se espera que el archivo tenga el formato especificado: URL || Contenido
  * @param filename El nombre/ruta del archivo de documentos a procesar
  * @param index Puntero al índice invertido que se llenará con los términos y documentos.
+ * Al final imprime un resumen con las líneas procesadas y los MB/s leídos.
  * @return bool Devuelve true si el archivo se procesó completamente sin errores fatales 
  * de lo contrario devuelve false.
  */
 bool procesar_archivo_documento(const char* nombre_archivo, indiceInvertido* index);
 
+/**
+ * @brief Igual que procesar_archivo_documento, pero repartiendo el trabajo entre varios hilos.
+ * El hilo que llama lee el archivo en bloques de líneas completas; cada hilo indexa bloques en
+ * índices parciales y el que llama los fusiona en 'index' en el orden del archivo, así que los IDs
+ * de los documentos son los mismos con cualquier cantidad de hilos. Las líneas se leen enteras,
+ * sin importar su largo.
+ * @param nombre_archivo El nombre/ruta del archivo de documentos a procesar.
+ * @param index Puntero al índice invertido que se llenará.
+ * @param num_hilos Cantidad de hilos que indexan; con 1 o menos se usa procesar_archivo_documento.
+ * @return bool true si el archivo se procesó completo, false si no se pudo abrir o falló la memoria.
+ */
+bool procesar_archivo_documento_paralelo(const char* nombre_archivo, indiceInvertido* index, int num_hilos);
+
+/**
+ * @brief Separa una línea del archivo de documentos en URL y contenido sin copiar ni reservar memoria.
+ * Busca el último separador "||" con una sola pasada desde el final de la línea. Es lo que usa
+ * procesar_archivo_documento: solo la URL se copia, una vez, a la tabla de documentos.
+ * @param linea La línea (no necesita terminar en '\0').
+ * @param largo Cantidad de caracteres de la línea.
+ * @param partes Donde se dejan los segmentos de URL y contenido (apuntan dentro de 'linea').
+ * @return bool true si la línea tiene el separador "||", false si no tiene el formato esperado.
+ */
+bool separar_linea_documento(const char* linea, size_t largo, LineaDocumento* partes);
+
 /**
  * @brief Parsea una única línea del archivo de documentos para separar la URL del contenido.
- * Busca el último separador "||" en la línea para distinguir la URL del contenido.
+ * Igual que separar_linea_documento, pero devuelve copias propias de la URL y el contenido.
  * Asigna memoria dinámicamente para almacenar la URL y el contenido como cadenas separadas.
  * @param line La línea de texto completa leída del archivo.
  * @param url_out Puntero a un char* donde se almacenará el puntero a la cadena de la URL asignada.
@@ -36,13 +75,16 @@ bool parsear_linea(char* linea_original, char** url_salida, char** contenido_sal
  * Recorre la cadena 'contenido', la divide en palabras (tokens) usando espacios y/o
  * signos de puntuación como delimitadores.
  * Para cada token: lo convierte a minúsculas, verifica si es una stopword y, si es
- * un término válido, lo añade al índice asociado al 'documento' dado usando la función
+ * un término válido, lo añade al índice asociado al documento dado usando la función
  * anadir_termino del módulo inverted_index.
+ * Si el índice es posicional (ver activar_posiciones) usa anadir_termino_en_posicion: la posición
+ * es el número de orden del token en el contenido, contando también las stopwords.
  * @param contenido La cadena de texto con el contenido del documento.
- * @param documento El identificador (URL) del documento al que pertenece el contenido.
+ * @param documento_id El ID del documento (ya registrado en index->documentos) al que pertenece el contenido.
  * @param index Puntero al índice invertido donde se añadirán los términos.
+ * @return uint32_t Cantidad de términos indexados (el largo del documento).
  */
 // Nombre cambiado
-void tokenizar_e_indexar_contenido(const char* contenido_const, const char* documento_id, indiceInvertido* indice);
+uint32_t tokenizar_e_indexar_contenido(const char* contenido_const, uint32_t documento_id, indiceInvertido* indice);
 
 #endif // parser_H_
\ No newline at end of file
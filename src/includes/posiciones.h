@@ -0,0 +1,87 @@
+#ifndef posiciones_H_
+#define posiciones_H_
+
+#include "list.h"
+#include <stdbool.h>
+#include <stddef.h>     // Para size_t
+#include <stdint.h>     // Para uint8_t, uint32_t
+
+/** @brief Maximo de terminos (sin contar stopwords) de una frase. */
+#define MAX_TERMINOS_FRASE 32
+
+/**
+ * @brief Posiciones de un termino en cada documento de su lista de posteo (indice posicional).
+ * La posicion de un token es su numero de orden dentro del contenido del documento, contando tambien
+ * las stopwords, asi una frase con stopwords en medio ("state of the art") calza con los mismos saltos.
+ * Van en el orden de la lista de posteo: por cada posteo, sus 'frecuencia' posiciones crecientes en
+ * VByte, la primera tal cual y las demas como diferencia con la anterior. Como en las listas
+ * comprimidas, se guarda donde empieza cada bloque de POSTEOS_POR_BLOQUE posteos, asi para leer las
+ * posiciones de un posteo solo se saltean las de los anteriores de su bloque.
+**/
+typedef struct {
+    uint8_t* bytes;               // Las posiciones en VByte.
+    size_t largo;                 // Bytes usados de "bytes".
+    size_t capacidad;             // Bytes reservados en "bytes".
+    uint32_t* inicio_bloques;     // inicio_bloques[b]: byte donde empiezan las posiciones del bloque b.
+    uint32_t capacidad_bloques;   // Entradas reservadas en "inicio_bloques".
+    uint32_t posteos;             // Posteos con posiciones guardadas.
+    uint32_t ultima;              // Ultima posicion agregada (base de la siguiente diferencia).
+} ListaPosiciones;
+
+// --- Prototipos de Funciones de ListaPosiciones ---
+
+/**
+ * @brief Crea una lista de posiciones vacia.
+ * @return ListaPosiciones* La lista o NULL si falla la memoria.
+ */
+ListaPosiciones* crear_lista_posiciones(void);
+
+/**
+ * @brief Libera una lista de posiciones.
+ * @param posiciones La lista (puede ser NULL).
+ */
+void destruir_lista_posiciones(ListaPosiciones* posiciones);
+
+/**
+ * @brief Agrega una posicion del termino.
+ * @param posiciones La lista.
+ * @param nuevo_posteo true si es la primera posicion de un documento (un posteo nuevo de la lista de posteo).
+ * @param posicion La posicion; dentro de un documento deben llegar en orden creciente.
+ * @return bool false si falla la memoria.
+ */
+bool agregar_posicion(ListaPosiciones* posiciones, bool nuevo_posteo, uint32_t posicion);
+
+/**
+ * @brief Agrega al final de 'destino' todas las posiciones de 'origen' (las de los documentos que se
+ * agregaron al final de su lista de posteo, ver fusionar_indice). Las posiciones no dependen del ID
+ * del documento, asi que se copian tal cual.
+ * @param destino Lista que recibe las posiciones.
+ * @param origen Lista de donde se copian.
+ * @param frecuencias_origen Frecuencia de cada posteo de 'origen' (cuantas posiciones tiene).
+ * @return bool false si falla la memoria.
+ */
+bool concatenar_posiciones(ListaPosiciones* destino, const ListaPosiciones* origen, const uint32_t* frecuencias_origen);
+
+/**
+ * @brief Lee las posiciones de un posteo.
+ * @param posiciones Las posiciones del termino.
+ * @param lista Su lista de posteo (de ella salen las frecuencias).
+ * @param indice_posteo Posicion del posteo dentro de la lista.
+ * @param salida Donde se dejan las posiciones (lugar para lista->frecuencias[indice_posteo]).
+ * @return uint32_t Cuantas se leyeron (0 si el posteo no existe o los datos no calzan).
+ */
+uint32_t leer_posiciones(const ListaPosiciones* posiciones, const ListaPosteo* lista, uint32_t indice_posteo, uint32_t* salida);
+
+/**
+ * @brief Cuenta las veces que aparece una frase: posiciones p tales que para cada termino j,
+ * p + desplazamientos[j] esta en posiciones[j].
+ * @param posiciones Posiciones crecientes de cada termino de la frase en el documento.
+ * @param cantidades Cuantas posiciones tiene cada termino.
+ * @param desplazamientos Lugar de cada termino dentro de la frase (el primero es 0).
+ * @param terminos Numero de terminos de la frase (hasta MAX_TERMINOS_FRASE).
+ * @return uint32_t Apariciones de la frase (0 si no esta).
+ */
+uint32_t contar_frase(const uint32_t* const posiciones[], const uint32_t cantidades[], const uint32_t desplazamientos[],
+                      size_t terminos);
+
+#endif // posiciones_H_
@@ -0,0 +1,173 @@
+#ifndef posteo_comprimido_H_
+#define posteo_comprimido_H_
+
+#include "list.h"
+#include <stdbool.h>
+#include <stddef.h>     // Para size_t
+#include <stdint.h>     // Para uint8_t, uint32_t
+#include <math.h>       // Para INFINITY
+
+/** @brief Posteos por bloque comprimido (el ultimo bloque de una lista puede tener menos). */
+#define POSTEOS_POR_BLOQUE 128
+/** @brief Bytes maximos de un entero de 32 bits en VByte. */
+#define MAX_BYTES_VBYTE 5
+/** @brief Bytes de cada entrada de la tabla de saltos: ultimo doc_id del bloque, donde empieza (u32) y su cota (float). */
+#define BYTES_POR_SALTO 12
+/** @brief Cota de un bloque o lista de la que no se sabe nada: no permite descartar ningun documento. */
+#define COTA_DESCONOCIDA INFINITY
+
+/**
+ * @brief Formato comprimido de una lista de posteo (el que usa el archivo de indice).
+ * La lista se parte en bloques de POSTEOS_POR_BLOQUE posteos. Cada bloque tiene primero las
+ * diferencias entre doc_ids consecutivos (la primera, respecto del ultimo doc_id del bloque
+ * anterior o de 0) y despues las frecuencias, todo en VByte: 7 bits por byte, con el bit alto
+ * en 1 mientras siguen bytes del mismo numero. Un posteo tipico ocupa 2 bytes en vez de 8.
+ * Si la lista tiene mas de un bloque, los bloques van precedidos por una tabla de saltos con una
+ * entrada por bloque: {ultimo doc_id del bloque, byte donde empieza el bloque contando desde el fin
+ * de la tabla, cota del bloque}, u32, u32 y float del orden de bytes de la maquina (sin alinear). Con ella
+ * saltar_a_doc va directo al bloque que puede tener un documento, sin decodificar los anteriores.
+ * La cota es un maximo de lo que puede aportar al puntaje cualquier posteo del bloque (la calcula y
+ * la interpreta ranking.h); deja descartar bloques enteros al buscar los mejores resultados.
+**/
+
+/**
+ * @brief Recorre una lista de posteo de a un bloque, ya sea comprimida o en arrays normales.
+ * En cada momento expone un bloque decodificado (doc_ids/frecuencias/largo), asi la interseccion
+ * trabaja bloque a bloque sin descomprimir la lista entera. Sobre arrays normales los bloques
+ * apuntan directo a ellos; sobre una lista comprimida se decodifican en los buffers del cursor,
+ * por eso un cursor no se copia por valor despues de abrirlo (se pasan punteros).
+**/
+typedef struct {
+    const uint32_t* doc_ids;      // Bloque actual: doc_ids ordenados de menor a mayor.
+    const uint32_t* frecuencias;  // Bloque actual: frecuencias[i] es la de doc_ids[i].
+    uint32_t largo;               // Posteos del bloque actual (0 antes del primer bloque y al terminar).
+    uint32_t cantidad;            // Posteos de toda la lista (cantidad de documentos del termino).
+
+    uint32_t entregados;          // Posteos de los bloques ya entregados, incluido el actual.
+    const uint32_t* docs_planos;  // Lista sin comprimir (NULL si es comprimida).
+    const uint32_t* frec_planas;
+    const uint8_t* actual;        // Lista comprimida: proximo byte a decodificar.
+    const uint8_t* fin;           // Lista comprimida: fin de sus bytes.
+    const uint8_t* inicio_bloques; // Lista comprimida: donde empiezan los bloques (despues de la tabla de saltos).
+    const uint8_t* saltos;        // Lista comprimida: tabla de saltos (NULL si la lista tiene un solo bloque).
+    uint32_t num_bloques;         // Bloques de la lista.
+    uint32_t ultimo_doc;          // Ultimo doc_id decodificado (base de las diferencias).
+    uint32_t bloques_leidos;      // Bloques que se entregaron (para medir cuanto se salto).
+    uint32_t posteos_leidos;      // Posteos de esos bloques.
+    float cota_lista;             // Cota de toda la lista (COTA_DESCONOCIDA si no se fijo, ver fijar_cotas_cursor).
+    const float* cotas_planas;    // Lista sin comprimir: cota de cada bloque (NULL si no hay).
+    bool corrupto;                // Los bytes comprimidos no calzaban con 'cantidad'.
+
+    uint32_t buffer_docs[POSTEOS_POR_BLOQUE];
+    uint32_t buffer_frecuencias[POSTEOS_POR_BLOQUE];
+} CursorPosteo;
+
+// --- Prototipos de Funciones VByte ---
+
+/**
+ * @brief Bytes que ocupa 'valor' en VByte.
+ * @param valor El numero.
+ * @return size_t Entre 1 y MAX_BYTES_VBYTE.
+ */
+size_t largo_vbyte(uint32_t valor);
+
+/**
+ * @brief Escribe 'valor' en VByte.
+ * @param salida Donde se escribe (con lugar para MAX_BYTES_VBYTE bytes).
+ * @param valor El numero.
+ * @return uint8_t* El byte siguiente al ultimo escrito.
+ */
+uint8_t* escribir_vbyte(uint8_t* salida, uint32_t valor);
+
+/**
+ * @brief Decodifica 'cantidad' enteros VByte seguidos.
+ * @param p Primer byte.
+ * @param fin Fin de los bytes validos; nunca se lee desde ahi en adelante.
+ * @param valores Donde se dejan los numeros.
+ * @param cantidad Cuantos numeros leer.
+ * @return const uint8_t* El byte siguiente al ultimo numero, o NULL si los bytes se acaban antes.
+ */
+const uint8_t* leer_vbytes(const uint8_t* p, const uint8_t* fin, uint32_t* valores, uint32_t cantidad);
+
+// --- Prototipos de Funciones de Compresion ---
+
+/**
+ * @brief Calcula cuantos bytes ocupa una lista en el formato comprimido, sin comprimirla.
+ * @param lista La lista (doc_ids ordenados de menor a mayor).
+ * @return size_t Bytes que escribiria comprimir_lista.
+ */
+size_t largo_lista_comprimida(const ListaPosteo* lista);
+
+/**
+ * @brief Comprime una lista de posteo.
+ * @param lista La lista (doc_ids ordenados de menor a mayor).
+ * @param cotas Cota de cada bloque para la tabla de saltos (NULL: COTA_DESCONOCIDA en todos).
+ * @param salida Donde se escriben los bytes; debe tener lugar para largo_lista_comprimida(lista)
+ * (o, sin calcularlo, para (2 * MAX_BYTES_VBYTE + BYTES_POR_SALTO) * lista->cantidad).
+ * @return size_t Bytes escritos.
+ */
+size_t comprimir_lista(const ListaPosteo* lista, const float* cotas, uint8_t* salida);
+
+/**
+ * @brief Cantidad de bloques de una lista de 'cantidad' posteos.
+ * @param cantidad Posteos de la lista.
+ * @return uint32_t Bloques (el ultimo puede estar incompleto).
+ */
+uint32_t bloques_de_lista(uint32_t cantidad);
+
+// --- Prototipos de Funciones del Cursor ---
+
+/**
+ * @brief Abre un cursor sobre una lista sin comprimir (no copia sus arrays).
+ * @param cursor El cursor.
+ * @param lista La lista; debe seguir viva y sin cambios mientras se usa el cursor.
+ */
+void abrir_cursor_lista(CursorPosteo* cursor, const ListaPosteo* lista);
+
+/**
+ * @brief Abre un cursor sobre una lista comprimida con comprimir_lista.
+ * @param cursor El cursor.
+ * @param datos Los bytes comprimidos.
+ * @param largo Cantidad de bytes; el cursor nunca lee fuera de ellos.
+ * @param cantidad Posteos de la lista.
+ */
+void abrir_cursor_comprimido(CursorPosteo* cursor, const uint8_t* datos, size_t largo, uint32_t cantidad);
+
+/**
+ * @brief Fija las cotas de la lista que recorre el cursor (al abrirlo quedan en COTA_DESCONOCIDA).
+ * Las cotas por bloque de una lista comprimida vienen en su tabla de saltos.
+ * @param cursor El cursor.
+ * @param cota_lista Cota de toda la lista.
+ * @param cotas_bloque Lista sin comprimir: cota de cada bloque (NULL si no hay); debe vivir lo que el cursor.
+ */
+void fijar_cotas_cursor(CursorPosteo* cursor, float cota_lista, const float* cotas_bloque);
+
+/**
+ * @brief Pasa al siguiente bloque de la lista (el primero, si recien se abrio).
+ * @param cursor El cursor.
+ * @return bool true si hay bloque, false al terminar la lista (o si los datos estan corruptos).
+ */
+bool avanzar_bloque(CursorPosteo* cursor);
+
+/**
+ * @brief Avanza hasta el primer bloque que puede tener 'doc_id': el bloque actual si su ultimo
+ * doc_id es >= 'doc_id', si no el que indique la tabla de saltos (o, en arrays normales, una
+ * busqueda sobre los ultimos doc_ids de cada bloque). Los bloques de en medio no se decodifican.
+ * Nunca retrocede.
+ * @param cursor El cursor.
+ * @param doc_id El documento buscado.
+ * @return bool true si quedo en un bloque cuyo ultimo doc_id es >= 'doc_id', false si la lista se acabo.
+ */
+bool saltar_a_doc(CursorPosteo* cursor, uint32_t doc_id);
+
+/**
+ * @brief Cota del bloque donde caeria 'doc_id' (el mismo que elegiria saltar_a_doc), sin moverse
+ * ni decodificar nada. Si no hay cotas por bloque devuelve la de toda la lista.
+ * @param cursor El cursor.
+ * @param doc_id El documento.
+ * @param ultimo_doc Recibe hasta que doc_id vale la cota (UINT32_MAX - 1 si vale hasta el final).
+ * @return float La cota, o 0 si la lista ya no tiene documentos >= 'doc_id'.
+ */
+float cota_bloque_para_doc(const CursorPosteo* cursor, uint32_t doc_id, uint32_t* ultimo_doc);
+
+#endif // posteo_comprimido_H_
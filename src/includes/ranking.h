@@ -0,0 +1,215 @@
+#ifndef ranking_H_
+#define ranking_H_
+
+#include <stdbool.h>
+#include <stddef.h>     // Para size_t
+#include <stdint.h>     // Para uint32_t
+#include "inverted_index.h"
+
+/** @brief Parametro k1 de BM25: cuanto pesa repetir un termino antes de saturarse. */
+#define BM25_K1 1.2
+/** @brief Parametro b de BM25: cuanto se castiga a los documentos mas largos que el promedio. */
+#define BM25_B 0.75
+
+/**
+ * @brief Margen relativo con que se usan las cotas guardadas: cubre el redondeo de sumar y multiplicar
+ * en otro orden que al puntuar, asi una cota nunca queda por debajo de un puntaje real.
+**/
+#define MARGEN_COTAS (1.0 + 1e-9)
+
+/** @brief Un documento del ranking con su puntaje. */
+typedef struct {
+    uint32_t doc_id;
+    double puntaje;
+} ResultadoBusqueda;
+
+/**
+ * @brief Los k mejores resultados vistos hasta ahora, en un min-heap de tamanio fijo: la raiz es
+ * el peor de los guardados, asi cada candidato nuevo se compara con uno solo y la memoria no crece
+ * con la cantidad de coincidencias. Trabaja sobre un array que pone quien lo usa.
+ * A igual puntaje gana el doc_id menor, para que el ranking no dependa del orden de llegada.
+**/
+typedef struct {
+    ResultadoBusqueda* resultados;  // Array de 'capacidad' elementos (del que llama).
+    size_t cantidad;                // Resultados guardados.
+    size_t capacidad;               // k.
+} HeapMejores;
+
+/**
+ * @brief Estadisticas de la coleccion con que se puntua cuando el indice que se recorre es solo una parte
+ * de ella (un segmento, ver segmentos.h): con el N, el largo promedio y el df de toda la coleccion, cada
+ * parte da los mismos puntajes que daria el indice completo y sus k mejores se pueden juntar.
+**/
+typedef struct {
+    uint32_t total_documentos;       // N de toda la coleccion.
+    double largo_promedio;           // Largo promedio de los documentos de toda la coleccion.
+    uint32_t documentos_con_termino[MAX_TERMINOS_INTERSECCION]; // df de cada cursor (en su orden) en toda la coleccion.
+    double escala_cotas;             // Factor (>= 1) de las cotas guardadas en la parte, ver escala_cotas_bm25.
+    double umbral_minimo;            // Busqueda OR: solo entran los documentos que lo superan (-INFINITY: todos).
+} ColeccionRanking;
+
+// --- Prototipos del Heap de Mejores Resultados ---
+
+/**
+ * @brief Prepara un heap vacio sobre 'resultados'.
+ * @param heap El heap.
+ * @param resultados Array donde se guardan los resultados.
+ * @param capacidad Elementos de 'resultados' (k).
+ */
+void iniciar_heap_mejores(HeapMejores* heap, ResultadoBusqueda* resultados, size_t capacidad);
+
+/**
+ * @brief Ofrece un candidato: entra si hay lugar o si es mejor que el peor guardado (al que reemplaza).
+ * @param heap El heap.
+ * @param doc_id El documento.
+ * @param puntaje Su puntaje.
+ */
+void ofrecer_a_heap(HeapMejores* heap, uint32_t doc_id, double puntaje);
+
+/**
+ * @brief Ordena los resultados guardados de mejor a peor (el heap deja de ser un heap).
+ * @param heap El heap.
+ * @return size_t Cantidad de resultados, que quedan en heap->resultados[0..cantidad).
+ */
+size_t ordenar_heap_mejores(HeapMejores* heap);
+
+// --- Prototipos de BM25 ---
+
+/**
+ * @brief IDF de BM25 (la variante que nunca da negativo): log(1 + (N - df + 0.5) / (df + 0.5)).
+ * @param total_documentos N, documentos del indice.
+ * @param documentos_con_termino df, documentos en que aparece el termino.
+ * @return double El IDF.
+ */
+double idf_bm25(uint32_t total_documentos, uint32_t documentos_con_termino);
+
+/**
+ * @brief Aporte de un termino al puntaje BM25 de un documento.
+ * @param idf IDF del termino (ver idf_bm25).
+ * @param frecuencia Veces que aparece el termino en el documento.
+ * @param largo_documento Terminos indexados del documento.
+ * @param largo_promedio Largo promedio de los documentos del indice.
+ * @return double El aporte.
+ */
+double puntaje_bm25_termino(double idf, uint32_t frecuencia, uint32_t largo_documento, double largo_promedio);
+
+/**
+ * @brief Busqueda con ranking: intersecta las listas (AND) bloque a bloque, puntua cada
+ * coincidencia con BM25 (largos de documento y df de cada termino guardados al indexar) y
+ * se queda solo con las k mejores, sin armar la lista completa de resultados.
+ * @param indice El indice (de el salen los largos de los documentos).
+ * @param cursores Cursores recien abiertos de los terminos (quedan consumidos).
+ * @param cantidad Numero de cursores (hasta MAX_TERMINOS_INTERSECCION).
+ * @param salida Array de al menos 'k' elementos; queda ordenado de mejor a peor.
+ * @param k Cuantos resultados se quieren.
+ * @param total_coincidencias Si no es NULL, recibe cuantos documentos tienen todos los terminos.
+ * @return size_t Resultados escritos en 'salida' (a lo mas k).
+ */
+size_t buscar_mejores_conjuntivo(const indiceInvertido* indice, CursorPosteo* cursores[], size_t cantidad,
+                                 ResultadoBusqueda* salida, size_t k, uint32_t* total_coincidencias);
+
+/**
+ * @brief Igual que buscar_mejores_conjuntivo pero usando un estado de interseccion que da quien
+ * llama, sin pedir memoria: cada hilo que atiende consultas reutiliza el suyo (ver EspacioConsulta).
+ * @param interseccion Estado de la interseccion (su contenido anterior no importa).
+ */
+size_t buscar_mejores_conjuntivo_con(const indiceInvertido* indice, CursorPosteo* cursores[], size_t cantidad,
+                                     InterseccionCursores* interseccion, ResultadoBusqueda* salida, size_t k,
+                                     uint32_t* total_coincidencias);
+
+/**
+ * @brief Igual que buscar_mejores_conjuntivo_con, pero puntuando con las estadisticas de una coleccion
+ * de la que 'indice' es solo una parte. Los doc_id de 'salida' son los de 'indice'.
+ * @param coleccion N, largo promedio y df de la coleccion completa.
+ */
+size_t buscar_mejores_conjuntivo_en_coleccion(const indiceInvertido* indice, CursorPosteo* cursores[], size_t cantidad,
+                                              const ColeccionRanking* coleccion, InterseccionCursores* interseccion,
+                                              ResultadoBusqueda* salida, size_t k, uint32_t* total_coincidencias);
+
+// --- Prototipos de Cotas para la Poda Dinamica ---
+// La cota de un bloque (o de una lista) es el maximo de puntaje_bm25_termino(1.0, ...) entre sus
+// posteos, redondeado hacia arriba a float: al buscar se multiplica por el IDF del termino, que
+// depende del total de documentos y se calcula en cada consulta. Solo vale para el largo promedio
+// con que se calculo, por eso se rehace si el indice cambia.
+
+/**
+ * @brief Largo promedio de los documentos de una tabla (0 si esta vacia).
+ * @param documentos La tabla de documentos.
+ * @return double El largo promedio.
+ */
+double largo_promedio_documentos(const TablaDocumentos* documentos);
+
+/**
+ * @brief Calcula la cota BM25 de cada bloque de una lista y la de la lista completa.
+ * @param lista La lista de posteo.
+ * @param documentos Tabla de donde salen los largos de los documentos.
+ * @param cotas Donde se escriben las bloques_de_lista(lista->cantidad) cotas de bloque (puede ser NULL).
+ * @return float La cota de la lista (el maximo de las de sus bloques), 0 si esta vacia.
+ */
+float calcular_cotas_bloques_bm25(const ListaPosteo* lista, const TablaDocumentos* documentos, float* cotas);
+
+/**
+ * @brief Factor por el que hay que multiplicar cotas calculadas con un largo promedio para que sigan
+ * siendo cotas con otro. Con un promedio mayor los documentos largos se castigan menos y el aporte de
+ * un posteo crece, pero a lo mas en la razon entre los promedios; con uno menor nunca crece.
+ * @param largo_promedio_cotas Largo promedio con que se calcularon las cotas.
+ * @param largo_promedio Largo promedio con que se va a puntuar.
+ * @return double max(1, largo_promedio / largo_promedio_cotas) (1 si largo_promedio_cotas no es positivo).
+ */
+double escala_cotas_bm25(double largo_promedio_cotas, double largo_promedio);
+
+/**
+ * @brief Calcula y guarda en el indice (en memoria) las cotas BM25 de todas sus listas, para que
+ * abrir_cursor_termino se las pase a los cursores. Se llama al terminar de construir el indice;
+ * si despues se agregan terminos las cotas dejan de usarse hasta volver a llamarla.
+ * Un indice abierto con cargar_indice ya trae las cotas en el archivo.
+ * @param indice El indice.
+ * @return bool false si falla la memoria (el indice queda sin cotas y se busca sin podar).
+ */
+bool preparar_cotas_bm25(indiceInvertido* indice);
+
+// --- Prototipos de Busqueda Disyuntiva (OR) ---
+
+/** @brief Cuanto trabajo hizo una busqueda disyuntiva (para medir la poda). */
+typedef struct {
+    uint64_t posteos_totales;      // Posteos de todas las listas de la consulta.
+    uint64_t posteos_decodificados; // Posteos de los bloques que se llegaron a decodificar.
+    uint64_t documentos_puntuados; // Documentos a los que se les calculo el puntaje completo.
+} EstadisticasBusqueda;
+
+/**
+ * @brief Busqueda con ranking de los documentos que tienen al menos uno de los terminos (OR), con
+ * Block-Max WAND: recorre las listas en orden de doc_id y, con las cotas de cada lista y de cada bloque
+ * (ver fijar_cotas_cursor), salta los documentos y bloques enteros que no pueden superar al peor de los k
+ * mejores ya encontrados. El resultado es identico al de puntuar todos los documentos.
+ * Sin cotas (COTA_DESCONOCIDA) no poda nada, pero el resultado es el mismo.
+ * @param indice El indice (de el salen los largos de los documentos).
+ * @param cursores Cursores recien abiertos de los terminos (quedan consumidos).
+ * @param cantidad Numero de cursores (hasta MAX_TERMINOS_INTERSECCION).
+ * @param salida Array de al menos 'k' elementos; queda ordenado de mejor a peor.
+ * @param k Cuantos resultados se quieren.
+ * @param estadisticas Si no es NULL, recibe cuanto se leyo y se puntuo.
+ * @return size_t Resultados escritos en 'salida' (a lo mas k).
+ */
+size_t buscar_mejores_disyuntivo(const indiceInvertido* indice, CursorPosteo* cursores[], size_t cantidad,
+                                 ResultadoBusqueda* salida, size_t k, EstadisticasBusqueda* estadisticas);
+
+/**
+ * @brief Igual que buscar_mejores_disyuntivo, pero puntuando (y podando) con las estadisticas de una
+ * coleccion de la que 'indice' es solo una parte. Los doc_id de 'salida' son los de 'indice'.
+ * Con un umbral minimo (el peor de los k mejores de las partes anteriores) la poda arranca desde el,
+ * en vez de esperar a juntar k resultados propios.
+ * @param coleccion N, largo promedio y df de la coleccion completa, la escala de las cotas de 'indice' y el umbral.
+ */
+size_t buscar_mejores_disyuntivo_en_coleccion(const indiceInvertido* indice, CursorPosteo* cursores[], size_t cantidad,
+                                              const ColeccionRanking* coleccion, ResultadoBusqueda* salida, size_t k,
+                                              EstadisticasBusqueda* estadisticas);
+
+/**
+ * @brief Igual que buscar_mejores_disyuntivo pero puntuando todos los documentos, sin poda.
+ * Sirve de referencia para comprobar y medir la poda.
+ */
+size_t buscar_mejores_disyuntivo_exhaustivo(const indiceInvertido* indice, CursorPosteo* cursores[], size_t cantidad,
+                                            ResultadoBusqueda* salida, size_t k, EstadisticasBusqueda* estadisticas);
+
+#endif // ranking_H_
@@ -0,0 +1,48 @@
+#ifndef registro_H_
+#define registro_H_
+
+#include <stdbool.h>
+
+// Mensajes de progreso y de diagnostico con nivel: los que pasan el nivel elegido se escriben
+// (ERROR y AVISO por stderr, INFO y DETALLE por stdout) y los demas no cuestan mas que una comparacion.
+
+/** @brief Niveles de los mensajes, del mas importante al mas detallado. */
+typedef enum {
+    REGISTRO_ERROR,
+    REGISTRO_AVISO,
+    REGISTRO_INFO,      // Progreso (por defecto se muestra hasta aca).
+    REGISTRO_DETALLE    // Un mensaje por evento (palabras nuevas, etc.): solo para depurar.
+} NivelRegistro;
+
+extern NivelRegistro g_nivel_registro;
+
+/**
+ * @brief Escribe el mensaje si 'nivel' esta habilitado. Los argumentos no se evaluan si no lo esta.
+ */
+#define REGISTRAR(nivel, ...) \
+    do { if ((nivel) <= g_nivel_registro) registrar_mensaje((nivel), __VA_ARGS__); } while (0)
+
+// --- Prototipos de Funciones del Registro ---
+
+/**
+ * @brief Elige hasta que nivel se escriben los mensajes (por defecto REGISTRO_INFO).
+ * @param nivel El nivel mas detallado que se muestra.
+ */
+void fijar_nivel_registro(NivelRegistro nivel);
+
+/**
+ * @brief Traduce el nombre de un nivel ("error", "aviso", "info" o "detalle").
+ * @param nombre El nombre.
+ * @param nivel Recibe el nivel.
+ * @return bool false si el nombre no es ninguno de esos.
+ */
+bool nivel_registro_desde_texto(const char* nombre, NivelRegistro* nivel);
+
+/**
+ * @brief Escribe un mensaje con formato de printf, sin mirar el nivel (usar REGISTRAR).
+ * @param nivel Decide si va a stderr (ERROR, AVISO) o a stdout.
+ * @param formato Formato de printf.
+ */
+void registrar_mensaje(NivelRegistro nivel, const char* formato, ...) __attribute__((format(printf, 2, 3)));
+
+#endif // registro_H_
@@ -0,0 +1,211 @@
+#ifndef segmentos_H_
+#define segmentos_H_
+
+#include <stdbool.h>
+#include <stddef.h>     // Para size_t
+#include <stdint.h>     // Para uint32_t, uint64_t
+#include <pthread.h>
+#include "inverted_index.h"
+#include "list.h"
+#include "ranking.h"
+#include "consultas.h"
+
+/**
+ * @brief Indice segmentado: la coleccion es una lista ordenada de segmentos inmutables, cada uno un
+ * archivo de indice (ver indice_disco.h) dentro de un directorio. El catalogo del directorio
+ * (CATALOGO_SEGMENTOS) dice cuales son y en que orden; se reescribe entero (a un .tmp que se renombra)
+ * con cada cambio, asi un fallo a medias deja el catalogo anterior.
+ * Los documentos de cada segmento van despues de los del anterior: el doc_id de la coleccion es la
+ * base del segmento (los documentos de los anteriores) mas el doc_id dentro de el.
+ * Agregar documentos arma un segmento nuevo solo con ellos, asi que cuesta lo que indexarlos a ellos y
+ * no toda la coleccion. Las busquedas recorren todos los segmentos y juntan los resultados.
+ * Para que los segmentos no se acumulen, una politica por niveles fusiona de a SEGMENTOS_POR_NIVEL
+ * segmentos vecinos del mismo nivel (tamanio parecido) en uno; con el hilo de fusiones eso pasa en
+ * segundo plano, con menos prioridad que las consultas.
+ * Solo un proceso a la vez puede tener abierto el directorio (se bloquea con un archivo).
+**/
+
+/** @brief Archivo del catalogo dentro del directorio de segmentos. */
+#define CATALOGO_SEGMENTOS "segmentos.txt"
+/** @brief Primera linea del catalogo (formato y version). */
+#define CATALOGO_SEGMENTOS_MAGIA "PEDDSEG 1"
+/** @brief Segmentos vecinos de un mismo nivel que se fusionan juntos. */
+#define SEGMENTOS_POR_NIVEL 4
+/** @brief Documentos hasta los que un segmento es del nivel 0; cada nivel siguiente es SEGMENTOS_POR_NIVEL veces mas grande. */
+#define DOCUMENTOS_NIVEL_BASE 1000
+
+/**
+ * @brief Un segmento abierto. Lo pueden estar usando varias vistas a la vez: se cierra (y, si ya
+ * salio del catalogo, se borra su archivo) cuando la ultima lo suelta.
+**/
+typedef struct {
+    indiceInvertido* indice;    // Abierto con cargar_indice (solo lectura).
+    char* ruta;                 // Archivo del segmento.
+    uint64_t numero;            // El del nombre del archivo ("seg_<numero>.idx").
+    uint32_t referencias;       // El catalogo (mientras esta en el) mas cada vista o fusion que lo usa.
+    bool retirado;              // Ya no esta en el catalogo: su archivo se borra al cerrarlo.
+} Segmento;
+
+/**
+ * @brief Directorio de segmentos abierto. El catalogo en memoria y las referencias se protegen con
+ * 'mutex'; las fusiones van de a una ('mutex_fusion') y nunca lo toman mientras leen o escriben archivos.
+**/
+typedef struct IndiceSegmentado {
+    char* directorio;
+    Segmento** segmentos;       // En orden de doc_id.
+    size_t cantidad;
+    size_t capacidad;
+    uint64_t proximo_numero;    // Para nombrar el siguiente segmento.
+    uint64_t generacion;        // Sube con cada cambio del catalogo.
+    uint64_t fusiones;          // Fusiones hechas desde que se abrio.
+    int descriptor_bloqueo;     // Archivo que bloquea el directorio (-1 si no hay).
+
+    pthread_mutex_t mutex;
+    pthread_mutex_t mutex_fusion;
+    pthread_cond_t cambio;      // Despierta al hilo de fusiones (segmento nuevo o hay que terminar).
+    pthread_t hilo_fusiones;
+    bool con_hilo;
+    bool terminar;
+    bool fusion_fallida;        // La ultima fusion fallo: no se reintenta hasta que llegue otro segmento.
+} IndiceSegmentado;
+
+/**
+ * @brief Foto de los segmentos en un momento dado. Mientras no se suelte, sus segmentos siguen
+ * abiertos aunque una fusion los reemplace en el catalogo, asi la busqueda no espera a las fusiones.
+**/
+typedef struct {
+    Segmento** segmentos;
+    uint32_t* bases;            // bases[s]: doc_id de la coleccion del primer documento del segmento s.
+    size_t cantidad;
+    uint32_t total_documentos;
+    uint64_t suma_largos;
+    uint64_t generacion;        // La del catalogo cuando se tomo.
+} VistaSegmentos;
+
+// --- Prototipos de Funciones del Indice Segmentado ---
+
+/**
+ * @brief Abre (o crea, si no existe) un directorio de segmentos y abre todos los del catalogo.
+ * Borra los archivos de segmentos que no estan en el catalogo (restos de una fusion o de un
+ * agregado que no termino).
+ * @param directorio El directorio.
+ * @param fusionar_en_segundo_plano true para lanzar el hilo de fusiones; si no, solo se fusiona al
+ * llamar a fusionar_segmentos_pendientes.
+ * @return IndiceSegmentado* El indice (se cierra con cerrar_indice_segmentado) o NULL si el directorio
+ * no se puede crear o bloquear, el catalogo esta roto o falta algun segmento.
+ */
+IndiceSegmentado* abrir_indice_segmentado(const char* directorio, bool fusionar_en_segundo_plano);
+
+/**
+ * @brief Espera a que termine la fusion en curso (si hay), detiene el hilo de fusiones y cierra todo.
+ * No debe quedar ninguna vista sin soltar.
+ * @param segmentado El indice (puede ser NULL).
+ */
+void cerrar_indice_segmentado(IndiceSegmentado* segmentado);
+
+/**
+ * @brief Guarda un indice en memoria como un segmento nuevo, al final de la coleccion.
+ * @param segmentado El indice segmentado.
+ * @param nuevo Indice con solo los documentos nuevos (sus doc_id empiezan en 0); no se modifica.
+ * @return bool true si el segmento quedo en el catalogo (o si 'nuevo' no tiene documentos).
+ */
+bool agregar_segmento(IndiceSegmentado* segmentado, const indiceInvertido* nuevo);
+
+/**
+ * @brief Indexa un archivo de documentos (con el mismo parser que el indice en memoria) y lo agrega
+ * como un segmento nuevo. El costo depende solo del archivo nuevo, no del resto de la coleccion.
+ * @param segmentado El indice segmentado.
+ * @param archivo_documentos Archivo con los documentos nuevos.
+ * @param num_hilos Hilos para indexarlo (ver procesar_archivo_documento_paralelo).
+ * @return bool false si el archivo no se pudo procesar entero o no se pudo guardar el segmento.
+ */
+bool agregar_documentos_como_segmento(IndiceSegmentado* segmentado, const char* archivo_documentos, int num_hilos);
+
+/**
+ * @brief Hace en el hilo que llama las fusiones que pide la politica por niveles, hasta que no quede
+ * ninguna (o una falle). Con el hilo de fusiones no hace falta llamarla.
+ * @param segmentado El indice segmentado.
+ * @return size_t Fusiones hechas.
+ */
+size_t fusionar_segmentos_pendientes(IndiceSegmentado* segmentado);
+
+/**
+ * @brief Indica si una ruta es un directorio (y por lo tanto se abre como indice segmentado y no
+ * como un archivo de indice).
+ * @param ruta La ruta.
+ * @return bool true si existe y es un directorio.
+ */
+bool es_directorio_de_segmentos(const char* ruta);
+
+/**
+ * @brief Nivel de un segmento segun su cantidad de documentos: 0 hasta DOCUMENTOS_NIVEL_BASE y uno
+ * mas cada vez que se multiplica por SEGMENTOS_POR_NIVEL.
+ * @param documentos Documentos del segmento.
+ * @return int El nivel.
+ */
+int nivel_de_segmento(uint32_t documentos);
+
+// --- Prototipos de Busqueda sobre los Segmentos ---
+
+/**
+ * @brief Toma una vista de los segmentos actuales (cada uno queda con una referencia mas).
+ * @param segmentado El indice segmentado.
+ * @param vista Donde se deja la vista (se suelta con soltar_vista_segmentos).
+ * @return bool false si falla la memoria (la vista queda vacia).
+ */
+bool tomar_vista_segmentos(IndiceSegmentado* segmentado, VistaSegmentos* vista);
+
+/**
+ * @brief Suelta una vista: los segmentos que ya salieron del catalogo se cierran si nadie mas los usa.
+ * @param segmentado El indice segmentado del que se tomo.
+ * @param vista La vista (queda vacia).
+ */
+void soltar_vista_segmentos(IndiceSegmentado* segmentado, VistaSegmentos* vista);
+
+/**
+ * @brief URL de un documento de la coleccion.
+ * @param vista La vista.
+ * @param doc_id doc_id de la coleccion.
+ * @return const char* La URL, o NULL si el doc_id no existe.
+ */
+const char* url_documento_segmentos(const VistaSegmentos* vista, uint32_t doc_id);
+
+/**
+ * @brief Cuantos documentos de la coleccion tienen el termino (su df, sumando el de cada segmento).
+ * @param vista La vista.
+ * @param termino El termino, ya normalizado.
+ * @param cursor Cursor de trabajo (queda abierto sobre el ultimo segmento que tiene el termino).
+ * @return uint32_t El df (0 si ningun segmento tiene el termino).
+ */
+uint32_t documentos_con_termino_segmentos(const VistaSegmentos* vista, const char* termino, CursorPosteo* cursor);
+
+/**
+ * @brief Busqueda conjuntiva (AND) sin ranking en todos los segmentos: intersecta en cada uno y junta
+ * los resultados con los doc_id de la coleccion (quedan ordenados, porque las bases crecen).
+ * @param vista La vista.
+ * @param consulta La consulta analizada (sus frases se buscan como terminos sueltos).
+ * @param espacio Memoria de trabajo (ver EspacioConsulta).
+ * @return ListaPosteo Lista nueva que se libera con free_list() (vacia si no hay documentos o falla la memoria).
+ */
+ListaPosteo buscar_conjuntivo_segmentos(const VistaSegmentos* vista, const ConsultaAnalizada* consulta,
+                                        EspacioConsulta* espacio);
+
+/**
+ * @brief Busqueda con ranking BM25 en todos los segmentos, AND u OR. Cada segmento puntua con el N, el
+ * largo promedio y el df de toda la coleccion (ver ColeccionRanking), asi los puntajes son los mismos que
+ * con un solo indice de todos los documentos y basta con juntar los k mejores de cada segmento.
+ * @param vista La vista.
+ * @param consulta La consulta analizada.
+ * @param disyuntiva true para OR con Block-Max WAND, false para AND.
+ * @param espacio Memoria de trabajo (ver EspacioConsulta).
+ * @param mejores Array de al menos k elementos; queda ordenado de mejor a peor, con doc_id de la coleccion.
+ * @param k Cuantos resultados se quieren.
+ * @param total_coincidencias Si no es NULL, recibe cuantos documentos tienen todos los terminos (solo AND).
+ * @param estadisticas Si no es NULL, recibe cuanto se leyo y se puntuo en todos los segmentos (solo OR).
+ * @return size_t Resultados escritos en 'mejores' (a lo mas k).
+ */
+size_t buscar_mejores_segmentos(const VistaSegmentos* vista, const ConsultaAnalizada* consulta, bool disyuntiva,
+                                EspacioConsulta* espacio, ResultadoBusqueda* mejores, size_t k,
+                                uint32_t* total_coincidencias, EstadisticasBusqueda* estadisticas);
+
+#endif // segmentos_H_
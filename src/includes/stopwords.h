@@ -2,6 +2,7 @@
 #define stopword_H_
 
 #include <stdbool.h>
+#include <stddef.h>  // Para size_t
 
 // --- Prototipos de Funciones para el Manejo de Stop Words ---
 
@@ -19,14 +20,24 @@ bool cargar_stopwords(const char* filename);
 
 /**
  * @brief Verifica si una palabra dada es una stop word.
- * Compara la palabra (probablemente convirtiéndola a minúsculas internamente)
- * con la lista de stop words cargada previamente en memoria.
+ * Sin distinguir mayúsculas; es es_stopword_largo con strlen(word).
  * @param word La palabra a verificar.
  * @return bool Devuelve true si la palabra se encuentra en la lista de stop words cargada,
  * false en caso contrario.
  */
 bool es_stopword(const char* word);
 
+/**
+ * @brief Verifica si los 'largo' caracteres de 'palabra' son una stop word, sin copiarlos.
+ * cargar_stopwords arma una tabla hash de solo lectura: la mayoría de las palabras se descarta por
+ * su largo o su primera letra y el resto cuesta un hash y un sondeo. Sin distinguir mayúsculas.
+ * Se puede llamar desde varios hilos a la vez mientras no se recarguen las stopwords.
+ * @param palabra Inicio de la palabra (no necesita terminar en '\0').
+ * @param largo Cantidad de caracteres de la palabra.
+ * @return bool true si es una stop word cargada, false si no (o si no hay stopwords cargadas).
+ */
+bool es_stopword_largo(const char* palabra, size_t largo);
+
 /**
  * @brief Libera toda la memoria utilizada para almacenar la lista de stop words.
  * Debe llamarse al final del programa para evitar fugas de memoria.
@@ -0,0 +1,51 @@
+#ifndef tokenizador_H_
+#define tokenizador_H_
+
+#include <stdbool.h>
+#include <stddef.h>     // Para size_t
+
+/** @brief Largo maximo de un termino; los tokens mas largos se cortan a este largo. */
+#define MAX_LARGO_TERMINO 255
+
+/**
+ * @brief Tokenizador reentrante sobre un texto que no se modifica.
+ * Separa por los mismos delimitadores de siempre (espacios, puntuacion, guiones, comillas) usando
+ * una tabla de 256 clases de caracter, y pasa a minusculas en la misma pasada. Cada hilo o consulta
+ * usa su propio Tokenizador, asi que se puede usar en paralelo (a diferencia de strtok).
+ * Lo comparten el parser y las consultas de main.c para que ambos normalicen igual los terminos.
+**/
+typedef struct {
+    const unsigned char* actual; // Proximo caracter por mirar.
+    const unsigned char* fin;    // Uno despues del ultimo caracter del texto.
+} Tokenizador;
+
+/**
+ * @brief Un token encontrado por siguiente_token.
+**/
+typedef struct {
+    const char* inicio;                   // Donde empieza el token en el texto original.
+    size_t largo;                         // Largo del token en el texto original.
+    char texto[MAX_LARGO_TERMINO + 1];    // El token en minusculas, cortado a MAX_LARGO_TERMINO y terminado en '\0'.
+    size_t largo_texto;                   // strlen(texto).
+} Token;
+
+// --- Prototipos de Funciones del Tokenizador ---
+
+/**
+ * @brief Prepara un tokenizador para recorrer 'largo' bytes de 'texto'.
+ * El texto debe seguir existiendo mientras se usen los tokens (Token.inicio apunta dentro de el).
+ * @param tokenizador El tokenizador a preparar.
+ * @param texto El texto a recorrer (no necesita terminar en '\0'; un '\0' se trata como separador).
+ * @param largo Cantidad de bytes de 'texto'.
+ */
+void iniciar_tokenizador(Tokenizador* tokenizador, const char* texto, size_t largo);
+
+/**
+ * @brief Avanza hasta el proximo token y lo deja en 'token' (ya en minusculas).
+ * @param tokenizador El tokenizador.
+ * @param token Donde se deja el token encontrado.
+ * @return bool true si encontro un token, false si se acabo el texto.
+ */
+bool siguiente_token(Tokenizador* tokenizador, Token* token);
+
+#endif // tokenizador_H_
@@ -0,0 +1,775 @@
+#include "includes/indice_disco.h"
+#include "includes/inverted_index.h"
+#include "includes/documentos.h"
+#include "includes/list.h"
+#include "includes/posteo_comprimido.h"
+#include "includes/ranking.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+
+// Con mmap el archivo se comparte entre procesos y solo se leen las paginas que se tocan;
+// en Windows (sin mmap) se lee el archivo entero a un buffer y se usa igual.
+#if !defined(_WIN32)
+#define INDICE_CON_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define LARGO_MAGIA 8
+
+// Cabecera del archivo; todos los campos quedan alineados, asi que no hay relleno entre ellos.
+typedef struct {
+    char magia[LARGO_MAGIA];
+    uint32_t version;
+    uint32_t num_documentos;
+    uint64_t num_terminos;
+    uint64_t suma_largos;
+    uint64_t tabla_tamanio;
+    uint64_t offset_largos;
+    uint64_t offset_urls;
+    uint64_t offset_terminos;
+    uint64_t offset_tabla;
+    uint64_t offset_textos;
+    uint64_t offset_posteos;
+    uint64_t tamanio_total;
+} CabeceraIndice;
+
+// Registro de un termino dentro del archivo.
+typedef struct {
+    uint32_t hash;           // Hash de la palabra (el de EntradaVocabulario).
+    uint32_t cantidad;       // Documentos en su lista de posteo.
+    uint64_t offset_palabra; // Palabra terminada en '\0'.
+    uint64_t offset_posteo;  // Lista comprimida (ver posteo_comprimido.h).
+    uint64_t largo_posteo;   // Bytes de la lista comprimida.
+    float cota_bm25;         // Cota BM25 de toda la lista (las de cada bloque van en su tabla de saltos).
+    uint32_t relleno;        // 0; deja el registro en 40 bytes, alineado a 8.
+} TerminoMapeado;
+
+// Escritor termino a termino (ver abrir_escritor_indice). Dos FILE* sobre el mismo archivo temporal:
+// uno avanza por la seccion de registros de los terminos y el otro por la de posteos.
+struct EscritorIndice {
+    FILE* registros;
+    FILE* posteos;
+    char* ruta;
+    char* ruta_temporal;
+    CabeceraIndice cabecera;
+    const TablaDocumentos* documentos; // Largos de los documentos, para las cotas BM25.
+    uint64_t escritos;                 // Terminos ya escritos.
+    uint64_t offset_palabra;           // Donde esta la palabra del proximo termino.
+    uint64_t offset_posteo;            // Donde va la lista del proximo termino.
+    uint64_t fin_textos;               // Fin de la seccion de textos (sin el relleno).
+    uint8_t* buffer;                   // Lista comprimida del termino actual.
+    size_t capacidad_buffer;
+    float* cotas;                      // Cotas de los bloques del termino actual.
+    uint32_t capacidad_cotas;
+    bool error;
+};
+
+struct IndiceMapeado {
+    const unsigned char* base;       // Inicio del archivo en memoria.
+    size_t tamanio;                  // Bytes del archivo.
+    const CabeceraIndice* cabecera;  // Apunta a "base".
+    const TerminoMapeado* terminos;  // cabecera->num_terminos registros.
+    const uint32_t* tabla_hash;      // cabecera->tabla_tamanio slots.
+    bool leido_en_memoria;           // true si se leyo con fread en vez de mapearse.
+};
+
+// --- Funciones Estáticas (disposicion del archivo) ---
+
+static uint64_t alinear_a_8(uint64_t offset) {
+    return (offset + 7) & ~(uint64_t)7;
+}
+
+// Mismo criterio que la tabla en memoria: potencia de 2 con factor de carga de 0.5 o menos.
+static uint64_t tamanio_tabla_archivo(uint64_t num_terminos) {
+    uint64_t tamanio = 16;
+    while (tamanio < num_terminos * 2) {
+        tamanio <<= 1;
+    }
+    return tamanio;
+}
+
+// Llena los offsets de las secciones de tamanio fijo a partir de las cantidades de la cabecera.
+static void calcular_secciones_fijas(CabeceraIndice* cabecera) {
+    cabecera->offset_largos = sizeof(CabeceraIndice);
+    cabecera->offset_urls = alinear_a_8(cabecera->offset_largos + (uint64_t)cabecera->num_documentos * sizeof(uint32_t));
+    cabecera->offset_terminos = cabecera->offset_urls + (uint64_t)cabecera->num_documentos * sizeof(uint64_t);
+    cabecera->offset_tabla = cabecera->offset_terminos + cabecera->num_terminos * sizeof(TerminoMapeado);
+    cabecera->offset_textos = alinear_a_8(cabecera->offset_tabla + cabecera->tabla_tamanio * sizeof(uint32_t));
+}
+
+// --- Funciones Estáticas (escritura) ---
+
+static bool escribir_ceros(FILE* archivo, uint64_t cantidad) {
+    static const char ceros[8] = { 0 };
+    return cantidad == 0 || fwrite(ceros, 1, (size_t)cantidad, archivo) == cantidad;
+}
+
+static bool escribir_u64(FILE* archivo, uint64_t valor) {
+    return fwrite(&valor, sizeof(valor), 1, archivo) == 1;
+}
+
+static bool escribir_documentos(FILE* archivo, const CabeceraIndice* cabecera, const TablaDocumentos* documentos) {
+    uint32_t n = cabecera->num_documentos;
+    if (n > 0 && fwrite(documentos->largos, sizeof(uint32_t), n, archivo) != n) return false;
+    if (!escribir_ceros(archivo, cabecera->offset_urls - (cabecera->offset_largos + (uint64_t)n * sizeof(uint32_t)))) return false;
+
+    // Las URLs van primero en la seccion de textos, en orden de ID.
+    uint64_t offset = cabecera->offset_textos;
+    for (uint32_t id = 0; id < n; id++) {
+        if (!escribir_u64(archivo, offset)) return false;
+        offset += strlen(url_documento(documentos, id)) + 1;
+    }
+    return true;
+}
+
+// Escribe los registros de los terminos; sus palabras van en "textos" despues de las URLs.
+// 'largos_posteo' y 'cotas' tienen los bytes comprimidos y la cota BM25 de cada lista, calculados en la primera pasada.
+static bool escribir_registros(FILE* archivo, const CabeceraIndice* cabecera, const indiceInvertido* indice,
+                               uint64_t offset_palabras, const uint64_t* largos_posteo, const float* cotas) {
+    uint64_t offset_posteo = cabecera->offset_posteos;
+    for (size_t i = 0; i < indice->cantidad; i++) {
+        const EntradaVocabulario* entrada = &indice->entradas[i];
+        TerminoMapeado registro;
+        registro.hash = entrada->hash;
+        registro.cantidad = entrada->lista_documentos.cantidad;
+        registro.offset_palabra = offset_palabras;
+        registro.offset_posteo = offset_posteo;
+        registro.largo_posteo = largos_posteo[i];
+        registro.cota_bm25 = cotas[i];
+        registro.relleno = 0;
+        if (fwrite(&registro, sizeof(registro), 1, archivo) != 1) return false;
+        offset_palabras += strlen(entrada->palabra) + 1;
+        offset_posteo += registro.largo_posteo;
+    }
+    return true;
+}
+
+// Arma la tabla hash del archivo con el mismo sondeo lineal que insertar_en_tabla de inverted_index.c.
+// El hash del termino 'pos' es el de la entrada del indice o, sin indice, hashes[pos].
+static bool escribir_tabla_hash(FILE* archivo, const CabeceraIndice* cabecera, const indiceInvertido* indice,
+                                const uint32_t* hashes) {
+    uint64_t tamanio = cabecera->tabla_tamanio;
+    uint32_t* tabla = (uint32_t*)calloc((size_t)tamanio, sizeof(uint32_t));
+    if (!tabla) {
+        perror("[INDICE_DISCO] Fallo calloc para la tabla hash del archivo");
+        return false;
+    }
+    uint64_t mascara = tamanio - 1;
+    for (size_t pos = 0; pos < cabecera->num_terminos; pos++) {
+        uint64_t i = (indice ? indice->entradas[pos].hash : hashes[pos]) & mascara;
+        while (tabla[i] != 0) {
+            i = (i + 1) & mascara;
+        }
+        tabla[i] = (uint32_t)(pos + 1);
+    }
+    bool ok = fwrite(tabla, sizeof(uint32_t), (size_t)tamanio, archivo) == tamanio;
+    free(tabla);
+    return ok && escribir_ceros(archivo, cabecera->offset_textos - (cabecera->offset_tabla + tamanio * sizeof(uint32_t)));
+}
+
+static bool escribir_textos(FILE* archivo, const CabeceraIndice* cabecera, const indiceInvertido* indice) {
+    uint64_t escritos = 0;
+    for (uint32_t id = 0; id < cabecera->num_documentos; id++) {
+        const char* url = url_documento(indice->documentos, id);
+        size_t largo = strlen(url) + 1;
+        if (fwrite(url, 1, largo, archivo) != largo) return false;
+        escritos += largo;
+    }
+    for (size_t i = 0; i < indice->cantidad; i++) {
+        size_t largo = strlen(indice->entradas[i].palabra) + 1;
+        if (fwrite(indice->entradas[i].palabra, 1, largo, archivo) != largo) return false;
+        escritos += largo;
+    }
+    return escribir_ceros(archivo, cabecera->offset_posteos - (cabecera->offset_textos + escritos));
+}
+
+// Comprime cada lista (con las cotas BM25 de sus bloques) en buffers que se reutilizan: crecen hasta el
+// tamanio de la lista comprimida mas larga y de la que tiene mas bloques.
+static bool escribir_posteos(FILE* archivo, const indiceInvertido* indice, const uint64_t* largos_posteo) {
+    uint64_t capacidad = 0;
+    uint32_t max_bloques = 1;
+    for (size_t i = 0; i < indice->cantidad; i++) {
+        if (largos_posteo[i] > capacidad) capacidad = largos_posteo[i];
+        uint32_t bloques = bloques_de_lista(indice->entradas[i].lista_documentos.cantidad);
+        if (bloques > max_bloques) max_bloques = bloques;
+    }
+    uint8_t* buffer = (uint8_t*)malloc(capacidad > 0 ? (size_t)capacidad : 1);
+    float* cotas = (float*)malloc((size_t)max_bloques * sizeof(float));
+    if (!buffer || !cotas) {
+        perror("[INDICE_DISCO] Fallo malloc para el buffer de compresion de posteos");
+        free(buffer);
+        free(cotas);
+        return false;
+    }
+    bool ok = true;
+    for (size_t i = 0; ok && i < indice->cantidad; i++) {
+        const ListaPosteo* lista = &indice->entradas[i].lista_documentos;
+        calcular_cotas_bloques_bm25(lista, indice->documentos, cotas);
+        size_t bytes = comprimir_lista(lista, cotas, buffer);
+        ok = bytes == largos_posteo[i] && (bytes == 0 || fwrite(buffer, 1, bytes, archivo) == bytes);
+    }
+    free(buffer);
+    free(cotas);
+    return ok;
+}
+
+// Escribe la seccion offsets_urls a partir de las URLs que estan al principio de 'textos' (terminadas en
+// '\0', una por documento) y deja en 'largo_urls' cuantos bytes ocupan. 'textos' queda al principio.
+static bool escribir_offsets_urls_de_archivo(FILE* archivo, const CabeceraIndice* cabecera, FILE* textos,
+                                             uint64_t largo_textos, uint64_t* largo_urls) {
+    char buffer[1 << 16];
+    uint64_t posicion = 0;
+    uint32_t pendientes = cabecera->num_documentos;
+    bool inicio_de_url = true;
+    rewind(textos);
+    while (pendientes > 0 && posicion < largo_textos) {
+        size_t leidos = fread(buffer, 1, sizeof(buffer), textos);
+        if (leidos == 0) break;
+        for (size_t i = 0; i < leidos && pendientes > 0; i++, posicion++) {
+            if (inicio_de_url) {
+                if (!escribir_u64(archivo, cabecera->offset_textos + posicion)) return false;
+                inicio_de_url = false;
+            }
+            if (buffer[i] == '\0') {
+                pendientes--;
+                inicio_de_url = true;
+            }
+        }
+    }
+    rewind(textos);
+    *largo_urls = posicion;
+    return pendientes == 0 && posicion <= largo_textos;
+}
+
+// Copia los 'largo' bytes de 'textos' (desde el principio) y el relleno hasta la seccion de posteos.
+static bool copiar_textos_de_archivo(FILE* archivo, const CabeceraIndice* cabecera, FILE* textos, uint64_t largo) {
+    char buffer[1 << 16];
+    uint64_t copiados = 0;
+    rewind(textos);
+    while (copiados < largo) {
+        size_t pedir = largo - copiados < sizeof(buffer) ? (size_t)(largo - copiados) : sizeof(buffer);
+        if (fread(buffer, 1, pedir, textos) != pedir || fwrite(buffer, 1, pedir, archivo) != pedir) return false;
+        copiados += pedir;
+    }
+    return escribir_ceros(archivo, cabecera->offset_posteos - (cabecera->offset_textos + largo));
+}
+
+static char* ruta_temporal_de(const char* ruta) {
+    size_t largo_ruta = strlen(ruta);
+    char* ruta_temporal = (char*)malloc(largo_ruta + 5);
+    if (!ruta_temporal) {
+        perror("[INDICE_DISCO] Fallo malloc para la ruta temporal");
+        return NULL;
+    }
+    memcpy(ruta_temporal, ruta, largo_ruta);
+    memcpy(ruta_temporal + largo_ruta, ".tmp", 5);
+    return ruta_temporal;
+}
+
+// --- Funciones Estáticas (lectura) ---
+
+// Revisa que la cabecera sea de este formato y que sus secciones calcen con el tamanio del archivo.
+static bool cabecera_valida(const CabeceraIndice* cabecera, size_t tamanio_archivo, const char* ruta) {
+    if (memcmp(cabecera->magia, FORMATO_INDICE_MAGIA, sizeof(FORMATO_INDICE_MAGIA)) != 0) {
+        fprintf(stderr, "[INDICE_DISCO] Error: '%s' no es un archivo de indice.\n", ruta);
+        return false;
+    }
+    if (cabecera->version != FORMATO_INDICE_VERSION) {
+        fprintf(stderr, "[INDICE_DISCO] Error: '%s' tiene la version de formato %u y se esperaba la %u.\n",
+                ruta, (unsigned)cabecera->version, (unsigned)FORMATO_INDICE_VERSION);
+        return false;
+    }
+    if (cabecera->num_documentos == DOC_ID_INVALIDO || cabecera->num_terminos >= UINT32_MAX ||
+        cabecera->tabla_tamanio != tamanio_tabla_archivo(cabecera->num_terminos) ||
+        cabecera->tamanio_total != tamanio_archivo) {
+        fprintf(stderr, "[INDICE_DISCO] Error: Cabecera invalida o archivo truncado en '%s'.\n", ruta);
+        return false;
+    }
+    CabeceraIndice esperada = *cabecera;
+    calcular_secciones_fijas(&esperada);
+    if (esperada.offset_largos != cabecera->offset_largos || esperada.offset_urls != cabecera->offset_urls ||
+        esperada.offset_terminos != cabecera->offset_terminos || esperada.offset_tabla != cabecera->offset_tabla ||
+        esperada.offset_textos != cabecera->offset_textos || cabecera->offset_posteos < cabecera->offset_textos ||
+        cabecera->offset_posteos % 8 != 0 || cabecera->offset_posteos > cabecera->tamanio_total) {
+        fprintf(stderr, "[INDICE_DISCO] Error: Las secciones de '%s' no calzan con su cabecera.\n", ruta);
+        return false;
+    }
+    return true;
+}
+
+// Revisa que cada URL empiece dentro de "textos" y que "textos" termine en '\0' antes de los posteos;
+// asi url_documento y los strcmp sobre las palabras nunca se salen del archivo.
+static bool textos_validos(const unsigned char* base, const CabeceraIndice* cabecera, const char* ruta) {
+    if (cabecera->offset_posteos > cabecera->offset_textos && base[cabecera->offset_posteos - 1] != '\0') {
+        fprintf(stderr, "[INDICE_DISCO] Error: Los textos de '%s' no terminan en '\\0'.\n", ruta);
+        return false;
+    }
+    const uint64_t* offsets_urls = (const uint64_t*)(base + cabecera->offset_urls);
+    for (uint32_t id = 0; id < cabecera->num_documentos; id++) {
+        if (offsets_urls[id] < cabecera->offset_textos || offsets_urls[id] >= cabecera->offset_posteos) {
+            fprintf(stderr, "[INDICE_DISCO] Error: La URL del documento %u de '%s' esta fuera de rango.\n",
+                    (unsigned)id, ruta);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Un registro es usable si su palabra cae en "textos" y su lista completa cabe en "posteos".
+// El contenido de la lista lo valida el cursor al decodificarla.
+static bool registro_en_rango(const struct IndiceMapeado* mapeado, const TerminoMapeado* registro) {
+    const CabeceraIndice* cabecera = mapeado->cabecera;
+    return registro->offset_palabra >= cabecera->offset_textos && registro->offset_palabra < cabecera->offset_posteos &&
+           registro->offset_posteo >= cabecera->offset_posteos && registro->cantidad <= cabecera->num_documentos &&
+           registro->offset_posteo <= mapeado->tamanio &&
+           registro->largo_posteo <= mapeado->tamanio - registro->offset_posteo;
+}
+
+// Deja el archivo completo en memoria (mapeado o leido). Devuelve NULL y avisa si no se puede.
+static const unsigned char* abrir_archivo_en_memoria(const char* ruta, size_t* tamanio, bool* leido_en_memoria) {
+#ifdef INDICE_CON_MMAP
+    int fd = open(ruta, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "[INDICE_DISCO] No se pudo abrir el archivo de indice '%s': %s\n", ruta, strerror(errno));
+        return NULL;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (uint64_t)info.st_size < sizeof(CabeceraIndice)) {
+        fprintf(stderr, "[INDICE_DISCO] Error: '%s' es muy corto para ser un archivo de indice.\n", ruta);
+        close(fd);
+        return NULL;
+    }
+    void* mapa = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // El mapeo sigue valido sin el descriptor.
+    if (mapa == MAP_FAILED) {
+        fprintf(stderr, "[INDICE_DISCO] No se pudo mapear '%s': %s\n", ruta, strerror(errno));
+        return NULL;
+    }
+    *tamanio = (size_t)info.st_size;
+    *leido_en_memoria = false;
+    return (const unsigned char*)mapa;
+#else
+    FILE* archivo = fopen(ruta, "rb");
+    if (!archivo) {
+        fprintf(stderr, "[INDICE_DISCO] No se pudo abrir el archivo de indice '%s': %s\n", ruta, strerror(errno));
+        return NULL;
+    }
+    long largo = -1;
+    if (fseek(archivo, 0, SEEK_END) == 0) largo = ftell(archivo);
+    if (largo < (long)sizeof(CabeceraIndice) || fseek(archivo, 0, SEEK_SET) != 0) {
+        fprintf(stderr, "[INDICE_DISCO] Error: '%s' es muy corto para ser un archivo de indice.\n", ruta);
+        fclose(archivo);
+        return NULL;
+    }
+    unsigned char* buffer = (unsigned char*)malloc((size_t)largo);
+    if (!buffer || fread(buffer, 1, (size_t)largo, archivo) != (size_t)largo) {
+        fprintf(stderr, "[INDICE_DISCO] No se pudo leer '%s' a memoria.\n", ruta);
+        free(buffer);
+        fclose(archivo);
+        return NULL;
+    }
+    fclose(archivo);
+    *tamanio = (size_t)largo;
+    *leido_en_memoria = true;
+    return buffer;
+#endif
+}
+
+static void soltar_archivo_en_memoria(const unsigned char* base, size_t tamanio, bool leido_en_memoria) {
+    if (!base) return;
+    if (leido_en_memoria) {
+        free((void*)base);
+        return;
+    }
+#ifdef INDICE_CON_MMAP
+    munmap((void*)base, tamanio);
+#else
+    (void)tamanio;
+#endif
+}
+
+// --- Implementación de Funciones Públicas (declaradas en indice_disco.h) ---
+
+bool guardar_indice(const indiceInvertido* indice, const char* ruta) {
+    if (!indice || !ruta) {
+        fprintf(stderr, "[INDICE_DISCO] Error: Indice o ruta nulos en guardar_indice.\n");
+        return false;
+    }
+    if (indice->mapeado) {
+        fprintf(stderr, "[INDICE_DISCO] Error: El indice ya es un archivo de solo lectura; no se vuelve a guardar.\n");
+        return false;
+    }
+
+    // Primera pasada: tamanios de las secciones variables (textos y posteos) para fijar todos los offsets.
+    CabeceraIndice cabecera;
+    memset(&cabecera, 0, sizeof(cabecera));
+    memcpy(cabecera.magia, FORMATO_INDICE_MAGIA, sizeof(FORMATO_INDICE_MAGIA));
+    cabecera.version = FORMATO_INDICE_VERSION;
+    cabecera.num_documentos = indice->documentos->cantidad;
+    cabecera.num_terminos = indice->cantidad;
+    cabecera.suma_largos = indice->documentos->suma_largos;
+    cabecera.tabla_tamanio = tamanio_tabla_archivo(cabecera.num_terminos);
+    calcular_secciones_fijas(&cabecera);
+
+    size_t num_listas = indice->cantidad > 0 ? indice->cantidad : 1;
+    uint64_t* largos_posteo = (uint64_t*)malloc(num_listas * sizeof(uint64_t));
+    float* cotas = (float*)malloc(num_listas * sizeof(float));
+    if (!largos_posteo || !cotas) {
+        perror("[INDICE_DISCO] Fallo malloc para los largos de las listas comprimidas");
+        free(largos_posteo);
+        free(cotas);
+        return false;
+    }
+    uint64_t largo_urls = 0, largo_palabras = 0, largo_posteos = 0;
+    for (uint32_t id = 0; id < cabecera.num_documentos; id++) {
+        largo_urls += strlen(url_documento(indice->documentos, id)) + 1;
+    }
+    for (size_t i = 0; i < indice->cantidad; i++) {
+        const ListaPosteo* lista = &indice->entradas[i].lista_documentos;
+        largo_palabras += strlen(indice->entradas[i].palabra) + 1;
+        largos_posteo[i] = largo_lista_comprimida(lista);
+        largo_posteos += largos_posteo[i];
+        cotas[i] = calcular_cotas_bloques_bm25(lista, indice->documentos, NULL);
+    }
+    cabecera.offset_posteos = alinear_a_8(cabecera.offset_textos + largo_urls + largo_palabras);
+    cabecera.tamanio_total = cabecera.offset_posteos + largo_posteos;
+
+    char* ruta_temporal = ruta_temporal_de(ruta);
+    if (!ruta_temporal) {
+        free(largos_posteo);
+        free(cotas);
+        return false;
+    }
+
+    FILE* archivo = fopen(ruta_temporal, "wb");
+    if (!archivo) {
+        fprintf(stderr, "[INDICE_DISCO] No se pudo crear '%s': %s\n", ruta_temporal, strerror(errno));
+        free(ruta_temporal);
+        free(largos_posteo);
+        free(cotas);
+        return false;
+    }
+
+    bool ok = fwrite(&cabecera, sizeof(cabecera), 1, archivo) == 1 &&
+              escribir_documentos(archivo, &cabecera, indice->documentos) &&
+              escribir_registros(archivo, &cabecera, indice, cabecera.offset_textos + largo_urls, largos_posteo, cotas) &&
+              escribir_tabla_hash(archivo, &cabecera, indice, NULL) &&
+              escribir_textos(archivo, &cabecera, indice) &&
+              escribir_posteos(archivo, indice, largos_posteo);
+
+    if (fclose(archivo) != 0) ok = false;
+    if (ok && rename(ruta_temporal, ruta) != 0) {
+        fprintf(stderr, "[INDICE_DISCO] No se pudo renombrar '%s' a '%s': %s\n", ruta_temporal, ruta, strerror(errno));
+        ok = false;
+    }
+    if (!ok) {
+        fprintf(stderr, "[INDICE_DISCO] Error escribiendo el indice en '%s'.\n", ruta);
+        remove(ruta_temporal);
+    } else {
+        printf("[INDICE_DISCO] Indice guardado en '%s' (%zu terminos, %u documentos, %llu bytes).\n",
+               ruta, indice->cantidad, (unsigned)indice->documentos->cantidad, (unsigned long long)cabecera.tamanio_total);
+    }
+    free(ruta_temporal);
+    free(largos_posteo);
+    free(cotas);
+    return ok;
+}
+
+indiceInvertido* cargar_indice(const char* ruta) {
+    if (!ruta) {
+        fprintf(stderr, "[INDICE_DISCO] Error: Ruta nula en cargar_indice.\n");
+        return NULL;
+    }
+
+    size_t tamanio = 0;
+    bool leido_en_memoria = false;
+    const unsigned char* base = abrir_archivo_en_memoria(ruta, &tamanio, &leido_en_memoria);
+    if (!base) {
+        return NULL;
+    }
+    const CabeceraIndice* cabecera = (const CabeceraIndice*)base;
+    if (!cabecera_valida(cabecera, tamanio, ruta) || !textos_validos(base, cabecera, ruta)) {
+        soltar_archivo_en_memoria(base, tamanio, leido_en_memoria);
+        return NULL;
+    }
+
+    struct IndiceMapeado* mapeado = (struct IndiceMapeado*)malloc(sizeof(struct IndiceMapeado));
+    indiceInvertido* indice = (indiceInvertido*)calloc(1, sizeof(indiceInvertido));
+    TablaDocumentos* documentos = crear_tabla_documentos_mapeada(
+        cabecera->num_documentos, (const uint32_t*)(base + cabecera->offset_largos), (const char*)base,
+        (const uint64_t*)(base + cabecera->offset_urls), cabecera->suma_largos);
+    if (!mapeado || !indice || !documentos) {
+        perror("[INDICE_DISCO] Fallo la memoria para abrir el indice");
+        free(mapeado);
+        free(indice);
+        destruir_tabla_documentos(documentos);
+        soltar_archivo_en_memoria(base, tamanio, leido_en_memoria);
+        return NULL;
+    }
+    mapeado->base = base;
+    mapeado->tamanio = tamanio;
+    mapeado->cabecera = cabecera;
+    mapeado->terminos = (const TerminoMapeado*)(base + cabecera->offset_terminos);
+    mapeado->tabla_hash = (const uint32_t*)(base + cabecera->offset_tabla);
+    mapeado->leido_en_memoria = leido_en_memoria;
+
+    // Sin "entradas" ni tablas propias: el indice solo responde busquedas sobre el archivo.
+    indice->cantidad = (size_t)cabecera->num_terminos;
+    indice->documentos = documentos;
+    indice->mapeado = mapeado;
+    indice->identidad = nueva_identidad_indice();
+
+    printf("[INDICE_DISCO] Indice abierto desde '%s' (%zu terminos, %u documentos, %s).\n",
+           ruta, indice->cantidad, (unsigned)documentos->cantidad, leido_en_memoria ? "leido a memoria" : "mapeado");
+    return indice;
+}
+
+indiceInvertido* leer_indice_en_memoria(const indiceInvertido* indice) {
+    if (!indice || !indice->mapeado) {
+        fprintf(stderr, "[INDICE_DISCO] Error: leer_indice_en_memoria necesita un indice abierto con cargar_indice.\n");
+        return NULL;
+    }
+    const struct IndiceMapeado* mapeado = indice->mapeado;
+    indiceInvertido* copia = crear_indice_silencioso((size_t)mapeado->cabecera->num_terminos + 1);
+    if (!copia) {
+        return NULL;
+    }
+    for (uint32_t id = 0; id < indice->documentos->cantidad; id++) {
+        const char* url = url_documento(indice->documentos, id);
+        uint32_t nuevo_id = registrar_documento(copia->documentos, url, strlen(url));
+        if (nuevo_id == DOC_ID_INVALIDO) {
+            destruir_indice(copia);
+            return NULL;
+        }
+        fijar_largo_documento(copia->documentos, nuevo_id, indice->documentos->largos[id]);
+    }
+
+    // Grande (buffers de un bloque): va en el heap y no en el stack.
+    CursorPosteo* cursor = (CursorPosteo*)malloc(sizeof(CursorPosteo));
+    if (!cursor) {
+        perror("[INDICE_DISCO] Fallo malloc para el cursor de la copia");
+        destruir_indice(copia);
+        return NULL;
+    }
+    bool ok = true;
+    for (uint64_t t = 0; ok && t < mapeado->cabecera->num_terminos; t++) {
+        const TerminoMapeado* registro = &mapeado->terminos[t];
+        if (!registro_en_rango(mapeado, registro)) {
+            fprintf(stderr, "[INDICE_DISCO] Error: El termino %llu del archivo esta fuera de rango.\n", (unsigned long long)t);
+            ok = false;
+            break;
+        }
+        abrir_cursor_comprimido(cursor, mapeado->base + registro->offset_posteo, (size_t)registro->largo_posteo,
+                                registro->cantidad);
+        ListaPosteo lista = LISTA_POSTEO_VACIA;
+        ok = reservar_lista(&lista, registro->cantidad);
+        while (ok && avanzar_bloque(cursor)) {
+            for (uint32_t i = 0; ok && i < cursor->largo; i++) {
+                ok = agregar_posteo(&lista, cursor->doc_ids[i], cursor->frecuencias[i]);
+            }
+        }
+        if (ok && (cursor->corrupto || lista.cantidad != registro->cantidad)) {
+            fprintf(stderr, "[INDICE_DISCO] Error: La lista de '%s' esta corrupta.\n",
+                    (const char*)mapeado->base + registro->offset_palabra);
+            ok = false;
+        }
+        ok = ok && anadir_lista_termino(copia, (const char*)mapeado->base + registro->offset_palabra, &lista);
+        free_list(&lista);
+    }
+    free(cursor);
+    if (!ok) {
+        destruir_indice(copia);
+        return NULL;
+    }
+    return copia;
+}
+
+EscritorIndice* abrir_escritor_indice(const char* ruta, const TablaDocumentos* documentos, FILE* textos,
+                                      uint64_t largo_textos, const uint32_t* hashes, uint64_t num_terminos) {
+    if (!ruta || !documentos || !textos || (num_terminos > 0 && !hashes) || num_terminos >= UINT32_MAX) {
+        fprintf(stderr, "[INDICE_DISCO] Error: Argumentos invalidos en abrir_escritor_indice.\n");
+        return NULL;
+    }
+    EscritorIndice* escritor = (EscritorIndice*)calloc(1, sizeof(EscritorIndice));
+    if (!escritor) {
+        perror("[INDICE_DISCO] Fallo calloc para el escritor del indice");
+        return NULL;
+    }
+    CabeceraIndice* cabecera = &escritor->cabecera;
+    memcpy(cabecera->magia, FORMATO_INDICE_MAGIA, sizeof(FORMATO_INDICE_MAGIA));
+    cabecera->version = FORMATO_INDICE_VERSION;
+    cabecera->num_documentos = documentos->cantidad;
+    cabecera->num_terminos = num_terminos;
+    cabecera->suma_largos = documentos->suma_largos;
+    cabecera->tabla_tamanio = tamanio_tabla_archivo(num_terminos);
+    calcular_secciones_fijas(cabecera);
+    cabecera->offset_posteos = alinear_a_8(cabecera->offset_textos + largo_textos);
+    escritor->documentos = documentos;
+    escritor->offset_posteo = cabecera->offset_posteos;
+    escritor->fin_textos = cabecera->offset_textos + largo_textos;
+    escritor->ruta = strdup(ruta);
+    escritor->ruta_temporal = ruta_temporal_de(ruta);
+    if (!escritor->ruta || !escritor->ruta_temporal) {
+        cerrar_escritor_indice(escritor, false);
+        return NULL;
+    }
+    escritor->registros = fopen(escritor->ruta_temporal, "wb");
+    if (!escritor->registros) {
+        fprintf(stderr, "[INDICE_DISCO] No se pudo crear '%s': %s\n", escritor->ruta_temporal, strerror(errno));
+        cerrar_escritor_indice(escritor, false);
+        return NULL;
+    }
+
+    // Todo lo que va antes de los posteos, salvo los registros de los terminos (se saltan y se llenan despues).
+    uint32_t n = cabecera->num_documentos;
+    uint64_t largo_urls = 0;
+    bool ok = fwrite(cabecera, sizeof(*cabecera), 1, escritor->registros) == 1 &&
+              (n == 0 || fwrite(documentos->largos, sizeof(uint32_t), n, escritor->registros) == n) &&
+              escribir_ceros(escritor->registros, cabecera->offset_urls - (cabecera->offset_largos + (uint64_t)n * sizeof(uint32_t))) &&
+              escribir_offsets_urls_de_archivo(escritor->registros, cabecera, textos, largo_textos, &largo_urls) &&
+              fseek(escritor->registros, (long)cabecera->offset_tabla, SEEK_SET) == 0 &&
+              escribir_tabla_hash(escritor->registros, cabecera, NULL, hashes) &&
+              copiar_textos_de_archivo(escritor->registros, cabecera, textos, largo_textos) &&
+              fflush(escritor->registros) == 0;
+    if (ok) {
+        escritor->posteos = fopen(escritor->ruta_temporal, "r+b");
+        ok = escritor->posteos && fseek(escritor->posteos, (long)cabecera->offset_posteos, SEEK_SET) == 0 &&
+             fseek(escritor->registros, (long)cabecera->offset_terminos, SEEK_SET) == 0;
+    }
+    if (!ok) {
+        fprintf(stderr, "[INDICE_DISCO] Error preparando el indice en '%s'.\n", escritor->ruta_temporal);
+        cerrar_escritor_indice(escritor, false);
+        return NULL;
+    }
+    escritor->offset_palabra = cabecera->offset_textos + largo_urls;
+    return escritor;
+}
+
+bool escribir_termino_indice(EscritorIndice* escritor, const char* palabra, const ListaPosteo* lista) {
+    if (!escritor || escritor->error || !palabra || !lista) return false;
+    size_t largo_palabra = strlen(palabra) + 1;
+    if (escritor->escritos >= escritor->cabecera.num_terminos ||
+        escritor->offset_palabra + largo_palabra > escritor->fin_textos) {
+        fprintf(stderr, "[INDICE_DISCO] Error: '%s' no estaba entre los terminos del escritor.\n", palabra);
+        escritor->error = true;
+        return false;
+    }
+    uint32_t bloques = bloques_de_lista(lista->cantidad);
+    size_t bytes = largo_lista_comprimida(lista);
+    if (bloques > escritor->capacidad_cotas) {
+        float* cotas = (float*)realloc(escritor->cotas, (size_t)bloques * sizeof(float));
+        if (!cotas) {
+            perror("[INDICE_DISCO] Fallo realloc para las cotas de un termino");
+            escritor->error = true;
+            return false;
+        }
+        escritor->cotas = cotas;
+        escritor->capacidad_cotas = bloques;
+    }
+    if (bytes > escritor->capacidad_buffer) {
+        uint8_t* buffer = (uint8_t*)realloc(escritor->buffer, bytes);
+        if (!buffer) {
+            perror("[INDICE_DISCO] Fallo realloc para el buffer de compresion de posteos");
+            escritor->error = true;
+            return false;
+        }
+        escritor->buffer = buffer;
+        escritor->capacidad_buffer = bytes;
+    }
+
+    TerminoMapeado registro;
+    registro.hash = hash_termino(palabra);
+    registro.cantidad = lista->cantidad;
+    registro.offset_palabra = escritor->offset_palabra;
+    registro.offset_posteo = escritor->offset_posteo;
+    registro.cota_bm25 = calcular_cotas_bloques_bm25(lista, escritor->documentos, escritor->cotas);
+    registro.largo_posteo = comprimir_lista(lista, escritor->cotas, escritor->buffer);
+    registro.relleno = 0;
+    if (registro.largo_posteo != bytes || (bytes > 0 && fwrite(escritor->buffer, 1, bytes, escritor->posteos) != bytes) ||
+        fwrite(&registro, sizeof(registro), 1, escritor->registros) != 1) {
+        escritor->error = true;
+        return false;
+    }
+    escritor->offset_palabra += largo_palabra;
+    escritor->offset_posteo += bytes;
+    escritor->escritos++;
+    return true;
+}
+
+bool cerrar_escritor_indice(EscritorIndice* escritor, bool completo) {
+    if (!escritor) return false;
+    CabeceraIndice* cabecera = &escritor->cabecera;
+    bool ok = completo && !escritor->error && escritor->registros && escritor->posteos &&
+              escritor->escritos == cabecera->num_terminos && escritor->offset_palabra == escritor->fin_textos;
+    if (completo && !ok) {
+        fprintf(stderr, "[INDICE_DISCO] Error: El indice de '%s' quedo incompleto (%llu de %llu terminos).\n",
+                escritor->ruta, (unsigned long long)escritor->escritos, (unsigned long long)cabecera->num_terminos);
+    }
+    cabecera->tamanio_total = escritor->offset_posteo;
+    // Los posteos se cierran primero: la cabecera completa es lo ultimo que se escribe.
+    if (escritor->posteos && fclose(escritor->posteos) != 0) ok = false;
+    if (escritor->registros) {
+        ok = ok && fseek(escritor->registros, 0, SEEK_SET) == 0 &&
+             fwrite(cabecera, sizeof(*cabecera), 1, escritor->registros) == 1;
+        if (fclose(escritor->registros) != 0) ok = false;
+    }
+    if (ok && rename(escritor->ruta_temporal, escritor->ruta) != 0) {
+        fprintf(stderr, "[INDICE_DISCO] No se pudo renombrar '%s' a '%s': %s\n", escritor->ruta_temporal, escritor->ruta,
+                strerror(errno));
+        ok = false;
+    }
+    if (ok) {
+        printf("[INDICE_DISCO] Indice guardado en '%s' (%llu terminos, %u documentos, %llu bytes).\n", escritor->ruta,
+               (unsigned long long)cabecera->num_terminos, (unsigned)cabecera->num_documentos,
+               (unsigned long long)cabecera->tamanio_total);
+    } else if (escritor->ruta_temporal) {
+        remove(escritor->ruta_temporal);
+    }
+    free(escritor->ruta);
+    free(escritor->ruta_temporal);
+    free(escritor->buffer);
+    free(escritor->cotas);
+    free(escritor);
+    return ok;
+}
+
+bool buscar_cursor_mapeado(const struct IndiceMapeado* mapeado, const char* palabra, uint32_t hash, CursorPosteo* cursor) {
+    if (!mapeado || !palabra || !cursor) {
+        return false;
+    }
+    const CabeceraIndice* cabecera = mapeado->cabecera;
+    uint64_t mascara = cabecera->tabla_tamanio - 1;
+    uint64_t i = hash & mascara;
+    for (uint64_t sondeos = 0; sondeos < cabecera->tabla_tamanio && mapeado->tabla_hash[i] != 0; sondeos++) {
+        uint32_t slot = mapeado->tabla_hash[i];
+        i = (i + 1) & mascara;
+        if (slot > cabecera->num_terminos) {
+            return false; // Archivo corrupto.
+        }
+        const TerminoMapeado* registro = &mapeado->terminos[slot - 1];
+        if (registro->hash != hash || !registro_en_rango(mapeado, registro) ||
+            strcmp((const char*)mapeado->base + registro->offset_palabra, palabra) != 0) {
+            continue;
+        }
+        // El cursor lee la lista comprimida directo del archivo, bloque a bloque.
+        abrir_cursor_comprimido(cursor, mapeado->base + registro->offset_posteo, (size_t)registro->largo_posteo,
+                                registro->cantidad);
+        fijar_cotas_cursor(cursor, registro->cota_bm25, NULL);
+        return true;
+    }
+    return false;
+}
+
+void cerrar_indice_mapeado(struct IndiceMapeado* mapeado) {
+    if (!mapeado) return;
+    soltar_archivo_en_memoria(mapeado->base, mapeado->tamanio, mapeado->leido_en_memoria);
+    free(mapeado);
+}
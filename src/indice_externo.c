@@ -0,0 +1,753 @@
+#include "includes/indice_externo.h"
+#include "includes/indice_disco.h"
+#include "includes/inverted_index.h"
+#include "includes/documentos.h"
+#include "includes/list.h"
+#include "includes/parser.h"
+#include "includes/lector_lineas.h"
+#include "includes/posteo_comprimido.h"
+#include "includes/medicion.h"
+#include "includes/registro.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>     // Para offsetof
+#include <errno.h>
+#include <time.h>
+
+#define MAGIA_CORRIDA "PEDDRUN"
+#define LARGO_MAGIA_CORRIDA 8
+// Buffer de cada archivo de corrida que se lee en una fusion (sale del presupuesto, entre estos limites).
+#define BUFFER_LECTURA_MINIMO (16u << 10)
+#define BUFFER_LECTURA_MAXIMO (1u << 20)
+// Bytes VByte que se juntan antes de cada fwrite al escribir una corrida.
+#define BUFFER_VBYTES 4096
+
+typedef struct {
+    char magia[LARGO_MAGIA_CORRIDA];
+    uint64_t num_terminos;
+} CabeceraCorrida;
+
+// Lo que va antes de cada palabra en el vocabulario de una corrida.
+typedef struct {
+    uint32_t largo_palabra;
+    uint32_t cantidad;       // Documentos de la lista.
+    uint64_t bytes_posteo;   // Bytes de la lista en el archivo de posteos.
+} TerminoCorrida;
+
+typedef struct {
+    FILE* vocabulario;
+    FILE* posteos;
+    uint64_t num_terminos;
+    uint64_t bytes_posteos;  // Bytes que ya se mandaron al archivo de posteos (o al buffer).
+    size_t usado;
+    uint8_t buffer[BUFFER_VBYTES];
+} EscritorCorrida;
+
+// Una corrida abierta para fusionarla: expone su termino actual.
+typedef struct {
+    FILE* vocabulario;
+    FILE* posteos;               // NULL si solo se recorre el vocabulario.
+    char* buffer_vocabulario;    // Buffers de los FILE* (setvbuf).
+    char* buffer_posteos;
+    uint32_t orden;              // Posicion de la corrida en la coleccion: desempata las palabras iguales.
+    uint64_t restantes;          // Terminos que faltan leer del vocabulario.
+    char* palabra;               // Termino actual, terminado en '\0'.
+    size_t capacidad_palabra;
+    TerminoCorrida termino;
+    bool error;
+} LectorCorrida;
+
+// Estado de una construccion por corridas.
+typedef struct {
+    const char* ruta_indice;
+    size_t memoria_bytes;
+    uint32_t* largos;               // Largo de cada documento ya volcado a una corrida.
+    uint32_t cantidad_documentos;
+    uint32_t capacidad_largos;
+    uint64_t suma_largos;
+    FILE* textos;                   // URLs de los documentos volcados (y despues las palabras del indice).
+    char* ruta_textos;
+    uint64_t largo_textos;
+    uint32_t* corridas;             // Numero de cada corrida viva, en orden de documentos.
+    size_t num_corridas;
+    size_t capacidad_corridas;
+    uint32_t proximo_numero;
+    uint32_t fusiones_intermedias;
+} ConstruccionExterna;
+
+// --- Funciones Estáticas (rutas) ---
+
+static double segundos_ahora(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// "<ruta_indice><sufijo>" en memoria nueva (NULL si falla la memoria).
+static char* ruta_con_sufijo(const char* ruta_indice, const char* sufijo) {
+    size_t largo = strlen(ruta_indice) + strlen(sufijo) + 1;
+    char* ruta = (char*)malloc(largo);
+    if (!ruta) {
+        perror("[INDICE_EXTERNO] Fallo malloc para la ruta de un archivo temporal");
+        return NULL;
+    }
+    snprintf(ruta, largo, "%s%s", ruta_indice, sufijo);
+    return ruta;
+}
+
+static char* ruta_de_corrida(const char* ruta_indice, uint32_t numero, const char* extension) {
+    char sufijo[32];
+    snprintf(sufijo, sizeof(sufijo), ".corrida%u.%s", (unsigned)numero, extension);
+    return ruta_con_sufijo(ruta_indice, sufijo);
+}
+
+static FILE* abrir_archivo_de_corrida(const char* ruta_indice, uint32_t numero, const char* extension, const char* modo) {
+    char* ruta = ruta_de_corrida(ruta_indice, numero, extension);
+    if (!ruta) return NULL;
+    FILE* archivo = fopen(ruta, modo);
+    if (!archivo) {
+        fprintf(stderr, "[INDICE_EXTERNO] No se pudo abrir '%s': %s\n", ruta, strerror(errno));
+    }
+    free(ruta);
+    return archivo;
+}
+
+static void borrar_corrida(const char* ruta_indice, uint32_t numero) {
+    const char* extensiones[] = { "voc", "pos" };
+    for (size_t i = 0; i < 2; i++) {
+        char* ruta = ruta_de_corrida(ruta_indice, numero, extensiones[i]);
+        if (ruta) remove(ruta);
+        free(ruta);
+    }
+}
+
+// --- Funciones Estáticas (escritura de corridas) ---
+
+static bool abrir_escritor_corrida(EscritorCorrida* escritor, const char* ruta_indice, uint32_t numero) {
+    memset(escritor, 0, offsetof(EscritorCorrida, buffer));
+    escritor->vocabulario = abrir_archivo_de_corrida(ruta_indice, numero, "voc", "wb");
+    escritor->posteos = escritor->vocabulario ? abrir_archivo_de_corrida(ruta_indice, numero, "pos", "wb") : NULL;
+    CabeceraCorrida cabecera;
+    memset(&cabecera, 0, sizeof(cabecera)); // El numero de terminos se escribe al cerrar.
+    return escritor->posteos && fwrite(&cabecera, sizeof(cabecera), 1, escritor->vocabulario) == 1;
+}
+
+static bool vaciar_buffer_corrida(EscritorCorrida* escritor) {
+    bool ok = escritor->usado == 0 || fwrite(escritor->buffer, 1, escritor->usado, escritor->posteos) == escritor->usado;
+    escritor->usado = 0;
+    return ok;
+}
+
+static bool escribir_vbyte_corrida(EscritorCorrida* escritor, uint32_t valor) {
+    if (escritor->usado + MAX_BYTES_VBYTE > BUFFER_VBYTES && !vaciar_buffer_corrida(escritor)) return false;
+    uint8_t* fin = escribir_vbyte(escritor->buffer + escritor->usado, valor);
+    size_t bytes = (size_t)(fin - (escritor->buffer + escritor->usado));
+    escritor->usado += bytes;
+    escritor->bytes_posteos += bytes;
+    return true;
+}
+
+// Agrega un termino (los terminos deben llegar en orden de strcmp). 'base' se suma a cada doc_id.
+static bool escribir_termino_corrida(EscritorCorrida* escritor, const char* palabra, const ListaPosteo* lista, uint32_t base) {
+    uint64_t inicio = escritor->bytes_posteos;
+    uint32_t anterior = 0;
+    for (uint32_t i = 0; i < lista->cantidad; i++) {
+        uint32_t doc_id = base + lista->doc_ids[i];
+        if (!escribir_vbyte_corrida(escritor, doc_id - anterior)) return false;
+        anterior = doc_id;
+    }
+    for (uint32_t i = 0; i < lista->cantidad; i++) {
+        if (!escribir_vbyte_corrida(escritor, lista->frecuencias[i])) return false;
+    }
+    TerminoCorrida termino;
+    termino.largo_palabra = (uint32_t)strlen(palabra);
+    termino.cantidad = lista->cantidad;
+    termino.bytes_posteo = escritor->bytes_posteos - inicio;
+    escritor->num_terminos++;
+    return fwrite(&termino, sizeof(termino), 1, escritor->vocabulario) == 1 &&
+           fwrite(palabra, 1, termino.largo_palabra, escritor->vocabulario) == termino.largo_palabra;
+}
+
+// Escribe la cabecera y cierra los archivos. Devuelve false si algo fallo (o si ya venia 'ok' en false).
+static bool cerrar_escritor_corrida(EscritorCorrida* escritor, bool ok) {
+    if (escritor->posteos) {
+        ok = vaciar_buffer_corrida(escritor) && ok;
+        if (fclose(escritor->posteos) != 0) ok = false;
+    }
+    if (escritor->vocabulario) {
+        CabeceraCorrida cabecera;
+        memset(&cabecera, 0, sizeof(cabecera));
+        memcpy(cabecera.magia, MAGIA_CORRIDA, sizeof(MAGIA_CORRIDA));
+        cabecera.num_terminos = escritor->num_terminos;
+        ok = ok && fseek(escritor->vocabulario, 0, SEEK_SET) == 0 &&
+             fwrite(&cabecera, sizeof(cabecera), 1, escritor->vocabulario) == 1;
+        if (fclose(escritor->vocabulario) != 0) ok = false;
+    }
+    escritor->vocabulario = NULL;
+    escritor->posteos = NULL;
+    return ok;
+}
+
+// --- Funciones Estáticas (lectura de corridas) ---
+
+// Carga el siguiente termino del vocabulario. false al terminar o si hay un error ('error' lo dice).
+static bool avanzar_lector_corrida(LectorCorrida* lector) {
+    if (lector->error || lector->restantes == 0) return false;
+    if (fread(&lector->termino, sizeof(lector->termino), 1, lector->vocabulario) != 1) {
+        lector->error = true;
+        return false;
+    }
+    size_t largo = lector->termino.largo_palabra;
+    if (largo + 1 > lector->capacidad_palabra) {
+        char* nueva = (char*)realloc(lector->palabra, largo + 1);
+        if (!nueva) {
+            perror("[INDICE_EXTERNO] Fallo realloc para una palabra de una corrida");
+            lector->error = true;
+            return false;
+        }
+        lector->palabra = nueva;
+        lector->capacidad_palabra = largo + 1;
+    }
+    if (fread(lector->palabra, 1, largo, lector->vocabulario) != largo) {
+        lector->error = true;
+        return false;
+    }
+    lector->palabra[largo] = '\0';
+    lector->restantes--;
+    return true;
+}
+
+static FILE* abrir_con_buffer(const char* ruta_indice, uint32_t numero, const char* extension, char** buffer,
+                              size_t bytes_buffer) {
+    FILE* archivo = abrir_archivo_de_corrida(ruta_indice, numero, extension, "rb");
+    *buffer = archivo ? (char*)malloc(bytes_buffer) : NULL;
+    if (*buffer) setvbuf(archivo, *buffer, _IOFBF, bytes_buffer);
+    return archivo;
+}
+
+// Abre una corrida y carga su primer termino. Devuelve false solo si hay un error
+// (una corrida sin terminos queda abierta con 'restantes' en 0).
+static bool abrir_lector_corrida(LectorCorrida* lector, const char* ruta_indice, uint32_t numero, uint32_t orden,
+                                 size_t bytes_buffer, bool con_posteos) {
+    memset(lector, 0, sizeof(*lector));
+    lector->orden = orden;
+    lector->vocabulario = abrir_con_buffer(ruta_indice, numero, "voc", &lector->buffer_vocabulario, bytes_buffer);
+    if (!lector->vocabulario) return false;
+    if (con_posteos) {
+        lector->posteos = abrir_con_buffer(ruta_indice, numero, "pos", &lector->buffer_posteos, bytes_buffer);
+        if (!lector->posteos) return false;
+    }
+    CabeceraCorrida cabecera;
+    if (fread(&cabecera, sizeof(cabecera), 1, lector->vocabulario) != 1 ||
+        memcmp(cabecera.magia, MAGIA_CORRIDA, sizeof(MAGIA_CORRIDA)) != 0) {
+        fprintf(stderr, "[INDICE_EXTERNO] Error: La corrida %u esta danada.\n", (unsigned)numero);
+        return false;
+    }
+    lector->restantes = cabecera.num_terminos;
+    return lector->restantes == 0 || avanzar_lector_corrida(lector);
+}
+
+static void cerrar_lector_corrida(LectorCorrida* lector) {
+    if (lector->vocabulario) fclose(lector->vocabulario);
+    if (lector->posteos) fclose(lector->posteos);
+    free(lector->buffer_vocabulario);
+    free(lector->buffer_posteos);
+    free(lector->palabra);
+    memset(lector, 0, sizeof(*lector));
+}
+
+// Agrega a 'lista' (con lugar ya reservado) la lista del termino actual de la corrida.
+// Sus doc_id tienen que ser mayores que los que ya hay en 'lista'.
+static bool leer_posteos_corrida(LectorCorrida* lector, ListaPosteo* lista, uint8_t** buffer, size_t* capacidad) {
+    uint64_t bytes = lector->termino.bytes_posteo;
+    uint32_t cantidad = lector->termino.cantidad;
+    if (bytes > *capacidad) {
+        uint8_t* nuevo = (uint8_t*)realloc(*buffer, (size_t)bytes);
+        if (!nuevo) {
+            perror("[INDICE_EXTERNO] Fallo realloc para los posteos de una corrida");
+            return false;
+        }
+        *buffer = nuevo;
+        *capacidad = (size_t)bytes;
+    }
+    if (bytes > 0 && fread(*buffer, 1, (size_t)bytes, lector->posteos) != bytes) {
+        lector->error = true;
+        return false;
+    }
+    uint32_t* docs = lista->doc_ids + lista->cantidad;
+    const uint8_t* fin = *buffer + bytes;
+    const uint8_t* p = leer_vbytes(*buffer, fin, docs, cantidad);
+    p = p ? leer_vbytes(p, fin, lista->frecuencias + lista->cantidad, cantidad) : NULL;
+    if (p != fin) {
+        fprintf(stderr, "[INDICE_EXTERNO] Error: Los posteos de '%s' en una corrida estan danados.\n", lector->palabra);
+        return false;
+    }
+    uint32_t anterior = 0;
+    for (uint32_t i = 0; i < cantidad; i++) {
+        docs[i] += anterior;
+        anterior = docs[i];
+    }
+    if (cantidad > 0 && lista->cantidad > 0 && docs[0] <= lista->doc_ids[lista->cantidad - 1]) {
+        fprintf(stderr, "[INDICE_EXTERNO] Error: Las corridas de '%s' no vienen en orden de documentos.\n", lector->palabra);
+        return false;
+    }
+    lista->cantidad += cantidad;
+    return true;
+}
+
+// --- Funciones Estáticas (fusion k-way) ---
+
+// Orden del heap: por palabra y, entre palabras iguales, por orden de la corrida (asi las listas se
+// juntan en orden de doc_id).
+static bool va_antes(const LectorCorrida* a, const LectorCorrida* b) {
+    int comparacion = strcmp(a->palabra, b->palabra);
+    return comparacion < 0 || (comparacion == 0 && a->orden < b->orden);
+}
+
+static void hundir_en_heap(LectorCorrida** heap, size_t cantidad, size_t i) {
+    while (true) {
+        size_t menor = i, izquierdo = 2 * i + 1, derecho = 2 * i + 2;
+        if (izquierdo < cantidad && va_antes(heap[izquierdo], heap[menor])) menor = izquierdo;
+        if (derecho < cantidad && va_antes(heap[derecho], heap[menor])) menor = derecho;
+        if (menor == i) return;
+        LectorCorrida* temporal = heap[i];
+        heap[i] = heap[menor];
+        heap[menor] = temporal;
+        i = menor;
+    }
+}
+
+static void subir_en_heap(LectorCorrida** heap, size_t i) {
+    while (i > 0 && va_antes(heap[i], heap[(i - 1) / 2])) {
+        LectorCorrida* temporal = heap[i];
+        heap[i] = heap[(i - 1) / 2];
+        heap[(i - 1) / 2] = temporal;
+        i = (i - 1) / 2;
+    }
+}
+
+// Una fusion de corridas: el heap tiene las que todavia tienen terminos.
+typedef struct {
+    LectorCorrida* lectores;
+    LectorCorrida** heap;
+    size_t en_heap;
+    size_t cantidad;
+    LectorCorrida** grupo;       // Corridas con la palabra actual, en orden de coleccion.
+    size_t en_grupo;
+    ListaPosteo lista;           // Lista de la palabra actual (con posteos).
+    uint8_t* buffer;             // Bytes de los posteos leidos de una corrida.
+    size_t capacidad_buffer;
+} FusionCorridas;
+
+static void cerrar_fusion(FusionCorridas* fusion) {
+    for (size_t i = 0; i < fusion->cantidad; i++) {
+        cerrar_lector_corrida(&fusion->lectores[i]);
+    }
+    free(fusion->lectores);
+    free(fusion->heap);
+    free(fusion->grupo);
+    free(fusion->buffer);
+    free_list(&fusion->lista);
+    memset(fusion, 0, sizeof(*fusion));
+}
+
+static bool abrir_fusion(FusionCorridas* fusion, const ConstruccionExterna* construccion, const uint32_t* numeros,
+                         size_t cantidad, bool con_posteos) {
+    memset(fusion, 0, sizeof(*fusion));
+    fusion->lectores = (LectorCorrida*)calloc(cantidad > 0 ? cantidad : 1, sizeof(LectorCorrida));
+    fusion->heap = (LectorCorrida**)malloc((cantidad > 0 ? cantidad : 1) * sizeof(LectorCorrida*));
+    fusion->grupo = (LectorCorrida**)malloc((cantidad > 0 ? cantidad : 1) * sizeof(LectorCorrida*));
+    if (!fusion->lectores || !fusion->heap || !fusion->grupo) {
+        perror("[INDICE_EXTERNO] Fallo la memoria para fusionar las corridas");
+        cerrar_fusion(fusion);
+        return false;
+    }
+    size_t bytes_buffer = construccion->memoria_bytes / (4 * (cantidad > 0 ? cantidad : 1));
+    if (bytes_buffer < BUFFER_LECTURA_MINIMO) bytes_buffer = BUFFER_LECTURA_MINIMO;
+    if (bytes_buffer > BUFFER_LECTURA_MAXIMO) bytes_buffer = BUFFER_LECTURA_MAXIMO;
+    for (size_t i = 0; i < cantidad; i++) {
+        fusion->cantidad = i + 1;
+        LectorCorrida* lector = &fusion->lectores[i];
+        if (!abrir_lector_corrida(lector, construccion->ruta_indice, numeros[i], (uint32_t)i, bytes_buffer, con_posteos)) {
+            cerrar_fusion(fusion);
+            return false;
+        }
+        if (lector->palabra) {
+            fusion->heap[fusion->en_heap] = lector;
+            subir_en_heap(fusion->heap, fusion->en_heap++);
+        }
+    }
+    return true;
+}
+
+// Vuelve a poner en el heap las corridas del grupo anterior (con su termino siguiente) y saca las
+// de la proxima palabra. Si 'con_posteos', deja en fusion->lista la lista completa de esa palabra.
+// Devuelve false cuando no quedan palabras; '*error' dice si fue por un error.
+static bool siguiente_palabra_fusion(FusionCorridas* fusion, bool con_posteos, bool* error) {
+    *error = false;
+    for (size_t i = 0; i < fusion->en_grupo; i++) {
+        LectorCorrida* lector = fusion->grupo[i];
+        if (avanzar_lector_corrida(lector)) {
+            fusion->heap[fusion->en_heap] = lector;
+            subir_en_heap(fusion->heap, fusion->en_heap++);
+        } else if (lector->error) {
+            fprintf(stderr, "[INDICE_EXTERNO] Error leyendo el vocabulario de una corrida.\n");
+            *error = true;
+            return false;
+        }
+    }
+    fusion->en_grupo = 0;
+    if (fusion->en_heap == 0) return false;
+
+    const char* palabra = fusion->heap[0]->palabra;
+    uint64_t total = 0;
+    do {
+        LectorCorrida* menor = fusion->heap[0];
+        fusion->heap[0] = fusion->heap[--fusion->en_heap];
+        hundir_en_heap(fusion->heap, fusion->en_heap, 0);
+        fusion->grupo[fusion->en_grupo++] = menor;
+        total += menor->termino.cantidad;
+    } while (fusion->en_heap > 0 && strcmp(fusion->heap[0]->palabra, palabra) == 0);
+    if (!con_posteos) return true;
+
+    fusion->lista.cantidad = 0;
+    if (total > UINT32_MAX || !reservar_lista(&fusion->lista, (size_t)total)) {
+        fprintf(stderr, "[INDICE_EXTERNO] No hay memoria para la lista de '%s' (%llu documentos).\n",
+                palabra, (unsigned long long)total);
+        *error = true;
+        return false;
+    }
+    for (size_t i = 0; i < fusion->en_grupo; i++) {
+        if (!leer_posteos_corrida(fusion->grupo[i], &fusion->lista, &fusion->buffer, &fusion->capacidad_buffer)) {
+            *error = true;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Fusiona las corridas 'numeros' (consecutivas en la coleccion) en una corrida nueva y las borra.
+static bool fusionar_en_corrida(ConstruccionExterna* construccion, const uint32_t* numeros, size_t cantidad,
+                                uint32_t numero_salida) {
+    FusionCorridas fusion;
+    EscritorCorrida* escritor = (EscritorCorrida*)malloc(sizeof(EscritorCorrida));
+    if (!escritor) {
+        perror("[INDICE_EXTERNO] Fallo malloc para el escritor de una corrida");
+        return false;
+    }
+    if (!abrir_fusion(&fusion, construccion, numeros, cantidad, true)) {
+        free(escritor);
+        return false;
+    }
+    bool ok = abrir_escritor_corrida(escritor, construccion->ruta_indice, numero_salida);
+    bool error = false;
+    while (ok && siguiente_palabra_fusion(&fusion, true, &error)) {
+        ok = escribir_termino_corrida(escritor, fusion.grupo[0]->palabra, &fusion.lista, 0);
+    }
+    ok = cerrar_escritor_corrida(escritor, ok && !error);
+    cerrar_fusion(&fusion);
+    free(escritor);
+    if (!ok) {
+        borrar_corrida(construccion->ruta_indice, numero_salida);
+        return false;
+    }
+    for (size_t i = 0; i < cantidad; i++) {
+        borrar_corrida(construccion->ruta_indice, numeros[i]);
+    }
+    construccion->fusiones_intermedias++;
+    return true;
+}
+
+// Junta las corridas de a CORRIDAS_POR_FUSION (vecinas, para no desordenar los documentos) hasta que
+// quepan todas en la fusion final.
+static bool reducir_corridas(ConstruccionExterna* construccion) {
+    while (construccion->num_corridas > CORRIDAS_POR_FUSION) {
+        size_t quedan = 0;
+        for (size_t inicio = 0; inicio < construccion->num_corridas; inicio += CORRIDAS_POR_FUSION) {
+            size_t cantidad = construccion->num_corridas - inicio;
+            if (cantidad > CORRIDAS_POR_FUSION) cantidad = CORRIDAS_POR_FUSION;
+            uint32_t numero = construccion->corridas[inicio];
+            if (cantidad > 1) {
+                numero = construccion->proximo_numero++;
+                MEDIR_DESDE(marca);
+                bool fusionada = fusionar_en_corrida(construccion, construccion->corridas + inicio, cantidad, numero);
+                MEDIR_FASE(FASE_FUSIONAR, marca);
+                if (!fusionada) return false;
+            }
+            // Las corridas de este grupo ya no se usan: su lugar sirve para la nueva.
+            construccion->corridas[quedan++] = numero;
+        }
+        construccion->num_corridas = quedan;
+        REGISTRAR(REGISTRO_INFO, "[INDICE_EXTERNO] Corridas fusionadas de a %d: quedan %zu.\n", CORRIDAS_POR_FUSION,
+                  construccion->num_corridas);
+    }
+    return true;
+}
+
+// Ultima fusion: una pasada por los vocabularios para saber cuantos terminos hay (y dejar sus palabras en
+// 'textos', despues de las URLs) y otra que escribe cada lista directo al archivo de indice.
+static bool escribir_indice_final(ConstruccionExterna* construccion) {
+    FusionCorridas fusion;
+    if (!abrir_fusion(&fusion, construccion, construccion->corridas, construccion->num_corridas, false)) return false;
+    uint32_t* hashes = NULL;
+    size_t num_terminos = 0, capacidad_hashes = 0;
+    bool ok = true, error = false;
+    while (ok && siguiente_palabra_fusion(&fusion, false, &error)) {
+        const char* palabra = fusion.grupo[0]->palabra;
+        if (num_terminos == capacidad_hashes) {
+            size_t nueva_capacidad = capacidad_hashes ? capacidad_hashes * 2 : 1024;
+            uint32_t* nuevos = (uint32_t*)realloc(hashes, nueva_capacidad * sizeof(uint32_t));
+            if (!nuevos) {
+                perror("[INDICE_EXTERNO] Fallo realloc para los hashes del vocabulario");
+                ok = false;
+                break;
+            }
+            hashes = nuevos;
+            capacidad_hashes = nueva_capacidad;
+        }
+        hashes[num_terminos++] = hash_termino(palabra);
+        size_t largo = strlen(palabra) + 1;
+        ok = fwrite(palabra, 1, largo, construccion->textos) == largo;
+        construccion->largo_textos += largo;
+    }
+    cerrar_fusion(&fusion);
+    ok = ok && !error && fflush(construccion->textos) == 0;
+
+    // Una tabla de documentos sobre los largos juntados: es todo lo que necesitan las cotas BM25.
+    TablaDocumentos documentos;
+    memset(&documentos, 0, sizeof(documentos));
+    documentos.largos = construccion->largos;
+    documentos.cantidad = construccion->cantidad_documentos;
+    documentos.capacidad = construccion->cantidad_documentos;
+    documentos.suma_largos = construccion->suma_largos;
+    EscritorIndice* escritor = ok ? abrir_escritor_indice(construccion->ruta_indice, &documentos, construccion->textos,
+                                                          construccion->largo_textos, hashes, num_terminos)
+                                  : NULL;
+    free(hashes);
+    if (!escritor) return false;
+
+    ok = abrir_fusion(&fusion, construccion, construccion->corridas, construccion->num_corridas, true);
+    while (ok && siguiente_palabra_fusion(&fusion, true, &error)) {
+        ok = escribir_termino_indice(escritor, fusion.grupo[0]->palabra, &fusion.lista);
+    }
+    cerrar_fusion(&fusion);
+    return cerrar_escritor_indice(escritor, ok && !error);
+}
+
+// --- Funciones Estáticas (ingesta) ---
+
+static int comparar_entradas_por_palabra(const void* a, const void* b) {
+    const EntradaVocabulario* x = *(const EntradaVocabulario* const*)a;
+    const EntradaVocabulario* y = *(const EntradaVocabulario* const*)b;
+    return strcmp(x->palabra, y->palabra);
+}
+
+// Memoria que cuenta para el presupuesto mientras se llena el parcial: el parcial, el array para ordenar
+// sus terminos al volcarlo, el buffer del lector y los largos de los documentos ya volcados.
+static size_t memoria_en_uso(const ConstruccionExterna* construccion, const indiceInvertido* parcial,
+                             const LectorLineas* lector) {
+    return memoria_indice(parcial) + parcial->cantidad * sizeof(EntradaVocabulario*) + lector->capacidad +
+           (size_t)construccion->capacidad_largos * sizeof(uint32_t);
+}
+
+// Escribe el parcial como una corrida nueva: sus documentos pasan a los largos y a 'textos' y sus
+// terminos, ordenados por palabra, a los archivos de la corrida (con los doc_id de la coleccion).
+static bool volcar_parcial(ConstruccionExterna* construccion, const indiceInvertido* parcial) {
+    const TablaDocumentos* documentos = parcial->documentos;
+    uint32_t base = construccion->cantidad_documentos;
+    if ((uint64_t)base + documentos->cantidad >= DOC_ID_INVALIDO) {
+        fprintf(stderr, "[INDICE_EXTERNO] Error: Demasiados documentos para un indice.\n");
+        return false;
+    }
+    uint32_t necesarios = base + documentos->cantidad;
+    if (necesarios > construccion->capacidad_largos) {
+        uint32_t nueva_capacidad = construccion->capacidad_largos ? construccion->capacidad_largos : 1024;
+        while (nueva_capacidad < necesarios) {
+            nueva_capacidad = nueva_capacidad > UINT32_MAX / 2 ? UINT32_MAX : nueva_capacidad * 2;
+        }
+        uint32_t* nuevos = (uint32_t*)realloc(construccion->largos, (size_t)nueva_capacidad * sizeof(uint32_t));
+        if (!nuevos) {
+            perror("[INDICE_EXTERNO] Fallo realloc para los largos de los documentos");
+            return false;
+        }
+        construccion->largos = nuevos;
+        construccion->capacidad_largos = nueva_capacidad;
+    }
+    for (uint32_t id = 0; id < documentos->cantidad; id++) {
+        const char* url = url_documento(documentos, id);
+        size_t largo = strlen(url) + 1;
+        if (fwrite(url, 1, largo, construccion->textos) != largo) {
+            fprintf(stderr, "[INDICE_EXTERNO] Error escribiendo las URLs en '%s'.\n", construccion->ruta_textos);
+            return false;
+        }
+        construccion->largo_textos += largo;
+        construccion->largos[base + id] = documentos->largos[id];
+        construccion->suma_largos += documentos->largos[id];
+    }
+    construccion->cantidad_documentos = necesarios;
+
+    const EntradaVocabulario** orden =
+        (const EntradaVocabulario**)malloc((parcial->cantidad > 0 ? parcial->cantidad : 1) * sizeof(EntradaVocabulario*));
+    EscritorCorrida* escritor = (EscritorCorrida*)malloc(sizeof(EscritorCorrida));
+    if (construccion->num_corridas == construccion->capacidad_corridas) {
+        size_t nueva_capacidad = construccion->capacidad_corridas ? construccion->capacidad_corridas * 2 : 16;
+        uint32_t* nuevas = (uint32_t*)realloc(construccion->corridas, nueva_capacidad * sizeof(uint32_t));
+        if (nuevas) {
+            construccion->corridas = nuevas;
+            construccion->capacidad_corridas = nueva_capacidad;
+        }
+    }
+    if (!orden || !escritor || construccion->num_corridas == construccion->capacidad_corridas) {
+        perror("[INDICE_EXTERNO] Fallo la memoria para volcar una corrida");
+        free(orden);
+        free(escritor);
+        return false;
+    }
+    for (size_t i = 0; i < parcial->cantidad; i++) {
+        orden[i] = &parcial->entradas[i];
+    }
+    qsort(orden, parcial->cantidad, sizeof(orden[0]), comparar_entradas_por_palabra);
+
+    uint32_t numero = construccion->proximo_numero++;
+    bool ok = abrir_escritor_corrida(escritor, construccion->ruta_indice, numero);
+    for (size_t i = 0; ok && i < parcial->cantidad; i++) {
+        ok = escribir_termino_corrida(escritor, orden[i]->palabra, &orden[i]->lista_documentos, base);
+    }
+    ok = cerrar_escritor_corrida(escritor, ok);
+    free(orden);
+    free(escritor);
+    if (!ok) {
+        fprintf(stderr, "[INDICE_EXTERNO] Error escribiendo la corrida %u.\n", (unsigned)numero);
+        borrar_corrida(construccion->ruta_indice, numero);
+        return false;
+    }
+    construccion->corridas[construccion->num_corridas++] = numero;
+    REGISTRAR(REGISTRO_INFO, "[INDICE_EXTERNO] Corrida %u: %u documentos, %zu terminos (%.1f MB en memoria).\n",
+              (unsigned)numero, (unsigned)documentos->cantidad, parcial->cantidad,
+              (double)memoria_indice(parcial) / (1024.0 * 1024.0));
+    return true;
+}
+
+// Vuelca el parcial (si tiene documentos) y lo cambia por uno vacio.
+static bool renovar_parcial(ConstruccionExterna* construccion, indiceInvertido** parcial) {
+    if ((*parcial)->documentos->cantidad == 0) return true;
+    MEDIR_DESDE(marca);
+    bool ok = volcar_parcial(construccion, *parcial);
+    MEDIR_FASE(FASE_FUSIONAR, marca);
+    destruir_indice(*parcial);
+    *parcial = ok ? crear_indice_silencioso(1024) : NULL;
+    return *parcial != NULL;
+}
+
+// --- Implementación de Funciones Públicas (declaradas en indice_externo.h) ---
+
+bool construir_indice_externo(const char* archivo_documentos, const char* ruta_indice, size_t memoria_bytes) {
+    if (!archivo_documentos || !ruta_indice || memoria_bytes == 0) {
+        fprintf(stderr, "[INDICE_EXTERNO] Error: Argumentos invalidos en construir_indice_externo.\n");
+        return false;
+    }
+    double inicio = segundos_ahora();
+    ConstruccionExterna construccion;
+    memset(&construccion, 0, sizeof(construccion));
+    construccion.ruta_indice = ruta_indice;
+    construccion.memoria_bytes = memoria_bytes;
+    construccion.ruta_textos = ruta_con_sufijo(ruta_indice, ".textos");
+    construccion.textos = construccion.ruta_textos ? fopen(construccion.ruta_textos, "w+b") : NULL;
+    if (!construccion.textos) {
+        if (construccion.ruta_textos) {
+            fprintf(stderr, "[INDICE_EXTERNO] No se pudo crear '%s': %s\n", construccion.ruta_textos, strerror(errno));
+        }
+        free(construccion.ruta_textos);
+        return false;
+    }
+
+    printf("[INDICE_EXTERNO] Indexando '%s' por corridas con un presupuesto de %.1f MB.\n", archivo_documentos,
+           (double)memoria_bytes / (1024.0 * 1024.0));
+    LectorLineas lector;
+    indiceInvertido* parcial = NULL;
+    bool abierto = abrir_lector_lineas(&lector, archivo_documentos);
+    bool ok = abierto;
+    if (!abierto) {
+        fprintf(stderr, "[INDICE_EXTERNO] No se pudo abrir el archivo de documentos '%s'!\n", archivo_documentos);
+    } else {
+        parcial = crear_indice_silencioso(1024);
+        ok = parcial != NULL;
+    }
+
+    char* linea = NULL;
+    size_t largo_linea = 0;
+    long lineas_leidas = 0, lineas_ok = 0, lineas_malas = 0;
+    MEDIR_DESDE(marca);
+    while (ok && siguiente_linea(&lector, &linea, &largo_linea)) {
+        MEDIR_FASE(FASE_LEER, marca);
+        lineas_leidas++;
+        if (lineas_leidas % 100000 == 0) {
+            REGISTRAR(REGISTRO_INFO, "[INDICE_EXTERNO] ... procesando línea %ld ... (%u corrida(s) escritas)\n",
+                      lineas_leidas, (unsigned)construccion.num_corridas);
+        }
+        LineaDocumento partes;
+        bool separada = separar_linea_documento(linea, largo_linea, &partes);
+        MEDIR_FASE(FASE_PARSEAR, marca);
+        if (!separada) {
+            lineas_malas++;
+            continue;
+        }
+        // La linea termina en '\0' y el contenido va hasta su final: se tokeniza ahi mismo.
+        uint32_t doc_id = registrar_documento(parcial->documentos, partes.url, partes.largo_url);
+        if (doc_id == DOC_ID_INVALIDO) {
+            fprintf(stderr, "[INDICE_EXTERNO] No se pudo registrar el documento de la línea %ld. Se salta.\n", lineas_leidas);
+            continue;
+        }
+        fijar_largo_documento(parcial->documentos, doc_id, tokenizar_e_indexar_contenido(partes.contenido, doc_id, parcial));
+        lineas_ok++;
+        if (memoria_en_uso(&construccion, parcial, &lector) >= memoria_bytes) {
+            ok = renovar_parcial(&construccion, &parcial);
+        }
+        MEDIR_REINICIAR(marca);
+    }
+    bool lectura_ok = ok && lector.fin_archivo && !lector.error_lectura;
+    if (ok && !lectura_ok) {
+        fprintf(stderr, "[INDICE_EXTERNO] Hubo un error leyendo el archivo de documentos; no se guarda el indice.\n");
+    }
+    uint64_t bytes_leidos = abierto ? lector.bytes_leidos : 0;
+    if (abierto) cerrar_lector_lineas(&lector);
+    MEDIR_CONTAR(CONTADOR_LINEAS, lineas_leidas);
+    MEDIR_CONTAR(CONTADOR_BYTES_LEIDOS, bytes_leidos);
+    double segundos_lectura = segundos_ahora() - inicio;
+
+    ok = lectura_ok && renovar_parcial(&construccion, &parcial);
+    destruir_indice(parcial);
+    ok = ok && reducir_corridas(&construccion);
+    if (ok) {
+        MEDIR_DESDE(marca_final);
+        ok = escribir_indice_final(&construccion);
+        MEDIR_FASE(FASE_FUSIONAR, marca_final);
+    }
+
+    for (size_t i = 0; i < construccion.num_corridas; i++) {
+        borrar_corrida(ruta_indice, construccion.corridas[i]);
+    }
+    fclose(construccion.textos);
+    remove(construccion.ruta_textos);
+    free(construccion.ruta_textos);
+    free(construccion.corridas);
+    free(construccion.largos);
+
+    if (!abierto) return false;
+    printf("\n[INDICE_EXTERNO] Termino la construccion por corridas de '%s'!\n", archivo_documentos);
+    printf("  Total de lineas leidas: %ld\n", lineas_leidas);
+    printf("  Lineas parseadas y procesadas correctamente: %ld\n", lineas_ok);
+    if (lineas_malas > 0) {
+        printf("  Lineas con formato 'URL || Contenido' no encontrado (saltadas): %ld\n", lineas_malas);
+    }
+    printf("  Corridas escritas: %u (%u fusion(es) intermedias)\n", (unsigned)construccion.proximo_numero -
+           construccion.fusiones_intermedias, (unsigned)construccion.fusiones_intermedias);
+    double megabytes = (double)bytes_leidos / (1024.0 * 1024.0);
+    printf("  Leidos %.1f MB en %.2f s (%.1f MB/s); fusion final en %.2f s\n", megabytes, segundos_lectura,
+           segundos_lectura > 0 ? megabytes / segundos_lectura : 0.0, segundos_ahora() - inicio - segundos_lectura);
+    return ok;
+}
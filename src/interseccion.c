@@ -0,0 +1,308 @@
+#include "includes/interseccion.h"
+
+#include <stdbool.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+// Las versiones vectoriales solo se compilan con GCC/Clang en x86; en otro caso queda solo la escalar.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define INTERSECCION_X86 1
+#include <immintrin.h>
+#endif
+
+// --- Funciones Estáticas (escalares) ---
+
+// Mezcla escalar a partir de a[i] y b[j]; agrega las coincidencias desde pos_a[encontrados].
+static size_t mezcla_escalar_desde(const uint32_t* a, size_t na, const uint32_t* b, size_t nb,
+                                   size_t i, size_t j, uint32_t* pos_a, uint32_t* pos_b, size_t encontrados) {
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) {
+            i++;
+        } else if (b[j] < a[i]) {
+            j++;
+        } else {
+            pos_a[encontrados] = (uint32_t)i;
+            pos_b[encontrados] = (uint32_t)j;
+            encontrados++;
+            i++;
+            j++;
+        }
+    }
+    return encontrados;
+}
+
+// Busqueda exponencial desde 'desde' (saltos 1, 2, 4, ...) y luego binaria, hasta que el rango
+// donde puede estar el primer b[k] >= objetivo tenga a lo mas 'ventana' elementos.
+// Devuelve el inicio de ese rango: b[k] < objetivo para todo desde <= k < inicio.
+static size_t acotar_galope(const uint32_t* b, size_t nb, size_t desde, uint32_t objetivo, size_t ventana) {
+    if (desde >= nb || b[desde] >= objetivo) return desde;
+
+    size_t paso = 1;
+    size_t bajo = desde;            // b[bajo] < objetivo
+    size_t alto = desde + paso;
+    while (alto < nb && b[alto] < objetivo) {
+        bajo = alto;
+        paso <<= 1;
+        alto = desde + paso;
+    }
+    if (alto > nb) alto = nb;
+
+    // Invariante: b[bajo] < objetivo y (alto == nb o b[alto] >= objetivo).
+    while (alto - bajo > ventana) {
+        size_t medio = bajo + (alto - bajo) / 2;
+        if (b[medio] < objetivo) bajo = medio; else alto = medio;
+    }
+    return bajo + 1;
+}
+
+// Primer indice >= desde con b[indice] >= objetivo (o nb si no hay).
+static size_t galopar_hasta(const uint32_t* b, size_t nb, size_t desde, uint32_t objetivo) {
+    return acotar_galope(b, nb, desde, objetivo, 1);
+}
+
+static size_t galope_escalar(const uint32_t* a, size_t na, const uint32_t* b, size_t nb,
+                             uint32_t* pos_a, uint32_t* pos_b) {
+    size_t j = 0, encontrados = 0;
+    for (size_t i = 0; i < na && j < nb; i++) {
+        j = galopar_hasta(b, nb, j, a[i]);
+        if (j < nb && b[j] == a[i]) {
+            pos_a[encontrados] = (uint32_t)i;
+            pos_b[encontrados] = (uint32_t)j;
+            encontrados++;
+            j++;
+        }
+    }
+    return encontrados;
+}
+
+#ifdef INTERSECCION_X86
+// --- Funciones Estáticas (SSE4.2, bloques de 4 IDs) ---
+
+// Mezcla por bloques: compara 4 IDs de 'a' contra los 4 de 'b' en todas sus rotaciones (4 comparaciones)
+// y avanza el bloque con el maximo menor (o ambos si los maximos son iguales).
+__attribute__((target("sse4.2")))
+static size_t mezcla_sse42(const uint32_t* a, size_t na, const uint32_t* b, size_t nb,
+                           uint32_t* pos_a, uint32_t* pos_b) {
+    size_t i = 0, j = 0, encontrados = 0;
+    while (i + 4 <= na && j + 4 <= nb) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + j));
+        // La rotacion r pone b[j + (k + r) % 4] en el carril k.
+        int m0 = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(va, vb)));
+        int m1 = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)))));
+        int m2 = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2)))));
+        int m3 = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)))));
+        int todas = m0 | m1 | m2 | m3;
+        while (todas) {
+            int k = __builtin_ctz((unsigned)todas);
+            int r = ((m0 >> k) & 1) ? 0 : ((m1 >> k) & 1) ? 1 : ((m2 >> k) & 1) ? 2 : 3;
+            pos_a[encontrados] = (uint32_t)(i + k);
+            pos_b[encontrados] = (uint32_t)(j + ((k + r) & 3));
+            encontrados++;
+            todas &= todas - 1;
+        }
+        uint32_t max_a = a[i + 3], max_b = b[j + 3];
+        if (max_a <= max_b) i += 4;
+        if (max_b <= max_a) j += 4;
+    }
+    return mezcla_escalar_desde(a, na, b, nb, i, j, pos_a, pos_b, encontrados);
+}
+
+// Galope que termina con una comparacion de 4 IDs en vez de los ultimos pasos de la busqueda binaria.
+// Las comparaciones de SSE son con signo, por eso se le invierte el bit alto a ambos lados.
+__attribute__((target("sse4.2")))
+static size_t galope_sse42(const uint32_t* a, size_t na, const uint32_t* b, size_t nb,
+                           uint32_t* pos_a, uint32_t* pos_b) {
+    const __m128i signo = _mm_set1_epi32((int)0x80000000u);
+    size_t j = 0, encontrados = 0;
+    for (size_t i = 0; i < na && j < nb; i++) {
+        size_t inicio = acotar_galope(b, nb, j, a[i], 4);
+        if (inicio + 4 <= nb) {
+            __m128i vb = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(b + inicio)), signo);
+            __m128i vt = _mm_xor_si128(_mm_set1_epi32((int)a[i]), signo);
+            int menores = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(vt, vb)));
+            j = inicio + (size_t)__builtin_popcount((unsigned)menores);
+        } else {
+            j = inicio;
+            while (j < nb && b[j] < a[i]) j++;
+        }
+        if (j < nb && b[j] == a[i]) {
+            pos_a[encontrados] = (uint32_t)i;
+            pos_b[encontrados] = (uint32_t)j;
+            encontrados++;
+            j++;
+        }
+    }
+    return encontrados;
+}
+
+// --- Funciones Estáticas (AVX2, bloques de 8 IDs) ---
+
+// Igual que mezcla_sse42 pero con 8 IDs: 4 rotaciones dentro de cada mitad de 128 bits, con 'b' tal cual
+// y con sus mitades intercambiadas (los cruces entre mitades son mas caros que las rotaciones internas).
+__attribute__((target("avx2")))
+static size_t mezcla_avx2(const uint32_t* a, size_t na, const uint32_t* b, size_t nb,
+                          uint32_t* pos_a, uint32_t* pos_b) {
+    size_t i = 0, j = 0, encontrados = 0;
+    while (i + 8 <= na && j + 8 <= nb) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + j));
+        __m256i vs = _mm256_permute2x128_si256(vb, vb, 1);
+        // mascaras[s * 4 + r]: 's' indica mitades intercambiadas y 'r' la rotacion dentro de la mitad.
+        int mascaras[8];
+        mascaras[0] = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(va, vb)));
+        mascaras[1] = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)))));
+        mascaras[2] = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2)))));
+        mascaras[3] = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)))));
+        mascaras[4] = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(va, vs)));
+        mascaras[5] = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vs, _MM_SHUFFLE(0, 3, 2, 1)))));
+        mascaras[6] = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vs, _MM_SHUFFLE(1, 0, 3, 2)))));
+        mascaras[7] = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vs, _MM_SHUFFLE(2, 1, 0, 3)))));
+        int todas = mascaras[0] | mascaras[1] | mascaras[2] | mascaras[3] |
+                    mascaras[4] | mascaras[5] | mascaras[6] | mascaras[7];
+        while (todas) {
+            int k = __builtin_ctz((unsigned)todas);
+            int v = 0;
+            while (!((mascaras[v] >> k) & 1)) v++;
+            int mitad = (k >> 2) ^ (v >> 2);
+            pos_a[encontrados] = (uint32_t)(i + k);
+            pos_b[encontrados] = (uint32_t)(j + mitad * 4 + (((k & 3) + (v & 3)) & 3));
+            encontrados++;
+            todas &= todas - 1;
+        }
+        uint32_t max_a = a[i + 7], max_b = b[j + 7];
+        if (max_a <= max_b) i += 8;
+        if (max_b <= max_a) j += 8;
+    }
+    return mezcla_escalar_desde(a, na, b, nb, i, j, pos_a, pos_b, encontrados);
+}
+
+__attribute__((target("avx2")))
+static size_t galope_avx2(const uint32_t* a, size_t na, const uint32_t* b, size_t nb,
+                          uint32_t* pos_a, uint32_t* pos_b) {
+    const __m256i signo = _mm256_set1_epi32((int)0x80000000u);
+    size_t j = 0, encontrados = 0;
+    for (size_t i = 0; i < na && j < nb; i++) {
+        size_t inicio = acotar_galope(b, nb, j, a[i], 8);
+        if (inicio + 8 <= nb) {
+            __m256i vb = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(b + inicio)), signo);
+            __m256i vt = _mm256_xor_si256(_mm256_set1_epi32((int)a[i]), signo);
+            int menores = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(vt, vb)));
+            j = inicio + (size_t)__builtin_popcount((unsigned)menores);
+        } else {
+            j = inicio;
+            while (j < nb && b[j] < a[i]) j++;
+        }
+        if (j < nb && b[j] == a[i]) {
+            pos_a[encontrados] = (uint32_t)i;
+            pos_b[encontrados] = (uint32_t)j;
+            encontrados++;
+            j++;
+        }
+    }
+    return encontrados;
+}
+#endif // INTERSECCION_X86
+
+// --- Seleccion de la implementacion segun la CPU ---
+
+typedef size_t (*FuncionInterseccion)(const uint32_t*, size_t, const uint32_t*, size_t, uint32_t*, uint32_t*);
+
+// La CPU se mira una sola vez (pthread_once): la primera interseccion puede llegar desde varios
+// hilos a la vez (por ejemplo, los del modo por lotes).
+static pthread_once_t g_deteccion = PTHREAD_ONCE_INIT;
+static _Atomic ImplementacionInterseccion g_implementacion = INTERSECCION_ESCALAR;
+
+bool interseccion_soportada(ImplementacionInterseccion implementacion) {
+    switch (implementacion) {
+        case INTERSECCION_ESCALAR:
+            return true;
+#ifdef INTERSECCION_X86
+        case INTERSECCION_SSE42:
+            return __builtin_cpu_supports("sse4.2");
+        case INTERSECCION_AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+static void elegir_implementacion(void) {
+    ImplementacionInterseccion elegida = INTERSECCION_ESCALAR;
+    if (interseccion_soportada(INTERSECCION_AVX2)) {
+        elegida = INTERSECCION_AVX2;
+    } else if (interseccion_soportada(INTERSECCION_SSE42)) {
+        elegida = INTERSECCION_SSE42;
+    }
+    atomic_store_explicit(&g_implementacion, elegida, memory_order_release);
+}
+
+ImplementacionInterseccion interseccion_implementacion_activa(void) {
+    pthread_once(&g_deteccion, elegir_implementacion);
+    return atomic_load_explicit(&g_implementacion, memory_order_acquire);
+}
+
+bool interseccion_fijar_implementacion(ImplementacionInterseccion implementacion) {
+    if (!interseccion_soportada(implementacion)) {
+        return false;
+    }
+    // Primero la deteccion, asi despues no pisa la implementacion fijada.
+    pthread_once(&g_deteccion, elegir_implementacion);
+    atomic_store_explicit(&g_implementacion, implementacion, memory_order_release);
+    return true;
+}
+
+const char* interseccion_nombre(ImplementacionInterseccion implementacion) {
+    switch (implementacion) {
+        case INTERSECCION_ESCALAR: return "escalar";
+        case INTERSECCION_SSE42:   return "sse4.2";
+        case INTERSECCION_AVX2:    return "avx2";
+        default:                   return "desconocida";
+    }
+}
+
+static FuncionInterseccion funcion_mezcla(ImplementacionInterseccion implementacion) {
+#ifdef INTERSECCION_X86
+    if (implementacion == INTERSECCION_AVX2) return mezcla_avx2;
+    if (implementacion == INTERSECCION_SSE42) return mezcla_sse42;
+#else
+    (void)implementacion;
+#endif
+    return interseccion_mezcla;
+}
+
+static FuncionInterseccion funcion_galope(ImplementacionInterseccion implementacion) {
+#ifdef INTERSECCION_X86
+    if (implementacion == INTERSECCION_AVX2) return galope_avx2;
+    if (implementacion == INTERSECCION_SSE42) return galope_sse42;
+#else
+    (void)implementacion;
+#endif
+    return galope_escalar;
+}
+
+// --- Implementación de Funciones Públicas (declaradas en interseccion.h) ---
+
+size_t interseccion_mezcla(const uint32_t* a, size_t na, const uint32_t* b, size_t nb,
+                           uint32_t* pos_a, uint32_t* pos_b) {
+    return mezcla_escalar_desde(a, na, b, nb, 0, 0, pos_a, pos_b, 0);
+}
+
+size_t interseccion_galope(const uint32_t* a, size_t na, const uint32_t* b, size_t nb,
+                           uint32_t* pos_a, uint32_t* pos_b) {
+    return galope_escalar(a, na, b, nb, pos_a, pos_b);
+}
+
+size_t interseccion_adaptativa(const uint32_t* a, size_t na, const uint32_t* b, size_t nb,
+                               uint32_t* pos_a, uint32_t* pos_b) {
+    if (na == 0 || nb == 0) return 0;
+    ImplementacionInterseccion implementacion = interseccion_implementacion_activa();
+    if (nb / na >= UMBRAL_GALOPE) {
+        return funcion_galope(implementacion)(a, na, b, nb, pos_a, pos_b);
+    }
+    if (na / nb >= UMBRAL_GALOPE) {
+        return funcion_galope(implementacion)(b, nb, a, na, pos_b, pos_a);
+    }
+    return funcion_mezcla(implementacion)(a, na, b, nb, pos_a, pos_b);
+}
@@ -1,11 +1,16 @@
 #include "includes/inverted_index.h"
 #include "includes/list.h"
+#include "includes/interseccion.h"
+#include "includes/indice_disco.h"
+#include "includes/medicion.h"
+#include "includes/registro.h"
 
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <stddef.h> 
 #include <stdbool.h>
+#include <stdatomic.h>
 
 
 #ifndef ssize_t
@@ -13,40 +18,150 @@
 #endif
 
 // --- Funciones Estáticas ---
-static ssize_t buscar_pos_termino(const indiceInvertido* indice, const char* palabra) {
-    if (!indice || !palabra) {
-        return -1;
+
+// Tabla hash del vocabulario: los slots guardan posicion+1 dentro de "entradas"; 0 marca un slot vacio.
+#define SLOT_VACIO 0
+// Entradas que se copian a la tabla nueva en cada llamada a anadir_termino mientras hay migracion.
+// Con 4 por llamada la migracion termina mucho antes de que "entradas" vuelva a llenarse.
+#define PASOS_MIGRACION 4
+
+// FNV-1a de 32 bits: simple y suficiente para palabras cortas.
+static uint32_t hash_palabra(const char* palabra) {
+    uint32_t h = 2166136261u;
+    for (const unsigned char* p = (const unsigned char*)palabra; *p; p++) {
+        h ^= *p;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// Tamanio de tabla (potencia de 2) para que el factor de carga quede en 0.5 o menos.
+static size_t tamanio_tabla_para(size_t capacidad) {
+    size_t tamanio = 16;
+    while (tamanio < capacidad * 2) {
+        tamanio <<= 1;
     }
-    for (size_t i = 0; i < indice->cantidad; i++) {
-        if (indice->entradas[i].palabra && strcmp(indice->entradas[i].palabra, palabra) == 0) {
-            return (ssize_t)i;
+    return tamanio;
+}
+
+static ssize_t buscar_en_tabla(const indiceInvertido* indice, const uint32_t* tabla, size_t tamanio,
+                               const char* palabra, uint32_t hash) {
+    size_t mascara = tamanio - 1;
+    for (size_t i = hash & mascara; tabla[i] != SLOT_VACIO; i = (i + 1) & mascara) {
+        const EntradaVocabulario* entrada = &indice->entradas[tabla[i] - 1];
+        if (entrada->hash == hash && strcmp(entrada->palabra, palabra) == 0) {
+            return (ssize_t)(tabla[i] - 1);
         }
     }
     return -1;
 }
 
+static void insertar_en_tabla(uint32_t* tabla, size_t tamanio, uint32_t hash, size_t pos) {
+    size_t mascara = tamanio - 1;
+    size_t i = hash & mascara;
+    while (tabla[i] != SLOT_VACIO) {
+        i = (i + 1) & mascara;
+    }
+    tabla[i] = (uint32_t)(pos + 1);
+}
+
+// Copia algunas entradas pendientes a la tabla nueva; si ya no quedan, suelta la tabla vieja.
+static void migrar_tabla(indiceInvertido* indice, size_t pasos) {
+    if (!indice->tabla_vieja) return;
+    while (pasos-- > 0 && indice->migracion_siguiente < indice->migracion_limite) {
+        size_t pos = indice->migracion_siguiente++;
+        insertar_en_tabla(indice->tabla_hash, indice->tabla_tamanio, indice->entradas[pos].hash, pos);
+    }
+    if (indice->migracion_siguiente >= indice->migracion_limite) {
+        free(indice->tabla_vieja);
+        indice->tabla_vieja = NULL;
+        indice->tabla_vieja_tamanio = 0;
+    }
+}
+
+static ssize_t buscar_pos_termino(const indiceInvertido* indice, const char* palabra, uint32_t hash) {
+    if (!indice || !palabra) {
+        return -1;
+    }
+    ssize_t pos = buscar_en_tabla(indice, indice->tabla_hash, indice->tabla_tamanio, palabra, hash);
+    if (pos < 0 && indice->tabla_vieja) {
+        // Durante la migracion, las entradas antiguas que aun no se copian solo estan en la tabla vieja.
+        pos = buscar_en_tabla(indice, indice->tabla_vieja, indice->tabla_vieja_tamanio, palabra, hash);
+    }
+    return pos;
+}
+
 static bool aumentar_capacidad(indiceInvertido* indice) {
     if (!indice) return false;
     size_t nueva_capacidad = (indice->capacidad == 0) ? 16 : indice->capacidad * 2; // Empezar con algo si es 0
+    // Si quedo una migracion a medias (no deberia pasar con PASOS_MIGRACION >= 1), se termina antes de empezar otra.
+    migrar_tabla(indice, indice->cantidad);
+
+    size_t nuevo_tamanio_tabla = tamanio_tabla_para(nueva_capacidad);
+    uint32_t* nueva_tabla = (uint32_t*)calloc(nuevo_tamanio_tabla, sizeof(uint32_t));
+    if (!nueva_tabla) {
+        fprintf(stderr, "[INDEX] Error: Fallo al asignar memoria para la nueva tabla hash del vocabulario.\n");
+        return false;
+    }
+    MEDIR_ASIGNACION(nuevo_tamanio_tabla * sizeof(uint32_t));
     EntradaVocabulario* nuevo_array = (EntradaVocabulario*)realloc(indice->entradas, sizeof(EntradaVocabulario) * nueva_capacidad);
     if (!nuevo_array) {
         fprintf(stderr, "[INDEX] Error: Fallo al reasignar memoria para aumentar capacidad del indice.\n");
+        free(nueva_tabla);
         return false;
     }
+    MEDIR_ASIGNACION(sizeof(EntradaVocabulario) * nueva_capacidad);
     for (size_t i = indice->capacidad; i < nueva_capacidad; i++) {
         nuevo_array[i].palabra = NULL;
-        nuevo_array[i].list_documentos_cabeza = NULL;
+        nuevo_array[i].hash = 0;
+        nuevo_array[i].cota_bm25 = COTA_DESCONOCIDA;
+        nuevo_array[i].cotas_bloque = NULL;
+        nuevo_array[i].posiciones = NULL;
+        nuevo_array[i].lista_documentos = LISTA_POSTEO_VACIA;
     }
     indice->entradas = nuevo_array;
     indice->capacidad = nueva_capacidad;
+
+    // La tabla actual pasa a ser la vieja y se va vaciando hacia la nueva de a poco.
+    indice->tabla_vieja = indice->tabla_hash;
+    indice->tabla_vieja_tamanio = indice->tabla_tamanio;
+    indice->tabla_hash = nueva_tabla;
+    indice->tabla_tamanio = nuevo_tamanio_tabla;
+    indice->migracion_siguiente = 0;
+    indice->migracion_limite = indice->cantidad;
     // Descomenta para ver cuándo crece el vocabulario
     // printf("    [INDEX_info] Capacidad del vocabulario aumentada a %zu entradas.\n", nueva_capacidad);
     return true;
 }
 
-// --- Implementación de Funciones Públicas (declaradas en inverted_index.h) ---
+// Crea la entrada para una palabra que no esta en el vocabulario y la registra en la tabla hash.
+// Devuelve su posicion en "entradas" o -1 si falla la memoria.
+static ssize_t agregar_entrada(indiceInvertido* indice, const char* palabra, uint32_t hash) {
+    if (indice->cantidad >= indice->capacidad) {
+        if (!aumentar_capacidad(indice)) {
+            fprintf(stderr, "[INDEX] Error: No se pudo aumentar capacidad para el termino '%s'.\n", palabra);
+            return -1;
+        }
+    }
+    size_t pos = indice->cantidad;
+    indice->entradas[pos].palabra = copiar_texto_en_arena(&indice->textos, palabra, strlen(palabra));
+    if (indice->entradas[pos].palabra == NULL) {
+        fprintf(stderr, "[INDEX] Error: Fallo la copia de la palabra '%s' al vocabulario.\n", palabra);
+        return -1;
+    }
+    indice->entradas[pos].hash = hash;
+    indice->entradas[pos].cota_bm25 = COTA_DESCONOCIDA;
+    indice->entradas[pos].cotas_bloque = NULL;
+    indice->entradas[pos].posiciones = NULL;
+    indice->entradas[pos].lista_documentos = LISTA_POSTEO_VACIA;
+    insertar_en_tabla(indice->tabla_hash, indice->tabla_tamanio, hash, pos);
+    indice->cantidad++;
+    return (ssize_t)pos;
+}
 
-indiceInvertido* crear_indice(size_t capacidad_inicial) {
+static atomic_uint_fast64_t g_identidades_indice = 0;
+
+static indiceInvertido* crear_indice_con_mensajes(size_t capacidad_inicial, bool silencioso) {
     if (capacidad_inicial == 0) {
         capacidad_inicial = 256; // Una capacidad inicial un poco más generosa.
     }
@@ -65,84 +180,557 @@ indiceInvertido* crear_indice(size_t capacidad_inicial) {
     }
     for (size_t i = 0; i < capacidad_inicial; i++) {
         idx->entradas[i].palabra = NULL;
-        idx->entradas[i].list_documentos_cabeza = NULL;
+        idx->entradas[i].hash = 0;
+        idx->entradas[i].cota_bm25 = COTA_DESCONOCIDA;
+        idx->entradas[i].cotas_bloque = NULL;
+        idx->entradas[i].posiciones = NULL;
+        idx->entradas[i].lista_documentos = LISTA_POSTEO_VACIA;
+    }
+    idx->tabla_tamanio = tamanio_tabla_para(capacidad_inicial);
+    idx->tabla_hash = (uint32_t*)calloc(idx->tabla_tamanio, sizeof(uint32_t));
+    if (!idx->tabla_hash) {
+        perror("[INDEX] Fallo calloc para la tabla hash del vocabulario");
+        free(idx->entradas);
+        free(idx);
+        return NULL;
+    }
+    idx->tabla_vieja = NULL;
+    idx->tabla_vieja_tamanio = 0;
+    idx->migracion_siguiente = 0;
+    idx->migracion_limite = 0;
+    idx->largo_promedio_cotas = 0.0;
+    idx->mapeado = NULL;
+    idx->silencioso = silencioso;
+    idx->con_posiciones = false;
+    idx->identidad = nueva_identidad_indice();
+    idx->version = 0;
+    iniciar_arena(&idx->textos, TAMANIO_BLOQUE_TEXTOS);
+    iniciar_pool_posteos(&idx->posteos);
+    idx->documentos = crear_tabla_documentos(capacidad_inicial);
+    if (!idx->documentos) {
+        free(idx->tabla_hash);
+        free(idx->entradas);
+        free(idx);
+        return NULL;
+    }
+    if (!silencioso) {
+        printf("[INDEX_info] Indice creado con capacidad inicial para %zu palabras.\n", capacidad_inicial);
     }
-    printf("[INDEX_info] Indice creado con capacidad inicial para %zu palabras.\n", capacidad_inicial);
     return idx;
 }
 
+// --- Implementación de Funciones Públicas (declaradas en inverted_index.h) ---
+
+indiceInvertido* crear_indice(size_t capacidad_inicial) {
+    return crear_indice_con_mensajes(capacidad_inicial, false);
+}
+
+indiceInvertido* crear_indice_silencioso(size_t capacidad_inicial) {
+    return crear_indice_con_mensajes(capacidad_inicial, true);
+}
+
+uint64_t nueva_identidad_indice(void) {
+    return atomic_fetch_add(&g_identidades_indice, 1) + 1;
+}
+
+uint32_t hash_termino(const char* palabra) {
+    return palabra ? hash_palabra(palabra) : 0;
+}
+
+size_t memoria_indice(const indiceInvertido* indice) {
+    if (!indice || indice->mapeado) return 0;
+    size_t bytes = indice->capacidad * sizeof(EntradaVocabulario) +
+                   (indice->tabla_tamanio + indice->tabla_vieja_tamanio) * sizeof(uint32_t) +
+                   indice->textos.bytes_reservados + indice->posteos.arena.bytes_reservados +
+                   indice->posteos.bytes_fuera_del_pool;
+    const TablaDocumentos* documentos = indice->documentos;
+    if (documentos) {
+        bytes += (size_t)documentos->capacidad * (sizeof(char*) + sizeof(uint32_t)) + documentos->textos.bytes_reservados;
+    }
+    return bytes;
+}
+
 void destruir_indice(indiceInvertido* indice) {
     if (!indice) return;
-    printf("[INDEX_info] Destruyendo indice. Liberando %zu entradas del vocabulario...\n", indice->cantidad);
-    for (size_t i = 0; i < indice->cantidad; i++) {
-        free(indice->entradas[i].palabra);
-        // free_list es de list.h
-        free_list(&(indice->entradas[i].list_documentos_cabeza));
+    bool silencioso = indice->silencioso;
+    if (!silencioso) printf("[INDEX_info] Destruyendo indice. Liberando %zu entradas del vocabulario...\n", indice->cantidad);
+    // Las palabras y las listas chicas viven en las arenas; solo las listas grandes tienen malloc propio.
+    for (size_t i = 0; indice->entradas && i < indice->cantidad; i++) {
+        ListaPosteo* lista = &(indice->entradas[i].lista_documentos);
+        if (lista->capacidad > CAPACIDAD_MAXIMA_POOL) {
+            free_list(lista);
+        }
+        free(indice->entradas[i].cotas_bloque);
+        destruir_lista_posiciones(indice->entradas[i].posiciones);
     }
+    liberar_arena(&indice->textos);
+    liberar_pool_posteos(&indice->posteos);
     free(indice->entradas);
+    free(indice->tabla_hash);
+    free(indice->tabla_vieja);
+    destruir_tabla_documentos(indice->documentos);
+    cerrar_indice_mapeado(indice->mapeado); // Despues de la tabla de documentos, que apunta dentro del mapeo.
     free(indice);
-    printf("[INDEX_info] Indice destruido completamente.\n");
+    if (!silencioso) printf("[INDEX_info] Indice destruido completamente.\n");
 }
 
 
-void anadir_termino(indiceInvertido* indice, const char* palabra, const char* documento) {
-    if (!indice || !palabra || !documento || strlen(palabra) == 0) { // Añadí strlen(palabra) == 0
-        return;
+// Cuerpo de anadir_termino: devuelve la posicion de la entrada (-1 si no se agrego) y si el documento
+// es un posteo nuevo de su lista (su primera aparicion).
+static ssize_t anadir_posteo(indiceInvertido* indice, const char* palabra, uint32_t doc_id, bool* posteo_nuevo) {
+    *posteo_nuevo = false;
+    if (!indice || !palabra || doc_id == DOC_ID_INVALIDO || strlen(palabra) == 0) { // Añadí strlen(palabra) == 0
+        return -1;
+    }
+    if (indice->mapeado) {
+        fprintf(stderr, "[INDEX] Error: El indice es de solo lectura. Termino '%s' no añadido.\n", palabra);
+        return -1;
     }
 
-    ssize_t pos = buscar_pos_termino(indice, palabra);
+    migrar_tabla(indice, PASOS_MIGRACION);
+    indice->largo_promedio_cotas = 0.0; // Las listas cambian: las cotas BM25 ya no sirven.
+    indice->version++;
+
+    uint32_t hash = hash_palabra(palabra);
+    ssize_t pos = buscar_pos_termino(indice, palabra, hash);
     
     if (pos < 0) {
-        if (indice->cantidad >= indice->capacidad) {
-            if (!aumentar_capacidad(indice)) {
-                fprintf(stderr, "[INDEX] Error: No se pudo aumentar capacidad. Termino '%s' para doc '%s' no añadido.\n", palabra, documento);
-                return;
-            }
+        pos = agregar_entrada(indice, palabra, hash);
+        if (pos < 0) {
+            fprintf(stderr, "[INDEX] Error: Termino '%s' para doc %u no añadido.\n", palabra, (unsigned)doc_id);
+            return -1;
+        }
+
+        MEDIR_CONTAR(CONTADOR_TERMINOS, 1);
+        if (!indice->silencioso && (indice->cantidad % 5000 == 0 || indice->cantidad <= 10)) {
+            REGISTRAR(REGISTRO_DETALLE, "    [INDEX_info] Palabra nueva en vocabulario: '%s' (Total vocabulario: %zu)\n",
+                      palabra, indice->cantidad);
+        }
+    }
+
+    // false tambien cuando solo se sumo la frecuencia (el documento ya estaba en la lista).
+    *posteo_nuevo = insertar_o_sumar_posteo_en_pool(&(indice->entradas[pos].lista_documentos), doc_id, &indice->posteos);
+    if (*posteo_nuevo) MEDIR_CONTAR(CONTADOR_POSTEOS, 1);
+    return pos;
+}
+
+
+void anadir_termino(indiceInvertido* indice, const char* palabra, uint32_t doc_id) {
+    bool posteo_nuevo;
+    anadir_posteo(indice, palabra, doc_id, &posteo_nuevo);
+}
+
+
+void anadir_termino_en_posicion(indiceInvertido* indice, const char* palabra, uint32_t doc_id, uint32_t posicion) {
+    bool posteo_nuevo;
+    ssize_t pos = anadir_posteo(indice, palabra, doc_id, &posteo_nuevo);
+    if (pos < 0 || !indice->con_posiciones) {
+        return;
+    }
+    EntradaVocabulario* entrada = &indice->entradas[pos];
+    if (!entrada->posiciones) {
+        entrada->posiciones = crear_lista_posiciones();
+        if (!entrada->posiciones) return;
+    }
+    agregar_posicion(entrada->posiciones, posteo_nuevo, posicion);
+}
+
+
+bool activar_posiciones(indiceInvertido* indice) {
+    if (!indice || indice->mapeado || indice->cantidad > 0) {
+        return false;
+    }
+    indice->con_posiciones = true;
+    indice->version++;
+    return true;
+}
+
+
+bool anadir_lista_termino(indiceInvertido* indice, const char* palabra, ListaPosteo* lista) {
+    if (!indice || !palabra || !lista || strlen(palabra) == 0 || indice->mapeado) {
+        return false;
+    }
+
+    migrar_tabla(indice, PASOS_MIGRACION);
+    indice->largo_promedio_cotas = 0.0;
+    indice->version++;
+
+    uint32_t hash = hash_palabra(palabra);
+    if (buscar_pos_termino(indice, palabra, hash) >= 0) {
+        fprintf(stderr, "[INDEX] Error: El termino '%s' ya tiene lista de posteo.\n", palabra);
+        return false;
+    }
+    ssize_t pos = agregar_entrada(indice, palabra, hash);
+    if (pos < 0) {
+        return false;
+    }
+    ListaPosteo* lista_entrada = &indice->entradas[pos].lista_documentos;
+    if (lista->cantidad > CAPACIDAD_MAXIMA_POOL) {
+        *lista_entrada = *lista; // La entrada se queda con los arrays de la lista.
+        *lista = LISTA_POSTEO_VACIA;
+        return true;
+    }
+    // Las listas chicas del indice viven en su pool: se copian ahi y se suelta la original.
+    if (lista->cantidad > 0) {
+        if (!reservar_lista_en_pool(lista_entrada, lista->cantidad, &indice->posteos)) {
+            return false;
         }
-        pos = indice->cantidad;
-        indice->entradas[pos].palabra = strdup(palabra);
-        if (indice->entradas[pos].palabra == NULL) {
-            perror("[INDEX] Fallo strdup para nueva palabra en vocabulario");
-            return; 
+        memcpy(lista_entrada->doc_ids, lista->doc_ids, lista->cantidad * sizeof(uint32_t));
+        memcpy(lista_entrada->frecuencias, lista->frecuencias, lista->cantidad * sizeof(uint32_t));
+        lista_entrada->cantidad = lista->cantidad;
+    }
+    free_list(lista);
+    return true;
+}
+
+
+bool fusionar_indice(indiceInvertido* destino, indiceInvertido* parcial) {
+    if (!destino || !parcial || destino->mapeado || parcial->mapeado) {
+        return false;
+    }
+
+    destino->largo_promedio_cotas = 0.0;
+    destino->version++;
+    // Las listas de 'parcial' que viven en su pool pasan tal cual a 'destino', que se queda con esa memoria.
+    adoptar_arena(&destino->posteos.arena, &parcial->posteos.arena);
+
+    uint32_t base = destino->documentos->cantidad;
+    for (uint32_t id = 0; id < parcial->documentos->cantidad; id++) {
+        const char* url = url_documento(parcial->documentos, id);
+        uint32_t nuevo_id = registrar_documento(destino->documentos, url, strlen(url));
+        if (nuevo_id == DOC_ID_INVALIDO) {
+            fprintf(stderr, "[INDEX] Error: No se pudo registrar el documento '%s' al fusionar.\n", url);
+            return false;
+        }
+        fijar_largo_documento(destino->documentos, nuevo_id, parcial->documentos->largos[id]);
+    }
+
+    for (size_t i = 0; i < parcial->cantidad; i++) {
+        EntradaVocabulario* entrada = &parcial->entradas[i];
+        ListaPosteo* lista = &entrada->lista_documentos;
+        for (uint32_t k = 0; k < lista->cantidad; k++) {
+            lista->doc_ids[k] += base;
         }
-        indice->entradas[pos].list_documentos_cabeza = NULL;
-        indice->cantidad++;
 
-        if (indice->cantidad % 5000 == 0 || indice->cantidad <= 10) {
-             printf("    [INDEX_info] Palabra nueva en vocabulario: '%s' (Total vocabulario: %zu)\n", palabra, indice->cantidad);
+        migrar_tabla(destino, PASOS_MIGRACION);
+        ssize_t pos = buscar_pos_termino(destino, entrada->palabra, entrada->hash);
+        if (pos < 0) {
+            pos = agregar_entrada(destino, entrada->palabra, entrada->hash);
+            if (pos < 0) {
+                return false;
+            }
+            destino->entradas[pos].lista_documentos = *lista; // Termino nuevo: la lista se traspasa tal cual.
+            *lista = LISTA_POSTEO_VACIA;
+            destino->entradas[pos].posiciones = entrada->posiciones; // Sus posiciones tambien.
+            entrada->posiciones = NULL;
+            continue;
+        }
+
+        // Todos los IDs de 'parcial' son mayores que los de 'destino': basta con agregarlos al final.
+        ListaPosteo* lista_destino = &destino->entradas[pos].lista_documentos;
+        if (!reservar_lista_en_pool(lista_destino, (size_t)lista_destino->cantidad + lista->cantidad, &destino->posteos)) {
+            return false;
         }
+        for (uint32_t k = 0; k < lista->cantidad; k++) {
+            agregar_posteo_en_pool(lista_destino, lista->doc_ids[k], lista->frecuencias[k], &destino->posteos);
+        }
+        if (destino->entradas[pos].posiciones &&
+            !concatenar_posiciones(destino->entradas[pos].posiciones, entrada->posiciones, lista->frecuencias)) {
+            return false;
+        }
+        liberar_lista_en_pool(lista, &destino->posteos); // Su bloque ya es de 'destino' y se reutiliza ahi.
+    }
+    return true;
+}
+
+
+bool buscar_lista_posteo_termino(const indiceInvertido* indice, const char* palabra, ListaPosteo* vista) {
+    if (!vista) {
+        return false;
+    }
+    *vista = LISTA_POSTEO_VACIA;
+    if (!indice || !palabra) {
+        return false;
+    }
+    if (indice->mapeado) {
+        return false; // Las listas del archivo estan comprimidas: se leen con abrir_cursor_termino.
+    }
+    uint32_t hash = hash_palabra(palabra);
+    ssize_t pos = buscar_pos_termino(indice, palabra, hash);
+    if (pos < 0) {
+        return false;
     }
+    *vista = indice->entradas[pos].lista_documentos;
+    return true;
+}
+
 
+ListaPosteo intersectar_listas_posteo(const ListaPosteo* lista1, const ListaPosteo* lista2) {
+    ListaPosteo resultado_interseccion = LISTA_POSTEO_VACIA;
+    if (!lista1 || !lista2 || lista1->cantidad == 0 || lista2->cantidad == 0) {
+        return resultado_interseccion;
+    }
+
+    uint32_t maximo = (lista1->cantidad < lista2->cantidad) ? lista1->cantidad : lista2->cantidad;
+    if (!reservar_lista(&resultado_interseccion, maximo)) {
+        free_list(&resultado_interseccion);
+        return resultado_interseccion;
+    }
 
-    if (!insertar_o_sumar_node(&(indice->entradas[pos].list_documentos_cabeza), documento)) {
-        // fprintf(stderr, "[INDEX_warn] No se pudo añadir/actualizar doc '%s' en lista de posteo para '%s'.\n", documento, palabra);
+    // Los arrays del resultado sirven primero para recibir las posiciones de cada coincidencia
+    // y luego se reescriben en el mismo lugar con el ID y la suma de frecuencias.
+    uint32_t* pos1 = resultado_interseccion.doc_ids;
+    uint32_t* pos2 = resultado_interseccion.frecuencias;
+    size_t encontrados = interseccion_adaptativa(lista1->doc_ids, lista1->cantidad,
+                                                 lista2->doc_ids, lista2->cantidad, pos1, pos2);
+    for (size_t k = 0; k < encontrados; k++) {
+        uint32_t frecuencia = lista1->frecuencias[pos1[k]] + lista2->frecuencias[pos2[k]];
+        resultado_interseccion.doc_ids[k] = lista1->doc_ids[pos1[k]];
+        resultado_interseccion.frecuencias[k] = frecuencia;
     }
+    resultado_interseccion.cantidad = (uint32_t)encontrados;
+    if (encontrados == 0) {
+        free_list(&resultado_interseccion);
+    }
+    return resultado_interseccion;
 }
 
 
-nodePtr buscar_lista_posteo_termino(const indiceInvertido* indice, const char* palabra) {
+bool abrir_cursor_termino(const indiceInvertido* indice, const char* palabra, CursorPosteo* cursor) {
+    if (!cursor) {
+        return false;
+    }
+    abrir_cursor_lista(cursor, NULL);
     if (!indice || !palabra) {
-        return NULL;
+        return false;
     }
-    ssize_t pos = buscar_pos_termino(indice, palabra);
-    return (pos >= 0) ? indice->entradas[pos].list_documentos_cabeza : NULL;
+    uint32_t hash = hash_palabra(palabra);
+    if (indice->mapeado) {
+        return buscar_cursor_mapeado(indice->mapeado, palabra, hash, cursor);
+    }
+    ssize_t pos = buscar_pos_termino(indice, palabra, hash);
+    if (pos < 0) {
+        return false;
+    }
+    const EntradaVocabulario* entrada = &indice->entradas[pos];
+    abrir_cursor_lista(cursor, &entrada->lista_documentos);
+    // Las cotas solo valen si se calcularon con el largo promedio actual (ver preparar_cotas_bm25).
+    const TablaDocumentos* documentos = indice->documentos;
+    if (indice->largo_promedio_cotas > 0.0 && documentos->cantidad > 0 &&
+        indice->largo_promedio_cotas == (double)documentos->suma_largos / documentos->cantidad) {
+        fijar_cotas_cursor(cursor, entrada->cota_bm25, entrada->cotas_bloque);
+    }
+    return true;
 }
 
 
-nodePtr intersectar_listas_posteo(nodePtr lista1, nodePtr lista2) {
-    nodePtr resultado_interseccion = NULL;
-    node* nodo_actual_lista1 = lista1;
+bool iniciar_interseccion(InterseccionCursores* interseccion, CursorPosteo* cursores[], size_t cantidad) {
+    if (!interseccion) {
+        return false;
+    }
+    interseccion->cursores = cursores;
+    interseccion->cantidad = cantidad;
+    interseccion->guia = 0;
+    interseccion->agotado = !cursores || cantidad == 0 || cantidad > MAX_TERMINOS_INTERSECCION;
+    interseccion->vivos = 0;
+    if (interseccion->agotado) {
+        return false;
+    }
+    // La lista mas corta manda: sus bloques son los candidatos que se van filtrando con las demas.
+    for (size_t j = 1; j < cantidad; j++) {
+        if (cursores[j]->cantidad < cursores[interseccion->guia]->cantidad) interseccion->guia = j;
+    }
+    return true;
+}
+
+
+bool siguiente_bloque_interseccion(InterseccionCursores* interseccion) {
+    if (!interseccion) {
+        return false;
+    }
+    CursorPosteo** cursores = interseccion->cursores;
+    size_t cantidad = interseccion->cantidad;
+    size_t menor = interseccion->guia;
+    uint32_t* candidatos = interseccion->doc_ids;
+    uint32_t pos_candidatos[POSTEOS_POR_BLOQUE], pos_bloque[POSTEOS_POR_BLOQUE];
+
+    while (!interseccion->agotado) {
+        CursorPosteo* guia = cursores[menor];
+        // Ninguna otra lista tiene documentos antes del primero de su bloque actual: la guia salta
+        // directo al bloque que alcanza al mayor de ellos en vez de decodificar los de en medio.
+        uint32_t objetivo = 0;
+        for (size_t j = 0; j < cantidad; j++) {
+            if (j != menor && cursores[j]->largo > 0 && cursores[j]->doc_ids[0] > objetivo) {
+                objetivo = cursores[j]->doc_ids[0];
+            }
+        }
+        bool hay_bloque = (guia->largo > 0 && guia->doc_ids[guia->largo - 1] < objetivo) ? saltar_a_doc(guia, objetivo)
+                                                                                          : avanzar_bloque(guia);
+        if (!hay_bloque) {
+            interseccion->agotado = true;
+            break;
+        }
+        uint32_t vivos = guia->largo;
+        memcpy(candidatos, guia->doc_ids, vivos * sizeof(uint32_t));
+        memcpy(interseccion->frecuencias[menor], guia->frecuencias, vivos * sizeof(uint32_t));
 
-    while (nodo_actual_lista1 != NULL) {
-        node* nodo_actual_lista2 = lista2;
-        while (nodo_actual_lista2 != NULL) {
-            if (strcmp(nodo_actual_lista1->documento, nodo_actual_lista2->documento) == 0) {
-                insertar_o_sumar_node(&resultado_interseccion, nodo_actual_lista1->documento);
-                break; 
+        // Terminos ya revisados en este bloque (sus frecuencias se compactan junto con los candidatos).
+        size_t revisados[MAX_TERMINOS_INTERSECCION];
+        size_t num_revisados = 0;
+        revisados[num_revisados++] = menor;
+        for (size_t j = 0; j < cantidad && vivos > 0; j++) {
+            if (j == menor) continue;
+            CursorPosteo* otro = cursores[j];
+            // Los sobrevivientes se compactan al principio de los arrays: nunca pisan uno que falta revisar.
+            uint32_t quedan = 0;
+            uint32_t desde = 0;
+            while (desde < vivos) {
+                if (!saltar_a_doc(otro, candidatos[desde])) {
+                    interseccion->agotado = true; // Esta lista se acabo: despues de este bloque no hay mas resultados.
+                    break;
+                }
+                size_t comunes = interseccion_adaptativa(candidatos + desde, vivos - desde, otro->doc_ids, otro->largo,
+                                                         pos_candidatos, pos_bloque);
+                for (size_t k = 0; k < comunes; k++) {
+                    uint32_t origen = desde + pos_candidatos[k];
+                    candidatos[quedan] = candidatos[origen];
+                    for (size_t r = 0; r < num_revisados; r++) {
+                        interseccion->frecuencias[revisados[r]][quedan] = interseccion->frecuencias[revisados[r]][origen];
+                    }
+                    interseccion->frecuencias[j][quedan] = otro->frecuencias[pos_bloque[k]];
+                    quedan++;
+                }
+                // Los candidatos que caen despues de este bloque se buscan en los siguientes.
+                uint32_t ultimo_bloque = otro->doc_ids[otro->largo - 1];
+                while (desde < vivos && candidatos[desde] <= ultimo_bloque) {
+                    desde++;
+                }
             }
-            nodo_actual_lista2 = nodo_actual_lista2->next;
+            vivos = quedan;
+            revisados[num_revisados++] = j;
+        }
+
+        if (vivos > 0) {
+            interseccion->vivos = vivos;
+            return true;
         }
-        nodo_actual_lista1 = nodo_actual_lista1->next;
     }
-    return resultado_interseccion;
+    interseccion->vivos = 0;
+    return false;
+}
+
+
+ListaPosteo intersectar_cursores_posteo(CursorPosteo* cursores[], size_t cantidad) {
+    ListaPosteo resultado = LISTA_POSTEO_VACIA;
+    // Grande (frecuencias por termino): va en el heap y no en el stack.
+    InterseccionCursores* interseccion = (InterseccionCursores*)malloc(sizeof(InterseccionCursores));
+    if (!interseccion) {
+        perror("[INDEX] Fallo malloc para el estado de la interseccion");
+        return resultado;
+    }
+    if (!iniciar_interseccion(interseccion, cursores, cantidad)) {
+        free(interseccion);
+        return resultado;
+    }
+    while (siguiente_bloque_interseccion(interseccion)) {
+        uint32_t vivos = interseccion->vivos;
+        // Crece al doble: pedir justo lo del bloque hacia un realloc (y una copia de todo) por bloque.
+        size_t necesario = (size_t)resultado.cantidad + vivos;
+        size_t doble = (size_t)resultado.capacidad * 2;
+        if (necesario > resultado.capacidad && !reservar_lista(&resultado, necesario > doble ? necesario : doble)) {
+            free_list(&resultado);
+            break;
+        }
+        memcpy(resultado.doc_ids + resultado.cantidad, interseccion->doc_ids, vivos * sizeof(uint32_t));
+        for (uint32_t i = 0; i < vivos; i++) {
+            uint32_t suma = 0;
+            for (size_t t = 0; t < cantidad; t++) {
+                suma += interseccion->frecuencias[t][i];
+            }
+            resultado.frecuencias[resultado.cantidad + i] = suma;
+        }
+        resultado.cantidad += vivos;
+    }
+    free(interseccion);
+    return resultado;
+}
+
+
+// Primer indice >= 'desde' con ids[indice] >= doc (galope y luego busqueda binaria); n si no hay.
+static uint32_t avanzar_hasta_doc(const uint32_t* ids, uint32_t n, uint32_t desde, uint32_t doc) {
+    uint32_t paso = 1;
+    uint32_t alto = desde;
+    while (alto < n && ids[alto] < doc) {
+        desde = alto + 1;
+        alto += paso;
+        paso *= 2;
+    }
+    if (alto > n) alto = n;
+    while (desde < alto) {
+        uint32_t medio = desde + (alto - desde) / 2;
+        if (ids[medio] < doc) desde = medio + 1; else alto = medio;
+    }
+    return desde;
+}
+
+
+ListaPosteo filtrar_por_frase(const indiceInvertido* indice, const char* const terminos[], const uint32_t desplazamientos[],
+                              size_t cantidad, const ListaPosteo* candidatos) {
+    ListaPosteo resultado = LISTA_POSTEO_VACIA;
+    if (!indice || !terminos || !desplazamientos || !candidatos || candidatos->cantidad == 0 ||
+        cantidad == 0 || cantidad > MAX_TERMINOS_FRASE || indice->mapeado || !indice->con_posiciones) {
+        return resultado;
+    }
+
+    const EntradaVocabulario* entradas[MAX_TERMINOS_FRASE];
+    uint32_t siguientes[MAX_TERMINOS_FRASE] = { 0 };   // Por donde va cada termino en su lista de posteo.
+    uint32_t* posiciones[MAX_TERMINOS_FRASE] = { NULL };
+    uint32_t capacidades[MAX_TERMINOS_FRASE] = { 0 };
+    uint32_t cantidades[MAX_TERMINOS_FRASE];
+    for (size_t j = 0; j < cantidad; j++) {
+        ssize_t pos = terminos[j] ? buscar_pos_termino(indice, terminos[j], hash_palabra(terminos[j])) : -1;
+        if (pos < 0 || !indice->entradas[pos].posiciones) {
+            return resultado;
+        }
+        entradas[j] = &indice->entradas[pos];
+    }
+
+    bool error = false;
+    for (uint32_t c = 0; c < candidatos->cantidad && !error; c++) {
+        uint32_t doc = candidatos->doc_ids[c];
+        bool en_todos = true;
+        for (size_t j = 0; j < cantidad && en_todos; j++) {
+            const ListaPosteo* lista = &entradas[j]->lista_documentos;
+            uint32_t k = avanzar_hasta_doc(lista->doc_ids, lista->cantidad, siguientes[j], doc);
+            siguientes[j] = k;
+            en_todos = k < lista->cantidad && lista->doc_ids[k] == doc;
+            if (!en_todos) break;
+            uint32_t frecuencia = lista->frecuencias[k];
+            if (frecuencia > capacidades[j]) {
+                uint32_t* nuevo = (uint32_t*)realloc(posiciones[j], frecuencia * sizeof(uint32_t));
+                if (!nuevo) {
+                    perror("[INDEX] Fallo realloc para las posiciones de una frase");
+                    error = true;
+                    break;
+                }
+                posiciones[j] = nuevo;
+                capacidades[j] = frecuencia;
+            }
+            cantidades[j] = leer_posiciones(entradas[j]->posiciones, lista, k, posiciones[j]);
+            en_todos = cantidades[j] > 0;
+        }
+        if (!en_todos || error) continue;
+        uint32_t apariciones = contar_frase((const uint32_t* const*)posiciones, cantidades, desplazamientos, cantidad);
+        if (apariciones > 0 && !agregar_posteo(&resultado, doc, apariciones)) {
+            error = true;
+        }
+    }
+
+    for (size_t j = 0; j < cantidad; j++) {
+        free(posiciones[j]);
+    }
+    if (error) {
+        free_list(&resultado);
+    }
+    return resultado;
 }
@@ -0,0 +1,106 @@
+#include "includes/lector_lineas.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+// --- Funciones Estáticas ---
+
+// Deja la linea a medias al principio del buffer, lo agranda si ya esta lleno y lee otro bloque.
+static bool rellenar_buffer(LectorLineas* lector) {
+    if (lector->inicio > 0) {
+        size_t pendientes = lector->fin - lector->inicio;
+        memmove(lector->buffer, lector->buffer + lector->inicio, pendientes);
+        lector->fin = pendientes;
+        lector->revisado -= lector->inicio;
+        lector->inicio = 0;
+    }
+    // Siempre queda un byte libre para el '\0' de la ultima linea.
+    if (lector->capacidad - lector->fin < TAMANIO_LECTURA_LINEAS + 1) {
+        size_t nueva_capacidad = lector->capacidad * 2;
+        while (nueva_capacidad - lector->fin < TAMANIO_LECTURA_LINEAS + 1) {
+            nueva_capacidad *= 2;
+        }
+        char* nuevo = (char*)realloc(lector->buffer, nueva_capacidad);
+        if (!nuevo) {
+            perror("[LECTOR] Fallo realloc para agrandar el buffer de lineas");
+            return false;
+        }
+        lector->buffer = nuevo;
+        lector->capacidad = nueva_capacidad;
+    }
+    size_t leidos = fread(lector->buffer + lector->fin, 1, lector->capacidad - lector->fin - 1, lector->archivo);
+    lector->fin += leidos;
+    lector->bytes_leidos += leidos;
+    if (leidos == 0) {
+        lector->fin_archivo = true;
+        lector->error_lectura = ferror(lector->archivo) != 0;
+    }
+    return true;
+}
+
+// Corta la linea [inicio, final) del buffer, le saca un '\r' final y la entrega.
+static void entregar_linea(LectorLineas* lector, size_t final, size_t siguiente, char** linea, size_t* largo) {
+    size_t largo_linea = final - lector->inicio;
+    char* inicio = lector->buffer + lector->inicio;
+    if (largo_linea > 0 && inicio[largo_linea - 1] == '\r') {
+        largo_linea--;
+    }
+    inicio[largo_linea] = '\0';
+    *linea = inicio;
+    if (largo) *largo = largo_linea;
+    lector->inicio = siguiente;
+    lector->revisado = siguiente;
+}
+
+// --- Implementación de Funciones Públicas (declaradas en lector_lineas.h) ---
+
+bool abrir_lector_lineas(LectorLineas* lector, const char* ruta) {
+    if (!lector || !ruta) return false;
+    memset(lector, 0, sizeof(*lector));
+    lector->archivo = fopen(ruta, "rb");
+    if (!lector->archivo) {
+        fprintf(stderr, "[LECTOR] No se pudo abrir '%s': %s\n", ruta, strerror(errno));
+        return false;
+    }
+    lector->capacidad = 2 * (size_t)TAMANIO_LECTURA_LINEAS;
+    lector->buffer = (char*)malloc(lector->capacidad);
+    if (!lector->buffer) {
+        perror("[LECTOR] Fallo malloc para el buffer de lineas");
+        fclose(lector->archivo);
+        lector->archivo = NULL;
+        return false;
+    }
+    return true;
+}
+
+bool siguiente_linea(LectorLineas* lector, char** linea, size_t* largo) {
+    if (!lector || !lector->buffer || !linea) return false;
+    while (true) {
+        char* salto = memchr(lector->buffer + lector->revisado, '\n', lector->fin - lector->revisado);
+        if (salto) {
+            size_t pos_salto = (size_t)(salto - lector->buffer);
+            entregar_linea(lector, pos_salto, pos_salto + 1, linea, largo);
+            return true;
+        }
+        lector->revisado = lector->fin;
+        if (lector->fin_archivo) {
+            if (lector->inicio < lector->fin) {
+                entregar_linea(lector, lector->fin, lector->fin, linea, largo); // Ultima linea sin '\n'.
+                return true;
+            }
+            return false;
+        }
+        if (!rellenar_buffer(lector)) {
+            return false;
+        }
+    }
+}
+
+void cerrar_lector_lineas(LectorLineas* lector) {
+    if (!lector) return;
+    if (lector->archivo) fclose(lector->archivo);
+    free(lector->buffer);
+    memset(lector, 0, sizeof(*lector));
+}
@@ -1,59 +1,185 @@
 #include "./includes/list.h"
+#include "./includes/medicion.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 
-node* crear_nodo(const char* documento) {
-    node* nuevo = malloc(sizeof(node));
-    if (!nuevo) {
-        perror("No se pudo crear nodo");
-        return NULL;
-    }
+// Capacidad con la que parte una lista; la mayoria de los terminos aparece en muy pocos documentos.
+#define CAPACIDAD_INICIAL_LISTA 2
+
+// Una lista de un indice con pool vive en el pool mientras su capacidad no pase de CAPACIDAD_MAXIMA_POOL.
+static bool lista_en_pool(const ListaPosteo* lista, const PoolPosteos* pool) {
+    return pool && lista->capacidad > 0 && lista->capacidad <= CAPACIDAD_MAXIMA_POOL;
+}
 
-    nuevo->documento = strdup(documento);
-    if (!nuevo->documento) {
-        free(nuevo);
-        return NULL;
+// Pasa la lista a un bloque del pool con al menos 'capacidad' lugares (redondeada a potencia de 2).
+static bool mover_a_bloque_pool(ListaPosteo* lista, size_t capacidad, PoolPosteos* pool) {
+    uint32_t capacidad_bloque = CAPACIDAD_INICIAL_LISTA;
+    while (capacidad_bloque < capacidad) {
+        capacidad_bloque <<= 1;
+    }
+    uint32_t* bloque = pedir_bloque_posteos(pool, capacidad_bloque);
+    if (!bloque) {
+        perror("No se pudo agrandar la lista de posteo");
+        return false;
+    }
+    if (lista->cantidad > 0) {
+        memcpy(bloque, lista->doc_ids, lista->cantidad * sizeof(uint32_t));
+        memcpy(bloque + capacidad_bloque, lista->frecuencias, lista->cantidad * sizeof(uint32_t));
     }
+    if (lista->capacidad > 0) {
+        devolver_bloque_posteos(pool, lista->doc_ids, lista->capacidad);
+    }
+    lista->doc_ids = bloque;
+    lista->frecuencias = bloque + capacidad_bloque;
+    lista->capacidad = capacidad_bloque;
+    return true;
+}
 
-    nuevo->frecuencia = 1;
-    nuevo->next = NULL;
-    return nuevo;
+// Pasa una lista del pool a dos arrays propios con malloc (cuando crece mas alla del pool).
+static bool sacar_de_pool(ListaPosteo* lista, size_t capacidad, PoolPosteos* pool) {
+    uint32_t* nuevos_docs = malloc(capacidad * sizeof(uint32_t));
+    uint32_t* nuevas_frecuencias = malloc(capacidad * sizeof(uint32_t));
+    if (!nuevos_docs || !nuevas_frecuencias) {
+        perror("No se pudo agrandar la lista de posteo");
+        free(nuevos_docs);
+        free(nuevas_frecuencias);
+        return false;
+    }
+    MEDIR_ASIGNACION(2 * capacidad * sizeof(uint32_t));
+    pool->bytes_fuera_del_pool += 2 * capacidad * sizeof(uint32_t);
+    memcpy(nuevos_docs, lista->doc_ids, lista->cantidad * sizeof(uint32_t));
+    memcpy(nuevas_frecuencias, lista->frecuencias, lista->cantidad * sizeof(uint32_t));
+    devolver_bloque_posteos(pool, lista->doc_ids, lista->capacidad);
+    lista->doc_ids = nuevos_docs;
+    lista->frecuencias = nuevas_frecuencias;
+    lista->capacidad = (uint32_t)capacidad;
+    return true;
 }
 
-bool insertar_o_sumar_node(nodePtr * lista, const char* documento) {
-    node* actual = *lista;
+bool reservar_lista_en_pool(ListaPosteo* lista, size_t capacidad, PoolPosteos* pool) {
+    if (!lista) return false;
+    if (capacidad <= lista->capacidad) return true;
+    if (capacidad > UINT32_MAX) return false;
 
-    while (actual) {
-        if (strcmp(actual->documento, documento) == 0) {
-            actual->frecuencia++;
-            return false;
-        }
-        actual = actual->next;
+    if (pool && capacidad <= CAPACIDAD_MAXIMA_POOL) {
+        return mover_a_bloque_pool(lista, capacidad, pool);
+    }
+    if (lista_en_pool(lista, pool)) {
+        return sacar_de_pool(lista, capacidad, pool);
+    }
+
+    uint32_t* nuevos_docs = realloc(lista->doc_ids, capacidad * sizeof(uint32_t));
+    if (!nuevos_docs) {
+        perror("No se pudo agrandar la lista de posteo");
+        return false;
+    }
+    lista->doc_ids = nuevos_docs;
+    uint32_t* nuevas_frecuencias = realloc(lista->frecuencias, capacidad * sizeof(uint32_t));
+    if (!nuevas_frecuencias) {
+        perror("No se pudo agrandar la lista de posteo");
+        return false;
     }
+    lista->frecuencias = nuevas_frecuencias;
+    if (pool) pool->bytes_fuera_del_pool += 2 * (capacidad - lista->capacidad) * sizeof(uint32_t);
+    lista->capacidad = (uint32_t)capacidad;
+    MEDIR_ASIGNACION(2 * capacidad * sizeof(uint32_t));
+    return true;
+}
+
+bool reservar_lista(ListaPosteo* lista, size_t capacidad) {
+    return reservar_lista_en_pool(lista, capacidad, NULL);
+}
+
+static bool asegurar_espacio(ListaPosteo* lista, PoolPosteos* pool) {
+    if (lista->cantidad < lista->capacidad) return true;
+    size_t nueva_capacidad = (lista->capacidad == 0) ? CAPACIDAD_INICIAL_LISTA : (size_t)lista->capacidad * 2;
+    return reservar_lista_en_pool(lista, nueva_capacidad, pool);
+}
+
+bool agregar_posteo_en_pool(ListaPosteo* lista, uint32_t doc_id, uint32_t frecuencia, PoolPosteos* pool) {
+    if (!lista || !asegurar_espacio(lista, pool)) return false;
+    lista->doc_ids[lista->cantidad] = doc_id;
+    lista->frecuencias[lista->cantidad] = frecuencia;
+    lista->cantidad++;
+    return true;
+}
+
+bool agregar_posteo(ListaPosteo* lista, uint32_t doc_id, uint32_t frecuencia) {
+    return agregar_posteo_en_pool(lista, doc_id, frecuencia, NULL);
+}
 
-    node* nuevo = crear_nodo(documento);
-    if (!nuevo) return false;
+bool insertar_o_sumar_posteo_en_pool(ListaPosteo* lista, uint32_t doc_id, PoolPosteos* pool) {
+    if (!lista) return false;
 
-    nuevo->next = *lista;
-    *lista = nuevo;
+    if (lista->cantidad == 0 || lista->doc_ids[lista->cantidad - 1] < doc_id) {
+        return agregar_posteo_en_pool(lista, doc_id, 1, pool);
+    }
+    if (lista->doc_ids[lista->cantidad - 1] == doc_id) {
+        lista->frecuencias[lista->cantidad - 1]++;
+        return false;
+    }
+
+    // Documento fuera de orden: busqueda binaria de su lugar (no pasa al indexar un archivo en orden).
+    uint32_t bajo = 0, alto = lista->cantidad;
+    while (bajo < alto) {
+        uint32_t medio = bajo + (alto - bajo) / 2;
+        if (lista->doc_ids[medio] < doc_id) bajo = medio + 1; else alto = medio;
+    }
+    if (lista->doc_ids[bajo] == doc_id) {
+        lista->frecuencias[bajo]++;
+        return false;
+    }
+    if (!asegurar_espacio(lista, pool)) return false;
+    size_t mover = lista->cantidad - bajo;
+    memmove(&lista->doc_ids[bajo + 1], &lista->doc_ids[bajo], mover * sizeof(uint32_t));
+    memmove(&lista->frecuencias[bajo + 1], &lista->frecuencias[bajo], mover * sizeof(uint32_t));
+    lista->doc_ids[bajo] = doc_id;
+    lista->frecuencias[bajo] = 1;
+    lista->cantidad++;
     return true;
 }
 
-void free_list(nodePtr* head) {
-    node* aux;
-    while (*head) {
-        aux = *head;
-        *head = (*head)->next;
-        free(aux->documento);
-        free(aux);
+bool insertar_o_sumar_posteo(ListaPosteo* lista, uint32_t doc_id) {
+    return insertar_o_sumar_posteo_en_pool(lista, doc_id, NULL);
+}
+
+ListaPosteo copiar_lista(const ListaPosteo* origen) {
+    ListaPosteo copia = LISTA_POSTEO_VACIA;
+    if (!origen || origen->cantidad == 0) return copia;
+    if (!reservar_lista(&copia, origen->cantidad)) {
+        free_list(&copia);
+        return copia;
+    }
+    memcpy(copia.doc_ids, origen->doc_ids, origen->cantidad * sizeof(uint32_t));
+    memcpy(copia.frecuencias, origen->frecuencias, origen->cantidad * sizeof(uint32_t));
+    copia.cantidad = origen->cantidad;
+    return copia;
+}
+
+void liberar_lista_en_pool(ListaPosteo* lista, PoolPosteos* pool) {
+    if (!lista) return;
+    if (lista_en_pool(lista, pool)) {
+        devolver_bloque_posteos(pool, lista->doc_ids, lista->capacidad);
+    } else {
+        if (pool) {
+            size_t bytes = 2 * (size_t)lista->capacidad * sizeof(uint32_t);
+            pool->bytes_fuera_del_pool -= bytes < pool->bytes_fuera_del_pool ? bytes : pool->bytes_fuera_del_pool;
+        }
+        free(lista->doc_ids);
+        free(lista->frecuencias);
     }
+    *lista = LISTA_POSTEO_VACIA;
 }
 
-void print_list(const nodePtr head) {
-    node* actual = head;
-    while (actual) {
-        printf("%s (freq: %d)\n", actual->documento, actual->frecuencia);
-        actual = actual->next;
+void free_list(ListaPosteo* lista) {
+    liberar_lista_en_pool(lista, NULL);
+}
+
+void print_list(const ListaPosteo* lista, const TablaDocumentos* documentos) {
+    if (!lista) return;
+    for (uint32_t i = 0; i < lista->cantidad; i++) {
+        const char* url = url_documento(documentos, lista->doc_ids[i]);
+        printf("%s (freq: %u)\n", url ? url : "(documento desconocido)", (unsigned)lista->frecuencias[i]);
     }
-}
\ No newline at end of file
+}
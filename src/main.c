@@ -2,39 +2,299 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
-#include <ctype.h>
+#include <unistd.h>     // Para dup y dup2
 
 // --- Nuestros Modulos ---
 #include "includes/stopwords.h"
 #include "includes/list.h"
 #include "includes/inverted_index.h"
 #include "includes/parser.h"
+#include "includes/indice_disco.h"
+#include "includes/ranking.h"
+#include "includes/consultas.h"
+#include "includes/cache_consultas.h"
+#include "includes/segmentos.h"
+#include "includes/indice_externo.h"
+#include "includes/medicion.h"
+#include "includes/registro.h"
 
 #define MAX_LARGO_CONSULTA 256   // Maximo de caracteres para la consulta del usuario.
-#define MAX_TERMINOS_CONSULTA 20 // Maximo de palabras "utiles" en una consulta.
+#define MAX_TOPK 10000           // Maximo de resultados que se piden con --topk.
+#define TOPK_POR_DEFECTO 10      // Resultados que muestra --cualquiera si no se da --topk.
+
+// Ordena los terminos (y sus cursores) de menor a mayor cantidad de documentos.
+// Son a lo mas MAX_TERMINOS_CONSULTA, asi que basta con insercion directa.
+static void ordenar_terminos_por_frecuencia(char* terminos[], CursorPosteo* cursores[], int cantidad) {
+    for (int i = 1; i < cantidad; i++) {
+        char* termino = terminos[i];
+        CursorPosteo* cursor = cursores[i];
+        int j = i - 1;
+        while (j >= 0 && cursores[j]->cantidad > cursor->cantidad) {
+            terminos[j + 1] = terminos[j];
+            cursores[j + 1] = cursores[j];
+            j--;
+        }
+        terminos[j + 1] = termino;
+        cursores[j + 1] = cursor;
+    }
+}
 
-// Funcion auxiliar local para pasar la consulta del usuario a minusculas.
-static void main_convertir_a_minusculas(char *cadena) {
-    if (!cadena) return; // Por si las moscas.
-    for (int i = 0; cadena[i]; i++) {
-        cadena[i] = tolower((unsigned char)cadena[i]);
+// Muestra un ranking: posicion, URL y puntaje de cada resultado.
+static void imprimir_mejores(const ResultadoBusqueda* mejores, size_t cantidad, const TablaDocumentos* documentos) {
+    for (size_t i = 0; i < cantidad; i++) {
+        const char* url = url_documento(documentos, mejores[i].doc_id);
+        printf("%zu. %s (puntaje: %.4f)\n", i + 1, url ? url : "(documento desconocido)", mejores[i].puntaje);
     }
 }
 
+// Responde una consulta sobre un directorio de segmentos, con los mismos mensajes que sobre un indice.
+// Cada consulta toma su vista de los segmentos; la cache se vacia cuando cambia su generacion (una
+// fusion o un segmento nuevo).
+static void responder_con_segmentos(IndiceSegmentado* segmentado, const ConsultaAnalizada* consulta, bool disyuntiva,
+                                    EspacioConsulta* espacio, ResultadoBusqueda* mejores, size_t top_k,
+                                    CacheConsultas* cache, const char* clave, size_t largo_clave) {
+    VistaSegmentos vista;
+    if (!tomar_vista_segmentos(segmentado, &vista)) {
+        printf("  No se pudieron leer los segmentos. Intenta de nuevo.\n");
+        return;
+    }
+    validar_cache_segmentos(cache, vista.generacion, vista.total_documentos, vista.suma_largos);
+    MEDIR_DESDE(marca);
+    // Los mismos avisos que con un indice: en OR los terminos que faltan no aportan, en AND no hay resultados.
+    for (int i = 0; i < consulta->cantidad; i++) {
+        if (documentos_con_termino_segmentos(&vista, consulta->terminos[i], &espacio->cursores[0]) > 0) continue;
+        printf("  El termino '%s' no lo tenemos registrado.\n", consulta->terminos[i]);
+        if (!disyuntiva) {
+            printf("Pucha, no encontramos documentos que tengan todos esos terminos juntos.\n");
+            soltar_vista_segmentos(segmentado, &vista);
+            return;
+        }
+    }
+    if (mejores) {
+        uint32_t total_coincidencias = 0;
+        EstadisticasBusqueda estadisticas;
+        size_t num_mejores = 0;
+        uint64_t datos_cache[2]; // Como con un indice: AND guarda las coincidencias y OR los posteos leidos y totales.
+        if (buscar_mejores_en_cache(cache, NULL, clave, largo_clave, mejores, &num_mejores, datos_cache)) {
+            total_coincidencias = (uint32_t)datos_cache[0];
+            estadisticas.posteos_decodificados = datos_cache[0];
+            estadisticas.posteos_totales = datos_cache[1];
+        } else {
+            num_mejores = buscar_mejores_segmentos(&vista, consulta, disyuntiva, espacio, mejores, top_k,
+                                                   &total_coincidencias, &estadisticas);
+            datos_cache[0] = disyuntiva ? estadisticas.posteos_decodificados : total_coincidencias;
+            datos_cache[1] = disyuntiva ? estadisticas.posteos_totales : 0;
+            guardar_mejores_en_cache(cache, NULL, clave, largo_clave, mejores, num_mejores, datos_cache);
+        }
+        MEDIR_FASE(FASE_INTERSECTAR, marca);
+        if (num_mejores == 0) {
+            printf(disyuntiva ? "Pucha, no encontramos documentos con ninguno de esos terminos.\n"
+                              : "Pucha, no encontramos documentos que tengan todos esos terminos juntos.\n");
+        } else {
+            if (disyuntiva) {
+                printf("--- Los %zu mejores documentos con alguno de los terminos (BM25, %llu de %llu posteos leidos): ---\n",
+                       num_mejores, (unsigned long long)estadisticas.posteos_decodificados,
+                       (unsigned long long)estadisticas.posteos_totales);
+            } else {
+                printf("--- Los %zu mejores de %u documentos con todos los terminos (BM25): ---\n",
+                       num_mejores, (unsigned)total_coincidencias);
+            }
+            for (size_t i = 0; i < num_mejores; i++) {
+                const char* url = url_documento_segmentos(&vista, mejores[i].doc_id);
+                printf("%zu. %s (puntaje: %.4f)\n", i + 1, url ? url : "(documento desconocido)", mejores[i].puntaje);
+            }
+        }
+    } else {
+        ListaPosteo resultado = LISTA_POSTEO_VACIA;
+        if (!buscar_lista_en_cache(cache, NULL, clave, largo_clave, &resultado)) {
+            resultado = buscar_conjuntivo_segmentos(&vista, consulta, espacio);
+            guardar_lista_en_cache(cache, NULL, clave, largo_clave, &resultado);
+        }
+        MEDIR_FASE(FASE_INTERSECTAR, marca);
+        if (resultado.cantidad == 0) {
+            printf("Pucha, no encontramos documentos que tengan todos esos terminos juntos.\n");
+        } else {
+            printf("--- Resultados! Documentos que contienen todos los terminos que buscaste: ---\n");
+            for (uint32_t i = 0; i < resultado.cantidad; i++) {
+                const char* url = url_documento_segmentos(&vista, resultado.doc_ids[i]);
+                printf("%s (freq: %u)\n", url ? url : "(documento desconocido)", (unsigned)resultado.frecuencias[i]);
+            }
+        }
+        free_list(&resultado);
+    }
+    MEDIR_FASE(FASE_IMPRIMIR, marca);
+    soltar_vista_segmentos(segmentado, &vista);
+}
+
+// Con --stats, al terminar (por cualquier camino) se deja lo medido en JSON por stderr.
+static void escribir_estadisticas_al_salir(void) {
+    escribir_medicion_json(stderr);
+    reiniciar_medicion();
+}
+
 void imprimir_uso(const char* nombre_programa) {
     printf("Uso: %s [<ruta_archivo_stopwords> <ruta_archivo_documentos>]\n", nombre_programa);
+    printf("     %s --construir <ruta_archivo_stopwords> <ruta_archivo_documentos> <ruta_archivo_indice>\n", nombre_programa);
+    printf("     %s --servir <ruta_archivo_stopwords> <ruta_archivo_indice o directorio_segmentos>\n", nombre_programa);
+    printf("     %s --agregar <ruta_archivo_stopwords> <ruta_archivo_documentos> <directorio_segmentos>\n", nombre_programa);
     printf("  Si no se especifican rutas, se usaran los valores por defecto:\n");
     printf("    Archivo de Stopwords: data/stopwords_english.dat.txt\n");
     printf("    Archivo de Documentos: data/gov2_pages.dat\n");
+    printf("  Opcion --hilos <N> (en cualquier posicion): indexa los documentos con N hilos (por defecto 1).\n");
+    printf("  Opcion --topk <K> (en cualquier posicion): ordena los resultados por BM25 y muestra solo los K mejores.\n");
+    printf("  Opcion --cualquiera (en cualquier posicion): busca documentos con al menos uno de los terminos (OR),\n");
+    printf("    ordenados por BM25 (los %d mejores si no se da --topk).\n", TOPK_POR_DEFECTO);
+    printf("  Opcion --posiciones (en cualquier posicion, solo con el indice en memoria): guarda la posicion de\n");
+    printf("    cada termino para buscar frases entre comillas, por ejemplo: \"new york\" hotels\n");
+    printf("  Opcion --consultas <archivo> (o --queries): modo por lotes, sin preguntar. Corre cada linea del archivo\n");
+    printf("    (\"id<TAB>consulta\" o solo la consulta) con ranking BM25 y escribe los K mejores de cada una;\n");
+    printf("    al final muestra por stderr la latencia p50/p95/p99 y las consultas por segundo.\n");
+    printf("    --formato tsv|trec elige el formato (tsv por defecto) y --salida <archivo> donde se escriben;\n");
+    printf("    sin --salida van a stdout y todos los demas mensajes a stderr.\n");
+    printf("    Con --hilos N las consultas tambien se reparten entre N hilos sobre el mismo indice.\n");
+    printf("  Opcion --cache-bytes <N>: bytes de la cache de resultados de las consultas interactivas\n");
+    printf("    (por defecto %u; 0 la desactiva). Al salir se muestran sus aciertos y fallos.\n", CACHE_BYTES_POR_DEFECTO);
+    printf("  Opcion --memoria-bytes <N> (solo con --construir): construye el indice por corridas en disco sin\n");
+    printf("    pasar de unos N bytes de memoria, aunque la coleccion no entre en memoria (usa un solo hilo).\n");
+    printf("  Opcion --stats: al terminar escribe en JSON (por stderr) el tiempo de cada fase (leer, parsear,\n");
+    printf("    tokenizar, stopwords, insertar, fusionar, intersectar, imprimir) y los contadores de cada hilo.\n");
+    printf("  Opcion --nivel-registro error|aviso|info|detalle: que mensajes se muestran (por defecto info;\n");
+    printf("    detalle agrega los de cada palabra nueva del vocabulario).\n");
+    printf("  --construir indexa los documentos, guarda el indice en el archivo dado y termina.\n");
+    printf("  --servir abre un indice ya construido (sin volver a parsear el corpus) y atiende consultas.\n");
+    printf("    Si la ruta es un directorio de segmentos, busca en todos y los va fusionando en segundo plano.\n");
+    printf("  --agregar indexa solo los documentos dados y los agrega como un segmento nuevo del directorio\n");
+    printf("    (lo crea si no existe); cuesta lo que esos documentos, no lo que toda la coleccion.\n");
 }
 
 
-int main(int argc, char* argv[]) {
+int main(int argc_original, char* argv_original[]) {
+
+    // "--hilos N" puede ir en cualquier parte; se saca antes de mirar el resto de los argumentos.
+    int num_hilos = 1;
+    int top_k = 0; // 0: sin ranking, se muestran todos los documentos en orden de ID.
+    bool disyuntiva = false; // --cualquiera: OR en vez de AND.
+    bool con_posiciones = false; // --posiciones: indice posicional para buscar frases.
+    const char* ruta_consultas = NULL; // --consultas: modo por lotes.
+    const char* ruta_salida = NULL;    // --salida: archivo de resultados del modo por lotes (si no, stdout).
+    FormatoResultados formato = FORMATO_TSV;
+    bool mostrar_estadisticas = false; // --stats: JSON con lo medido al terminar.
+    size_t bytes_cache = CACHE_BYTES_POR_DEFECTO; // --cache-bytes: presupuesto de la cache de resultados.
+    size_t memoria_construccion = 0; // --memoria-bytes: construir por corridas con este presupuesto (0: en memoria).
+    char* argv[6];
+    int argc = 0;
+    for (int i = 0; i < argc_original; i++) {
+        if (strcmp(argv_original[i], "--hilos") == 0 && i + 1 < argc_original) {
+            num_hilos = atoi(argv_original[++i]);
+            if (num_hilos < 1) {
+                fprintf(stderr, "[MAIN_ERROR] --hilos necesita un numero mayor que 0.\n");
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv_original[i], "--topk") == 0 && i + 1 < argc_original) {
+            top_k = atoi(argv_original[++i]);
+            if (top_k < 1 || top_k > MAX_TOPK) {
+                fprintf(stderr, "[MAIN_ERROR] --topk necesita un numero entre 1 y %d.\n", MAX_TOPK);
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv_original[i], "--cualquiera") == 0) {
+            disyuntiva = true;
+        } else if (strcmp(argv_original[i], "--posiciones") == 0) {
+            con_posiciones = true;
+        } else if ((strcmp(argv_original[i], "--consultas") == 0 || strcmp(argv_original[i], "--queries") == 0) &&
+                   i + 1 < argc_original) {
+            ruta_consultas = argv_original[++i];
+        } else if (strcmp(argv_original[i], "--salida") == 0 && i + 1 < argc_original) {
+            ruta_salida = argv_original[++i];
+        } else if (strcmp(argv_original[i], "--formato") == 0 && i + 1 < argc_original) {
+            const char* nombre = argv_original[++i];
+            if (strcmp(nombre, "tsv") == 0) {
+                formato = FORMATO_TSV;
+            } else if (strcmp(nombre, "trec") == 0) {
+                formato = FORMATO_TREC;
+            } else {
+                fprintf(stderr, "[MAIN_ERROR] --formato debe ser 'tsv' o 'trec'.\n");
+                return EXIT_FAILURE;
+            }
+        } else if (strcmp(argv_original[i], "--cache-bytes") == 0 && i + 1 < argc_original) {
+            char* fin = NULL;
+            unsigned long long bytes = strtoull(argv_original[++i], &fin, 10);
+            if (!fin || *fin != '\0' || argv_original[i][0] == '-') {
+                fprintf(stderr, "[MAIN_ERROR] --cache-bytes necesita un numero de bytes (0 para no usar cache).\n");
+                return EXIT_FAILURE;
+            }
+            bytes_cache = (size_t)bytes;
+        } else if (strcmp(argv_original[i], "--memoria-bytes") == 0 && i + 1 < argc_original) {
+            char* fin = NULL;
+            unsigned long long bytes = strtoull(argv_original[++i], &fin, 10);
+            if (!fin || *fin != '\0' || argv_original[i][0] == '-' || bytes == 0) {
+                fprintf(stderr, "[MAIN_ERROR] --memoria-bytes necesita un numero de bytes mayor que 0.\n");
+                return EXIT_FAILURE;
+            }
+            memoria_construccion = (size_t)bytes;
+        } else if (strcmp(argv_original[i], "--stats") == 0) {
+            mostrar_estadisticas = true;
+        } else if (strcmp(argv_original[i], "--nivel-registro") == 0 && i + 1 < argc_original) {
+            NivelRegistro nivel;
+            if (!nivel_registro_desde_texto(argv_original[++i], &nivel)) {
+                fprintf(stderr, "[MAIN_ERROR] --nivel-registro debe ser 'error', 'aviso', 'info' o 'detalle'.\n");
+                return EXIT_FAILURE;
+            }
+            fijar_nivel_registro(nivel);
+        } else if (argc < (int)(sizeof(argv) / sizeof(argv[0]))) {
+            argv[argc++] = argv_original[i];
+        } else {
+            argc++; // Sobran argumentos: se cuenta igual para que caiga en el error de uso.
+        }
+    }
+
+    if (mostrar_estadisticas) {
+        if (!medicion_disponible()) {
+            fprintf(stderr, "[MAIN] --stats: este ejecutable se compilo sin medicion (make MEDICION=1).\n");
+        }
+        activar_medicion(true);
+        atexit(escribir_estadisticas_al_salir);
+    }
 
-    const char* archivo_stopwords_path;
-    const char* archivo_documentos_path;
+    // Lotes sin --salida: los resultados salen por el stdout original y todos los mensajes (los de main
+    // y los de los modulos) pasan a stderr, asi stdout queda como un TSV o run TREC valido.
+    FILE* resultados_stdout = stdout;
+    if (ruta_consultas && !ruta_salida) {
+        int copia = dup(STDOUT_FILENO);
+        resultados_stdout = copia >= 0 ? fdopen(copia, "w") : NULL;
+        if (!resultados_stdout || dup2(STDERR_FILENO, STDOUT_FILENO) < 0) {
+            perror("[MAIN_ERROR] No se pudo separar los resultados de los mensajes");
+            return EXIT_FAILURE;
+        }
+    }
+
+    if ((disyuntiva || ruta_consultas) && top_k == 0) {
+        top_k = TOPK_POR_DEFECTO; // Un OR sin ranking listaria casi todo el corpus; los lotes siempre van con ranking.
+    }
 
-    if (argc == 1) {
+    const char* archivo_stopwords_path;
+    const char* archivo_documentos_path = NULL;
+    const char* archivo_indice_path = NULL;  // Con --construir es donde se guarda; con --servir, de donde se carga.
+    bool solo_construir = false;
+    bool solo_agregar = false; // --agregar: el indice es un directorio de segmentos.
+
+    if (argc == 5 && strcmp(argv[1], "--construir") == 0) {
+        solo_construir = true;
+        archivo_stopwords_path = argv[2];
+        archivo_documentos_path = argv[3];
+        archivo_indice_path = argv[4];
+        printf("[MAIN_INFO] Modo construir: el indice de '%s' se guardara en '%s'\n", archivo_documentos_path, archivo_indice_path);
+    } else if (argc == 5 && strcmp(argv[1], "--agregar") == 0) {
+        solo_agregar = true;
+        archivo_stopwords_path = argv[2];
+        archivo_documentos_path = argv[3];
+        archivo_indice_path = argv[4];
+        printf("[MAIN_INFO] Modo agregar: los documentos de '%s' seran un segmento nuevo de '%s'\n",
+               archivo_documentos_path, archivo_indice_path);
+    } else if (argc == 4 && strcmp(argv[1], "--servir") == 0) {
+        archivo_stopwords_path = argv[2];
+        archivo_indice_path = argv[3];
+        printf("[MAIN_INFO] Modo servir: usando el indice guardado en '%s'\n", archivo_indice_path);
+    } else if (argc == 1) {
         printf("[MAIN_info] No se especificaron las rutas de archivos, usando valores por defecto.");
         archivo_stopwords_path    = "data/stopwords_english.dat.txt";
         archivo_documentos_path   = "data/small_gov.dat";
@@ -49,6 +309,17 @@ int main(int argc, char* argv[]) {
         return EXIT_FAILURE;
     }
 
+    // El archivo del indice no guarda posiciones: solo el indice en memoria puede ser posicional.
+    if (con_posiciones && archivo_indice_path) {
+        fprintf(stderr, "[MAIN_ERROR] --posiciones no se puede usar con --construir ni --servir.\n");
+        return EXIT_FAILURE;
+    }
+
+    if (memoria_construccion > 0 && !solo_construir) {
+        fprintf(stderr, "[MAIN_ERROR] --memoria-bytes solo se puede usar con --construir.\n");
+        return EXIT_FAILURE;
+    }
+
     printf("------------------------------------------------------------\n");
     printf("--- Mi Buscador Personalizado - Version 1.0 ---\n");
     printf("------------------------------------------------------------\n\n");
@@ -61,23 +332,142 @@ int main(int argc, char* argv[]) {
 
     printf("[MAIN] Stopwords listas y dispuestas para ser ignoradas!\n\n");
 
-    printf("[MAIN] Creando el indice invertido...\n");
+    indiceInvertido* mi_indice = NULL;
+    IndiceSegmentado* segmentado = NULL;
+    if (solo_agregar) {
+        segmentado = abrir_indice_segmentado(archivo_indice_path, false);
+        bool agregado = segmentado && agregar_documentos_como_segmento(segmentado, archivo_documentos_path, num_hilos);
+        if (!agregado) {
+            fprintf(stderr, "[MAIN] No se agrego ningun segmento a '%s'.\n", archivo_indice_path);
+        }
+        cerrar_indice_segmentado(segmentado);
+        free_stopwords();
+        return agregado ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (archivo_documentos_path == NULL && es_directorio_de_segmentos(archivo_indice_path)) {
+        printf("[MAIN] Abriendo los segmentos de '%s'...\n", archivo_indice_path);
+        segmentado = abrir_indice_segmentado(archivo_indice_path, true);
+        if (!segmentado) {
+            fprintf(stderr, "[MAIN] No se pudo abrir el directorio de segmentos!\n");
+            free_stopwords();
+            return EXIT_FAILURE;
+        }
+        printf("[MAIN] Segmentos listos; se fusionan en segundo plano mientras atendemos consultas.\n\n");
+    } else if (solo_construir && memoria_construccion > 0) {
+        // Por corridas el indice entero nunca esta en memoria: se escribe directo al archivo.
+        if (num_hilos > 1) {
+            REGISTRAR(REGISTRO_AVISO, "[MAIN] --hilos se ignora con --memoria-bytes: la construccion por corridas usa un hilo.\n");
+        }
+        bool guardado = construir_indice_externo(archivo_documentos_path, archivo_indice_path, memoria_construccion);
+        if (!guardado) {
+            fprintf(stderr, "[MAIN] No se guardo el indice en '%s'.\n", archivo_indice_path);
+        }
+        free_stopwords();
+        return guardado ? EXIT_SUCCESS : EXIT_FAILURE;
+    } else if (archivo_documentos_path == NULL) {
+        printf("[MAIN] Abriendo el indice guardado en '%s'...\n", archivo_indice_path);
+        mi_indice = cargar_indice(archivo_indice_path);
+        if (!mi_indice) {
+            fprintf(stderr, "[MAIN] No se pudo abrir el indice! Construyelo primero con --construir.\n");
+            free_stopwords();
+            return EXIT_FAILURE;
+        }
+        printf("[MAIN] Indice listo. Tiene %zu palabras unicas en %u documentos.\n\n",
+               mi_indice->cantidad, (unsigned)mi_indice->documentos->cantidad);
+    } else {
+        printf("[MAIN] Creando el indice invertido...\n");
+
+        mi_indice = crear_indice(2048);
+        if (!mi_indice) {
+            fprintf(stderr, "[MAIN] Fallo la creacion del indice invertido! Problemas de memoria quizas.\n");
+            free_stopwords();
+            return EXIT_FAILURE;
+        }
+        if (con_posiciones) {
+            activar_posiciones(mi_indice);
+            printf("[MAIN] El indice guardara las posiciones de los terminos (busqueda de frases).\n");
+        }
+        printf("[MAIN] Indice invertido listo para recibir datos.\n\n");
 
-    indiceInvertido* mi_indice = crear_indice(2048);
-    if (!mi_indice) {
-        fprintf(stderr, "[MAIN] Fallo la creacion del indice invertido! Problemas de memoria quizas.\n");
+        printf("[MAIN] Procesando documentos desde '%s' para llenar el indice...\n", archivo_documentos_path);
+
+        bool documentos_ok = procesar_archivo_documento_paralelo(archivo_documentos_path, mi_indice, num_hilos);
+        if (!documentos_ok) {
+            fprintf(stderr, "[MAIN] Hubo un problema procesando los documentos. El indice podria estar incompleto.\n");
+        } else {
+            printf("[MAIN] Documentos procesados. El indice tiene %zu palabras unicas en %u documentos.\n\n",
+                   mi_indice->cantidad, (unsigned)mi_indice->documentos->cantidad);
+        }
+
+        if (solo_construir) {
+            // Un indice incompleto no se guarda: con --servir se confundiria con uno bueno.
+            bool guardado = documentos_ok && guardar_indice(mi_indice, archivo_indice_path);
+            if (!guardado) {
+                fprintf(stderr, "[MAIN] No se guardo el indice en '%s'.\n", archivo_indice_path);
+            }
+            destruir_indice(mi_indice);
+            free_stopwords();
+            return guardado ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
+        // Las cotas BM25 dejan que la busqueda OR salte los documentos que no pueden entrar al top-k.
+        if (disyuntiva && !preparar_cotas_bm25(mi_indice)) {
+            fprintf(stderr, "[MAIN] No se pudieron calcular las cotas BM25; las busquedas OR seran mas lentas.\n");
+        }
+    }
+
+    if (ruta_consultas) {
+        FILE* salida = ruta_salida ? fopen(ruta_salida, "w") : resultados_stdout;
+        if (!salida) {
+            fprintf(stderr, "[MAIN] No se pudo abrir '%s' para escribir los resultados.\n", ruta_salida);
+            cerrar_indice_segmentado(segmentado);
+            destruir_indice(mi_indice);
+            free_stopwords();
+            return EXIT_FAILURE;
+        }
+        EstadisticasLote lote;
+        // Con segmentos, las fusiones siguen en segundo plano mientras corre el lote.
+        bool lote_ok = segmentado ? correr_lote_consultas_segmentos(segmentado, ruta_consultas, salida, formato, disyuntiva,
+                                                                    (size_t)top_k, num_hilos, &lote)
+                                  : correr_lote_consultas(mi_indice, ruta_consultas, salida, formato, disyuntiva,
+                                                          (size_t)top_k, num_hilos, &lote);
+        fclose(salida);
+        if (lote_ok) {
+            // Por stderr, para no mezclarse con los resultados.
+            fprintf(stderr, "[MAIN] %zu consultas (%zu sin resultados) con %d hilo(s) en %.3f s: %.1f consultas/s\n",
+                    lote.consultas, lote.sin_resultados, lote.hilos, lote.segundos_totales,
+                    lote.segundos_totales > 0 ? (double)lote.consultas / lote.segundos_totales : 0.0);
+            fprintf(stderr, "[MAIN] Latencia por consulta (ms): p50 %.3f  p95 %.3f  p99 %.3f  max %.3f\n",
+                    lote.latencia_p50_ms, lote.latencia_p95_ms, lote.latencia_p99_ms, lote.latencia_max_ms);
+        } else {
+            fprintf(stderr, "[MAIN] No se pudieron correr las consultas de '%s'.\n", ruta_consultas);
+        }
+        cerrar_indice_segmentado(segmentado);
+        destruir_indice(mi_indice);
         free_stopwords();
-        return EXIT_FAILURE;
+        return lote_ok ? EXIT_SUCCESS : EXIT_FAILURE;
     }
-    printf("[MAIN] Indice invertido listo para recibir datos.\n\n");
 
-    printf("[MAIN] Procesando documentos desde '%s' para llenar el indice...\n", archivo_documentos_path);
+    // Con --topk los K mejores quedan aqui; el heap nunca guarda mas que eso.
+    ResultadoBusqueda* mejores = NULL;
+    if (top_k > 0) {
+        mejores = (ResultadoBusqueda*)malloc((size_t)top_k * sizeof(ResultadoBusqueda));
+        if (!mejores) {
+            fprintf(stderr, "[MAIN] Fallo malloc para los %d mejores resultados.\n", top_k);
+            cerrar_indice_segmentado(segmentado);
+            destruir_indice(mi_indice);
+            free_stopwords();
+            return EXIT_FAILURE;
+        }
+    }
 
-    if (!procesar_archivo_documento(archivo_documentos_path, mi_indice)) {
-        fprintf(stderr, "[MAIN] Hubo un problema procesando los documentos. El indice podria estar incompleto.\n");
-    } else {
-        printf("[MAIN] Documentos procesados. El indice tiene %zu palabras unicas.\n\n", mi_indice->cantidad);
+    // Las consultas que se repiten se responden de aqui sin volver a intersectar.
+    CacheConsultas cache;
+    if (!iniciar_cache_consultas(&cache, bytes_cache)) {
+        fprintf(stderr, "[MAIN] No se pudo crear la cache de consultas; se busca siempre en el indice.\n");
     }
+    static char clave_cache[MAX_LARGO_CLAVE_CACHE];
+    static EspacioConsulta espacio_segmentos; // Static: trae los cursores de todos los terminos.
 
     char consulta_del_usuario[MAX_LARGO_CONSULTA];
     printf("\n------------------------------------------\n");
@@ -102,20 +492,19 @@ int main(int argc, char* argv[]) {
 
         printf("[MAIN] Procesando: \"%s\"\n", consulta_del_usuario);
 
-        char copia_consulta[MAX_LARGO_CONSULTA];
-        strcpy(copia_consulta, consulta_del_usuario);
-        main_convertir_a_minusculas(copia_consulta);
-
-        char* terminos_validos[MAX_TERMINOS_CONSULTA];
-        int num_terminos_validos = 0;
-        const char* delimitadores_consulta = " \t\n\r\f\v,.;:!?()[]{}-\"\'“”‘’"; // Hartos delimitadores.
-        char* token = strtok(copia_consulta, delimitadores_consulta);
-
-        while (token != NULL && num_terminos_validos < MAX_TERMINOS_CONSULTA) {
-            if (strlen(token) > 0 && !es_stopword(token)) { 
-                terminos_validos[num_terminos_validos++] = token;
-            }
-            token = strtok(NULL, delimitadores_consulta);
+        // Mismo tokenizador que el parser: la consulta se normaliza igual que los documentos indexados.
+        static ConsultaAnalizada consulta; // Static: trae los tokens de todos los terminos.
+        analizar_consulta(consulta_del_usuario, &consulta);
+        char** terminos_validos = consulta.terminos;
+        int num_terminos_validos = consulta.cantidad;
+        FraseConsulta* frases = consulta.frases;
+        int num_frases_a_filtrar = consulta.num_frases;
+        bool con_posiciones_indice = mi_indice && mi_indice->con_posiciones;
+        if (num_frases_a_filtrar > 0 && (disyuntiva || mejores || !con_posiciones_indice)) {
+            printf("  (Las frases entre comillas se buscan como terminos sueltos: %s)\n",
+                   !con_posiciones_indice ? "el indice no guarda posiciones, usa --posiciones"
+                                          : "la busqueda de frases es solo sin ranking");
+            num_frases_a_filtrar = 0;
         }
 
         if (num_terminos_validos == 0) {
@@ -126,54 +515,146 @@ int main(int argc, char* argv[]) {
         printf("  Buscando %d termino(s) clave: ", num_terminos_validos);
         for(int i = 0; i < num_terminos_validos; ++i) printf("'%s' ", terminos_validos[i]);
         printf("\n");
+        MEDIR_CONTAR(CONTADOR_CONSULTAS, 1);
+        // La clave se arma antes de ordenar los terminos por frecuencia (igual la ordena por texto).
+        ModoCache modo_cache = disyuntiva ? MODO_CACHE_DISYUNTIVO : mejores ? MODO_CACHE_CONJUNTIVO_RANKING
+                                                                            : MODO_CACHE_CONJUNTIVO;
+        size_t largo_clave = armar_clave_consulta(&consulta, modo_cache, (size_t)top_k, num_frases_a_filtrar, clave_cache);
+        if (segmentado) {
+            responder_con_segmentos(segmentado, &consulta, disyuntiva, &espacio_segmentos, mejores, (size_t)top_k,
+                                    &cache, clave_cache, largo_clave);
+            continue;
+        }
+        MEDIR_DESDE(marca);
+
+        if (disyuntiva) {
+            // OR: los terminos que no estan en el indice simplemente no aportan.
+            static CursorPosteo cursores_o[MAX_TERMINOS_CONSULTA];
+            CursorPosteo* cursores[MAX_TERMINOS_CONSULTA];
+            size_t num_cursores = 0;
+            for (int i = 0; i < num_terminos_validos; ++i) {
+                if (abrir_cursor_termino(mi_indice, terminos_validos[i], &cursores_o[num_cursores])) {
+                    cursores[num_cursores] = &cursores_o[num_cursores];
+                    num_cursores++;
+                } else {
+                    printf("  El termino '%s' no lo tenemos registrado.\n", terminos_validos[i]);
+                }
+            }
+            EstadisticasBusqueda estadisticas;
+            size_t num_mejores = 0;
+            uint64_t posteos[2]; // Decodificados y totales, para repetir el mismo mensaje desde la cache.
+            if (buscar_mejores_en_cache(&cache, mi_indice, clave_cache, largo_clave, mejores, &num_mejores, posteos)) {
+                estadisticas.posteos_decodificados = posteos[0];
+                estadisticas.posteos_totales = posteos[1];
+            } else {
+                num_mejores = buscar_mejores_disyuntivo(mi_indice, cursores, num_cursores, mejores, (size_t)top_k, &estadisticas);
+                posteos[0] = estadisticas.posteos_decodificados;
+                posteos[1] = estadisticas.posteos_totales;
+                guardar_mejores_en_cache(&cache, mi_indice, clave_cache, largo_clave, mejores, num_mejores, posteos);
+            }
+            MEDIR_FASE(FASE_INTERSECTAR, marca);
+            if (num_mejores == 0) {
+                printf("Pucha, no encontramos documentos con ninguno de esos terminos.\n");
+                continue;
+            }
+            printf("--- Los %zu mejores documentos con alguno de los terminos (BM25, %llu de %llu posteos leidos): ---\n",
+                   num_mejores, (unsigned long long)estadisticas.posteos_decodificados,
+                   (unsigned long long)estadisticas.posteos_totales);
+            imprimir_mejores(mejores, num_mejores, mi_indice->documentos);
+            MEDIR_FASE(FASE_IMPRIMIR, marca);
+            continue;
+        }
 
-        nodePtr lista_resultado_final = NULL;
-        bool es_primera_lista_valida = true;
-
+        // Buscamos primero todas las listas: si falta un termino no hay nada que intersectar.
+        // Los cursores leen las listas del indice (o del archivo, comprimidas) sin copiarlas.
+        static CursorPosteo cursores_terminos[MAX_TERMINOS_CONSULTA]; // Static: cada uno trae sus buffers de bloque.
+        CursorPosteo* cursores[MAX_TERMINOS_CONSULTA];
+        bool falta_algun_termino = false;
         for (int i = 0; i < num_terminos_validos; ++i) {
-            nodePtr lista_del_termino_actual = buscar_lista_posteo_termino(mi_indice, terminos_validos[i]);
-
-            if (!lista_del_termino_actual) {
+            cursores[i] = &cursores_terminos[i];
+            if (!abrir_cursor_termino(mi_indice, terminos_validos[i], cursores[i])) {
                 printf("  El termino '%s' no lo tenemos registrado.\n", terminos_validos[i]);
-                free_list(&lista_resultado_final);
-                lista_resultado_final = NULL;
+                falta_algun_termino = true;
                 break;
             }
+        }
 
-            if (es_primera_lista_valida) {
-                nodePtr nodo_aux_copia = lista_del_termino_actual;
-                while(nodo_aux_copia) {
-                    insertar_o_sumar_node(&lista_resultado_final, nodo_aux_copia->documento);
-                    nodo_aux_copia = nodo_aux_copia->next;
-                }
-                es_primera_lista_valida = false;
-                if (!lista_resultado_final && num_terminos_validos > 0) {
-                     printf("  Problemas al armar la lista inicial con '%s'.\n", terminos_validos[i]);
-                     break;
-                }
+        if (!falta_algun_termino && mejores) {
+            // Ranking: se puntua cada coincidencia al vuelo y solo se guardan las K mejores.
+            uint32_t total_coincidencias = 0;
+            size_t num_mejores = 0;
+            uint64_t datos_cache[2];
+            if (buscar_mejores_en_cache(&cache, mi_indice, clave_cache, largo_clave, mejores, &num_mejores, datos_cache)) {
+                total_coincidencias = (uint32_t)datos_cache[0];
             } else {
+                num_mejores = buscar_mejores_conjuntivo(mi_indice, cursores, (size_t)num_terminos_validos,
+                                                        mejores, (size_t)top_k, &total_coincidencias);
+                datos_cache[0] = total_coincidencias;
+                datos_cache[1] = 0;
+                guardar_mejores_en_cache(&cache, mi_indice, clave_cache, largo_clave, mejores, num_mejores, datos_cache);
+            }
+            MEDIR_FASE(FASE_INTERSECTAR, marca);
+            if (num_mejores == 0) {
+                printf("Pucha, no encontramos documentos que tengan todos esos terminos juntos.\n");
+                continue;
+            }
+            printf("--- Los %zu mejores de %u documentos con todos los terminos (BM25): ---\n",
+                   num_mejores, (unsigned)total_coincidencias);
+            imprimir_mejores(mejores, num_mejores, mi_indice->documentos);
+            MEDIR_FASE(FASE_IMPRIMIR, marca);
+            continue;
+        }
 
-                nodePtr lista_intermedia = intersectar_listas_posteo(lista_resultado_final, lista_del_termino_actual);
-                free_list(&lista_resultado_final);
-                lista_resultado_final = lista_intermedia;
-                if (lista_resultado_final == NULL) {
-
-                    printf("  Parece que '%s' no tiene documentos en comun con los terminos anteriores.\n", terminos_validos[i]);
-                    break;
+        ListaPosteo lista_resultado_final = LISTA_POSTEO_VACIA;
+        const ListaPosteo* lista_a_mostrar = NULL;
+
+        if (!falta_algun_termino) {
+            if (!buscar_lista_en_cache(&cache, mi_indice, clave_cache, largo_clave, &lista_resultado_final)) {
+                // La lista mas corta guia la interseccion, bloque a bloque; las demas se recorren en ese orden.
+                ordenar_terminos_por_frecuencia(terminos_validos, cursores, num_terminos_validos);
+
+                lista_resultado_final = intersectar_cursores_posteo(cursores, (size_t)num_terminos_validos);
+                // Las posiciones solo se leen para los documentos que tienen todos los terminos.
+                for (int i = 0; i < num_frases_a_filtrar && lista_resultado_final.cantidad > 0; i++) {
+                    ListaPosteo con_frase = filtrar_por_frase(mi_indice, frases[i].terminos, frases[i].desplazamientos,
+                                                              frases[i].cantidad, &lista_resultado_final);
+                    free_list(&lista_resultado_final);
+                    lista_resultado_final = con_frase;
                 }
+                guardar_lista_en_cache(&cache, mi_indice, clave_cache, largo_clave, &lista_resultado_final);
+            }
+            if (lista_resultado_final.cantidad > 0) {
+                lista_a_mostrar = &lista_resultado_final;
+            } else if (num_frases_a_filtrar > 0) {
+                printf("  Los terminos estan, pero no en el orden de la frase.\n");
+            } else if (num_terminos_validos > 1) {
+                printf("  Parece que esos terminos no tienen documentos en comun.\n");
             }
         }
+        MEDIR_FASE(FASE_INTERSECTAR, marca);
 
-        if (lista_resultado_final != NULL) {
+        if (lista_a_mostrar) {
             printf("--- Resultados! Documentos que contienen todos los terminos que buscaste: ---\n");
-            print_list(lista_resultado_final);
+            print_list(lista_a_mostrar, mi_indice->documentos);
+            MEDIR_FASE(FASE_IMPRIMIR, marca);
             free_list(&lista_resultado_final);
         } else {
             printf("Pucha, no encontramos documentos que tengan todos esos terminos juntos.\n");
         }
     }
 
+    if (cache.aciertos + cache.fallos > 0) {
+        printf("[MAIN] Cache de consultas: %llu aciertos, %llu fallos (%zu resultados guardados en %zu bytes).\n",
+               (unsigned long long)cache.aciertos, (unsigned long long)cache.fallos, cache.entradas, cache.bytes_usados);
+    }
+    liberar_cache_consultas(&cache);
+
     printf("\n[MAIN] Limpiando y liberando toda la memoria...\n");
+    free(mejores);
+    if (segmentado) {
+        printf("[MAIN] Esperando la fusion de segmentos en curso (si hay)...\n");
+        cerrar_indice_segmentado(segmentado);
+    }
     if (mi_indice) {
         destruir_indice(mi_indice);
         printf("[MAIN] Indice invertido liberado.\n");
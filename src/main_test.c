@@ -3,6 +3,7 @@
 #include <string.h>
 #include <stdbool.h>
 #include <ctype.h>
+#include <math.h>
 
 // --- Nuestros Módulos ---
 // Asegúrate que estas rutas sean correctas según tu estructura.
@@ -10,10 +11,29 @@
 #include "includes/list.h"
 #include "includes/inverted_index.h"
 #include "includes/parser.h"
+#include "includes/interseccion.h"
+#include "includes/indice_disco.h"
+#include "includes/tokenizador.h"
+#include "includes/lector_lineas.h"
+#include "includes/arena.h"
+#include "includes/posteo_comprimido.h"
+#include "includes/ranking.h"
+#include "includes/posiciones.h"
+#include "includes/consultas.h"
+#include "includes/cache_consultas.h"
+#include "includes/medicion.h"
+#include "includes/registro.h"
+#include "includes/segmentos.h"
+#include "includes/indice_externo.h"
 
 // --- Archivos de Datos para Pruebas ---
 const char* TEST_STOPWORDS_FILE = "test_stopwords.dat";
 const char* TEST_DOCS_FILE = "test_docs.dat";
+const char* TEST_INDICE_FILE = "test_indice.idx";
+const char* TEST_LINEAS_FILE = "test_lineas.dat";
+const char* TEST_CONSULTAS_FILE = "test_consultas.txt";
+const char* TEST_SEGMENTOS_DIR = "test_segmentos";
+const char* TEST_INDICE_EXTERNO_FILE = "test_indice_externo.idx";
 
 // --- Funciones Auxiliares para las Pruebas ---
 
@@ -71,6 +91,9 @@ void test_modulo_stopwords() {
         printf("  Probando es_stopword('COMPUTADOR'): %s\n", !es_stopword("COMPUTADOR") ? "false (CORRECTO)" : "true (ERROR)");
         printf("  Probando es_stopword(NULL): %s\n", !es_stopword(NULL) ? "false (CORRECTO)" : "true (ERROR)");
         printf("  Probando es_stopword(\"\"): %s\n", !es_stopword("") ? "false (CORRECTO)" : "true (ERROR)");
+        printf("  Probando es_stopword_largo(\"delta\", 2) (solo 'de'): %s\n", es_stopword_largo("delta", 2) ? "true (CORRECTO)" : "false (ERROR)");
+        printf("  Probando es_stopword_largo(\"EL\", 2): %s\n", es_stopword_largo("EL", 2) ? "true (CORRECTO)" : "false (ERROR)");
+        printf("  Probando es_stopword_largo(\"ela\", 3): %s\n", !es_stopword_largo("ela", 3) ? "false (CORRECTO)" : "true (ERROR)");
 
         printf("  Liberando stopwords...\n");
         free_stopwords();
@@ -87,47 +110,52 @@ void test_modulo_stopwords() {
 
 // --- Tests para el Módulo LIST ---
 void test_modulo_list() {
-    imprimir_titulo_test("Modulo List (Listas Enlazadas)");
-    nodePtr cabeza = NULL;
+    imprimir_titulo_test("Modulo List (Listas de Posteo)");
+    ListaPosteo lista = LISTA_POSTEO_VACIA;
+    TablaDocumentos* docs = crear_tabla_documentos(0);
+    if (!docs) {
+        fprintf(stderr, "  ERROR: crear_tabla_documentos fallo.\n");
+        return;
+    }
+    uint32_t doc1 = registrar_documento(docs, "doc1.txt", strlen("doc1.txt"));
+    uint32_t doc2 = registrar_documento(docs, "doc2.pdf", strlen("doc2.pdf"));
+    uint32_t doc3 = registrar_documento(docs, "doc3.html", strlen("doc3.html"));
+    printf("  IDs asignados: doc1.txt=%u, doc2.pdf=%u, doc3.html=%u %s\n", (unsigned)doc1, (unsigned)doc2, (unsigned)doc3,
+           (doc1 == 0 && doc2 == 1 && doc3 == 2) ? "(CORRECTO)" : "(ERROR)");
 
     printf("  Insertando 'doc1.txt'...\n");
-    insertar_o_sumar_node(&cabeza, "doc1.txt"); // Frecuencia 1
-    printf("  Insertando 'doc2.pdf'...\n");
-    insertar_o_sumar_node(&cabeza, "doc2.pdf"); // Frecuencia 1
+    insertar_o_sumar_posteo(&lista, doc1); // Frecuencia 1
     printf("  Insertando 'doc1.txt' de nuevo...\n");
-    insertar_o_sumar_node(&cabeza, "doc1.txt"); // Frecuencia 2 para doc1.txt
+    insertar_o_sumar_posteo(&lista, doc1); // Frecuencia 2 para doc1.txt
     printf("  Insertando 'doc3.html'...\n");
-    insertar_o_sumar_node(&cabeza, "doc3.html"); // Frecuencia 1
+    insertar_o_sumar_posteo(&lista, doc3); // Frecuencia 1
+    printf("  Insertando 'doc2.pdf' (fuera de orden)...\n");
+    insertar_o_sumar_posteo(&lista, doc2); // Frecuencia 1, debe quedar entre doc1 y doc3
 
     printf("  Contenido de la lista despues de inserciones:\n");
-    print_list(cabeza);
-
-    // Test crear_nodo individualmente (aunque insertar_o_sumar_node ya lo usa)
-    printf("  Creando nodo individual 'doc_test_individual.txt'...\n");
-    nodePtr nodo_suelto = crear_nodo("doc_test_individual.txt");
-    if (nodo_suelto) {
-        printf("    Nodo suelto creado: %s, Freq: %d\n", nodo_suelto->documento, nodo_suelto->frecuencia);
-        // Liberamos este nodo suelto (su documento y el nodo)
-        free(nodo_suelto->documento);
-        free(nodo_suelto);
-        printf("    Nodo suelto liberado.\n");
-    } else {
-        fprintf(stderr, "  ERROR: crear_nodo fallo para 'doc_test_individual.txt'.\n");
-    }
+    print_list(&lista, docs);
+    bool ordenada = lista.cantidad == 3 && lista.doc_ids[0] == doc1 && lista.doc_ids[1] == doc2 && lista.doc_ids[2] == doc3;
+    printf("  Lista ordenada por ID y con freq 2 en doc1.txt: %s\n",
+           (ordenada && lista.frecuencias[0] == 2) ? "si (CORRECTO)" : "no (ERROR)");
 
+    printf("  Copiando la lista...\n");
+    ListaPosteo copia = copiar_lista(&lista);
+    printf("    Copia con %u documentos %s\n", (unsigned)copia.cantidad, copia.cantidad == lista.cantidad ? "(CORRECTO)" : "(ERROR)");
+    free_list(&copia);
 
     printf("  Liberando la lista completa...\n");
-    free_list(&cabeza);
-    if (cabeza == NULL) {
-        printf("  Lista liberada correctamente (cabeza es NULL).\n");
+    free_list(&lista);
+    if (lista.cantidad == 0 && lista.doc_ids == NULL) {
+        printf("  Lista liberada correctamente (quedo vacia).\n");
     } else {
-        fprintf(stderr, "  ERROR: La cabeza de la lista no es NULL después de free_list.\n");
+        fprintf(stderr, "  ERROR: La lista no quedo vacia después de free_list.\n");
     }
     // Imprimimos de nuevo para verificar que esté vacía (no debería imprimir nada)
     printf("  Contenido de la lista despues de liberar (deberia estar vacia):\n");
-    print_list(cabeza);
+    print_list(&lista, docs);
+    destruir_tabla_documentos(docs);
 
-    imprimir_fin_test("Modulo List (Listas Enlazadas)");
+    imprimir_fin_test("Modulo List (Listas de Posteo)");
 }
 
 // --- Tests para el Módulo INVERTED_INDEX ---
@@ -140,45 +168,70 @@ void test_modulo_inverted_index() {
     }
     printf("  Indice creado con capacidad inicial: %zu\n", idx->capacidad);
 
+    uint32_t doc1 = registrar_documento(idx->documentos, "doc1", 4);
+    uint32_t doc2 = registrar_documento(idx->documentos, "doc2", 4);
+    uint32_t doc3 = registrar_documento(idx->documentos, "doc3", 4);
+    uint32_t doc4 = registrar_documento(idx->documentos, "doc4", 4);
+
     printf("  Añadiendo términos...\n");
-    anadir_termino(idx, "hola", "doc1");
-    anadir_termino(idx, "mundo", "doc1");
-    anadir_termino(idx, "hola", "doc2");
-    anadir_termino(idx, "test", "doc1");
-    anadir_termino(idx, "prueba", "doc3");
-    anadir_termino(idx, "hola", "doc1"); // Debería incrementar frecuencia en ("hola", "doc1")
+    anadir_termino(idx, "hola", doc1);
+    anadir_termino(idx, "mundo", doc1);
+    anadir_termino(idx, "hola", doc2);
+    anadir_termino(idx, "test", doc1);
+    anadir_termino(idx, "prueba", doc3);
+    anadir_termino(idx, "hola", doc1); // Debería incrementar frecuencia en ("hola", "doc1")
 
     printf("  Indice despues de añadir terminos (Cantidad: %zu, Capacidad: %zu):\n", idx->cantidad, idx->capacidad);
     // Para ver el contenido, buscamos algunos términos
-    nodePtr lista_hola = buscar_lista_posteo_termino(idx, "hola");
+    ListaPosteo vista_hola;
+    const ListaPosteo* lista_hola = buscar_lista_posteo_termino(idx, "hola", &vista_hola) ? &vista_hola : NULL;
     printf("    Documentos para 'hola':\n    ");
-    print_list(lista_hola); // No liberar lista_hola, es parte del índice.
+    print_list(lista_hola, idx->documentos); // No liberar lista_hola, es parte del índice.
 
-    nodePtr lista_mundo = buscar_lista_posteo_termino(idx, "mundo");
+    ListaPosteo vista_mundo;
+    const ListaPosteo* lista_mundo = buscar_lista_posteo_termino(idx, "mundo", &vista_mundo) ? &vista_mundo : NULL;
     printf("    Documentos para 'mundo':\n    ");
-    print_list(lista_mundo);
+    print_list(lista_mundo, idx->documentos);
 
-    nodePtr lista_inexistente = buscar_lista_posteo_termino(idx, "chao");
+    ListaPosteo vista_inexistente;
+    const ListaPosteo* lista_inexistente = buscar_lista_posteo_termino(idx, "chao", &vista_inexistente) ? &vista_inexistente : NULL;
     printf("    Documentos para 'chao' (deberia ser NULL o lista vacia):\n    ");
-    if (lista_inexistente == NULL) printf("NULL (CORRECTO)\n"); else print_list(lista_inexistente);
+    if (lista_inexistente == NULL) printf("NULL (CORRECTO)\n"); else print_list(lista_inexistente, idx->documentos);
 
 
     // Test de intersección
     printf("  Probando interseccion de 'hola' y 'test' (ambos en doc1)...\n");
-    // buscar_lista_posteo_termino devuelve punteros a listas internas, no debemos liberarlas.
+    // buscar_lista_posteo_termino deja vistas de listas internas, no debemos liberarlas.
     // intersectar_listas_posteo devuelve una NUEVA lista que SÍ debemos liberar.
-    nodePtr interseccion1 = intersectar_listas_posteo(lista_hola, lista_mundo); // hola (d1,d2), mundo (d1) -> d1
+    ListaPosteo interseccion1 = intersectar_listas_posteo(lista_hola, lista_mundo); // hola (d1,d2), mundo (d1) -> d1
     printf("    Intersección ('hola' y 'mundo'):\n    ");
-    print_list(interseccion1);
+    print_list(&interseccion1, idx->documentos);
     free_list(&interseccion1); // Liberamos la lista resultado de la intersección
 
     printf("  Probando intersección de 'hola' y 'prueba' (ninguno en común)...\n");
-    nodePtr lista_prueba = buscar_lista_posteo_termino(idx, "prueba"); // prueba (d3)
-    nodePtr interseccion2 = intersectar_listas_posteo(lista_hola, lista_prueba); // hola (d1,d2), prueba (d3) -> NULL
+    ListaPosteo vista_prueba;
+    const ListaPosteo* lista_prueba = buscar_lista_posteo_termino(idx, "prueba", &vista_prueba) ? &vista_prueba : NULL; // prueba (d3)
+    ListaPosteo interseccion2 = intersectar_listas_posteo(lista_hola, lista_prueba); // hola (d1,d2), prueba (d3) -> vacia
     printf("    Intersección ('hola' y 'prueba'):\n    ");
-    if (interseccion2 == NULL) printf("NULL (CORRECTO)\n"); else print_list(interseccion2);
+    if (interseccion2.cantidad == 0) printf("vacia (CORRECTO)\n"); else print_list(&interseccion2, idx->documentos);
     free_list(&interseccion2);
 
+    // Forzamos varios crecimientos para que la tabla hash migre mientras seguimos buscando.
+    printf("  Añadiendo 1000 terminos para forzar el crecimiento de la tabla hash...\n");
+    char termino_generado[32];
+    int encontrados = 0;
+    ListaPosteo vista;
+    for (int i = 0; i < 1000; i++) {
+        snprintf(termino_generado, sizeof(termino_generado), "termino%d", i);
+        anadir_termino(idx, termino_generado, doc4);
+    }
+    for (int i = 0; i < 1000; i++) {
+        snprintf(termino_generado, sizeof(termino_generado), "termino%d", i);
+        if (buscar_lista_posteo_termino(idx, termino_generado, &vista)) encontrados++;
+    }
+    printf("    Terminos encontrados despues de crecer: %d/1000 %s\n", encontrados, encontrados == 1000 ? "(CORRECTO)" : "(ERROR)");
+    printf("    'hola' sigue en el indice: %s\n", buscar_lista_posteo_termino(idx, "hola", &vista) ? "si (CORRECTO)" : "no (ERROR)");
+
 
     printf("  Destruyendo el índice...\n");
     destruir_indice(idx);
@@ -187,6 +240,682 @@ void test_modulo_inverted_index() {
     imprimir_fin_test("Modulo Inverted Index");
 }
 
+// --- Tests para el Módulo INTERSECCION ---
+void test_modulo_interseccion() {
+    imprimir_titulo_test("Modulo Interseccion");
+    // 'corta' tiene 5 IDs y 'larga' todos los multiplos de 3 hasta 2997: comunes 0, 300, 999 y 2997.
+    uint32_t corta[] = { 0, 7, 300, 999, 2997 };
+    uint32_t larga[1000];
+    for (uint32_t i = 0; i < 1000; i++) larga[i] = i * 3;
+
+    uint32_t pos_a[5], pos_b[5];
+    size_t por_mezcla = interseccion_mezcla(corta, 5, larga, 1000, pos_a, pos_b);
+    printf("  Mezcla encontro %zu comunes %s\n", por_mezcla, por_mezcla == 4 ? "(CORRECTO)" : "(ERROR)");
+
+    size_t por_galope = interseccion_galope(corta, 5, larga, 1000, pos_a, pos_b);
+    bool posiciones_ok = por_galope == 4 && pos_a[1] == 2 && pos_b[1] == 100 && pos_b[3] == 999;
+    printf("  Galope encontro %zu comunes con posiciones correctas: %s\n", por_galope, posiciones_ok ? "si (CORRECTO)" : "no (ERROR)");
+
+    // Con los argumentos al reves la adaptativa debe galopar igual y devolver las posiciones en el orden pedido.
+    size_t por_adaptativa = interseccion_adaptativa(larga, 1000, corta, 5, pos_b, pos_a);
+    printf("  Adaptativa (larga, corta) encontro %zu comunes %s\n", por_adaptativa,
+           (por_adaptativa == 4 && larga[pos_b[2]] == 999 && corta[pos_a[2]] == 999) ? "(CORRECTO)" : "(ERROR)");
+
+    printf("  Interseccion con un array vacio: %zu %s\n", interseccion_adaptativa(corta, 0, larga, 1000, pos_a, pos_b),
+           interseccion_adaptativa(corta, 0, larga, 1000, pos_a, pos_b) == 0 ? "(CORRECTO)" : "(ERROR)");
+
+    // Cada implementacion vectorial soportada debe dar lo mismo que la escalar (mezcla y galope).
+    uint32_t pares[500], pos_esc_a[500], pos_esc_b[500], pos_simd_a[500], pos_simd_b[500];
+    for (uint32_t i = 0; i < 500; i++) pares[i] = i * 2;
+    ImplementacionInterseccion original = interseccion_implementacion_activa();
+    for (int impl = INTERSECCION_ESCALAR; impl <= INTERSECCION_AVX2; impl++) {
+        if (!interseccion_fijar_implementacion((ImplementacionInterseccion)impl)) continue;
+        size_t esc_mezcla = interseccion_mezcla(pares, 500, larga, 1000, pos_esc_a, pos_esc_b);
+        size_t simd_mezcla = interseccion_adaptativa(pares, 500, larga, 1000, pos_simd_a, pos_simd_b);
+        bool iguales = esc_mezcla == simd_mezcla;
+        for (size_t k = 0; iguales && k < esc_mezcla; k++) {
+            iguales = pos_esc_a[k] == pos_simd_a[k] && pos_esc_b[k] == pos_simd_b[k];
+        }
+        size_t simd_galope = interseccion_adaptativa(larga, 1000, corta, 5, pos_simd_b, pos_simd_a);
+        printf("  Implementacion %s igual a la escalar: %s\n", interseccion_nombre((ImplementacionInterseccion)impl),
+               (iguales && simd_galope == 4) ? "si (CORRECTO)" : "no (ERROR)");
+    }
+    interseccion_fijar_implementacion(original);
+    imprimir_fin_test("Modulo Interseccion");
+}
+
+// --- Tests para el Módulo POSTEO_COMPRIMIDO ---
+void test_modulo_posteo_comprimido() {
+    imprimir_titulo_test("Modulo Posteo Comprimido");
+    // 300 posteos (3 bloques, el ultimo incompleto) con saltos chicos y uno enorme para probar VByte de 5 bytes.
+    ListaPosteo lista = LISTA_POSTEO_VACIA;
+    for (uint32_t i = 0; i < 300; i++) {
+        uint32_t doc = (i < 299) ? i * 3 : 4000000000u;
+        agregar_posteo(&lista, doc, (i % 7 == 0) ? 1000 + i : 1);
+    }
+    size_t esperado = largo_lista_comprimida(&lista);
+    uint8_t* datos = (uint8_t*)malloc((2 * MAX_BYTES_VBYTE + BYTES_POR_SALTO) * lista.cantidad);
+    size_t escritos = datos ? comprimir_lista(&lista, NULL, datos) : 0;
+    printf("  300 posteos comprimidos en %zu bytes (sin comprimir: %zu) %s\n", escritos,
+           (size_t)lista.cantidad * 2 * sizeof(uint32_t), (escritos == esperado && escritos < 1000) ? "(CORRECTO)" : "(ERROR)");
+
+    CursorPosteo cursor;
+    abrir_cursor_comprimido(&cursor, datos, escritos, lista.cantidad);
+    uint32_t vistos = 0, bloques = 0;
+    bool iguales = true;
+    while (avanzar_bloque(&cursor)) {
+        bloques++;
+        for (uint32_t k = 0; k < cursor.largo; k++, vistos++) {
+            if (cursor.doc_ids[k] != lista.doc_ids[vistos] || cursor.frecuencias[k] != lista.frecuencias[vistos]) iguales = false;
+        }
+    }
+    printf("  Decodificado bloque a bloque (%u bloques): %s\n", (unsigned)bloques,
+           (iguales && vistos == 300 && bloques == 3 && !cursor.corrupto) ? "igual (CORRECTO)" : "distinto (ERROR)");
+
+    abrir_cursor_comprimido(&cursor, datos, escritos, lista.cantidad);
+    bool salto_ok = saltar_a_doc(&cursor, 500) && cursor.doc_ids[0] == 384 && saltar_a_doc(&cursor, 4000000000u) &&
+                    cursor.doc_ids[cursor.largo - 1] == 4000000000u && !saltar_a_doc(&cursor, 4000000001u);
+    printf("  saltar_a_doc deja el bloque correcto: %s\n", salto_ok ? "si (CORRECTO)" : "no (ERROR)");
+
+    abrir_cursor_comprimido(&cursor, datos, escritos / 2, lista.cantidad); // Datos truncados.
+    while (avanzar_bloque(&cursor)) { }
+    printf("  Lista truncada se detecta como corrupta: %s\n", cursor.corrupto ? "si (CORRECTO)" : "no (ERROR)");
+
+    // Interseccion por cursores (una comprimida y otra en arrays) igual a la de listas completas.
+    ListaPosteo multiplos = LISTA_POSTEO_VACIA;
+    for (uint32_t i = 0; i < 400; i++) agregar_posteo(&multiplos, i * 2, 2);
+    ListaPosteo por_listas = intersectar_listas_posteo(&lista, &multiplos);
+    CursorPosteo cursor_lista, cursor_multiplos;
+    abrir_cursor_comprimido(&cursor_lista, datos, escritos, lista.cantidad);
+    abrir_cursor_lista(&cursor_multiplos, &multiplos);
+    CursorPosteo* cursores[] = { &cursor_multiplos, &cursor_lista };
+    ListaPosteo por_cursores = intersectar_cursores_posteo(cursores, 2);
+    bool misma = por_cursores.cantidad == por_listas.cantidad && por_listas.cantidad > 0;
+    for (uint32_t k = 0; misma && k < por_listas.cantidad; k++) {
+        misma = por_cursores.doc_ids[k] == por_listas.doc_ids[k] && por_cursores.frecuencias[k] == por_listas.frecuencias[k];
+    }
+    printf("  Interseccion por cursores (%u docs) igual a la de listas: %s\n", (unsigned)por_cursores.cantidad,
+           misma ? "si (CORRECTO)" : "no (ERROR)");
+    free_list(&por_listas);
+    free_list(&por_cursores);
+
+    // Termino raro con uno que esta en todos los documentos: con la tabla de saltos solo se leen
+    // los bloques del comun que pueden tener los documentos del raro.
+    ListaPosteo comun = LISTA_POSTEO_VACIA, raro = LISTA_POSTEO_VACIA;
+    for (uint32_t i = 0; i < 100000; i++) agregar_posteo(&comun, i, 1);
+    agregar_posteo(&raro, 50, 1);
+    agregar_posteo(&raro, 70000, 1);
+    uint8_t* datos_comun = (uint8_t*)malloc(largo_lista_comprimida(&comun));
+    size_t bytes_comun = datos_comun ? comprimir_lista(&comun, NULL, datos_comun) : 0;
+    CursorPosteo cursor_comun, cursor_raro;
+    abrir_cursor_comprimido(&cursor_comun, datos_comun, bytes_comun, comun.cantidad);
+    abrir_cursor_lista(&cursor_raro, &raro);
+    CursorPosteo* raro_y_comun[] = { &cursor_comun, &cursor_raro };
+    ListaPosteo ambos = intersectar_cursores_posteo(raro_y_comun, 2);
+    printf("  Raro y comun: %u docs leyendo %u de %u bloques del comun %s\n", (unsigned)ambos.cantidad,
+           (unsigned)cursor_comun.bloques_leidos, (unsigned)cursor_comun.num_bloques,
+           (ambos.cantidad == 2 && ambos.doc_ids[1] == 70000 && cursor_comun.bloques_leidos == 2) ? "(CORRECTO)" : "(ERROR)");
+    abrir_cursor_lista(&cursor_comun, &comun);
+    bool salto_plano = saltar_a_doc(&cursor_comun, 99999) && cursor_comun.doc_ids[cursor_comun.largo - 1] == 99999 &&
+                       cursor_comun.bloques_leidos == 1;
+    printf("  saltar_a_doc sobre arrays sin comprimir salta directo: %s\n", salto_plano ? "si (CORRECTO)" : "no (ERROR)");
+    free_list(&ambos);
+    free_list(&comun);
+    free_list(&raro);
+    free(datos_comun);
+    free_list(&multiplos);
+    free_list(&lista);
+    free(datos);
+    imprimir_fin_test("Modulo Posteo Comprimido");
+}
+
+// --- Tests para el Módulo POSICIONES ---
+void test_modulo_posiciones() {
+    imprimir_titulo_test("Modulo Posiciones");
+    // 300 posteos (3 bloques de posiciones) con 1 a 4 posiciones cada uno; algunas grandes para VByte largos.
+    ListaPosteo lista = LISTA_POSTEO_VACIA;
+    ListaPosiciones* posiciones = crear_lista_posiciones();
+    ListaPosiciones* primera_mitad = crear_lista_posiciones();
+    ListaPosiciones* segunda_mitad = crear_lista_posiciones();
+    for (uint32_t i = 0; i < 300; i++) {
+        uint32_t frecuencia = 1 + i % 4;
+        agregar_posteo(&lista, i * 2, frecuencia);
+        for (uint32_t k = 0; k < frecuencia; k++) {
+            uint32_t posicion = i + k * (i % 5 == 0 ? 100000 : 3);
+            agregar_posicion(posiciones, k == 0, posicion);
+            agregar_posicion(i < 150 ? primera_mitad : segunda_mitad, k == 0, posicion);
+        }
+    }
+    uint32_t leidas[4];
+    bool iguales = true;
+    for (uint32_t i = 0; i < 300; i++) {
+        uint32_t cantidad = leer_posiciones(posiciones, &lista, i, leidas);
+        iguales = iguales && cantidad == lista.frecuencias[i];
+        for (uint32_t k = 0; iguales && k < cantidad; k++) {
+            iguales = leidas[k] == i + k * (i % 5 == 0 ? 100000 : 3);
+        }
+    }
+    printf("  300 posteos con posiciones en %zu bytes, leidas de vuelta: %s\n", posiciones->largo,
+           iguales ? "iguales (CORRECTO)" : "distintas (ERROR)");
+
+    // Concatenar dos mitades (como al fusionar indices parciales) da lo mismo que guardarlas de una vez.
+    concatenar_posiciones(primera_mitad, segunda_mitad, lista.frecuencias + 150);
+    bool concatenadas = primera_mitad->posteos == posiciones->posteos && primera_mitad->largo == posiciones->largo &&
+                        memcmp(primera_mitad->bytes, posiciones->bytes, posiciones->largo) == 0 &&
+                        memcmp(primera_mitad->inicio_bloques, posiciones->inicio_bloques, 3 * sizeof(uint32_t)) == 0;
+    printf("  Concatenar mitades igual a guardar todo junto: %s\n", concatenadas ? "si (CORRECTO)" : "no (ERROR)");
+    printf("  Posteo inexistente no lee nada: %s\n", leer_posiciones(posiciones, &lista, 300, leidas) == 0 ? "(CORRECTO)" : "(ERROR)");
+
+    // "a b _ c": b justo despues de a y c dos lugares despues de b.
+    const uint32_t pos_a[] = { 0, 10, 20 }, pos_b[] = { 1, 11, 25 }, pos_c[] = { 3, 12, 14 };
+    const uint32_t* const terminos[] = { pos_a, pos_b, pos_c };
+    const uint32_t cantidades[] = { 3, 3, 3 };
+    const uint32_t desplazamientos[] = { 0, 1, 3 };
+    uint32_t apariciones = contar_frase(terminos, cantidades, desplazamientos, 3);
+    uint32_t sin_hueco = contar_frase(terminos, cantidades, (const uint32_t[]){ 0, 1, 2 }, 3);
+    printf("  contar_frase: %u y %u apariciones %s\n", (unsigned)apariciones, (unsigned)sin_hueco,
+           (apariciones == 1 && sin_hueco == 1) ? "(CORRECTO)" : "(ERROR)");
+
+    // Indice posicional: las stopwords cuentan en las posiciones, asi la frase calza con ellas en medio.
+    crear_archivo_test_stopwords();
+    cargar_stopwords(TEST_STOPWORDS_FILE);
+    indiceInvertido* indice = crear_indice_silencioso(16);
+    const char* textos[] = { "casa de la pradera", "la pradera y la casa", "casa de piedra de la pradera",
+                             "una casa de la pradera y otra casa de la pradera" };
+    bool activado = indice && activar_posiciones(indice);
+    for (uint32_t d = 0; activado && d < 4; d++) {
+        char url[16];
+        snprintf(url, sizeof(url), "doc%u", (unsigned)d);
+        tokenizar_e_indexar_contenido(textos[d], registrar_documento(indice->documentos, url, strlen(url)), indice);
+    }
+    ListaPosteo casa, pradera;
+    ListaPosteo candidatos = LISTA_POSTEO_VACIA;
+    if (activado && buscar_lista_posteo_termino(indice, "casa", &casa) && buscar_lista_posteo_termino(indice, "pradera", &pradera)) {
+        candidatos = intersectar_listas_posteo(&casa, &pradera);
+    }
+    const char* frase[] = { "casa", "pradera" };
+    const uint32_t lugares[] = { 0, 3 }; // "casa de la pradera"
+    ListaPosteo con_frase = filtrar_por_frase(indice, frase, lugares, 2, &candidatos);
+    bool frase_ok = candidatos.cantidad == 4 && con_frase.cantidad == 2 && con_frase.doc_ids[0] == 0 &&
+                    con_frase.frecuencias[0] == 1 && con_frase.doc_ids[1] == 3 && con_frase.frecuencias[1] == 2;
+    printf("  Frase \"casa de la pradera\": %u de %u candidatos %s\n", (unsigned)con_frase.cantidad,
+           (unsigned)candidatos.cantidad, frase_ok ? "(CORRECTO)" : "(ERROR)");
+    printf("  No se activan posiciones en un indice con terminos: %s\n",
+           (indice && !activar_posiciones(indice)) ? "(CORRECTO)" : "(ERROR)");
+    free_list(&con_frase);
+    free_list(&candidatos);
+    destruir_indice(indice);
+    free_stopwords();
+    remove(TEST_STOPWORDS_FILE);
+
+    destruir_lista_posiciones(posiciones);
+    destruir_lista_posiciones(primera_mitad);
+    destruir_lista_posiciones(segunda_mitad);
+    free_list(&lista);
+    imprimir_fin_test("Modulo Posiciones");
+}
+
+// --- Tests para el Módulo CONSULTAS ---
+void test_modulo_consultas() {
+    imprimir_titulo_test("Modulo Consultas");
+    crear_archivo_test_stopwords();
+    cargar_stopwords(TEST_STOPWORDS_FILE);
+
+    static ConsultaAnalizada consulta;
+    analizar_consulta("el \"casa de la pradera\" perro \"gato\"", &consulta);
+    bool analisis_ok = consulta.cantidad == 4 && strcmp(consulta.terminos[0], "casa") == 0 &&
+                       strcmp(consulta.terminos[3], "gato") == 0 && consulta.num_frases == 1 &&
+                       consulta.frases[0].cantidad == 2 && consulta.frases[0].desplazamientos[1] == 3;
+    printf("  analizar_consulta: %d terminos y %d frase %s\n", consulta.cantidad, consulta.num_frases,
+           analisis_ok ? "(CORRECTO)" : "(ERROR)");
+
+    indiceInvertido* indice = crear_indice_silencioso(16);
+    const char* textos[] = { "casa de la pradera", "la pradera y la casa", "casa de piedra", "perro y casa" };
+    for (uint32_t d = 0; indice && d < 4; d++) {
+        char url[16];
+        snprintf(url, sizeof(url), "doc %u", (unsigned)d);
+        uint32_t id = registrar_documento(indice->documentos, url, strlen(url));
+        fijar_largo_documento(indice->documentos, id, tokenizar_e_indexar_contenido(textos[d], id, indice));
+    }
+
+    // Una consulta con ID propio, una linea vacia, una sin ID y una sin resultados.
+    FILE* f = fopen(TEST_CONSULTAS_FILE, "w");
+    if (f) {
+        fprintf(f, "q1\tcasa pradera\n\ncasa\nnoexiste\n");
+        fclose(f);
+    }
+    FILE* salida = tmpfile();
+    EstadisticasLote lote;
+    bool lote_ok = indice && salida && correr_lote_consultas(indice, TEST_CONSULTAS_FILE, salida, FORMATO_TSV, false, 10, 1, &lote);
+    char linea[256];
+    int lineas = 0;
+    bool primera_ok = false;
+    if (salida) {
+        rewind(salida);
+        while (fgets(linea, sizeof(linea), salida)) {
+            if (lineas++ == 0) primera_ok = strncmp(linea, "q1\t1\t", 5) == 0;
+        }
+    }
+    printf("  Lote TSV: %zu consultas, %zu sin resultados, %d lineas %s\n", lote_ok ? lote.consultas : 0,
+           lote_ok ? lote.sin_resultados : 0, lineas,
+           (lote_ok && lote.consultas == 3 && lote.sin_resultados == 1 && lineas == 6 && primera_ok &&
+            lote.latencia_p50_ms <= lote.latencia_p99_ms) ? "(CORRECTO)" : "(ERROR)");
+
+    if (salida) {
+        rewind(salida);
+        lote_ok = indice && correr_lote_consultas(indice, TEST_CONSULTAS_FILE, salida, FORMATO_TREC, true, 1, 1, &lote);
+        rewind(salida);
+        bool trec_ok = lote_ok && fgets(linea, sizeof(linea), salida) && strncmp(linea, "q1 Q0 doc_", 10) == 0 &&
+                       strstr(linea, " 1 ") && strstr(linea, " buscador");
+        printf("  Lote TREC (OR, top-1): %s", trec_ok ? linea : "(ERROR)\n");
+        printf("    Formato TREC %s\n", trec_ok ? "(CORRECTO)" : "(ERROR)");
+        fclose(salida);
+    }
+    // Con varios hilos los resultados salen iguales y en el mismo orden que con uno.
+    f = fopen(TEST_CONSULTAS_FILE, "w");
+    if (f) {
+        for (int q = 0; q < 200; q++) fprintf(f, "%s\n", (q % 3 == 0) ? "casa pradera" : (q % 3 == 1) ? "perro casa" : "piedra");
+        fclose(f);
+    }
+    FILE* con_uno = tmpfile();
+    FILE* con_varios = tmpfile();
+    bool iguales = indice && con_uno && con_varios &&
+                   correr_lote_consultas(indice, TEST_CONSULTAS_FILE, con_uno, FORMATO_TSV, true, 3, 1, NULL) &&
+                   correr_lote_consultas(indice, TEST_CONSULTAS_FILE, con_varios, FORMATO_TSV, true, 3, 4, &lote);
+    if (iguales) {
+        rewind(con_uno);
+        rewind(con_varios);
+        int a, b;
+        do {
+            a = fgetc(con_uno);
+            b = fgetc(con_varios);
+        } while (a == b && a != EOF);
+        iguales = a == b && lote.consultas == 200 && lote.hilos == 4;
+    }
+    printf("  Lote con 4 hilos igual al de 1 hilo: %s\n", iguales ? "si (CORRECTO)" : "no (ERROR)");
+    if (con_uno) fclose(con_uno);
+    if (con_varios) fclose(con_varios);
+
+    printf("  Archivo de consultas inexistente: %s\n",
+           (indice && !correr_lote_consultas(indice, "no_existe_consultas.txt", stdout, FORMATO_TSV, false, 10, 1, NULL))
+               ? "falla (CORRECTO)" : "no falla (ERROR)");
+
+    destruir_indice(indice);
+    free_stopwords();
+    remove(TEST_STOPWORDS_FILE);
+    remove(TEST_CONSULTAS_FILE);
+    imprimir_fin_test("Modulo Consultas");
+}
+
+// --- Tests para el Módulo RANKING ---
+void test_modulo_ranking() {
+    imprimir_titulo_test("Modulo Ranking");
+    // Heap de 5 sobre 1000 puntajes pseudoaleatorios (con empates): deben quedar los 5 mayores, en orden.
+    ResultadoBusqueda mejores[5];
+    HeapMejores heap;
+    iniciar_heap_mejores(&heap, mejores, 5);
+    double maximos[5] = { -1, -1, -1, -1, -1 };
+    uint32_t docs_maximos[5] = { 0 };
+    for (uint32_t i = 0; i < 1000; i++) {
+        double puntaje = (double)((i * 7919u) % 997u);
+        ofrecer_a_heap(&heap, i, puntaje);
+        // Referencia por insercion directa (mismo criterio de empate: gana el doc_id menor).
+        for (int j = 0; j < 5; j++) {
+            if (puntaje > maximos[j]) {
+                for (int m = 4; m > j; m--) { maximos[m] = maximos[m - 1]; docs_maximos[m] = docs_maximos[m - 1]; }
+                maximos[j] = puntaje;
+                docs_maximos[j] = i;
+                break;
+            }
+        }
+    }
+    size_t n = ordenar_heap_mejores(&heap);
+    bool heap_ok = (n == 5);
+    for (size_t j = 0; heap_ok && j < n; j++) {
+        heap_ok = mejores[j].doc_id == docs_maximos[j] && mejores[j].puntaje == maximos[j];
+    }
+    printf("  El heap se queda con los 5 mejores de 1000, ordenados: %s\n", heap_ok ? "si (CORRECTO)" : "no (ERROR)");
+
+    bool idf_ok = idf_bm25(1000, 1) > idf_bm25(1000, 500) && idf_bm25(1000, 1000) > 0.0;
+    printf("  IDF mayor para terminos raros y nunca negativo: %s\n", idf_ok ? "si (CORRECTO)" : "no (ERROR)");
+    bool tf_ok = puntaje_bm25_termino(1.0, 3, 10, 10.0) > puntaje_bm25_termino(1.0, 1, 10, 10.0) &&
+                 puntaje_bm25_termino(1.0, 1, 5, 10.0) > puntaje_bm25_termino(1.0, 1, 20, 10.0);
+    printf("  Mas frecuencia suma, mas largo resta: %s\n", tf_ok ? "si (CORRECTO)" : "no (ERROR)");
+
+    // Indice de 400 documentos: "comun" en todos, "par" en los pares con frecuencia variable.
+    indiceInvertido* idx = crear_indice(8);
+    if (!idx) {
+        printf("  ERROR: crear_indice fallo.\n");
+        imprimir_fin_test("Modulo Ranking");
+        return;
+    }
+    for (uint32_t d = 0; d < 400; d++) {
+        char url[16];
+        snprintf(url, sizeof(url), "doc%u", (unsigned)d);
+        uint32_t id = registrar_documento(idx->documentos, url, strlen(url));
+        uint32_t largo = 1;
+        anadir_termino(idx, "comun", id);
+        for (uint32_t f = 0; d % 2 == 0 && f < 1 + (d % 9); f++, largo++) anadir_termino(idx, "par", id);
+        fijar_largo_documento(idx->documentos, id, largo + d % 5);
+    }
+    CursorPosteo cursor_par, cursor_comun;
+    CursorPosteo* cursores[2] = { &cursor_par, &cursor_comun };
+    abrir_cursor_termino(idx, "par", &cursor_par);
+    abrir_cursor_termino(idx, "comun", &cursor_comun);
+    ResultadoBusqueda top[3];
+    uint32_t total = 0;
+    size_t num_top = buscar_mejores_conjuntivo(idx, cursores, 2, top, 3, &total);
+
+    // Referencia: puntuar todos los pares y buscar los 3 mejores a mano.
+    double largo_promedio = (double)idx->documentos->suma_largos / idx->documentos->cantidad;
+    double idf_par = idf_bm25(400, 200), idf_comun = idf_bm25(400, 400);
+    bool top_ok = (num_top == 3 && total == 200);
+    for (size_t j = 0; top_ok && j < num_top; j++) {
+        uint32_t mejor_doc = 0;
+        double mejor = -1.0;
+        for (uint32_t d = 0; d < 400; d += 2) {
+            uint32_t largo = idx->documentos->largos[d];
+            double puntaje = puntaje_bm25_termino(idf_par, 1 + d % 9, largo, largo_promedio) +
+                             puntaje_bm25_termino(idf_comun, 1, largo, largo_promedio);
+            bool ya_esta = false;
+            for (size_t m = 0; m < j; m++) ya_esta = ya_esta || top[m].doc_id == d;
+            if (!ya_esta && puntaje > mejor) { mejor = puntaje; mejor_doc = d; }
+        }
+        top_ok = top[j].doc_id == mejor_doc && fabs(top[j].puntaje - mejor) < 1e-9;
+    }
+    printf("  Top-3 BM25 (%u coincidencias) igual al puntaje exhaustivo: %s\n", (unsigned)total,
+           top_ok ? "si (CORRECTO)" : "no (ERROR)");
+    destruir_indice(idx);
+
+    // OR con Block-Max WAND: 3000 documentos con un termino en todos, uno en 1 de cada 3 y uno raro,
+    // frecuencias y largos variados. Debe dar lo mismo que puntuar todo, en memoria y desde el archivo.
+    idx = crear_indice(8);
+    if (!idx) {
+        printf("  ERROR: crear_indice fallo.\n");
+        imprimir_fin_test("Modulo Ranking");
+        return;
+    }
+    for (uint32_t d = 0; d < 3000; d++) {
+        char url[16];
+        snprintf(url, sizeof(url), "doc%u", (unsigned)d);
+        uint32_t id = registrar_documento(idx->documentos, url, strlen(url));
+        uint32_t largo = 0;
+        for (uint32_t f = 0; f < 1 + (d * 7) % 5; f++, largo++) anadir_termino(idx, "todos", id);
+        for (uint32_t f = 0; d % 3 == 0 && f < 1 + (d * 13) % 4; f++, largo++) anadir_termino(idx, "tercio", id);
+        if (d % 97 == 5) { anadir_termino(idx, "raro", id); largo++; }
+        fijar_largo_documento(idx->documentos, id, largo + (d * 31) % 40);
+    }
+    preparar_cotas_bm25(idx);
+    bool guardado = guardar_indice(idx, TEST_INDICE_FILE);
+    indiceInvertido* cargado = guardado ? cargar_indice(TEST_INDICE_FILE) : NULL;
+    const char* consultas[][3] = { { "todos", "raro", NULL }, { "tercio", "todos", "raro" }, { "raro", NULL, NULL },
+                                   { "todos", NULL, NULL }, { "tercio", "nada", NULL } };
+    const size_t ks[] = { 1, 5, 50 };
+    bool o_iguales = cargado != NULL;
+    uint64_t puntuados_poda = 0, puntuados_todos = 0;
+    for (int origen = 0; origen < 2; origen++) {
+        const indiceInvertido* donde = origen == 0 ? idx : cargado;
+        for (size_t q = 0; donde && q < sizeof(consultas) / sizeof(consultas[0]); q++) {
+            for (size_t j = 0; j < sizeof(ks) / sizeof(ks[0]); j++) {
+                CursorPosteo cursores_a[3], cursores_b[3];
+                CursorPosteo* lista_a[3];
+                CursorPosteo* lista_b[3];
+                size_t n = 0;
+                for (size_t t = 0; t < 3 && consultas[q][t]; t++) {
+                    if (abrir_cursor_termino(donde, consultas[q][t], &cursores_a[n]) &&
+                        abrir_cursor_termino(donde, consultas[q][t], &cursores_b[n])) {
+                        lista_a[n] = &cursores_a[n];
+                        lista_b[n] = &cursores_b[n];
+                        n++;
+                    }
+                }
+                ResultadoBusqueda exhaustivo[50], podado[50];
+                EstadisticasBusqueda est_a, est_b;
+                size_t na = buscar_mejores_disyuntivo_exhaustivo(donde, lista_a, n, exhaustivo, ks[j], &est_a);
+                size_t nb = buscar_mejores_disyuntivo(donde, lista_b, n, podado, ks[j], &est_b);
+                o_iguales = o_iguales && na == nb && na > 0;
+                for (size_t i = 0; o_iguales && i < na; i++) {
+                    o_iguales = exhaustivo[i].doc_id == podado[i].doc_id && exhaustivo[i].puntaje == podado[i].puntaje;
+                }
+                puntuados_todos += est_a.documentos_puntuados;
+                puntuados_poda += est_b.documentos_puntuados;
+            }
+        }
+    }
+    printf("  OR con Block-Max WAND igual al puntaje exhaustivo (memoria y archivo): %s\n",
+           o_iguales ? "si (CORRECTO)" : "no (ERROR)");
+    printf("  La poda puntua menos documentos (%llu de %llu): %s\n", (unsigned long long)puntuados_poda,
+           (unsigned long long)puntuados_todos, puntuados_poda < puntuados_todos ? "si (CORRECTO)" : "no (ERROR)");
+
+    // Con cotas viejas (el indice cambio despues de calcularlas) no se poda, pero el resultado es el mismo.
+    anadir_termino(idx, "raro", 2999);
+    CursorPosteo cursor_viejo;
+    bool sin_cotas = abrir_cursor_termino(idx, "todos", &cursor_viejo) && isinf(cursor_viejo.cota_lista);
+    printf("  Tras cambiar el indice las cotas no se usan: %s\n", sin_cotas ? "si (CORRECTO)" : "no (ERROR)");
+
+    destruir_indice(cargado);
+    destruir_indice(idx);
+    remove(TEST_INDICE_FILE);
+    imprimir_fin_test("Modulo Ranking");
+}
+
+// --- Tests para el Módulo INDICE_DISCO ---
+void test_modulo_indice_disco() {
+    imprimir_titulo_test("Modulo Indice en Disco");
+    indiceInvertido* original = crear_indice(4);
+    if (!original) {
+        fprintf(stderr, "  ERROR: crear_indice fallo.\n");
+        return;
+    }
+    uint32_t doc1 = registrar_documento(original->documentos, "doc1.com", 8);
+    uint32_t doc2 = registrar_documento(original->documentos, "doc2.org", 8);
+    anadir_termino(original, "casa", doc1);
+    anadir_termino(original, "casa", doc1);
+    anadir_termino(original, "casa", doc2);
+    anadir_termino(original, "perro", doc2);
+    fijar_largo_documento(original->documentos, doc1, 2);
+    fijar_largo_documento(original->documentos, doc2, 2);
+
+    printf("  Guardando el indice en '%s'...\n", TEST_INDICE_FILE);
+    bool guardado = guardar_indice(original, TEST_INDICE_FILE);
+    printf("    guardar_indice: %s\n", guardado ? "true (CORRECTO)" : "false (ERROR)");
+
+    indiceInvertido* cargado = cargar_indice(TEST_INDICE_FILE);
+    if (cargado) {
+        // Las listas del archivo estan comprimidas: se recorren con cursores.
+        CursorPosteo cursor_casa;
+        bool hay_casa = abrir_cursor_termino(cargado, "casa", &cursor_casa);
+        bool casa_ok = hay_casa && cursor_casa.cantidad == 2 && avanzar_bloque(&cursor_casa) && cursor_casa.largo == 2 &&
+                       cursor_casa.doc_ids[0] == doc1 && cursor_casa.frecuencias[0] == 2 && cursor_casa.doc_ids[1] == doc2;
+        printf("    Indice cargado con %zu terminos y %u documentos %s\n", cargado->cantidad,
+               (unsigned)cargado->documentos->cantidad,
+               (cargado->cantidad == 2 && cargado->documentos->cantidad == 2) ? "(CORRECTO)" : "(ERROR)");
+        printf("    Lista de 'casa' igual a la original: %s\n", casa_ok ? "si (CORRECTO)" : "no (ERROR)");
+        printf("    URL del doc %u: %s %s\n", (unsigned)doc2, url_documento(cargado->documentos, doc2),
+               strcmp(url_documento(cargado->documentos, doc2), "doc2.org") == 0 ? "(CORRECTO)" : "(ERROR)");
+        printf("    Suma de largos: %llu %s\n", (unsigned long long)cargado->documentos->suma_largos,
+               cargado->documentos->suma_largos == 4 ? "(CORRECTO)" : "(ERROR)");
+
+        CursorPosteo cursor_perro, cursor_gato;
+        abrir_cursor_termino(cargado, "casa", &cursor_casa);
+        bool hay_perro = abrir_cursor_termino(cargado, "perro", &cursor_perro);
+        CursorPosteo* cursores[] = { &cursor_casa, &cursor_perro };
+        ListaPosteo comun = intersectar_cursores_posteo(cursores, 2);
+        printf("    Interseccion de cursores 'casa' y 'perro': %u doc(s) %s\n", (unsigned)comun.cantidad,
+               (hay_perro && comun.cantidad == 1 && comun.doc_ids[0] == doc2 && comun.frecuencias[0] == 2) ? "(CORRECTO)" : "(ERROR)");
+        free_list(&comun);
+        printf("    'gato' no esta en el indice cargado: %s\n",
+               !abrir_cursor_termino(cargado, "gato", &cursor_gato) ? "si (CORRECTO)" : "no (ERROR)");
+        anadir_termino(cargado, "gato", doc1); // Indice de solo lectura: no debe cambiar.
+        printf("    El indice cargado es de solo lectura: %s\n",
+               cargado->cantidad == 2 ? "si (CORRECTO)" : "no (ERROR)");
+        destruir_indice(cargado);
+    } else {
+        fprintf(stderr, "  ERROR: cargar_indice fallo con un archivo recien guardado.\n");
+    }
+
+    // Una URL que apunta fuera de "textos" debe rechazarse al cargar, no al leerla.
+    // offset_urls esta en el byte 48 de la cabecera (ver CabeceraIndice en indice_disco.c).
+    FILE* f = fopen(TEST_INDICE_FILE, "r+b");
+    uint64_t offset_urls = 0, fuera = UINT64_MAX / 2;
+    bool corrompido = f && fseek(f, 48, SEEK_SET) == 0 && fread(&offset_urls, sizeof(offset_urls), 1, f) == 1 &&
+                      fseek(f, (long)(offset_urls + sizeof(uint64_t) * doc2), SEEK_SET) == 0 &&
+                      fwrite(&fuera, sizeof(fuera), 1, f) == 1;
+    if (f) fclose(f);
+    indiceInvertido* url_fuera = corrompido ? cargar_indice(TEST_INDICE_FILE) : NULL;
+    printf("  Cargar un indice con una URL fuera de rango devuelve NULL: %s\n",
+           (corrompido && url_fuera == NULL) ? "si (CORRECTO)" : "no (ERROR)");
+    destruir_indice(url_fuera);
+
+    // Un archivo que no es indice debe rechazarse en vez de cargarse a medias.
+    f = fopen(TEST_INDICE_FILE, "wb");
+    if (f) {
+        fprintf(f, "esto no es un indice");
+        fclose(f);
+    }
+    indiceInvertido* invalido = cargar_indice(TEST_INDICE_FILE);
+    printf("  Cargar un archivo invalido devuelve NULL: %s\n", invalido == NULL ? "si (CORRECTO)" : "no (ERROR)");
+    destruir_indice(invalido);
+
+    destruir_indice(original);
+    remove(TEST_INDICE_FILE);
+    imprimir_fin_test("Modulo Indice en Disco");
+}
+
+// --- Tests para el Módulo TOKENIZADOR ---
+void test_modulo_tokenizador() {
+    imprimir_titulo_test("Modulo Tokenizador");
+    const char* texto = "  Hola, MUNDO-feliz! “comillas” (x)";
+    const char* esperados[] = { "hola", "mundo", "feliz", "comillas", "x" };
+    size_t num_esperados = sizeof(esperados) / sizeof(esperados[0]);
+
+    Tokenizador tokenizador;
+    Token token;
+    iniciar_tokenizador(&tokenizador, texto, strlen(texto));
+    size_t encontrados = 0;
+    bool iguales = true;
+    while (siguiente_token(&tokenizador, &token)) {
+        if (encontrados >= num_esperados || strcmp(token.texto, esperados[encontrados]) != 0) iguales = false;
+        encontrados++;
+    }
+    printf("  Tokens de \"%s\": %zu en minusculas y en orden %s\n", texto, encontrados,
+           (iguales && encontrados == num_esperados) ? "(CORRECTO)" : "(ERROR)");
+
+    iniciar_tokenizador(&tokenizador, texto, strlen(texto));
+    siguiente_token(&tokenizador, &token);
+    siguiente_token(&tokenizador, &token);
+    printf("  El token 'mundo' apunta al texto original: %s\n",
+           (token.largo == 5 && strncmp(token.inicio, "MUNDO", 5) == 0) ? "si (CORRECTO)" : "no (ERROR)");
+
+    // Dos tokenizadores intercalados no se pisan (strtok no lo permitia).
+    Tokenizador otro;
+    Token token_otro;
+    iniciar_tokenizador(&tokenizador, "uno dos", 7);
+    iniciar_tokenizador(&otro, "tres cuatro", 11);
+    siguiente_token(&tokenizador, &token);
+    siguiente_token(&otro, &token_otro);
+    siguiente_token(&tokenizador, &token);
+    printf("  Tokenizadores intercalados: '%s' y '%s' %s\n", token.texto, token_otro.texto,
+           (strcmp(token.texto, "dos") == 0 && strcmp(token_otro.texto, "tres") == 0) ? "(CORRECTO)" : "(ERROR)");
+
+    char largo[400];
+    memset(largo, 'a', sizeof(largo) - 1);
+    largo[sizeof(largo) - 1] = '\0';
+    iniciar_tokenizador(&tokenizador, largo, strlen(largo));
+    siguiente_token(&tokenizador, &token);
+    printf("  Token de %zu caracteres se corta a %zu: %s\n", token.largo, token.largo_texto,
+           (token.largo == 399 && token.largo_texto == MAX_LARGO_TERMINO) ? "(CORRECTO)" : "(ERROR)");
+
+    iniciar_tokenizador(&tokenizador, " ,.; ", 5);
+    printf("  Texto sin tokens: %s\n", !siguiente_token(&tokenizador, &token) ? "ninguno (CORRECTO)" : "alguno (ERROR)");
+    imprimir_fin_test("Modulo Tokenizador");
+}
+
+// --- Tests para el Módulo ARENA ---
+void test_modulo_arena() {
+    imprimir_titulo_test("Modulo Arena");
+    Arena arena;
+    iniciar_arena(&arena, 64);
+    char* a = copiar_texto_en_arena(&arena, "hola mundo", 4);
+    char* b = copiar_texto_en_arena(&arena, "adios", 5);
+    void* grande = reservar_en_arena(&arena, 1000); // Mas grande que el bloque: bloque propio.
+    char* c = copiar_texto_en_arena(&arena, "sigue", 5);
+    printf("  Copias en la arena: '%s', '%s', '%s' %s\n", a, b, c,
+           (a && b && c && grande && strcmp(a, "hola") == 0 && strcmp(b, "adios") == 0 &&
+            strcmp(c, "sigue") == 0 && ((uintptr_t)b % 8) == 0) ? "(CORRECTO)" : "(ERROR)");
+
+    Arena otra;
+    iniciar_arena(&otra, 64);
+    char* d = copiar_texto_en_arena(&otra, "adoptada", 8);
+    adoptar_arena(&arena, &otra);
+    printf("  Texto de una arena adoptada sigue valido: %s\n",
+           (d && strcmp(d, "adoptada") == 0 && otra.bloques == NULL) ? "si (CORRECTO)" : "no (ERROR)");
+    liberar_arena(&otra);
+    liberar_arena(&arena);
+
+    PoolPosteos pool;
+    iniciar_pool_posteos(&pool);
+    ListaPosteo lista = LISTA_POSTEO_VACIA;
+    bool ok = true;
+    for (uint32_t id = 0; id < 100; id++) {
+        ok = agregar_posteo_en_pool(&lista, id * 2, id + 1, &pool) && ok;
+    }
+    for (uint32_t k = 0; k < lista.cantidad; k++) {
+        if (lista.doc_ids[k] != k * 2 || lista.frecuencias[k] != k + 1) ok = false;
+    }
+    printf("  Lista que crece del pool a malloc (%u docs, capacidad %u): %s\n", (unsigned)lista.cantidad,
+           (unsigned)lista.capacidad, (ok && lista.cantidad == 100 && lista.capacidad > CAPACIDAD_MAXIMA_POOL) ? "(CORRECTO)" : "(ERROR)");
+    liberar_lista_en_pool(&lista, &pool);
+
+    // Un bloque devuelto se reutiliza para la proxima lista de la misma clase.
+    ListaPosteo chica = LISTA_POSTEO_VACIA;
+    agregar_posteo_en_pool(&chica, 7, 1, &pool);
+    uint32_t* bloque = chica.doc_ids;
+    liberar_lista_en_pool(&chica, &pool);
+    agregar_posteo_en_pool(&chica, 9, 1, &pool);
+    printf("  Bloque del pool reutilizado: %s\n", (chica.doc_ids == bloque && chica.doc_ids[0] == 9) ? "si (CORRECTO)" : "no (ERROR)");
+    liberar_pool_posteos(&pool); // Suelta tambien los bloques de 'chica'.
+    imprimir_fin_test("Modulo Arena");
+}
+
+// --- Tests para el Módulo LECTOR_LINEAS ---
+void test_modulo_lector_lineas() {
+    imprimir_titulo_test("Modulo Lector de Lineas");
+    // Una linea de 3 MB (mas larga que un bloque de lectura), una con \r\n, una vacia y una sin \n al final.
+    size_t largo_larga = 3 * (size_t)TAMANIO_LECTURA_LINEAS;
+    FILE* f = fopen(TEST_LINEAS_FILE, "wb");
+    if (!f) {
+        perror("  [TEST_ERROR] No se pudo crear el archivo de lineas para test");
+        return;
+    }
+    fprintf(f, "larga.com||");
+    for (size_t i = 0; i < largo_larga; i++) fputc('x', f);
+    fprintf(f, "\nwindows.com||texto\r\n\nultima.com||sin salto");
+    fclose(f);
+
+    LectorLineas lector;
+    if (!abrir_lector_lineas(&lector, TEST_LINEAS_FILE)) {
+        fprintf(stderr, "  ERROR: abrir_lector_lineas fallo.\n");
+        remove(TEST_LINEAS_FILE);
+        return;
+    }
+    char* linea = NULL;
+    size_t largo = 0;
+    bool ok_larga = siguiente_linea(&lector, &linea, &largo) && largo == largo_larga + strlen("larga.com||");
+    bool ok_windows = siguiente_linea(&lector, &linea, &largo) && strcmp(linea, "windows.com||texto") == 0;
+    bool ok_vacia = siguiente_linea(&lector, &linea, &largo) && largo == 0;
+    bool ok_ultima = siguiente_linea(&lector, &linea, &largo) && strcmp(linea, "ultima.com||sin salto") == 0;
+    bool ok_fin = !siguiente_linea(&lector, &linea, &largo);
+    printf("  Linea de %zu bytes llega entera: %s\n", largo_larga, ok_larga ? "si (CORRECTO)" : "no (ERROR)");
+    printf("  Linea con \\r\\n sin el \\r: %s\n", ok_windows ? "si (CORRECTO)" : "no (ERROR)");
+    printf("  Linea vacia y ultima linea sin salto: %s\n", (ok_vacia && ok_ultima) ? "si (CORRECTO)" : "no (ERROR)");
+    printf("  Fin del archivo y bytes leidos (%llu): %s\n", (unsigned long long)lector.bytes_leidos,
+           (ok_fin && !lector.error_lectura) ? "(CORRECTO)" : "(ERROR)");
+    cerrar_lector_lineas(&lector);
+    remove(TEST_LINEAS_FILE);
+    imprimir_fin_test("Modulo Lector de Lineas");
+}
+
 // --- Tests para el Módulo PARSER ---
 void test_modulo_parser() {
     imprimir_titulo_test("Modulo Parser");
@@ -213,6 +942,30 @@ void test_modulo_parser() {
         printf("    Parseo Fallo (sin separador): CORRECTO, no se pudo parsear.\n");
     } else { fprintf(stderr, "    ERROR: parsear_linea parseo incorrectamente una linea sin separador.\n"); free(url3); free(contenido3); }
 
+    // separar_linea_documento: segmentos dentro de la misma linea, ultimo "||" y corridas de '|'
+    printf("  Testeando separar_linea_documento...\n");
+    const char linea4_test[] = "http://a.com/x||b||   contenido final";
+    LineaDocumento partes4;
+    if (separar_linea_documento(linea4_test, strlen(linea4_test), &partes4) &&
+        partes4.url == linea4_test && partes4.largo_url == strlen("http://a.com/x||b") &&
+        partes4.largo_contenido == strlen("contenido final") &&
+        strncmp(partes4.contenido, "contenido final", partes4.largo_contenido) == 0) {
+        printf("    Separacion OK: URL='%.*s', Contenido='%.*s'\n",
+               (int)partes4.largo_url, partes4.url, (int)partes4.largo_contenido, partes4.contenido);
+    } else { fprintf(stderr, "    ERROR: separar_linea_documento no separo bien en el ultimo \"||\".\n"); }
+
+    const char linea5_test[] = "http://a.com/y|||texto"; // "|||": el separador es el primer par, como con strstr
+    LineaDocumento partes5;
+    if (separar_linea_documento(linea5_test, strlen(linea5_test), &partes5) &&
+        partes5.largo_url == strlen("http://a.com/y") && partes5.largo_contenido == strlen("|texto")) {
+        printf("    Corrida \"|||\" OK: Contenido='%.*s'\n", (int)partes5.largo_contenido, partes5.contenido);
+    } else { fprintf(stderr, "    ERROR: separar_linea_documento eligio mal el separador en \"|||\".\n"); }
+
+    LineaDocumento partes6;
+    if (separar_linea_documento("url|x", 5, &partes6)) {
+        fprintf(stderr, "    ERROR: separar_linea_documento acepto una linea sin \"||\".\n");
+    }
+
     // Test para tokenizar_e_indexar_contenido y procesar_archivo_documento (juntos)
     printf("\n  Testeando procesar_archivo_documento (que usa tokenizar_e_indexar_contenido)...\n");
     crear_archivo_test_stopwords(); // Necesitamos stopwords cargadas
@@ -233,25 +986,75 @@ void test_modulo_parser() {
         printf("    procesar_archivo_documento finalizado.\n");
         printf("    Índice despues de procesar (Cantidad: %zu, Capacidad: %zu):\n", idx_parser->cantidad, idx_parser->capacidad);
 
-        nodePtr lista_contenido = buscar_lista_posteo_termino(idx_parser, "contenido");
-        printf("      Docs para 'contenido': "); print_list(lista_contenido);
+        ListaPosteo vista_contenido;
+        const ListaPosteo* lista_contenido = buscar_lista_posteo_termino(idx_parser, "contenido", &vista_contenido) ? &vista_contenido : NULL;
+        printf("      Docs para 'contenido': "); print_list(lista_contenido, idx_parser->documentos);
 
-        nodePtr lista_casa = buscar_lista_posteo_termino(idx_parser, "casa");
-        printf("      Docs para 'casa': "); print_list(lista_casa);
+        ListaPosteo vista_casa;
+        const ListaPosteo* lista_casa = buscar_lista_posteo_termino(idx_parser, "casa", &vista_casa) ? &vista_casa : NULL;
+        printf("      Docs para 'casa': "); print_list(lista_casa, idx_parser->documentos);
 
-        nodePtr lista_perro = buscar_lista_posteo_termino(idx_parser, "perro");
-        printf("      Docs para 'perro': "); print_list(lista_perro);
+        ListaPosteo vista_perro;
+        const ListaPosteo* lista_perro = buscar_lista_posteo_termino(idx_parser, "perro", &vista_perro) ? &vista_perro : NULL;
+        printf("      Docs para 'perro': "); print_list(lista_perro, idx_parser->documentos);
         
-        nodePtr lista_indexado = buscar_lista_posteo_termino(idx_parser, "indexado");
-        printf("      Docs para 'indexado': "); print_list(lista_indexado);
+        ListaPosteo vista_indexado;
+        const ListaPosteo* lista_indexado = buscar_lista_posteo_termino(idx_parser, "indexado", &vista_indexado) ? &vista_indexado : NULL;
+        printf("      Docs para 'indexado': "); print_list(lista_indexado, idx_parser->documentos);
 
-        nodePtr lista_prueba = buscar_lista_posteo_termino(idx_parser, "prueba");
-        printf("      Docs para 'prueba': "); print_list(lista_prueba);
+        ListaPosteo vista_prueba;
+        const ListaPosteo* lista_prueba = buscar_lista_posteo_termino(idx_parser, "prueba", &vista_prueba) ? &vista_prueba : NULL;
+        printf("      Docs para 'prueba': "); print_list(lista_prueba, idx_parser->documentos);
 
     } else {
         fprintf(stderr, "    ERROR: procesar_archivo_documento fallo.\n");
     }
 
+    // La ingesta en paralelo debe dar los mismos IDs y listas que la secuencial.
+    printf("\n  Testeando procesar_archivo_documento_paralelo con 3 hilos...\n");
+    indiceInvertido* idx_paralelo = crear_indice(10);
+    if (idx_paralelo && procesar_archivo_documento_paralelo(TEST_DOCS_FILE, idx_paralelo, 3)) {
+        bool iguales = idx_paralelo->cantidad == idx_parser->cantidad &&
+                       idx_paralelo->documentos->cantidad == idx_parser->documentos->cantidad;
+        for (size_t i = 0; iguales && i < idx_parser->cantidad; i++) {
+            const ListaPosteo* esperada = &idx_parser->entradas[i].lista_documentos;
+            ListaPosteo obtenida;
+            iguales = buscar_lista_posteo_termino(idx_paralelo, idx_parser->entradas[i].palabra, &obtenida) &&
+                      obtenida.cantidad == esperada->cantidad &&
+                      memcmp(obtenida.doc_ids, esperada->doc_ids, esperada->cantidad * sizeof(uint32_t)) == 0 &&
+                      memcmp(obtenida.frecuencias, esperada->frecuencias, esperada->cantidad * sizeof(uint32_t)) == 0;
+        }
+        printf("    Indice en paralelo igual al secuencial: %s\n", iguales ? "si (CORRECTO)" : "no (ERROR)");
+    } else {
+        fprintf(stderr, "    ERROR: procesar_archivo_documento_paralelo fallo.\n");
+    }
+    destruir_indice(idx_paralelo);
+
+    // Con posiciones, la fusion de los indices parciales debe dejar las mismas posiciones que la ingesta secuencial.
+    indiceInvertido* idx_posicional = crear_indice(10);
+    indiceInvertido* idx_posicional_paralelo = crear_indice(10);
+    if (idx_posicional && idx_posicional_paralelo && activar_posiciones(idx_posicional) &&
+        activar_posiciones(idx_posicional_paralelo) && procesar_archivo_documento(TEST_DOCS_FILE, idx_posicional) &&
+        procesar_archivo_documento_paralelo(TEST_DOCS_FILE, idx_posicional_paralelo, 3)) {
+        bool iguales = idx_posicional->cantidad == idx_posicional_paralelo->cantidad;
+        for (size_t i = 0; iguales && i < idx_posicional->cantidad; i++) {
+            const ListaPosiciones* esperadas = idx_posicional->entradas[i].posiciones;
+            const ListaPosiciones* obtenidas = NULL;
+            for (size_t j = 0; j < idx_posicional_paralelo->cantidad; j++) {
+                if (strcmp(idx_posicional_paralelo->entradas[j].palabra, idx_posicional->entradas[i].palabra) == 0) {
+                    obtenidas = idx_posicional_paralelo->entradas[j].posiciones;
+                }
+            }
+            iguales = esperadas && obtenidas && esperadas->posteos == obtenidas->posteos &&
+                      esperadas->largo == obtenidas->largo && memcmp(esperadas->bytes, obtenidas->bytes, esperadas->largo) == 0;
+        }
+        printf("    Posiciones en paralelo iguales a las secuenciales: %s\n", iguales ? "si (CORRECTO)" : "no (ERROR)");
+    } else {
+        fprintf(stderr, "    ERROR: la ingesta con posiciones fallo.\n");
+    }
+    destruir_indice(idx_posicional);
+    destruir_indice(idx_posicional_paralelo);
+
     destruir_indice(idx_parser);
     free_stopwords();
     remove(TEST_STOPWORDS_FILE);
@@ -261,6 +1064,438 @@ void test_modulo_parser() {
 }
 
 
+// --- Tests para el Módulo CACHE_CONSULTAS ---
+void test_modulo_cache_consultas() {
+    imprimir_titulo_test("Modulo Cache de Consultas");
+    static ConsultaAnalizada consulta; // Static: trae los tokens de todos los terminos.
+    static char clave_a[MAX_LARGO_CLAVE_CACHE], clave_b[MAX_LARGO_CLAVE_CACHE];
+    analizar_consulta("Perro gato", &consulta);
+    size_t largo_a = armar_clave_consulta(&consulta, MODO_CACHE_CONJUNTIVO, 0, 0, clave_a);
+    analizar_consulta("gato PERRO", &consulta);
+    size_t largo_b = armar_clave_consulta(&consulta, MODO_CACHE_CONJUNTIVO, 0, 0, clave_b);
+    bool ok_orden = largo_a == largo_b && memcmp(clave_a, clave_b, largo_a) == 0;
+    largo_b = armar_clave_consulta(&consulta, MODO_CACHE_DISYUNTIVO, 10, 0, clave_b);
+    bool ok_modo = largo_a != largo_b || memcmp(clave_a, clave_b, largo_a) != 0;
+    analizar_consulta("gato gato perro", &consulta);
+    largo_b = armar_clave_consulta(&consulta, MODO_CACHE_CONJUNTIVO, 0, 0, clave_b);
+    bool ok_repetidos = largo_a != largo_b || memcmp(clave_a, clave_b, largo_a) != 0;
+    printf("  Clave: mismo orden normalizado '%s' %s, otro modo %s, repetidos %s\n", clave_a,
+           ok_orden ? "(CORRECTO)" : "(ERROR)", ok_modo ? "(CORRECTO)" : "(ERROR)", ok_repetidos ? "(CORRECTO)" : "(ERROR)");
+
+    indiceInvertido* indice = crear_indice_silencioso(16);
+    CacheConsultas cache;
+    if (!indice || !iniciar_cache_consultas(&cache, 1 << 20)) {
+        fprintf(stderr, "  ERROR: no se pudo preparar el indice o la cache.\n");
+        destruir_indice(indice);
+        return;
+    }
+    uint32_t docs[] = {1, 5, 300000};
+    uint32_t frecuencias[] = {2, 1, 7};
+    ListaPosteo lista = { docs, frecuencias, 3, 3 };
+    ListaPosteo leida = LISTA_POSTEO_VACIA;
+    bool fallo_inicial = !buscar_lista_en_cache(&cache, indice, clave_a, largo_a, &leida);
+    guardar_lista_en_cache(&cache, indice, clave_a, largo_a, &lista);
+    bool acierto = buscar_lista_en_cache(&cache, indice, clave_a, largo_a, &leida);
+    bool ok_lista = acierto && leida.cantidad == 3 && memcmp(leida.doc_ids, docs, sizeof(docs)) == 0 &&
+                    memcmp(leida.frecuencias, frecuencias, sizeof(frecuencias)) == 0;
+    free_list(&leida);
+    printf("  Lista guardada y recuperada (%llu acierto, %llu fallo): %s\n", (unsigned long long)cache.aciertos,
+           (unsigned long long)cache.fallos, (fallo_inicial && ok_lista && cache.aciertos == 1 && cache.fallos == 1) ? "(CORRECTO)" : "(ERROR)");
+
+    ResultadoBusqueda mejores[2] = { {5, 2.5}, {1, 1.25} };
+    ResultadoBusqueda copia[2];
+    size_t cantidad = 0;
+    uint64_t datos[2] = {40, 100}, datos_leidos[2] = {0, 0};
+    guardar_mejores_en_cache(&cache, indice, clave_b, largo_b, mejores, 2, datos);
+    bool ok_mejores = buscar_mejores_en_cache(&cache, indice, clave_b, largo_b, copia, &cantidad, datos_leidos) &&
+                      cantidad == 2 && copia[0].doc_id == 5 && copia[1].puntaje == 1.25 && datos_leidos[1] == 100;
+    printf("  Mejores con sus datos: %s\n", ok_mejores ? "(CORRECTO)" : "(ERROR)");
+
+    // Cualquier cambio del indice vacia la cache: el resultado guardado ya puede no ser cierto.
+    anadir_termino(indice, "gato", 7);
+    bool invalida = !buscar_lista_en_cache(&cache, indice, clave_a, largo_a, &leida) && cache.entradas == 0 &&
+                    cache.invalidaciones == 1;
+    printf("  Se invalida al cambiar el indice: %s\n", invalida ? "si (CORRECTO)" : "no (ERROR)");
+    liberar_cache_consultas(&cache);
+
+    // Una entrada mas grande que el presupuesto no se guarda. Con lugar para dos, la tercera
+    // desaloja la usada hace mas tiempo, no la primera que se guardo.
+    char claves[3][8] = {"Y|uno", "Y|dos", "Y|tres"};
+    iniciar_cache_consultas(&cache, 1);
+    guardar_lista_en_cache(&cache, indice, claves[0], strlen(claves[0]), &lista); // Mas grande que el presupuesto.
+    bool ok_grande = cache.entradas == 0;
+    liberar_cache_consultas(&cache);
+    iniciar_cache_consultas(&cache, 0); // Sin presupuesto no guarda nada.
+    guardar_lista_en_cache(&cache, indice, claves[0], strlen(claves[0]), &lista);
+    ok_grande = ok_grande && cache.entradas == 0;
+    liberar_cache_consultas(&cache);
+    iniciar_cache_consultas(&cache, 1 << 20);
+    guardar_lista_en_cache(&cache, indice, claves[0], strlen(claves[0]), &lista);
+    size_t por_entrada = cache.bytes_usados;
+    liberar_cache_consultas(&cache);
+    iniciar_cache_consultas(&cache, 2 * por_entrada + por_entrada / 2);
+    guardar_lista_en_cache(&cache, indice, claves[0], strlen(claves[0]), &lista);
+    guardar_lista_en_cache(&cache, indice, claves[1], strlen(claves[1]), &lista);
+    bool uno = buscar_lista_en_cache(&cache, indice, claves[0], strlen(claves[0]), &leida);
+    free_list(&leida);
+    guardar_lista_en_cache(&cache, indice, claves[2], strlen(claves[2]), &lista);
+    bool sigue_uno = buscar_lista_en_cache(&cache, indice, claves[0], strlen(claves[0]), &leida);
+    free_list(&leida);
+    bool salio_dos = !buscar_lista_en_cache(&cache, indice, claves[1], strlen(claves[1]), &leida);
+    printf("  LRU dentro del presupuesto (%zu de %zu bytes, %llu desalojo): %s\n", cache.bytes_usados,
+           cache.presupuesto_bytes, (unsigned long long)cache.desalojos,
+           (ok_grande && uno && sigue_uno && salio_dos && cache.desalojos == 1 &&
+            cache.bytes_usados <= cache.presupuesto_bytes) ? "(CORRECTO)" : "(ERROR)");
+    liberar_cache_consultas(&cache);
+
+    // Con segmentos la validez va por la generacion de la vista: otra generacion (una fusion o un
+    // segmento agregado) o volver a un indice la vacian; sin validar_cache_segmentos no hay cache.
+    iniciar_cache_consultas(&cache, 1 << 20);
+    bool ok_segmentos = !guardar_lista_en_cache(&cache, NULL, claves[0], strlen(claves[0]), &lista);
+    validar_cache_segmentos(&cache, 3, 10, 40);
+    ok_segmentos = ok_segmentos && guardar_lista_en_cache(&cache, NULL, claves[0], strlen(claves[0]), &lista);
+    validar_cache_segmentos(&cache, 3, 10, 40);
+    ok_segmentos = ok_segmentos && buscar_lista_en_cache(&cache, NULL, claves[0], strlen(claves[0]), &leida) &&
+                   leida.cantidad == lista.cantidad;
+    free_list(&leida);
+    validar_cache_segmentos(&cache, 4, 10, 40);
+    ok_segmentos = ok_segmentos && !buscar_lista_en_cache(&cache, NULL, claves[0], strlen(claves[0]), &leida) &&
+                   cache.invalidaciones == 1;
+    guardar_lista_en_cache(&cache, NULL, claves[0], strlen(claves[0]), &lista);
+    ok_segmentos = ok_segmentos && !buscar_lista_en_cache(&cache, indice, claves[0], strlen(claves[0]), &leida) &&
+                   cache.invalidaciones == 2 && !cache.por_segmentos;
+    printf("  Con segmentos se invalida al cambiar la generacion o al pasar a un indice: %s\n",
+           ok_segmentos ? "(CORRECTO)" : "(ERROR)");
+    liberar_cache_consultas(&cache);
+    destruir_indice(indice);
+    imprimir_fin_test("Modulo Cache de Consultas");
+}
+
+// --- Tests para los Módulos MEDICION y REGISTRO ---
+void test_modulo_medicion() {
+    imprimir_titulo_test("Modulo Medicion y Registro");
+    NivelRegistro nivel = REGISTRO_INFO;
+    bool ok_niveles = nivel_registro_desde_texto("detalle", &nivel) && nivel == REGISTRO_DETALLE &&
+                      !nivel_registro_desde_texto("todo", &nivel) && nivel == REGISTRO_DETALLE;
+    printf("  Niveles del registro por nombre: %s\n", ok_niveles ? "(CORRECTO)" : "(ERROR)");
+
+    FILE* json = tmpfile();
+    if (!json) {
+        perror("  [TEST_ERROR] No se pudo crear el archivo temporal");
+        return;
+    }
+    if (!medicion_disponible()) {
+        escribir_medicion_json(json);
+        rewind(json);
+        char linea[64] = "";
+        char* leida = fgets(linea, sizeof(linea), json);
+        printf("  Sin CON_MEDICION el JSON lo dice: %s\n",
+               (leida && strstr(linea, "\"disponible\": false")) ? "(CORRECTO)" : "(ERROR)");
+        fclose(json);
+        imprimir_fin_test("Modulo Medicion y Registro");
+        return;
+    }
+
+    crear_archivo_test_stopwords();
+    cargar_stopwords(TEST_STOPWORDS_FILE);
+    indiceInvertido* indice = crear_indice_silencioso(16);
+    reiniciar_medicion();
+    tokenizar_e_indexar_contenido("el gato y la gata", 0, indice); // Sin medir todavia: no cuenta.
+    activar_medicion(true);
+    // 6 tokens, 3 stopwords; "gato" y "perro" son nuevos, "gata" ya estaba. Posteos nuevos: 3 (doc 1).
+    tokenizar_e_indexar_contenido("el perro y la gata gato", 1, indice);
+    activar_medicion(false);
+    escribir_medicion_json(json);
+    long largo = ftell(json);
+    char* texto = (char*)calloc((size_t)largo + 1, 1);
+    rewind(json);
+    bool leido = texto && fread(texto, 1, (size_t)largo, json) == (size_t)largo;
+    fclose(json);
+    bool ok_contadores = leido && strstr(texto, "\"tokens\": 6") && strstr(texto, "\"stopwords\": 3") &&
+                         strstr(texto, "\"terminos_nuevos\": 1") && strstr(texto, "\"posteos_nuevos\": 3") &&
+                         strstr(texto, "\"hilos\": 1");
+    printf("  Contadores de tokens, stopwords, terminos y posteos: %s\n", ok_contadores ? "(CORRECTO)" : "(ERROR)");
+    if (!ok_contadores && texto) printf("%s", texto);
+    free(texto);
+    reiniciar_medicion();
+    destruir_indice(indice);
+    free_stopwords();
+    remove(TEST_STOPWORDS_FILE);
+    imprimir_fin_test("Modulo Medicion y Registro");
+}
+
+
+// Arma un indice en memoria con los documentos [desde, hasta) de 'textos' (URL "docN").
+static indiceInvertido* indice_de_documentos(const char* const textos[], int desde, int hasta) {
+    indiceInvertido* indice = crear_indice_silencioso(16);
+    for (int d = desde; indice && d < hasta; d++) {
+        char url[16];
+        snprintf(url, sizeof(url), "doc%d", d);
+        uint32_t id = registrar_documento(indice->documentos, url, strlen(url));
+        fijar_largo_documento(indice->documentos, id, tokenizar_e_indexar_contenido(textos[d], id, indice));
+    }
+    return indice;
+}
+
+// true si las busquedas con ranking (AND y OR) sobre los segmentos dan lo mismo que sobre 'completo'.
+static bool segmentos_igual_que_indice(const VistaSegmentos* vista, const indiceInvertido* completo, const char* texto) {
+    static ConsultaAnalizada consulta;
+    static EspacioConsulta espacio;
+    ResultadoBusqueda esperados[4], obtenidos[4];
+    analizar_consulta(texto, &consulta);
+    for (int disyuntiva = 0; disyuntiva <= 1; disyuntiva++) {
+        size_t n_esperados = buscar_mejores_consulta(completo, &consulta, disyuntiva, &espacio, esperados, 4);
+        size_t n_obtenidos = buscar_mejores_segmentos(vista, &consulta, disyuntiva, &espacio, obtenidos, 4, NULL, NULL);
+        if (n_esperados != n_obtenidos) return false;
+        for (size_t i = 0; i < n_esperados; i++) {
+            if (esperados[i].doc_id != obtenidos[i].doc_id || esperados[i].puntaje != obtenidos[i].puntaje) return false;
+        }
+    }
+    return true;
+}
+
+// true si los dos archivos (abiertos para leer) tienen los mismos bytes.
+static bool mismo_contenido(FILE* a, FILE* b) {
+    rewind(a);
+    rewind(b);
+    int x, y;
+    do {
+        x = fgetc(a);
+        y = fgetc(b);
+    } while (x == y && x != EOF);
+    return x == y;
+}
+
+void test_modulo_segmentos() {
+    imprimir_titulo_test("Modulo Segmentos");
+    bool ok_niveles = nivel_de_segmento(1) == 0 && nivel_de_segmento(DOCUMENTOS_NIVEL_BASE) == 0 &&
+                      nivel_de_segmento(DOCUMENTOS_NIVEL_BASE + 1) == 1 &&
+                      nivel_de_segmento(DOCUMENTOS_NIVEL_BASE * SEGMENTOS_POR_NIVEL + 1) == 2;
+    printf("  Niveles por cantidad de documentos: %s\n", ok_niveles ? "(CORRECTO)" : "(ERROR)");
+
+    crear_archivo_test_stopwords();
+    cargar_stopwords(TEST_STOPWORDS_FILE);
+    // Largos distintos por segmento: el largo promedio de cada uno no es el de la coleccion.
+    const char* textos[] = {
+        "gato perro", "gato gato raton queso pan", "perro", "raton queso", "gato perro raton",
+        "queso queso queso gato", "pan", "perro perro gato pan leche agua sal", "gato raton"
+    };
+    indiceInvertido* completo = indice_de_documentos(textos, 0, 9);
+    IndiceSegmentado* segmentado = abrir_indice_segmentado(TEST_SEGMENTOS_DIR, false);
+    if (!completo || !segmentado) {
+        fprintf(stderr, "  ERROR: no se pudo preparar el indice o el directorio de segmentos.\n");
+        destruir_indice(completo);
+        cerrar_indice_segmentado(segmentado);
+        free_stopwords();
+        remove(TEST_STOPWORDS_FILE);
+        return;
+    }
+    // Cinco segmentos (de 2, 2, 2, 2 y 1 documentos), todos del nivel 0.
+    bool agregados = true;
+    for (int desde = 0; desde < 9; desde += 2) {
+        indiceInvertido* nuevo = indice_de_documentos(textos, desde, desde + 2 < 9 ? desde + 2 : 9);
+        agregados = agregados && nuevo && agregar_segmento(segmentado, nuevo);
+        destruir_indice(nuevo);
+    }
+    printf("  Cinco segmentos agregados: %s\n", (agregados && segmentado->cantidad == 5) ? "(CORRECTO)" : "(ERROR)");
+
+    VistaSegmentos vista;
+    tomar_vista_segmentos(segmentado, &vista);
+    const char* url = url_documento_segmentos(&vista, 7);
+    bool ok_url = vista.total_documentos == 9 && url && strcmp(url, "doc7") == 0 && !url_documento_segmentos(&vista, 9);
+    printf("  doc_id de la coleccion -> URL: %s\n", ok_url ? "(CORRECTO)" : "(ERROR)");
+
+    static EspacioConsulta espacio_df;
+    CursorPosteo cursor_gato;
+    bool ok_df = abrir_cursor_termino(completo, "gato", &cursor_gato) &&
+                 documentos_con_termino_segmentos(&vista, "gato", &espacio_df.cursores[0]) == cursor_gato.cantidad &&
+                 documentos_con_termino_segmentos(&vista, "zorro", &espacio_df.cursores[0]) == 0;
+    printf("  df de un termino sumado en todos los segmentos (y 0 si no esta): %s\n", ok_df ? "(CORRECTO)" : "(ERROR)");
+
+    static ConsultaAnalizada consulta;
+    static EspacioConsulta espacio;
+    analizar_consulta("gato raton", &consulta);
+    ListaPosteo lista = buscar_conjuntivo_segmentos(&vista, &consulta, &espacio);
+    bool ok_and = lista.cantidad == 3 && lista.doc_ids[0] == 1 && lista.doc_ids[1] == 4 && lista.doc_ids[2] == 8 &&
+                  lista.frecuencias[0] == 3;
+    free_list(&lista);
+    printf("  AND sin ranking en todos los segmentos (docs 1, 4 y 8): %s\n", ok_and ? "(CORRECTO)" : "(ERROR)");
+
+    bool ok_ranking = segmentos_igual_que_indice(&vista, completo, "gato raton") &&
+                      segmentos_igual_que_indice(&vista, completo, "perro queso pan") &&
+                      segmentos_igual_que_indice(&vista, completo, "leche");
+    printf("  Ranking AND y OR igual que con un solo indice (N, df y largo promedio de la coleccion): %s\n",
+           ok_ranking ? "(CORRECTO)" : "(ERROR)");
+
+    // Modo por lotes sobre los segmentos (con varios hilos): lo mismo que sobre el indice completo.
+    FILE* f = fopen(TEST_CONSULTAS_FILE, "w");
+    if (f) {
+        for (int q = 0; q < 60; q++) fprintf(f, "q%d\t%s\n", q, (q % 3 == 0) ? "gato raton" : (q % 3 == 1) ? "perro queso pan" : "leche");
+        fclose(f);
+    }
+    FILE* de_indice = tmpfile();
+    FILE* de_segmentos = tmpfile();
+    EstadisticasLote lote;
+    bool ok_lote = f && de_indice && de_segmentos;
+    for (int disyuntiva = 0; ok_lote && disyuntiva <= 1; disyuntiva++) {
+        rewind(de_indice);
+        rewind(de_segmentos);
+        ok_lote = correr_lote_consultas(completo, TEST_CONSULTAS_FILE, de_indice, FORMATO_TSV, disyuntiva, 3, 1, NULL) &&
+                  correr_lote_consultas_segmentos(segmentado, TEST_CONSULTAS_FILE, de_segmentos, FORMATO_TSV, disyuntiva,
+                                                  3, 3, &lote) &&
+                  lote.consultas == 60 && mismo_contenido(de_indice, de_segmentos);
+    }
+    printf("  Lote de consultas (AND y OR, 3 hilos) igual que con un solo indice: %s\n", ok_lote ? "(CORRECTO)" : "(ERROR)");
+    if (de_indice) fclose(de_indice);
+    if (de_segmentos) fclose(de_segmentos);
+    remove(TEST_CONSULTAS_FILE);
+
+    // La fusion junta los cuatro primeros; la vista tomada antes sigue viendo los segmentos viejos.
+    size_t fusiones = fusionar_segmentos_pendientes(segmentado);
+    bool ok_fusion = fusiones == 1 && segmentado->cantidad == 2 && vista.cantidad == 5 &&
+                     segmentos_igual_que_indice(&vista, completo, "gato raton");
+    soltar_vista_segmentos(segmentado, &vista);
+    tomar_vista_segmentos(segmentado, &vista);
+    ok_fusion = ok_fusion && vista.total_documentos == 9 && segmentos_igual_que_indice(&vista, completo, "gato raton") &&
+                segmentos_igual_que_indice(&vista, completo, "perro queso pan");
+    soltar_vista_segmentos(segmentado, &vista);
+    char ruta[256];
+    snprintf(ruta, sizeof(ruta), "%s/seg_00000000.idx", TEST_SEGMENTOS_DIR);
+    FILE* viejo = fopen(ruta, "rb");
+    if (viejo) fclose(viejo);
+    printf("  Politica por niveles: 4 segmentos del nivel 0 fusionados, resultados iguales, archivos viejos borrados: %s\n",
+           (ok_fusion && !viejo) ? "(CORRECTO)" : "(ERROR)");
+
+    // El catalogo queda en el disco: al reabrir estan los mismos segmentos.
+    cerrar_indice_segmentado(segmentado);
+    segmentado = abrir_indice_segmentado(TEST_SEGMENTOS_DIR, true);
+    bool ok_reabrir = segmentado && segmentado->cantidad == 2 && tomar_vista_segmentos(segmentado, &vista) &&
+                      vista.total_documentos == 9;
+    if (ok_reabrir) soltar_vista_segmentos(segmentado, &vista);
+    printf("  Catalogo reabierto (con el hilo de fusiones): %s\n", ok_reabrir ? "(CORRECTO)" : "(ERROR)");
+
+    cerrar_indice_segmentado(segmentado);
+    destruir_indice(completo);
+    free_stopwords();
+    remove(TEST_STOPWORDS_FILE);
+    const char* archivos[] = { "seg_00000004.idx", "seg_00000005.idx", CATALOGO_SEGMENTOS, "bloqueo" };
+    for (size_t i = 0; i < sizeof(archivos) / sizeof(archivos[0]); i++) {
+        snprintf(ruta, sizeof(ruta), "%s/%s", TEST_SEGMENTOS_DIR, archivos[i]);
+        remove(ruta);
+    }
+    remove(TEST_SEGMENTOS_DIR);
+    imprimir_fin_test("Modulo Segmentos");
+}
+
+
+// true si 'palabra' tiene en los dos indices cargados la misma lista (documentos y frecuencias).
+static bool misma_lista_en_archivos(const indiceInvertido* a, const indiceInvertido* b, const char* palabra) {
+    CursorPosteo cursor_a, cursor_b;
+    if (!abrir_cursor_termino(a, palabra, &cursor_a) || !abrir_cursor_termino(b, palabra, &cursor_b) ||
+        cursor_a.cantidad != cursor_b.cantidad) {
+        return false;
+    }
+    while (avanzar_bloque(&cursor_a)) {
+        if (!avanzar_bloque(&cursor_b) || cursor_a.largo != cursor_b.largo) return false;
+        for (uint32_t i = 0; i < cursor_a.largo; i++) {
+            if (cursor_a.doc_ids[i] != cursor_b.doc_ids[i] || cursor_a.frecuencias[i] != cursor_b.frecuencias[i]) return false;
+        }
+    }
+    return !avanzar_bloque(&cursor_b);
+}
+
+static long tamanio_archivo(const char* ruta) {
+    FILE* f = fopen(ruta, "rb");
+    if (!f) return -1;
+    fseek(f, 0, SEEK_END);
+    long tamanio = ftell(f);
+    fclose(f);
+    return tamanio;
+}
+
+void test_modulo_indice_externo() {
+    imprimir_titulo_test("Modulo Indice Externo");
+    crear_archivo_test_stopwords();
+    cargar_stopwords(TEST_STOPWORDS_FILE);
+    // Mas documentos que CORRIDAS_POR_FUSION: con un presupuesto de 1 byte cada uno es una corrida,
+    // asi tambien se prueban las fusiones intermedias. Una linea mala no debe correr los IDs.
+    const char* palabras[] = { "gato", "perro", "raton", "queso", "pan", "leche", "agua", "sal", "casa", "arbol" };
+    FILE* f = fopen(TEST_DOCS_FILE, "w");
+    if (!f) {
+        perror("  [TEST_ERROR] No se pudo crear el archivo de documentos para test");
+        free_stopwords();
+        remove(TEST_STOPWORDS_FILE);
+        return;
+    }
+    int documentos = CORRIDAS_POR_FUSION + 16;
+    for (int d = 0; d < documentos; d++) {
+        fprintf(f, "doc%d.com||", d);
+        for (int t = 0; t <= d % 7; t++) {
+            fprintf(f, "%s %s ", palabras[(d * 3 + t) % 10], t % 3 == 0 ? "el" : "de");
+        }
+        fprintf(f, "%s\n", d % 11 == 0 ? "unica" : "");
+        if (d == 5) fprintf(f, "linea_sin_separador\n");
+    }
+    fclose(f);
+
+    indiceInvertido* en_memoria = crear_indice_silencioso(16);
+    bool ok_memoria = en_memoria && procesar_archivo_documento(TEST_DOCS_FILE, en_memoria) &&
+                      guardar_indice(en_memoria, TEST_INDICE_FILE);
+    bool construido = construir_indice_externo(TEST_DOCS_FILE, TEST_INDICE_EXTERNO_FILE, 1);
+    printf("  Construccion por corridas con presupuesto minimo: %s\n", (ok_memoria && construido) ? "(CORRECTO)" : "(ERROR)");
+
+    long tamanio_memoria = tamanio_archivo(TEST_INDICE_FILE);
+    long tamanio_externo = tamanio_archivo(TEST_INDICE_EXTERNO_FILE);
+    printf("  Mismo tamanio que guardar_indice: %ld vs %ld bytes %s\n", tamanio_externo, tamanio_memoria,
+           (tamanio_memoria > 0 && tamanio_memoria == tamanio_externo) ? "(CORRECTO)" : "(ERROR)");
+
+    indiceInvertido* esperado = cargar_indice(TEST_INDICE_FILE);
+    indiceInvertido* externo = cargar_indice(TEST_INDICE_EXTERNO_FILE);
+    if (esperado && externo && en_memoria) {
+        bool ok_documentos = externo->documentos->cantidad == (uint32_t)documentos &&
+                             externo->documentos->suma_largos == esperado->documentos->suma_largos &&
+                             externo->cantidad == esperado->cantidad;
+        for (uint32_t id = 0; ok_documentos && id < (uint32_t)documentos; id++) {
+            ok_documentos = strcmp(url_documento(externo->documentos, id), url_documento(esperado->documentos, id)) == 0 &&
+                            externo->documentos->largos[id] == esperado->documentos->largos[id];
+        }
+        printf("  Documentos (URLs, largos) y vocabulario iguales: %s\n", ok_documentos ? "(CORRECTO)" : "(ERROR)");
+        bool ok_listas = true;
+        for (size_t i = 0; ok_listas && i < en_memoria->cantidad; i++) {
+            ok_listas = misma_lista_en_archivos(esperado, externo, en_memoria->entradas[i].palabra);
+        }
+        CursorPosteo cursor;
+        printf("  Listas de los %zu terminos iguales y sin stopwords: %s\n", en_memoria->cantidad,
+               (ok_listas && !abrir_cursor_termino(externo, "el", &cursor)) ? "(CORRECTO)" : "(ERROR)");
+    } else {
+        fprintf(stderr, "  ERROR: no se pudieron cargar los indices a comparar.\n");
+    }
+    destruir_indice(esperado);
+    destruir_indice(externo);
+    destruir_indice(en_memoria);
+
+    // No quedan corridas ni textos temporales junto al indice.
+    char ruta[256];
+    snprintf(ruta, sizeof(ruta), "%s.corrida0.voc", TEST_INDICE_EXTERNO_FILE);
+    long corrida = tamanio_archivo(ruta);
+    snprintf(ruta, sizeof(ruta), "%s.textos", TEST_INDICE_EXTERNO_FILE);
+    printf("  Archivos temporales borrados: %s\n", (corrida < 0 && tamanio_archivo(ruta) < 0) ? "(CORRECTO)" : "(ERROR)");
+
+    // Si falta el archivo de documentos no se deja un indice a medias.
+    remove(TEST_INDICE_EXTERNO_FILE);
+    bool fallo = !construir_indice_externo("no_existe.dat", TEST_INDICE_EXTERNO_FILE, 1 << 20);
+    printf("  Sin archivo de documentos falla y no crea el indice: %s\n",
+           (fallo && tamanio_archivo(TEST_INDICE_EXTERNO_FILE) < 0) ? "(CORRECTO)" : "(ERROR)");
+
+    free_stopwords();
+    remove(TEST_STOPWORDS_FILE);
+    remove(TEST_DOCS_FILE);
+    remove(TEST_INDICE_FILE);
+    remove(TEST_INDICE_EXTERNO_FILE);
+    imprimir_fin_test("Modulo Indice Externo");
+}
+
+
 // --- Main para las Pruebas ---
 int main(void) {
     printf("=============================================\n");
@@ -269,8 +1504,21 @@ int main(void) {
 
     test_modulo_stopwords();
     test_modulo_list();
+    test_modulo_arena();
     test_modulo_inverted_index();
+    test_modulo_interseccion();
+    test_modulo_posteo_comprimido();
+    test_modulo_posiciones();
+    test_modulo_ranking();
+    test_modulo_indice_disco();
+    test_modulo_tokenizador();
+    test_modulo_lector_lineas();
     test_modulo_parser();
+    test_modulo_consultas();
+    test_modulo_cache_consultas();
+    test_modulo_medicion();
+    test_modulo_segmentos();
+    test_modulo_indice_externo();
 
     printf("\n=============================================\n");
     printf("====== FIN DE TODAS LAS PRUEBAS       ======\n");
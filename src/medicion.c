@@ -0,0 +1,148 @@
+#include "includes/medicion.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#define LECTURAS_CALIBRACION 1000
+
+static const char* const NOMBRES_FASES[NUM_FASES] = {
+    "leer", "parsear", "tokenizar", "stopwords", "insertar", "fusionar", "intersectar", "imprimir"
+};
+static const char* const NOMBRES_CONTADORES[NUM_CONTADORES] = {
+    "lineas", "bytes_leidos", "tokens", "stopwords", "posteos_nuevos", "terminos_nuevos",
+    "asignaciones", "bytes_reservados", "consultas", "cache_aciertos", "cache_fallos"
+};
+
+#ifdef CON_MEDICION
+
+bool g_medicion_activa = false;
+uint64_t g_costo_reloj_nanos = 0;
+_Thread_local MedicionHilo* t_medicion = NULL;
+
+// --- Variables Estáticas (internas a este módulo) ---
+static MedicionHilo* g_hilos_medidos = NULL;   // Lista de las mediciones de cada hilo.
+static size_t g_cantidad_hilos = 0;
+static pthread_mutex_t g_mutex_medicion = PTHREAD_MUTEX_INITIALIZER;
+
+MedicionHilo* registrar_medicion_hilo(void) {
+    MedicionHilo* medicion = (MedicionHilo*)calloc(1, sizeof(MedicionHilo));
+    if (!medicion) return NULL; // Sin memoria no se mide este hilo; el programa sigue igual.
+    pthread_mutex_lock(&g_mutex_medicion);
+    medicion->siguiente = g_hilos_medidos;
+    g_hilos_medidos = medicion;
+    g_cantidad_hilos++;
+    pthread_mutex_unlock(&g_mutex_medicion);
+    t_medicion = medicion;
+    return medicion;
+}
+
+uint64_t medicion_nanos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// Costo de una lectura del reloj: el minimo de varias tandas, para no contar interrupciones.
+static uint64_t calibrar_costo_reloj(void) {
+    uint64_t minimo = UINT64_MAX;
+    for (int tanda = 0; tanda < 5; tanda++) {
+        uint64_t inicio = medicion_nanos();
+        for (int i = 0; i < LECTURAS_CALIBRACION; i++) {
+            (void)medicion_nanos();
+        }
+        uint64_t costo = (medicion_nanos() - inicio) / (LECTURAS_CALIBRACION + 1);
+        if (costo < minimo) minimo = costo;
+    }
+    return minimo;
+}
+
+// Un objeto {"fases": {...}, "contadores": {...}} con lo de 'medicion'.
+static void escribir_objeto_medicion(FILE* salida, const MedicionHilo* medicion, const char* sangria) {
+    fprintf(salida, "{\n%s  \"fases\": {", sangria);
+    for (int f = 0; f < NUM_FASES; f++) {
+        fprintf(salida, "%s\n%s    \"%s\": {\"segundos\": %.6f, \"veces\": %llu}", f > 0 ? "," : "", sangria,
+                NOMBRES_FASES[f], (double)medicion->nanos[f] / 1e9, (unsigned long long)medicion->veces[f]);
+    }
+    fprintf(salida, "\n%s  },\n%s  \"contadores\": {", sangria, sangria);
+    for (int c = 0; c < NUM_CONTADORES; c++) {
+        fprintf(salida, "%s\n%s    \"%s\": %llu", c > 0 ? "," : "", sangria, NOMBRES_CONTADORES[c],
+                (unsigned long long)medicion->contadores[c]);
+    }
+    fprintf(salida, "\n%s  }\n%s}", sangria, sangria);
+}
+
+#endif // CON_MEDICION
+
+// --- Implementación de Funciones Públicas (declaradas en medicion.h) ---
+
+bool medicion_disponible(void) {
+#ifdef CON_MEDICION
+    return true;
+#else
+    return false;
+#endif
+}
+
+void activar_medicion(bool activa) {
+#ifdef CON_MEDICION
+    if (activa && !g_medicion_activa) {
+        g_costo_reloj_nanos = calibrar_costo_reloj();
+    }
+    g_medicion_activa = activa;
+#else
+    (void)activa;
+#endif
+}
+
+void escribir_medicion_json(FILE* salida) {
+    if (!salida) return;
+#ifdef CON_MEDICION
+    pthread_mutex_lock(&g_mutex_medicion);
+    MedicionHilo total;
+    memset(&total, 0, sizeof(total));
+    for (const MedicionHilo* m = g_hilos_medidos; m; m = m->siguiente) {
+        for (int f = 0; f < NUM_FASES; f++) {
+            total.nanos[f] += m->nanos[f];
+            total.veces[f] += m->veces[f];
+        }
+        for (int c = 0; c < NUM_CONTADORES; c++) {
+            total.contadores[c] += m->contadores[c];
+        }
+    }
+    // Las fases de varios hilos se suman: con --hilos N el total puede pasar el tiempo de reloj.
+    fprintf(salida, "{\n  \"disponible\": true,\n  \"muestreo_por_token\": %d,\n  \"costo_reloj_ns\": %llu,\n"
+                     "  \"hilos\": %zu,\n  \"total\": ",
+            MUESTREO_DETALLE, (unsigned long long)g_costo_reloj_nanos, g_cantidad_hilos);
+    escribir_objeto_medicion(salida, &total, "  ");
+    fprintf(salida, ",\n  \"por_hilo\": [");
+    for (const MedicionHilo* m = g_hilos_medidos; m; m = m->siguiente) {
+        fprintf(salida, "%s\n    ", m == g_hilos_medidos ? "" : ",");
+        escribir_objeto_medicion(salida, m, "    ");
+    }
+    fprintf(salida, "\n  ]\n}\n");
+    pthread_mutex_unlock(&g_mutex_medicion);
+#else
+    fprintf(salida, "{\"disponible\": false}\n");
+    (void)NOMBRES_FASES;
+    (void)NOMBRES_CONTADORES;
+#endif
+}
+
+void reiniciar_medicion(void) {
+#ifdef CON_MEDICION
+    pthread_mutex_lock(&g_mutex_medicion);
+    MedicionHilo* m = g_hilos_medidos;
+    while (m) {
+        MedicionHilo* siguiente = m->siguiente;
+        free(m);
+        m = siguiente;
+    }
+    g_hilos_medidos = NULL;
+    g_cantidad_hilos = 0;
+    t_medicion = NULL;
+    pthread_mutex_unlock(&g_mutex_medicion);
+#endif
+}
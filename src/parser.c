@@ -1,19 +1,84 @@
 #include "includes/parser.h"
 #include "includes/stopwords.h"
 #include "includes/inverted_index.h"
+#include "includes/tokenizador.h"
+#include "includes/lector_lineas.h"
+#include "includes/medicion.h"
+#include "includes/registro.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 #include <errno.h>
+#include <pthread.h>
+#include <time.h>
 
-// Función estática para convertir a minúsculas, la necesitamos aquí.
-static void parser_convertir_a_minusculas(char *cadena) {
-    if (!cadena) return;
-    for (int i = 0; cadena[i]; i++) {
-        cadena[i] = tolower((unsigned char)cadena[i]);
+// Bytes que el lector junta por bloque en la ingesta en paralelo (se agranda si una linea no cabe).
+#define TAMANIO_BLOQUE_INGESTA (4u << 20)
+// Bloques en vuelo por hilo: mientras un hilo procesa uno, ya hay otro leido esperandolo.
+#define BLOQUES_POR_HILO 2
+
+// Un bloque de lineas completas del archivo de documentos y el indice parcial que sale de el.
+typedef enum { BLOQUE_LIBRE, BLOQUE_PENDIENTE, BLOQUE_EN_PROCESO, BLOQUE_LISTO } EstadoBloque;
+
+typedef struct {
+    char* texto;                // Lineas completas seguidas de '\0'.
+    size_t largo;               // Bytes de "texto" sin contar el '\0'.
+    size_t capacidad;           // Bytes reservados en "texto".
+    EstadoBloque estado;
+    indiceInvertido* parcial;   // Resultado del hilo (NULL si fallo la memoria).
+    long lineas_leidas;
+    long lineas_ok;
+    long lineas_malas;
+} BloqueIngesta;
+
+// Estado compartido entre el lector/fusionador (hilo principal) y los hilos que indexan.
+// Los bloques forman un anillo: el bloque numero n usa bloques[n % num_bloques].
+typedef struct {
+    BloqueIngesta* bloques;
+    size_t num_bloques;
+    long bloques_leidos;        // Bloques que el lector ya dejo PENDIENTE.
+    long siguiente_a_procesar;  // Proximo bloque que toma un hilo.
+    bool sin_mas_bloques;       // El lector llego al final del archivo.
+    bool con_posiciones;        // Los indices parciales guardan posiciones (el indice final es posicional).
+    pthread_mutex_t mutex;
+    pthread_cond_t hay_trabajo;
+    pthread_cond_t hay_resultado;
+} ColaIngesta;
+
+bool separar_linea_documento(const char* linea, size_t largo, LineaDocumento* partes) {
+    if (!linea || !partes) {
+        return false;
+    }
+
+    // Una sola pasada hacia atras hasta el ultimo par "||". Si esta dentro de una corrida de mas de
+    // dos '|', se elige el mismo separador que daria buscar "||" de izquierda a derecha sin solaparse:
+    // el ultimo par completo contando desde el inicio de la corrida.
+    size_t fin_corrida = largo;
+    while (fin_corrida >= 2 && !(linea[fin_corrida - 1] == '|' && linea[fin_corrida - 2] == '|')) {
+        fin_corrida--;
     }
+    if (fin_corrida < 2) {
+        // La línea no tiene el formato "URL || Contenido" que esperamos.
+        return false;
+    }
+    size_t inicio_corrida = fin_corrida - 2;
+    while (inicio_corrida > 0 && linea[inicio_corrida - 1] == '|') {
+        inicio_corrida--;
+    }
+    size_t separador = inicio_corrida + 2 * ((fin_corrida - inicio_corrida - 2) / 2);
+
+    size_t inicio_contenido = separador + 2; // Saltamos el "||"
+    while (inicio_contenido < largo && isspace((unsigned char)linea[inicio_contenido])) {
+        inicio_contenido++; // Saltamos espacios al inicio del contenido.
+    }
+
+    partes->url = linea;
+    partes->largo_url = separador;
+    partes->contenido = linea + inicio_contenido;
+    partes->largo_contenido = largo - inicio_contenido;
+    return true;
 }
 
 // En tu parser.h los params son linea_original, url_salida, contenido_salida
@@ -27,35 +92,20 @@ bool parsear_linea(char* linea_original, char** url_salida, char** contenido_sal
     *url_salida = NULL;
     *contenido_salida = NULL;
 
-    char* ultimo_separador = NULL;
-    char* puntero_busqueda = linea_original;
-    char* ocurrencia_actual;
-
-    while ((ocurrencia_actual = strstr(puntero_busqueda, "||")) != NULL) {
-        ultimo_separador = ocurrencia_actual;
-        puntero_busqueda = ocurrencia_actual + 2; // Avanzamos para buscar la siguiente ocurrencia.
-    }
-
-    if (ultimo_separador == NULL) {
-        // La línea no tiene el formato "URL || Contenido" que esperamos.
+    LineaDocumento partes;
+    if (!separar_linea_documento(linea_original, strlen(linea_original), &partes)) {
         return false;
     }
 
-    size_t largo_url = ultimo_separador - linea_original;
-    *url_salida = (char*)malloc(largo_url + 1);
+    *url_salida = (char*)malloc(partes.largo_url + 1);
     if (!*url_salida) {
         perror("[PARSER] Fallo malloc para url_salida en parsear_linea");
         return false;
     }
-    strncpy(*url_salida, linea_original, largo_url);
-    (*url_salida)[largo_url] = '\0';
-
-    char* inicio_contenido = ultimo_separador + 2; // Saltamos el "||"
-    while (*inicio_contenido && isspace((unsigned char)*inicio_contenido)) {
-        inicio_contenido++; // Saltamos espacios al inicio del contenido.
-    }
+    memcpy(*url_salida, partes.url, partes.largo_url);
+    (*url_salida)[partes.largo_url] = '\0';
 
-    *contenido_salida = strdup(inicio_contenido);
+    *contenido_salida = strdup(partes.contenido);
     if (!*contenido_salida) {
         perror("[PARSER] Falló strdup para contenido_salida en parsear_linea");
         free(*url_salida);
@@ -67,38 +117,76 @@ bool parsear_linea(char* linea_original, char** url_salida, char** contenido_sal
     return true;
 }
 
-// En tu parser.h los params son contenido_const, documento_id, index
-void tokenizar_e_indexar_contenido(const char* contenido_const, const char* documento_id, indiceInvertido* indice) {
-    if (!contenido_const || !documento_id || !indice) {
-        return; // Sin los ingredientes, no hay receta.
-    }
+// Tokeniza e indexa los 'largo' bytes de 'contenido' (no necesita terminar en '\0').
+static uint32_t tokenizar_e_indexar_segmento(const char* contenido, size_t largo, uint32_t documento_id, indiceInvertido* indice) {
 
-    char* contenido_mutable = strdup(contenido_const);
-    if (!contenido_mutable) {
-        perror("[PARSER] Fallo strdup para contenido_mutable en tokenizar_e_indexar_contenido");
-        return;
-    }
-
-    // printf("    [PARSER_info] Tokenizando para DocID: %.70s...\n", documento_id); //VERBOSE
-    int terminos_indexados_este_doc = 0;
-    const char* delimitadores = " \t\n\r\f\v,.;:!?()[]{}-\"\'“”‘’"; // Buena artillería de separadores.
-    char* token = strtok(contenido_mutable, delimitadores);
+    // printf("    [PARSER_info] Tokenizando para DocID: %u...\n", (unsigned)documento_id); //VERBOSE
+    uint32_t terminos_indexados_este_doc = 0;
+    uint32_t posicion = 0; // Numero de orden del token, contando las stopwords (indice posicional).
+    // El tokenizador recorre el contenido sin modificarlo (ya no hace falta copiarlo) y entrega cada
+    // token en minusculas; es reentrante, asi que sirve tambien en la ingesta en paralelo.
+    Tokenizador tokenizador;
+    Token token;
+    iniciar_tokenizador(&tokenizador, contenido, largo);
+    // Cronometrar cada token costaria mas que indexarlo: solo se detallan algunos documentos.
+    MEDIR_DETALLE_DESDE(detallar, marca, documento_id);
 
-    while (token != NULL) {
-        parser_convertir_a_minusculas(token);
-        if (strlen(token) > 0 && !es_stopword(token)) { // Ojo, es_stopword es de stopwords.h
+    while (siguiente_token(&tokenizador, &token)) {
+        MEDIR_DETALLE(detallar, FASE_TOKENIZAR, marca);
+        bool es_util = !es_stopword_largo(token.texto, token.largo_texto); // Ojo, es_stopword es de stopwords.h
+        MEDIR_DETALLE(detallar, FASE_STOPWORDS, marca);
+        if (es_util) {
             // Descomenta si quieres ver cada término que se intenta indexar (¡serán millones!)
-            // printf("      [PARSER_info] Indexando término: '%s' en DocID: %s\n", token, documento_id);
-            anadir_termino(indice, token, documento_id); // Esta es de inverted_index.h
+            // printf("      [PARSER_info] Indexando término: '%s' en DocID: %u\n", token.texto, (unsigned)documento_id);
+            if (indice->con_posiciones) {
+                anadir_termino_en_posicion(indice, token.texto, documento_id, posicion);
+            } else {
+                anadir_termino(indice, token.texto, documento_id); // Esta es de inverted_index.h
+            }
+            MEDIR_DETALLE(detallar, FASE_INSERTAR, marca);
             terminos_indexados_este_doc++;
         }
-        token = strtok(NULL, delimitadores);
+        posicion++;
     }
+    MEDIR_CONTAR(CONTADOR_TOKENS, posicion);
+    MEDIR_CONTAR(CONTADOR_STOPWORDS, posicion - terminos_indexados_este_doc);
     // Descomenta si quieres un resumen por documento
     // if (terminos_indexados_este_doc > 0) {
-    //    printf("    [PARSER_info] DocID %s: %d términos útiles indexados.\n", documento_id, terminos_indexados_este_doc);
+    //    printf("    [PARSER_info] DocID %u: %u términos útiles indexados.\n", (unsigned)documento_id, terminos_indexados_este_doc);
     // }
-    free(contenido_mutable); // No olvidar la copia.
+    return terminos_indexados_este_doc;
+}
+
+// En tu parser.h los params son contenido_const, documento_id, index
+uint32_t tokenizar_e_indexar_contenido(const char* contenido_const, uint32_t documento_id, indiceInvertido* indice) {
+    if (!contenido_const || documento_id == DOC_ID_INVALIDO || !indice) {
+        return 0; // Sin los ingredientes, no hay receta.
+    }
+    return tokenizar_e_indexar_segmento(contenido_const, strlen(contenido_const), documento_id, indice);
+}
+
+static double segundos_ahora(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Ultima linea del resumen del parser: cuanto se leyo y a que velocidad.
+static void imprimir_rendimiento_ingesta(uint64_t bytes, double segundos) {
+    double megabytes = (double)bytes / (1024.0 * 1024.0);
+    printf("  Leidos %.1f MB en %.2f s (%.1f MB/s)\n", megabytes, segundos, segundos > 0 ? megabytes / segundos : 0.0);
+}
+
+// Registra el documento (la URL se copia una sola vez, a la tabla de documentos; las listas de posteo
+// solo llevan el ID) e indexa su contenido directo desde la linea. Devuelve false si no se le pudo asignar un ID.
+static bool indexar_documento(const LineaDocumento* partes, indiceInvertido* indice) {
+    uint32_t doc_id = registrar_documento(indice->documentos, partes->url, partes->largo_url);
+    if (doc_id == DOC_ID_INVALIDO) {
+        return false;
+    }
+    uint32_t largo = tokenizar_e_indexar_segmento(partes->contenido, partes->largo_contenido, doc_id, indice);
+    fijar_largo_documento(indice->documentos, doc_id, largo);
+    return true;
 }
 
 // En tu parser.h los params son nombre_archivo, index
@@ -108,60 +196,355 @@ bool procesar_archivo_documento(const char* nombre_archivo, indiceInvertido* ind
         return false;
     }
 
-    FILE* archivo_docs = fopen(nombre_archivo, "r");
-    if (!archivo_docs) {
-        fprintf(stderr, "[PARSER] No se pudo abrir el archivo de documentos '%s'! Error: %s\n", nombre_archivo, strerror(errno));
+    double inicio = segundos_ahora();
+    LectorLineas lector;
+    if (!abrir_lector_lineas(&lector, nombre_archivo)) {
+        fprintf(stderr, "[PARSER] No se pudo abrir el archivo de documentos '%s'!\n", nombre_archivo);
         return false;
     }
 
     // El mensaje inicial ya lo pone el main.c
     // printf("[PARSER] Abierto '%s'. Empezando a leer línea por línea...\n", nombre_archivo);
 
-    char buffer_linea[8192]; // Un buffer generoso, por si las líneas son kilométricas.
+    // Cada linea llega entera (sin importar su largo) y sin el \n, apuntando al buffer del lector.
+    // La URL y el contenido se usan ahi mismo, sin copiarlos.
+    char* linea = NULL;
+    size_t largo_linea = 0;
     long contador_lineas_leidas = 0;
     long lineas_parseadas_ok = 0;
     long lineas_con_formato_malo = 0;
 
-    while (fgets(buffer_linea, sizeof(buffer_linea), archivo_docs) != NULL) {
+    MEDIR_DESDE(marca);
+    while (siguiente_linea(&lector, &linea, &largo_linea)) {
+        MEDIR_FASE(FASE_LEER, marca);
         contador_lineas_leidas++;
 
         // Un reporte de cómo vamos, pa' no creer que se pegó.
         // Lo ajusté para que no reporte tan seguido si el archivo es muy grande.
         if (contador_lineas_leidas % 100000 == 0) { // Cada 100,000 líneas
-            printf("[PARSER] ... procesando línea %ld ... (%ld parseadas OK, %ld con formato malo)\n",
-                   contador_lineas_leidas, lineas_parseadas_ok, lineas_con_formato_malo);
+            REGISTRAR(REGISTRO_INFO, "[PARSER] ... procesando línea %ld ... (%ld parseadas OK, %ld con formato malo)\n",
+                      contador_lineas_leidas, lineas_parseadas_ok, lineas_con_formato_malo);
         }
 
-        buffer_linea[strcspn(buffer_linea, "\n")] = '\0'; // Sacamos el \n que deja fgets.
-
-        char* url = NULL;
-        char* contenido = NULL;
-
-        // En tu parser.h los params de parsear_linea son linea_original, url_salida, contenido_salida
-        if (parsear_linea(buffer_linea, &url, &contenido)) {
-            // En tu parser.h los params de tokenizar son contenido_const, documento_id, index
-            tokenizar_e_indexar_contenido(contenido, url, index);
-            free(url); // Liberamos lo que parsear_linea nos dio.
-            free(contenido);
-            lineas_parseadas_ok++;
+        LineaDocumento partes;
+        bool separada = separar_linea_documento(linea, largo_linea, &partes);
+        MEDIR_FASE(FASE_PARSEAR, marca);
+        if (separada) {
+            if (indexar_documento(&partes, index)) {
+                lineas_parseadas_ok++;
+            } else {
+                fprintf(stderr, "[PARSER] No se pudo registrar el documento de la línea %ld. Se salta.\n", contador_lineas_leidas);
+            }
         } else {
             // Si la línea no tenía el formato "URL || Contenido", la contamos pero no la procesamos.
             lineas_con_formato_malo++;
             // Descomenta si quieres ver cada línea que no se pudo parsear (puede ser mucho)
-            // fprintf(stderr, "[PARSER_warn] Línea %ld no tenía el formato esperado: %.70s...\n", contador_lineas_leidas, buffer_linea);
+            // fprintf(stderr, "[PARSER_warn] Línea %ld no tenía el formato esperado: %.70s...\n", contador_lineas_leidas, linea);
         }
+        MEDIR_REINICIAR(marca); // La indexacion ya se midio por token; la proxima lectura empieza aca.
     }
 
-    if (ferror(archivo_docs)) { // ¿Pasó algo mientras leíamos?
-        perror("[PARSER] Hubo un error de lectura en el archivo de documentos durante fgets");
+    bool lectura_ok = lector.fin_archivo && !lector.error_lectura;
+    if (!lectura_ok) { // ¿Pasó algo mientras leíamos?
+        fprintf(stderr, "[PARSER] Hubo un error leyendo el archivo de documentos; el indice puede quedar incompleto.\n");
     }
+    uint64_t bytes_leidos = lector.bytes_leidos;
+    cerrar_lector_lineas(&lector);
+    MEDIR_CONTAR(CONTADOR_LINEAS, contador_lineas_leidas);
+    MEDIR_CONTAR(CONTADOR_BYTES_LEIDOS, bytes_leidos);
 
-    fclose(archivo_docs);
     printf("\n[PARSER] Termino el procesamiento de '%s'!\n", nombre_archivo);
     printf("  Total de lineas leidas: %ld\n", contador_lineas_leidas);
     printf("  Lineas parseadas y procesadas correctamente: %ld\n", lineas_parseadas_ok);
     if (lineas_con_formato_malo > 0) {
         printf("  Lineas con formato 'URL || Contenido' no encontrado (saltadas): %ld\n", lineas_con_formato_malo);
     }
-    return true;
+    imprimir_rendimiento_ingesta(bytes_leidos, segundos_ahora() - inicio);
+    return lectura_ok;
+}
+
+// --- Ingesta en paralelo ---
+
+// Deja en el bloque el resto de la lectura anterior mas lo que se lea ahora, cortado en el ultimo '\n';
+// lo que queda despues de ese salto pasa a "resto" para el bloque siguiente. Una linea mas larga que
+// TAMANIO_BLOQUE_INGESTA hace crecer el bloque hasta que aparezca su salto o se acabe el archivo.
+// Devuelve false si ya no quedaba nada por leer (o si falla la memoria).
+static bool leer_bloque(FILE* archivo, BloqueIngesta* bloque, char** resto, size_t* largo_resto, size_t* capacidad_resto,
+                        uint64_t* bytes_leidos) {
+    bloque->largo = 0;
+    while (true) {
+        size_t necesario = bloque->largo + *largo_resto + TAMANIO_BLOQUE_INGESTA + 1;
+        if (necesario > bloque->capacidad) {
+            char* nuevo = (char*)realloc(bloque->texto, necesario);
+            if (!nuevo) {
+                perror("[PARSER] Fallo realloc para un bloque de la ingesta en paralelo");
+                return false;
+            }
+            bloque->texto = nuevo;
+            bloque->capacidad = necesario;
+        }
+        if (*largo_resto > 0) {
+            memcpy(bloque->texto + bloque->largo, *resto, *largo_resto);
+            bloque->largo += *largo_resto;
+            *largo_resto = 0;
+        }
+
+        size_t inicio_nuevo = bloque->largo;
+        size_t leidos = fread(bloque->texto + bloque->largo, 1, TAMANIO_BLOQUE_INGESTA, archivo);
+        bloque->largo += leidos;
+        *bytes_leidos += leidos;
+        if (leidos == 0) {
+            break; // Fin del archivo: lo que haya es la ultima linea (sin '\n').
+        }
+
+        size_t ultimo_salto = bloque->largo;
+        for (size_t i = bloque->largo; i > inicio_nuevo; i--) {
+            if (bloque->texto[i - 1] == '\n') {
+                ultimo_salto = i - 1;
+                break;
+            }
+        }
+        if (ultimo_salto == bloque->largo) {
+            continue; // Ningun salto en lo nuevo: la linea sigue en el proximo fread.
+        }
+
+        size_t largo_cola = bloque->largo - (ultimo_salto + 1);
+        if (largo_cola > *capacidad_resto) {
+            char* nuevo = (char*)realloc(*resto, largo_cola);
+            if (!nuevo) {
+                perror("[PARSER] Fallo realloc para el resto de un bloque");
+                return false;
+            }
+            *resto = nuevo;
+            *capacidad_resto = largo_cola;
+        }
+        if (largo_cola > 0) {
+            memcpy(*resto, bloque->texto + ultimo_salto + 1, largo_cola);
+        }
+        *largo_resto = largo_cola;
+        bloque->largo = ultimo_salto + 1;
+        break;
+    }
+    bloque->texto[bloque->largo] = '\0';
+    return bloque->largo > 0;
+}
+
+// Indexa las lineas de un bloque en un indice parcial propio, con IDs locales 0, 1, 2, ...
+static void procesar_bloque(BloqueIngesta* bloque, bool con_posiciones) {
+    bloque->lineas_leidas = 0;
+    bloque->lineas_ok = 0;
+    bloque->lineas_malas = 0;
+    bloque->parcial = crear_indice_silencioso(1024);
+    if (!bloque->parcial) {
+        return;
+    }
+    if (con_posiciones) {
+        activar_posiciones(bloque->parcial);
+    }
+
+    char* linea = bloque->texto;
+    char* fin = bloque->texto + bloque->largo;
+    while (linea < fin) {
+        char* salto = memchr(linea, '\n', (size_t)(fin - linea));
+        char* fin_linea = salto ? salto : fin;
+        if (fin_linea > linea && fin_linea[-1] == '\r') fin_linea--; // Igual que siguiente_linea.
+        *fin_linea = '\0';
+        bloque->lineas_leidas++;
+
+        LineaDocumento partes;
+        MEDIR_DESDE(marca);
+        bool separada = separar_linea_documento(linea, (size_t)(fin_linea - linea), &partes);
+        MEDIR_FASE(FASE_PARSEAR, marca);
+        if (separada) {
+            if (indexar_documento(&partes, bloque->parcial)) {
+                bloque->lineas_ok++;
+            } else {
+                fprintf(stderr, "[PARSER] No se pudo registrar un documento de un bloque. Se salta.\n");
+            }
+        } else {
+            bloque->lineas_malas++;
+        }
+        linea = salto ? salto + 1 : fin;
+    }
+    MEDIR_CONTAR(CONTADOR_LINEAS, bloque->lineas_leidas);
+}
+
+static void* hilo_ingesta(void* argumento) {
+    ColaIngesta* cola = (ColaIngesta*)argumento;
+    pthread_mutex_lock(&cola->mutex);
+    while (true) {
+        while (cola->siguiente_a_procesar == cola->bloques_leidos && !cola->sin_mas_bloques) {
+            pthread_cond_wait(&cola->hay_trabajo, &cola->mutex);
+        }
+        if (cola->siguiente_a_procesar == cola->bloques_leidos) {
+            break; // No quedan bloques y el lector ya termino.
+        }
+        BloqueIngesta* bloque = &cola->bloques[cola->siguiente_a_procesar % (long)cola->num_bloques];
+        cola->siguiente_a_procesar++;
+        bloque->estado = BLOQUE_EN_PROCESO;
+        pthread_mutex_unlock(&cola->mutex);
+
+        procesar_bloque(bloque, cola->con_posiciones);
+
+        pthread_mutex_lock(&cola->mutex);
+        bloque->estado = BLOQUE_LISTO;
+        pthread_cond_signal(&cola->hay_resultado);
+    }
+    pthread_mutex_unlock(&cola->mutex);
+    return NULL;
+}
+
+bool procesar_archivo_documento_paralelo(const char* nombre_archivo, indiceInvertido* index, int num_hilos) {
+    if (!nombre_archivo || !index) {
+        fprintf(stderr, "[PARSER] Error: Nombre de archivo o índice nulos en procesar_archivo_documento_paralelo.\n");
+        return false;
+    }
+    if (num_hilos <= 1) {
+        return procesar_archivo_documento(nombre_archivo, index);
+    }
+
+    double inicio = segundos_ahora();
+    FILE* archivo_docs = fopen(nombre_archivo, "rb");
+    if (!archivo_docs) {
+        fprintf(stderr, "[PARSER] No se pudo abrir el archivo de documentos '%s'! Error: %s\n", nombre_archivo, strerror(errno));
+        return false;
+    }
+
+    ColaIngesta cola;
+    memset(&cola, 0, sizeof(cola));
+    cola.num_bloques = (size_t)num_hilos * BLOQUES_POR_HILO;
+    cola.con_posiciones = index->con_posiciones;
+    cola.bloques = (BloqueIngesta*)calloc(cola.num_bloques, sizeof(BloqueIngesta));
+    pthread_t* hilos = (pthread_t*)malloc(sizeof(pthread_t) * (size_t)num_hilos);
+    if (!cola.bloques || !hilos) {
+        perror("[PARSER] Fallo la memoria para la ingesta en paralelo");
+        free(cola.bloques);
+        free(hilos);
+        fclose(archivo_docs);
+        return false;
+    }
+    pthread_mutex_init(&cola.mutex, NULL);
+    pthread_cond_init(&cola.hay_trabajo, NULL);
+    pthread_cond_init(&cola.hay_resultado, NULL);
+
+    int hilos_creados = 0;
+    while (hilos_creados < num_hilos && pthread_create(&hilos[hilos_creados], NULL, hilo_ingesta, &cola) == 0) {
+        hilos_creados++;
+    }
+    if (hilos_creados < num_hilos) {
+        fprintf(stderr, "[PARSER] Aviso: Solo se pudieron crear %d de %d hilos.\n", hilos_creados, num_hilos);
+    }
+    printf("[PARSER] Ingesta en paralelo de '%s' con %d hilos.\n", nombre_archivo, hilos_creados);
+
+    // El hilo principal lee bloques mientras haya lugar en el anillo y fusiona los listos en orden de archivo.
+    char* resto = NULL;
+    size_t largo_resto = 0, capacidad_resto = 0;
+    long siguiente_a_fusionar = 0;
+    bool fin_archivo = hilos_creados == 0; // Sin hilos no hay quien procese: no se lee nada.
+    bool fusion_ok = hilos_creados > 0;
+    long lineas_leidas = 0, lineas_ok = 0, lineas_malas = 0;
+    long siguiente_reporte = 100000;
+    uint64_t bytes_leidos = 0;
+
+    while (true) {
+        BloqueIngesta* listo = NULL;
+        pthread_mutex_lock(&cola.mutex);
+        while (true) {
+            if (siguiente_a_fusionar < cola.bloques_leidos) {
+                BloqueIngesta* proximo = &cola.bloques[siguiente_a_fusionar % (long)cola.num_bloques];
+                if (proximo->estado == BLOQUE_LISTO) {
+                    listo = proximo;
+                    break;
+                }
+            } else if (fin_archivo) {
+                break; // Todo lo leido ya se fusiono.
+            }
+            if (!fin_archivo && cola.bloques_leidos - siguiente_a_fusionar < (long)cola.num_bloques) {
+                break; // Hay un bloque libre para leer.
+            }
+            pthread_cond_wait(&cola.hay_resultado, &cola.mutex);
+        }
+        pthread_mutex_unlock(&cola.mutex);
+
+        if (listo) {
+            if (!listo->parcial) {
+                fprintf(stderr, "[PARSER] Un bloque no se pudo indexar por falta de memoria.\n");
+                fusion_ok = false;
+            } else if (fusion_ok) {
+                MEDIR_DESDE(marca);
+                bool fusionado = fusionar_indice(index, listo->parcial);
+                MEDIR_FASE(FASE_FUSIONAR, marca);
+                if (!fusionado) {
+                    fprintf(stderr, "[PARSER] Fallo la fusion de un bloque con el indice.\n");
+                    fusion_ok = false;
+                }
+            }
+            destruir_indice(listo->parcial);
+            listo->parcial = NULL;
+            lineas_leidas += listo->lineas_leidas;
+            lineas_ok += listo->lineas_ok;
+            lineas_malas += listo->lineas_malas;
+            listo->estado = BLOQUE_LIBRE;
+            siguiente_a_fusionar++;
+            if (lineas_leidas >= siguiente_reporte) {
+                REGISTRAR(REGISTRO_INFO, "[PARSER] ... procesando línea %ld ... (%ld parseadas OK, %ld con formato malo)\n",
+                          lineas_leidas, lineas_ok, lineas_malas);
+                siguiente_reporte = (lineas_leidas / 100000 + 1) * 100000;
+            }
+            continue;
+        }
+        if (fin_archivo) {
+            break;
+        }
+
+        // Solo el hilo principal toca los bloques libres, asi que se lee sin el mutex.
+        BloqueIngesta* libre = &cola.bloques[cola.bloques_leidos % (long)cola.num_bloques];
+        MEDIR_DESDE(marca);
+        bool hay_bloque = leer_bloque(archivo_docs, libre, &resto, &largo_resto, &capacidad_resto, &bytes_leidos);
+        MEDIR_FASE(FASE_LEER, marca);
+        pthread_mutex_lock(&cola.mutex);
+        if (hay_bloque) {
+            libre->estado = BLOQUE_PENDIENTE;
+            cola.bloques_leidos++;
+            pthread_cond_signal(&cola.hay_trabajo);
+        } else {
+            fin_archivo = true;
+            cola.sin_mas_bloques = true;
+            pthread_cond_broadcast(&cola.hay_trabajo);
+        }
+        pthread_mutex_unlock(&cola.mutex);
+    }
+
+    pthread_mutex_lock(&cola.mutex);
+    cola.sin_mas_bloques = true;
+    pthread_cond_broadcast(&cola.hay_trabajo);
+    pthread_mutex_unlock(&cola.mutex);
+    for (int i = 0; i < hilos_creados; i++) {
+        pthread_join(hilos[i], NULL);
+    }
+
+    if (ferror(archivo_docs)) {
+        perror("[PARSER] Hubo un error de lectura en el archivo de documentos");
+        fusion_ok = false;
+    }
+    fclose(archivo_docs);
+    for (size_t i = 0; i < cola.num_bloques; i++) {
+        free(cola.bloques[i].texto);
+    }
+    free(cola.bloques);
+    free(hilos);
+    free(resto);
+    pthread_mutex_destroy(&cola.mutex);
+    pthread_cond_destroy(&cola.hay_trabajo);
+    pthread_cond_destroy(&cola.hay_resultado);
+    MEDIR_CONTAR(CONTADOR_BYTES_LEIDOS, bytes_leidos);
+
+    printf("\n[PARSER] Termino el procesamiento en paralelo de '%s'!\n", nombre_archivo);
+    printf("  Total de lineas leidas: %ld\n", lineas_leidas);
+    printf("  Lineas parseadas y procesadas correctamente: %ld\n", lineas_ok);
+    if (lineas_malas > 0) {
+        printf("  Lineas con formato 'URL || Contenido' no encontrado (saltadas): %ld\n", lineas_malas);
+    }
+    imprimir_rendimiento_ingesta(bytes_leidos, segundos_ahora() - inicio);
+    return fusion_ok;
 }
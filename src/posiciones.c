@@ -0,0 +1,148 @@
+#include "includes/posiciones.h"
+#include "includes/posteo_comprimido.h"
+#include "includes/medicion.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#define CAPACIDAD_INICIAL_POSICIONES 16
+
+// --- Funciones Estáticas ---
+
+static bool reservar_bytes(ListaPosiciones* posiciones, size_t necesarios) {
+    if (necesarios <= posiciones->capacidad) return true;
+    size_t capacidad = posiciones->capacidad > 0 ? posiciones->capacidad : CAPACIDAD_INICIAL_POSICIONES;
+    while (capacidad < necesarios) {
+        capacidad *= 2;
+    }
+    uint8_t* bytes = (uint8_t*)realloc(posiciones->bytes, capacidad);
+    if (!bytes) {
+        perror("[POSICIONES] Fallo realloc para las posiciones");
+        return false;
+    }
+    posiciones->bytes = bytes;
+    posiciones->capacidad = capacidad;
+    MEDIR_ASIGNACION(capacidad);
+    return true;
+}
+
+// Cuenta un posteo nuevo; si empieza un bloque, anota donde empiezan sus posiciones.
+static bool empezar_posteo(ListaPosiciones* posiciones) {
+    if (posiciones->posteos % POSTEOS_POR_BLOQUE == 0) {
+        uint32_t bloque = posiciones->posteos / POSTEOS_POR_BLOQUE;
+        if (bloque >= posiciones->capacidad_bloques) {
+            uint32_t capacidad = posiciones->capacidad_bloques > 0 ? posiciones->capacidad_bloques * 2 : 1;
+            uint32_t* inicio = (uint32_t*)realloc(posiciones->inicio_bloques, (size_t)capacidad * sizeof(uint32_t));
+            if (!inicio) {
+                perror("[POSICIONES] Fallo realloc para el inicio de los bloques");
+                return false;
+            }
+            posiciones->inicio_bloques = inicio;
+            posiciones->capacidad_bloques = capacidad;
+            MEDIR_ASIGNACION((size_t)capacidad * sizeof(uint32_t));
+        }
+        posiciones->inicio_bloques[bloque] = (uint32_t)posiciones->largo;
+    }
+    posiciones->posteos++;
+    posiciones->ultima = 0;
+    return true;
+}
+
+// Salta 'cantidad' numeros VByte (basta contar los bytes que terminan un numero).
+static const uint8_t* saltar_vbytes(const uint8_t* p, const uint8_t* fin, uint64_t cantidad) {
+    while (cantidad > 0 && p < fin) {
+        if (*p++ < 0x80) cantidad--;
+    }
+    return cantidad == 0 ? p : NULL;
+}
+
+// --- Implementación de Funciones Públicas (declaradas en posiciones.h) ---
+
+ListaPosiciones* crear_lista_posiciones(void) {
+    ListaPosiciones* posiciones = (ListaPosiciones*)calloc(1, sizeof(ListaPosiciones));
+    if (!posiciones) {
+        perror("[POSICIONES] Fallo calloc para una lista de posiciones");
+    }
+    return posiciones;
+}
+
+void destruir_lista_posiciones(ListaPosiciones* posiciones) {
+    if (!posiciones) return;
+    free(posiciones->bytes);
+    free(posiciones->inicio_bloques);
+    free(posiciones);
+}
+
+bool agregar_posicion(ListaPosiciones* posiciones, bool nuevo_posteo, uint32_t posicion) {
+    if (!posiciones) return false;
+    if (!reservar_bytes(posiciones, posiciones->largo + MAX_BYTES_VBYTE)) return false;
+    if ((nuevo_posteo || posiciones->posteos == 0) && !empezar_posteo(posiciones)) return false;
+    uint32_t diferencia = posicion >= posiciones->ultima ? posicion - posiciones->ultima : 0;
+    posiciones->largo = (size_t)(escribir_vbyte(posiciones->bytes + posiciones->largo, diferencia) - posiciones->bytes);
+    posiciones->ultima = posicion;
+    return true;
+}
+
+bool concatenar_posiciones(ListaPosiciones* destino, const ListaPosiciones* origen, const uint32_t* frecuencias_origen) {
+    if (!destino || !origen || origen->posteos == 0) return true;
+    if (!frecuencias_origen || !reservar_bytes(destino, destino->largo + origen->largo)) return false;
+    // Los bloques de 'destino' no coinciden con los de 'origen': se recorre para anotar donde empieza cada uno.
+    const uint8_t* p = origen->bytes;
+    const uint8_t* fin = origen->bytes + origen->largo;
+    for (uint32_t i = 0; i < origen->posteos; i++) {
+        if (!empezar_posteo(destino)) return false;
+        const uint8_t* siguiente = saltar_vbytes(p, fin, frecuencias_origen[i]);
+        if (!siguiente) return false;
+        memcpy(destino->bytes + destino->largo, p, (size_t)(siguiente - p));
+        destino->largo += (size_t)(siguiente - p);
+        p = siguiente;
+    }
+    destino->ultima = origen->ultima;
+    return true;
+}
+
+uint32_t leer_posiciones(const ListaPosiciones* posiciones, const ListaPosteo* lista, uint32_t indice_posteo, uint32_t* salida) {
+    if (!posiciones || !lista || !salida || indice_posteo >= lista->cantidad || indice_posteo >= posiciones->posteos) {
+        return 0;
+    }
+    uint32_t inicio_bloque = indice_posteo - indice_posteo % POSTEOS_POR_BLOQUE;
+    uint64_t anteriores = 0;
+    for (uint32_t i = inicio_bloque; i < indice_posteo; i++) {
+        anteriores += lista->frecuencias[i];
+    }
+    const uint8_t* fin = posiciones->bytes + posiciones->largo;
+    const uint8_t* p = saltar_vbytes(posiciones->bytes + posiciones->inicio_bloques[indice_posteo / POSTEOS_POR_BLOQUE],
+                                     fin, anteriores);
+    uint32_t cantidad = lista->frecuencias[indice_posteo];
+    if (!p || !leer_vbytes(p, fin, salida, cantidad)) {
+        return 0;
+    }
+    for (uint32_t i = 1; i < cantidad; i++) {
+        salida[i] += salida[i - 1];
+    }
+    return cantidad;
+}
+
+uint32_t contar_frase(const uint32_t* const posiciones[], const uint32_t cantidades[], const uint32_t desplazamientos[],
+                      size_t terminos) {
+    if (terminos == 0) return 0;
+    // Cada termino avanza un solo indice: las posiciones candidatas del primero van en orden creciente.
+    uint32_t indices[MAX_TERMINOS_FRASE] = { 0 };
+    if (terminos > MAX_TERMINOS_FRASE) return 0;
+    uint32_t apariciones = 0;
+    for (uint32_t i = 0; i < cantidades[0]; i++) {
+        if (posiciones[0][i] < desplazamientos[0]) continue;
+        uint64_t base = (uint64_t)posiciones[0][i] - desplazamientos[0];
+        bool calza = true;
+        for (size_t j = 1; calza && j < terminos; j++) {
+            uint64_t buscada = base + desplazamientos[j];
+            while (indices[j] < cantidades[j] && posiciones[j][indices[j]] < buscada) {
+                indices[j]++;
+            }
+            calza = indices[j] < cantidades[j] && posiciones[j][indices[j]] == buscada;
+        }
+        if (calza) apariciones++;
+    }
+    return apariciones;
+}
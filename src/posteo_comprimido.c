@@ -0,0 +1,303 @@
+#include "includes/posteo_comprimido.h"
+
+#include <string.h>
+
+// --- Funciones Estáticas ---
+
+// Rango [inicio, inicio + largo) de un bloque: igual para comprimir, medir y recorrer.
+static uint32_t largo_bloque(uint32_t cantidad, uint32_t inicio) {
+    uint32_t restantes = cantidad - inicio;
+    return restantes < POSTEOS_POR_BLOQUE ? restantes : POSTEOS_POR_BLOQUE;
+}
+
+static uint32_t bloques_de(uint32_t cantidad) {
+    return (uint32_t)(((uint64_t)cantidad + POSTEOS_POR_BLOQUE - 1) / POSTEOS_POR_BLOQUE);
+}
+
+// Bytes de la tabla de saltos: solo se guarda si hay mas de un bloque.
+static size_t largo_tabla_saltos(uint32_t cantidad) {
+    uint32_t bloques = bloques_de(cantidad);
+    return bloques > 1 ? (size_t)bloques * BYTES_POR_SALTO : 0;
+}
+
+// La tabla de saltos no esta alineada (la lista empieza en cualquier byte del archivo): se lee con memcpy.
+static uint32_t leer_u32(const uint8_t* p) {
+    uint32_t valor;
+    memcpy(&valor, p, sizeof(valor));
+    return valor;
+}
+
+static void escribir_u32(uint8_t* p, uint32_t valor) {
+    memcpy(p, &valor, sizeof(valor));
+}
+
+static float leer_float(const uint8_t* p) {
+    float valor;
+    memcpy(&valor, p, sizeof(valor));
+    return valor;
+}
+
+// Ultimo doc_id del bloque 'bloque' sin decodificarlo: de la tabla de saltos o del array sin comprimir.
+static uint32_t ultimo_doc_bloque(const CursorPosteo* cursor, uint32_t bloque) {
+    if (cursor->docs_planos) {
+        uint32_t fin = (bloque + 1) * POSTEOS_POR_BLOQUE;
+        return cursor->docs_planos[(fin < cursor->cantidad ? fin : cursor->cantidad) - 1];
+    }
+    return leer_u32(cursor->saltos + (size_t)bloque * BYTES_POR_SALTO);
+}
+
+// Cota del bloque 'bloque': de la tabla de saltos o del array de cotas de la lista sin comprimir.
+static float cota_de_bloque(const CursorPosteo* cursor, uint32_t bloque) {
+    if (cursor->cotas_planas) {
+        return cursor->cotas_planas[bloque];
+    }
+    return leer_float(cursor->saltos + (size_t)bloque * BYTES_POR_SALTO + 2 * sizeof(uint32_t));
+}
+
+// Primer bloque desde 'desde' cuyo ultimo doc_id alcanza a 'doc_id' (num_bloques si no hay): galope y luego
+// busqueda binaria, asi los saltos cortos (lo comun al intersectar) miran pocas entradas.
+// Solo sirve si hay tabla de saltos o arrays sin comprimir.
+static uint32_t buscar_bloque(const CursorPosteo* cursor, uint32_t desde, uint32_t doc_id) {
+    uint32_t bajo = desde, paso = 1;
+    while (bajo + paso < cursor->num_bloques && ultimo_doc_bloque(cursor, bajo + paso - 1) < doc_id) {
+        bajo += paso;
+        paso *= 2;
+    }
+    uint32_t alto = (bajo + paso < cursor->num_bloques) ? bajo + paso - 1 : cursor->num_bloques - 1;
+    while (bajo < alto) {
+        uint32_t medio = bajo + (alto - bajo) / 2;
+        if (ultimo_doc_bloque(cursor, medio) < doc_id) bajo = medio + 1; else alto = medio;
+    }
+    return ultimo_doc_bloque(cursor, bajo) < doc_id ? cursor->num_bloques : bajo;
+}
+
+// Deja el cursor listo para que avanzar_bloque entregue el bloque 'bloque' (que viene despues del actual).
+static bool posicionar_en_bloque(CursorPosteo* cursor, uint32_t bloque) {
+    if (!cursor->docs_planos) {
+        uint32_t offset = leer_u32(cursor->saltos + (size_t)bloque * BYTES_POR_SALTO + sizeof(uint32_t));
+        if (offset > (size_t)(cursor->fin - cursor->inicio_bloques)) {
+            cursor->corrupto = true;
+            return false;
+        }
+        cursor->actual = cursor->inicio_bloques + offset;
+        cursor->ultimo_doc = ultimo_doc_bloque(cursor, bloque - 1);
+    }
+    cursor->entregados = bloque * POSTEOS_POR_BLOQUE;
+    return true;
+}
+
+// --- Implementación de Funciones Públicas (declaradas en posteo_comprimido.h) ---
+
+size_t largo_vbyte(uint32_t valor) {
+    size_t bytes = 1;
+    while (valor >= 0x80) {
+        valor >>= 7;
+        bytes++;
+    }
+    return bytes;
+}
+
+uint8_t* escribir_vbyte(uint8_t* salida, uint32_t valor) {
+    while (valor >= 0x80) {
+        *salida++ = (uint8_t)(valor | 0x80);
+        valor >>= 7;
+    }
+    *salida++ = (uint8_t)valor;
+    return salida;
+}
+
+const uint8_t* leer_vbytes(const uint8_t* p, const uint8_t* fin, uint32_t* valores, uint32_t cantidad) {
+    for (uint32_t i = 0; i < cantidad; i++) {
+        // Caso comun: el numero cabe en un byte (diferencias chicas y frecuencias bajas).
+        if (p < fin && *p < 0x80) {
+            valores[i] = *p++;
+            continue;
+        }
+        uint32_t valor = 0;
+        unsigned desplazamiento = 0;
+        for (;;) {
+            if (p >= fin || desplazamiento > 28) return NULL;
+            uint8_t byte = *p++;
+            valor |= (uint32_t)(byte & 0x7F) << desplazamiento;
+            if (byte < 0x80) break;
+            desplazamiento += 7;
+        }
+        valores[i] = valor;
+    }
+    return p;
+}
+
+size_t largo_lista_comprimida(const ListaPosteo* lista) {
+    if (!lista) return 0;
+    size_t bytes = largo_tabla_saltos(lista->cantidad);
+    uint32_t anterior = 0;
+    for (uint32_t i = 0; i < lista->cantidad; i++) {
+        bytes += largo_vbyte(lista->doc_ids[i] - anterior) + largo_vbyte(lista->frecuencias[i]);
+        anterior = lista->doc_ids[i];
+    }
+    return bytes;
+}
+
+size_t comprimir_lista(const ListaPosteo* lista, const float* cotas, uint8_t* salida) {
+    if (!lista || !salida) return 0;
+    uint8_t* saltos = salida;
+    uint8_t* inicio_bloques = salida + largo_tabla_saltos(lista->cantidad);
+    uint8_t* p = inicio_bloques;
+    uint32_t anterior = 0;
+    for (uint32_t inicio = 0; inicio < lista->cantidad; inicio += POSTEOS_POR_BLOQUE) {
+        uint32_t largo = largo_bloque(lista->cantidad, inicio);
+        if (inicio_bloques != salida) {
+            uint32_t bloque = inicio / POSTEOS_POR_BLOQUE;
+            uint8_t* salto = saltos + (size_t)bloque * BYTES_POR_SALTO;
+            float cota = cotas ? cotas[bloque] : COTA_DESCONOCIDA;
+            escribir_u32(salto, lista->doc_ids[inicio + largo - 1]);
+            escribir_u32(salto + sizeof(uint32_t), (uint32_t)(p - inicio_bloques));
+            memcpy(salto + 2 * sizeof(uint32_t), &cota, sizeof(cota));
+        }
+        for (uint32_t i = inicio; i < inicio + largo; i++) {
+            p = escribir_vbyte(p, lista->doc_ids[i] - anterior);
+            anterior = lista->doc_ids[i];
+        }
+        for (uint32_t i = inicio; i < inicio + largo; i++) {
+            p = escribir_vbyte(p, lista->frecuencias[i]);
+        }
+    }
+    return (size_t)(p - salida);
+}
+
+uint32_t bloques_de_lista(uint32_t cantidad) {
+    return bloques_de(cantidad);
+}
+
+void abrir_cursor_lista(CursorPosteo* cursor, const ListaPosteo* lista) {
+    if (!cursor) return;
+    memset(cursor, 0, offsetof(CursorPosteo, buffer_docs)); // Los buffers no hace falta limpiarlos.
+    cursor->cota_lista = COTA_DESCONOCIDA;
+    if (!lista) return;
+    cursor->cantidad = lista->cantidad;
+    cursor->num_bloques = bloques_de(lista->cantidad);
+    cursor->docs_planos = lista->doc_ids;
+    cursor->frec_planas = lista->frecuencias;
+}
+
+void abrir_cursor_comprimido(CursorPosteo* cursor, const uint8_t* datos, size_t largo, uint32_t cantidad) {
+    if (!cursor) return;
+    memset(cursor, 0, offsetof(CursorPosteo, buffer_docs));
+    cursor->cota_lista = COTA_DESCONOCIDA;
+    if (!datos) return;
+    cursor->cantidad = cantidad;
+    cursor->num_bloques = bloques_de(cantidad);
+    cursor->fin = datos + largo;
+    size_t largo_saltos = largo_tabla_saltos(cantidad);
+    if (largo_saltos > largo) {
+        cursor->corrupto = true;
+        return;
+    }
+    cursor->saltos = largo_saltos > 0 ? datos : NULL;
+    cursor->inicio_bloques = datos + largo_saltos;
+    cursor->actual = cursor->inicio_bloques;
+}
+
+void fijar_cotas_cursor(CursorPosteo* cursor, float cota_lista, const float* cotas_bloque) {
+    if (!cursor) return;
+    cursor->cota_lista = cota_lista;
+    cursor->cotas_planas = cursor->docs_planos ? cotas_bloque : NULL;
+}
+
+bool avanzar_bloque(CursorPosteo* cursor) {
+    if (!cursor || cursor->corrupto || cursor->entregados >= cursor->cantidad) {
+        if (cursor) cursor->largo = 0;
+        return false;
+    }
+    uint32_t inicio = cursor->entregados;
+    uint32_t largo = largo_bloque(cursor->cantidad, inicio);
+
+    if (cursor->docs_planos) {
+        cursor->doc_ids = cursor->docs_planos + inicio;
+        cursor->frecuencias = cursor->frec_planas + inicio;
+    } else {
+        const uint8_t* p = leer_vbytes(cursor->actual, cursor->fin, cursor->buffer_docs, largo);
+        p = p ? leer_vbytes(p, cursor->fin, cursor->buffer_frecuencias, largo) : NULL;
+        if (!p) {
+            cursor->corrupto = true;
+            cursor->largo = 0;
+            return false;
+        }
+        // Las diferencias pasan a doc_ids; si alguna se desborda la lista no viene de comprimir_lista.
+        uint32_t doc = cursor->ultimo_doc;
+        for (uint32_t i = 0; i < largo; i++) {
+            uint32_t siguiente = doc + cursor->buffer_docs[i];
+            if (siguiente < doc || (siguiente == doc && inicio + i > 0)) {
+                cursor->corrupto = true;
+                cursor->largo = 0;
+                return false;
+            }
+            doc = siguiente;
+            cursor->buffer_docs[i] = doc;
+        }
+        cursor->ultimo_doc = doc;
+        cursor->actual = p;
+        cursor->doc_ids = cursor->buffer_docs;
+        cursor->frecuencias = cursor->buffer_frecuencias;
+    }
+    cursor->largo = largo;
+    cursor->entregados = inicio + largo;
+    cursor->bloques_leidos++;
+    cursor->posteos_leidos += largo;
+    return true;
+}
+
+bool saltar_a_doc(CursorPosteo* cursor, uint32_t doc_id) {
+    if (!cursor || cursor->corrupto) return false;
+    if (cursor->largo > 0 && cursor->doc_ids[cursor->largo - 1] >= doc_id) {
+        return true;
+    }
+    // Primer bloque pendiente cuyo ultimo doc_id alcanza a 'doc_id'.
+    uint32_t siguiente = bloques_de(cursor->entregados);
+    if (siguiente >= cursor->num_bloques) {
+        cursor->largo = 0;
+        return false;
+    }
+    if (cursor->docs_planos || cursor->saltos) {
+        uint32_t bajo = buscar_bloque(cursor, siguiente, doc_id);
+        if (bajo >= cursor->num_bloques) {
+            cursor->largo = 0;
+            cursor->entregados = cursor->cantidad;
+            return false;
+        }
+        if (bajo > siguiente && !posicionar_en_bloque(cursor, bajo)) {
+            cursor->largo = 0;
+            return false;
+        }
+    }
+    return avanzar_bloque(cursor) && cursor->doc_ids[cursor->largo - 1] >= doc_id;
+}
+
+float cota_bloque_para_doc(const CursorPosteo* cursor, uint32_t doc_id, uint32_t* ultimo_doc) {
+    uint32_t ultimo = UINT32_MAX - 1; // Sin cotas por bloque, la de la lista vale hasta el final.
+    float cota = 0.0f;
+    if (cursor && !cursor->corrupto) {
+        cota = cursor->cota_lista;
+        bool con_cotas_bloque = cursor->cotas_planas || cursor->saltos;
+        if (cursor->largo > 0 && cursor->doc_ids[cursor->largo - 1] >= doc_id) {
+            // El bloque actual (ya decodificado) puede tener 'doc_id'.
+            uint32_t actual = bloques_de(cursor->entregados) - 1;
+            if (con_cotas_bloque) {
+                ultimo = cursor->doc_ids[cursor->largo - 1];
+                cota = cota_de_bloque(cursor, actual);
+            }
+        } else if (bloques_de(cursor->entregados) >= cursor->num_bloques) {
+            cota = 0.0f; // La lista ya se acabo.
+        } else if (con_cotas_bloque) {
+            uint32_t bloque = buscar_bloque(cursor, bloques_de(cursor->entregados), doc_id);
+            if (bloque >= cursor->num_bloques) {
+                cota = 0.0f;
+            } else {
+                ultimo = ultimo_doc_bloque(cursor, bloque);
+                cota = cota_de_bloque(cursor, bloque);
+            }
+        }
+    }
+    if (ultimo_doc) *ultimo_doc = ultimo;
+    return cota;
+}
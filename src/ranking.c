@@ -0,0 +1,422 @@
+#include "includes/ranking.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** @brief Marca de una lista que ya no tiene documentos (ningun doc_id real llega a DOC_ID_INVALIDO). */
+#define DOC_AGOTADO DOC_ID_INVALIDO
+
+// Estado de un termino durante una busqueda disyuntiva: su cursor y el posteo donde esta parado.
+typedef struct {
+    CursorPosteo* cursor;
+    uint32_t pos;       // Posicion del posteo actual dentro del bloque del cursor.
+    uint32_t doc;       // doc_id del posteo actual (DOC_AGOTADO si la lista se acabo).
+    bool pendiente;     // 'doc' es solo una cota inferior: el cursor todavia no se movio hasta ahi.
+    double idf;
+    double cota;        // Cota de toda la lista, ya multiplicada por el IDF.
+} TerminoDisyuntivo;
+
+// --- Funciones Estáticas ---
+
+// true si 'a' va antes que 'b' en el ranking: mas puntaje, o igual puntaje y doc_id menor.
+static bool es_mejor(const ResultadoBusqueda* a, const ResultadoBusqueda* b) {
+    return a->puntaje > b->puntaje || (a->puntaje == b->puntaje && a->doc_id < b->doc_id);
+}
+
+// Baja el elemento 'i' hasta que sus hijos sean mejores que el (la raiz queda con el peor).
+static void hundir(ResultadoBusqueda* resultados, size_t cantidad, size_t i) {
+    ResultadoBusqueda elemento = resultados[i];
+    for (;;) {
+        size_t hijo = 2 * i + 1;
+        if (hijo >= cantidad) break;
+        if (hijo + 1 < cantidad && es_mejor(&resultados[hijo], &resultados[hijo + 1])) hijo++;
+        if (!es_mejor(&elemento, &resultados[hijo])) break;
+        resultados[i] = resultados[hijo];
+        i = hijo;
+    }
+    resultados[i] = elemento;
+}
+
+// Un indice completo es su propia coleccion: el df de cada termino es el largo de su lista.
+static void coleccion_del_indice(const indiceInvertido* indice, CursorPosteo* cursores[], size_t cantidad,
+                                 ColeccionRanking* coleccion) {
+    coleccion->total_documentos = indice->documentos->cantidad;
+    coleccion->largo_promedio = largo_promedio_documentos(indice->documentos);
+    for (size_t t = 0; t < cantidad; t++) {
+        coleccion->documentos_con_termino[t] = cursores[t]->cantidad;
+    }
+    coleccion->escala_cotas = 1.0;
+    coleccion->umbral_minimo = -INFINITY;
+}
+
+// --- Implementación de Funciones Públicas (declaradas en ranking.h) ---
+
+void iniciar_heap_mejores(HeapMejores* heap, ResultadoBusqueda* resultados, size_t capacidad) {
+    if (!heap) return;
+    heap->resultados = resultados;
+    heap->cantidad = 0;
+    heap->capacidad = resultados ? capacidad : 0;
+}
+
+void ofrecer_a_heap(HeapMejores* heap, uint32_t doc_id, double puntaje) {
+    if (!heap || heap->capacidad == 0) return;
+    ResultadoBusqueda candidato = { doc_id, puntaje };
+    if (heap->cantidad < heap->capacidad) {
+        // Sube desde la ultima hoja mientras sea peor que su padre.
+        size_t i = heap->cantidad++;
+        while (i > 0) {
+            size_t padre = (i - 1) / 2;
+            if (!es_mejor(&heap->resultados[padre], &candidato)) break;
+            heap->resultados[i] = heap->resultados[padre];
+            i = padre;
+        }
+        heap->resultados[i] = candidato;
+    } else if (es_mejor(&candidato, &heap->resultados[0])) {
+        heap->resultados[0] = candidato;
+        hundir(heap->resultados, heap->cantidad, 0);
+    }
+}
+
+size_t ordenar_heap_mejores(HeapMejores* heap) {
+    if (!heap) return 0;
+    // Heapsort: se saca el peor a la ultima posicion libre, asi el array queda de mejor a peor.
+    for (size_t fin = heap->cantidad; fin > 1; fin--) {
+        ResultadoBusqueda peor = heap->resultados[0];
+        heap->resultados[0] = heap->resultados[fin - 1];
+        heap->resultados[fin - 1] = peor;
+        hundir(heap->resultados, fin - 1, 0);
+    }
+    return heap->cantidad;
+}
+
+double idf_bm25(uint32_t total_documentos, uint32_t documentos_con_termino) {
+    double n = (double)total_documentos;
+    double df = (double)documentos_con_termino;
+    if (df > n) df = n;
+    return log(1.0 + (n - df + 0.5) / (df + 0.5));
+}
+
+double puntaje_bm25_termino(double idf, uint32_t frecuencia, uint32_t largo_documento, double largo_promedio) {
+    double tf = (double)frecuencia;
+    double normalizacion = 1.0 - BM25_B + (largo_promedio > 0.0 ? BM25_B * (double)largo_documento / largo_promedio : 0.0);
+    return idf * tf * (BM25_K1 + 1.0) / (tf + BM25_K1 * normalizacion);
+}
+
+size_t buscar_mejores_conjuntivo(const indiceInvertido* indice, CursorPosteo* cursores[], size_t cantidad,
+                                 ResultadoBusqueda* salida, size_t k, uint32_t* total_coincidencias) {
+    if (total_coincidencias) *total_coincidencias = 0;
+    if (!indice || !indice->documentos || !salida || k == 0) return 0;
+
+    // Grande (frecuencias por termino): va en el heap y no en el stack.
+    InterseccionCursores* interseccion = (InterseccionCursores*)malloc(sizeof(InterseccionCursores));
+    if (!interseccion) {
+        perror("[RANKING] Fallo malloc para el estado de la interseccion");
+        return 0;
+    }
+    size_t encontrados = buscar_mejores_conjuntivo_con(indice, cursores, cantidad, interseccion, salida, k, total_coincidencias);
+    free(interseccion);
+    return encontrados;
+}
+
+size_t buscar_mejores_conjuntivo_con(const indiceInvertido* indice, CursorPosteo* cursores[], size_t cantidad,
+                                     InterseccionCursores* interseccion, ResultadoBusqueda* salida, size_t k,
+                                     uint32_t* total_coincidencias) {
+    if (total_coincidencias) *total_coincidencias = 0;
+    if (!indice || !indice->documentos || cantidad > MAX_TERMINOS_INTERSECCION) return 0;
+    ColeccionRanking coleccion;
+    coleccion_del_indice(indice, cursores, cantidad, &coleccion);
+    return buscar_mejores_conjuntivo_en_coleccion(indice, cursores, cantidad, &coleccion, interseccion, salida, k,
+                                                  total_coincidencias);
+}
+
+size_t buscar_mejores_conjuntivo_en_coleccion(const indiceInvertido* indice, CursorPosteo* cursores[], size_t cantidad,
+                                              const ColeccionRanking* coleccion, InterseccionCursores* interseccion,
+                                              ResultadoBusqueda* salida, size_t k, uint32_t* total_coincidencias) {
+    if (total_coincidencias) *total_coincidencias = 0;
+    if (!indice || !indice->documentos || !coleccion || !interseccion || !salida || k == 0) return 0;
+    const TablaDocumentos* documentos = indice->documentos;
+    if (!iniciar_interseccion(interseccion, cursores, cantidad)) {
+        return 0;
+    }
+
+    // El IDF de cada termino se calcula una vez por consulta.
+    double idf[MAX_TERMINOS_INTERSECCION];
+    for (size_t t = 0; t < cantidad; t++) {
+        idf[t] = idf_bm25(coleccion->total_documentos, coleccion->documentos_con_termino[t]);
+    }
+    double largo_promedio = coleccion->largo_promedio;
+
+    HeapMejores heap;
+    iniciar_heap_mejores(&heap, salida, k);
+    uint32_t total = 0;
+    while (siguiente_bloque_interseccion(interseccion)) {
+        for (uint32_t i = 0; i < interseccion->vivos; i++) {
+            uint32_t doc_id = interseccion->doc_ids[i];
+            uint32_t largo = doc_id < documentos->cantidad ? documentos->largos[doc_id] : 0;
+            double puntaje = 0.0;
+            for (size_t t = 0; t < cantidad; t++) {
+                puntaje += puntaje_bm25_termino(idf[t], interseccion->frecuencias[t][i], largo, largo_promedio);
+            }
+            ofrecer_a_heap(&heap, doc_id, puntaje);
+        }
+        total += interseccion->vivos;
+    }
+
+    if (total_coincidencias) *total_coincidencias = total;
+    return ordenar_heap_mejores(&heap);
+}
+
+// --- Funciones Estáticas (busqueda disyuntiva) ---
+
+// Redondea hacia arriba a float, para que la cota guardada nunca quede debajo del valor exacto.
+static float cota_hacia_arriba(double valor) {
+    float cota = (float)valor;
+    if ((double)cota < valor) cota = nextafterf(cota, INFINITY);
+    return cota;
+}
+
+// Deja al termino en su primer posteo con doc_id >= 'doc_id' (o agotado), decodificando su bloque.
+static void posicionar_termino(TerminoDisyuntivo* termino, uint32_t doc_id) {
+    CursorPosteo* cursor = termino->cursor;
+    termino->pendiente = false;
+    uint32_t entregados = cursor->entregados;
+    if (!saltar_a_doc(cursor, doc_id)) {
+        termino->doc = DOC_AGOTADO;
+        return;
+    }
+    uint32_t bajo = (cursor->entregados == entregados) ? termino->pos : 0; // Otro bloque: desde su inicio.
+    uint32_t alto = cursor->largo - 1; // saltar_a_doc asegura que el ultimo del bloque es >= doc_id.
+    while (bajo < alto) {
+        uint32_t medio = bajo + (alto - bajo) / 2;
+        if (cursor->doc_ids[medio] < doc_id) bajo = medio + 1; else alto = medio;
+    }
+    termino->pos = bajo;
+    termino->doc = cursor->doc_ids[bajo];
+}
+
+// Adelanta al termino hasta 'doc_id'. Con poda el salto es superficial: solo se anota la cota inferior
+// y el bloque se decodifica recien si el termino hace falta para puntuar (ver buscar_disyuntivo),
+// asi los bloques que se descartan por su cota nunca se leen.
+static void adelantar_termino(TerminoDisyuntivo* termino, uint32_t doc_id, bool superficial) {
+    if (termino->doc >= doc_id) return;
+    if (doc_id == DOC_AGOTADO) {
+        termino->doc = DOC_AGOTADO;
+        termino->pendiente = false;
+    } else if (superficial) {
+        termino->doc = doc_id;
+        termino->pendiente = true;
+    } else {
+        posicionar_termino(termino, doc_id);
+    }
+}
+
+// Ordena los terminos por su doc_id actual (insercion directa: casi siempre ya estan casi ordenados).
+static void ordenar_por_doc(TerminoDisyuntivo* orden[], size_t cantidad) {
+    for (size_t i = 1; i < cantidad; i++) {
+        TerminoDisyuntivo* termino = orden[i];
+        size_t j = i;
+        while (j > 0 && orden[j - 1]->doc > termino->doc) {
+            orden[j] = orden[j - 1];
+            j--;
+        }
+        orden[j] = termino;
+    }
+}
+
+static size_t buscar_disyuntivo(const indiceInvertido* indice, CursorPosteo* cursores[], size_t cantidad,
+                                const ColeccionRanking* coleccion, ResultadoBusqueda* salida, size_t k,
+                                EstadisticasBusqueda* estadisticas, bool podar) {
+    if (estadisticas) {
+        estadisticas->posteos_totales = 0;
+        estadisticas->posteos_decodificados = 0;
+        estadisticas->documentos_puntuados = 0;
+    }
+    if (!indice || !indice->documentos || !cursores || !salida || k == 0 || cantidad == 0 ||
+        cantidad > MAX_TERMINOS_INTERSECCION) {
+        return 0;
+    }
+    const TablaDocumentos* documentos = indice->documentos;
+    ColeccionRanking propia;
+    if (!coleccion) {
+        coleccion_del_indice(indice, cursores, cantidad, &propia);
+        coleccion = &propia;
+    }
+    double largo_promedio = coleccion->largo_promedio;
+    double escala = coleccion->escala_cotas * MARGEN_COTAS;
+
+    TerminoDisyuntivo terminos[MAX_TERMINOS_INTERSECCION];
+    TerminoDisyuntivo* orden[MAX_TERMINOS_INTERSECCION];
+    for (size_t t = 0; t < cantidad; t++) {
+        TerminoDisyuntivo* termino = &terminos[t];
+        termino->cursor = cursores[t];
+        termino->pos = 0;
+        termino->pendiente = false;
+        termino->doc = avanzar_bloque(cursores[t]) ? cursores[t]->doc_ids[0] : DOC_AGOTADO;
+        termino->idf = idf_bm25(coleccion->total_documentos, coleccion->documentos_con_termino[t]);
+        termino->cota = termino->idf * cursores[t]->cota_lista * escala;
+        orden[t] = termino;
+        if (estadisticas) estadisticas->posteos_totales += cursores[t]->cantidad;
+    }
+
+    HeapMejores heap;
+    iniciar_heap_mejores(&heap, salida, k);
+    for (;;) {
+        ordenar_por_doc(orden, cantidad);
+        // Un documento entra solo si supera al peor de los k mejores: los que vienen despues tienen
+        // doc_id mayor y pierden los empates, asi que "no superar" ya alcanza para descartarlo.
+        double umbral = (podar && heap.cantidad == heap.capacidad) ? heap.resultados[0].puntaje : -INFINITY;
+        if (podar && coleccion->umbral_minimo > umbral) umbral = coleccion->umbral_minimo;
+
+        // Pivote: el primer termino (en orden de doc_id) con el que la suma de cotas supera el umbral.
+        // Ningun documento anterior a su doc_id puede entrar: solo tiene terminos de antes del pivote.
+        double acumulado = 0.0;
+        size_t pivote = cantidad;
+        for (size_t i = 0; i < cantidad && orden[i]->doc != DOC_AGOTADO; i++) {
+            acumulado += orden[i]->cota;
+            if (acumulado > umbral) {
+                pivote = i;
+                break;
+            }
+        }
+        if (pivote == cantidad) break;
+        uint32_t doc = orden[pivote]->doc;
+        while (pivote + 1 < cantidad && orden[pivote + 1]->doc == doc) {
+            pivote++;
+        }
+
+        if (podar) {
+            // Block-Max: con las cotas de los bloques donde cae 'doc' se puede descartar hasta
+            // el fin del primero de esos bloques (o hasta el doc del siguiente termino).
+            uint32_t siguiente = (pivote + 1 < cantidad) ? orden[pivote + 1]->doc : DOC_AGOTADO;
+            double cota_bloques = 0.0;
+            for (size_t i = 0; i <= pivote; i++) {
+                uint32_t ultimo;
+                cota_bloques += orden[i]->idf * cota_bloque_para_doc(orden[i]->cursor, doc, &ultimo) * escala;
+                if (ultimo + 1 < siguiente) siguiente = ultimo + 1;
+            }
+            if (cota_bloques <= umbral) {
+                for (size_t i = 0; i <= pivote; i++) {
+                    adelantar_termino(orden[i], siguiente, podar);
+                }
+                continue;
+            }
+        }
+
+        if (orden[0]->doc != doc) {
+            // Faltan terminos por llegar a 'doc': lo anterior no puede entrar.
+            for (size_t i = 0; i < pivote && orden[i]->doc < doc; i++) {
+                adelantar_termino(orden[i], doc, podar);
+            }
+            continue;
+        }
+
+        // Los saltos superficiales se hacen efectivos recien ahora; si alguno cae despues de 'doc',
+        // el documento ya no tiene todos esos terminos y se vuelve a elegir pivote.
+        bool movido = false;
+        for (size_t i = 0; i <= pivote; i++) {
+            if (orden[i]->pendiente) {
+                posicionar_termino(orden[i], orden[i]->doc);
+                movido = movido || orden[i]->doc != doc;
+            }
+        }
+        if (movido) continue;
+
+        // Todos los terminos hasta el pivote estan en 'doc': se puntua en el orden de 'cursores',
+        // igual que sin poda, para que las sumas den exactamente lo mismo.
+        uint32_t largo = doc < documentos->cantidad ? documentos->largos[doc] : 0;
+        double puntaje = 0.0;
+        for (size_t t = 0; t < cantidad; t++) {
+            if (terminos[t].doc == doc) {
+                uint32_t frecuencia = terminos[t].cursor->frecuencias[terminos[t].pos];
+                puntaje += puntaje_bm25_termino(terminos[t].idf, frecuencia, largo, largo_promedio);
+            }
+        }
+        if (!podar || puntaje > coleccion->umbral_minimo) ofrecer_a_heap(&heap, doc, puntaje);
+        if (estadisticas) estadisticas->documentos_puntuados++;
+        for (size_t i = 0; i <= pivote; i++) {
+            adelantar_termino(orden[i], doc + 1, podar);
+        }
+    }
+
+    if (estadisticas) {
+        for (size_t t = 0; t < cantidad; t++) {
+            estadisticas->posteos_decodificados += cursores[t]->posteos_leidos;
+        }
+    }
+    return ordenar_heap_mejores(&heap);
+}
+
+// --- Implementación de Funciones Públicas (cotas y busqueda disyuntiva) ---
+
+double largo_promedio_documentos(const TablaDocumentos* documentos) {
+    if (!documentos || documentos->cantidad == 0) return 0.0;
+    return (double)documentos->suma_largos / documentos->cantidad;
+}
+
+float calcular_cotas_bloques_bm25(const ListaPosteo* lista, const TablaDocumentos* documentos, float* cotas) {
+    if (!lista || !documentos) return 0.0f;
+    double largo_promedio = largo_promedio_documentos(documentos);
+    float cota_lista = 0.0f;
+    for (uint32_t inicio = 0; inicio < lista->cantidad; inicio += POSTEOS_POR_BLOQUE) {
+        uint32_t fin = (lista->cantidad - inicio < POSTEOS_POR_BLOQUE) ? lista->cantidad : inicio + POSTEOS_POR_BLOQUE;
+        double maximo = 0.0;
+        for (uint32_t i = inicio; i < fin; i++) {
+            uint32_t doc_id = lista->doc_ids[i];
+            uint32_t largo = doc_id < documentos->cantidad ? documentos->largos[doc_id] : 0;
+            double aporte = puntaje_bm25_termino(1.0, lista->frecuencias[i], largo, largo_promedio);
+            if (aporte > maximo) maximo = aporte;
+        }
+        float cota = cota_hacia_arriba(maximo);
+        if (cotas) cotas[inicio / POSTEOS_POR_BLOQUE] = cota;
+        if (cota > cota_lista) cota_lista = cota;
+    }
+    return cota_lista;
+}
+
+double escala_cotas_bm25(double largo_promedio_cotas, double largo_promedio) {
+    if (largo_promedio_cotas <= 0.0 || largo_promedio <= largo_promedio_cotas) return 1.0;
+    return largo_promedio / largo_promedio_cotas;
+}
+
+bool preparar_cotas_bm25(indiceInvertido* indice) {
+    if (!indice || indice->mapeado) return false;
+    indice->largo_promedio_cotas = 0.0;
+    for (size_t i = 0; i < indice->cantidad; i++) {
+        EntradaVocabulario* entrada = &indice->entradas[i];
+        free(entrada->cotas_bloque);
+        entrada->cotas_bloque = NULL;
+        uint32_t bloques = bloques_de_lista(entrada->lista_documentos.cantidad);
+        if (bloques > 1) {
+            entrada->cotas_bloque = (float*)malloc((size_t)bloques * sizeof(float));
+            if (!entrada->cotas_bloque) {
+                perror("[RANKING] Fallo malloc para las cotas de los bloques");
+                return false;
+            }
+        }
+        entrada->cota_bm25 = calcular_cotas_bloques_bm25(&entrada->lista_documentos, indice->documentos, entrada->cotas_bloque);
+    }
+    indice->largo_promedio_cotas = largo_promedio_documentos(indice->documentos);
+    return true;
+}
+
+size_t buscar_mejores_disyuntivo(const indiceInvertido* indice, CursorPosteo* cursores[], size_t cantidad,
+                                 ResultadoBusqueda* salida, size_t k, EstadisticasBusqueda* estadisticas) {
+    return buscar_disyuntivo(indice, cursores, cantidad, NULL, salida, k, estadisticas, true);
+}
+
+size_t buscar_mejores_disyuntivo_en_coleccion(const indiceInvertido* indice, CursorPosteo* cursores[], size_t cantidad,
+                                              const ColeccionRanking* coleccion, ResultadoBusqueda* salida, size_t k,
+                                              EstadisticasBusqueda* estadisticas) {
+    if (!coleccion) {
+        if (estadisticas) memset(estadisticas, 0, sizeof(*estadisticas));
+        return 0;
+    }
+    return buscar_disyuntivo(indice, cursores, cantidad, coleccion, salida, k, estadisticas, true);
+}
+
+size_t buscar_mejores_disyuntivo_exhaustivo(const indiceInvertido* indice, CursorPosteo* cursores[], size_t cantidad,
+                                            ResultadoBusqueda* salida, size_t k, EstadisticasBusqueda* estadisticas) {
+    return buscar_disyuntivo(indice, cursores, cantidad, NULL, salida, k, estadisticas, false);
+}
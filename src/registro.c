@@ -0,0 +1,34 @@
+#include "includes/registro.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+NivelRegistro g_nivel_registro = REGISTRO_INFO;
+
+static const char* const NOMBRES_NIVELES[] = { "error", "aviso", "info", "detalle" };
+
+// --- Implementación de Funciones Públicas (declaradas en registro.h) ---
+
+void fijar_nivel_registro(NivelRegistro nivel) {
+    g_nivel_registro = nivel;
+}
+
+bool nivel_registro_desde_texto(const char* nombre, NivelRegistro* nivel) {
+    if (!nombre || !nivel) return false;
+    for (int i = REGISTRO_ERROR; i <= REGISTRO_DETALLE; i++) {
+        if (strcmp(nombre, NOMBRES_NIVELES[i]) == 0) {
+            *nivel = (NivelRegistro)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void registrar_mensaje(NivelRegistro nivel, const char* formato, ...) {
+    FILE* salida = nivel <= REGISTRO_AVISO ? stderr : stdout;
+    va_list argumentos;
+    va_start(argumentos, formato);
+    vfprintf(salida, formato, argumentos);
+    va_end(argumentos);
+}
@@ -0,0 +1,686 @@
+#include "includes/segmentos.h"
+#include "includes/indice_disco.h"
+#include "includes/parser.h"
+#include "includes/registro.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <time.h>
+#include <math.h>
+
+#if !defined(_WIN32)
+#define SEGMENTOS_CON_POSIX 1
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+#else
+#include <direct.h>
+#include <sys/stat.h>
+#endif
+
+#define MAX_LARGO_RUTA_SEGMENTO 4096
+#define ARCHIVO_BLOQUEO_SEGMENTOS "bloqueo"
+#define PRIORIDAD_FUSIONES 10   // "nice" del hilo de fusiones: las consultas van primero.
+
+// --- Funciones Estáticas ---
+
+static double segundos_ahora(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static uint32_t documentos_de(const Segmento* segmento) {
+    return segmento->indice->documentos->cantidad;
+}
+
+static bool armar_ruta(char* ruta, const char* directorio, const char* nombre) {
+    int largo = snprintf(ruta, MAX_LARGO_RUTA_SEGMENTO, "%s/%s", directorio, nombre);
+    return largo > 0 && largo < MAX_LARGO_RUTA_SEGMENTO;
+}
+
+static bool armar_ruta_segmento(char* ruta, const char* directorio, uint64_t numero) {
+    char nombre[32];
+    snprintf(nombre, sizeof(nombre), "seg_%08" PRIu64 ".idx", numero);
+    return armar_ruta(ruta, directorio, nombre);
+}
+
+static Segmento* abrir_segmento(const char* directorio, uint64_t numero) {
+    char ruta[MAX_LARGO_RUTA_SEGMENTO];
+    if (!armar_ruta_segmento(ruta, directorio, numero)) {
+        fprintf(stderr, "[SEGMENTOS] Error: La ruta del segmento %" PRIu64 " es muy larga.\n", numero);
+        return NULL;
+    }
+    Segmento* segmento = (Segmento*)calloc(1, sizeof(Segmento));
+    char* copia_ruta = strdup(ruta);
+    if (!segmento || !copia_ruta) {
+        perror("[SEGMENTOS] Fallo la memoria para un segmento");
+        free(segmento);
+        free(copia_ruta);
+        return NULL;
+    }
+    segmento->indice = cargar_indice(ruta);
+    if (!segmento->indice) {
+        free(segmento);
+        free(copia_ruta);
+        return NULL;
+    }
+    segmento->ruta = copia_ruta;
+    segmento->numero = numero;
+    segmento->referencias = 1; // La del catalogo.
+    return segmento;
+}
+
+// Suelta una referencia; la ultima cierra el segmento. Se llama con el mutex tomado (o sin otros hilos).
+static void soltar_segmento(Segmento* segmento) {
+    if (!segmento || --segmento->referencias > 0) return;
+    destruir_indice(segmento->indice);
+    if (segmento->retirado && remove(segmento->ruta) != 0) {
+        fprintf(stderr, "[SEGMENTOS] No se pudo borrar '%s': %s\n", segmento->ruta, strerror(errno));
+    }
+    free(segmento->ruta);
+    free(segmento);
+}
+
+// Escribe el catalogo con 'cantidad' segmentos (a un .tmp que se renombra encima del anterior).
+static bool escribir_catalogo(const char* directorio, Segmento* const segmentos[], size_t cantidad) {
+    char ruta[MAX_LARGO_RUTA_SEGMENTO];
+    char ruta_temporal[MAX_LARGO_RUTA_SEGMENTO];
+    if (!armar_ruta(ruta, directorio, CATALOGO_SEGMENTOS) ||
+        !armar_ruta(ruta_temporal, directorio, CATALOGO_SEGMENTOS ".tmp")) {
+        return false;
+    }
+    FILE* archivo = fopen(ruta_temporal, "w");
+    if (!archivo) {
+        fprintf(stderr, "[SEGMENTOS] No se pudo crear '%s': %s\n", ruta_temporal, strerror(errno));
+        return false;
+    }
+    bool ok = fprintf(archivo, "%s\n", CATALOGO_SEGMENTOS_MAGIA) > 0;
+    for (size_t i = 0; ok && i < cantidad; i++) {
+        ok = fprintf(archivo, "%" PRIu64 " %u\n", segmentos[i]->numero, (unsigned)documentos_de(segmentos[i])) > 0;
+    }
+    if (fclose(archivo) != 0) ok = false;
+    if (ok && rename(ruta_temporal, ruta) != 0) {
+        fprintf(stderr, "[SEGMENTOS] No se pudo renombrar '%s': %s\n", ruta_temporal, strerror(errno));
+        ok = false;
+    }
+    if (!ok) {
+        fprintf(stderr, "[SEGMENTOS] Error escribiendo el catalogo de '%s'.\n", directorio);
+        remove(ruta_temporal);
+    }
+    return ok;
+}
+
+static bool asegurar_capacidad(IndiceSegmentado* segmentado, size_t cantidad) {
+    if (cantidad <= segmentado->capacidad) return true;
+    size_t nueva = segmentado->capacidad ? segmentado->capacidad * 2 : 8;
+    while (nueva < cantidad) nueva *= 2;
+    Segmento** segmentos = (Segmento**)realloc(segmentado->segmentos, nueva * sizeof(Segmento*));
+    if (!segmentos) {
+        perror("[SEGMENTOS] Fallo realloc para la lista de segmentos");
+        return false;
+    }
+    segmentado->segmentos = segmentos;
+    segmentado->capacidad = nueva;
+    return true;
+}
+
+// Lee el catalogo y abre sus segmentos. Un directorio sin catalogo es una coleccion vacia.
+static bool leer_catalogo(IndiceSegmentado* segmentado) {
+    char ruta[MAX_LARGO_RUTA_SEGMENTO];
+    if (!armar_ruta(ruta, segmentado->directorio, CATALOGO_SEGMENTOS)) return false;
+    FILE* archivo = fopen(ruta, "r");
+    if (!archivo) {
+        return errno == ENOENT;
+    }
+    char linea[128];
+    bool ok = fgets(linea, sizeof(linea), archivo) != NULL &&
+              strncmp(linea, CATALOGO_SEGMENTOS_MAGIA, strlen(CATALOGO_SEGMENTOS_MAGIA)) == 0;
+    if (!ok) {
+        fprintf(stderr, "[SEGMENTOS] Error: '%s' no es un catalogo de segmentos de esta version.\n", ruta);
+    }
+    while (ok && fgets(linea, sizeof(linea), archivo)) {
+        uint64_t numero;
+        unsigned documentos;
+        if (sscanf(linea, "%" SCNu64 " %u", &numero, &documentos) != 2) {
+            fprintf(stderr, "[SEGMENTOS] Error: Linea invalida en '%s': %s", ruta, linea);
+            ok = false;
+            break;
+        }
+        Segmento* segmento = abrir_segmento(segmentado->directorio, numero);
+        if (!segmento) {
+            ok = false;
+            break;
+        }
+        if (documentos_de(segmento) != documentos || !asegurar_capacidad(segmentado, segmentado->cantidad + 1)) {
+            if (documentos_de(segmento) != documentos) {
+                fprintf(stderr, "[SEGMENTOS] Error: El segmento '%s' no tiene los documentos que dice el catalogo.\n",
+                        segmento->ruta);
+            }
+            soltar_segmento(segmento);
+            ok = false;
+            break;
+        }
+        segmentado->segmentos[segmentado->cantidad++] = segmento;
+        if (numero >= segmentado->proximo_numero) segmentado->proximo_numero = numero + 1;
+    }
+    fclose(archivo);
+    return ok;
+}
+
+// Borra los archivos de segmentos (y temporales) que no estan en el catalogo.
+static void limpiar_huerfanos(IndiceSegmentado* segmentado) {
+#ifdef SEGMENTOS_CON_POSIX
+    DIR* dir = opendir(segmentado->directorio);
+    if (!dir) return;
+    struct dirent* entrada;
+    while ((entrada = readdir(dir)) != NULL) {
+        uint64_t numero;
+        char resto[8];
+        if (sscanf(entrada->d_name, "seg_%" SCNu64 ".%7s", &numero, resto) != 2 ||
+            (strcmp(resto, "idx") != 0 && strcmp(resto, "idx.tmp") != 0)) {
+            continue;
+        }
+        bool en_catalogo = false;
+        for (size_t i = 0; i < segmentado->cantidad && !en_catalogo; i++) {
+            en_catalogo = segmentado->segmentos[i]->numero == numero && strcmp(resto, "idx") == 0;
+        }
+        char ruta[MAX_LARGO_RUTA_SEGMENTO];
+        if (!en_catalogo && armar_ruta(ruta, segmentado->directorio, entrada->d_name)) {
+            REGISTRAR(REGISTRO_AVISO, "[SEGMENTOS] Borrando '%s', que no esta en el catalogo.\n", ruta);
+            remove(ruta);
+        }
+        if (numero >= segmentado->proximo_numero) segmentado->proximo_numero = numero + 1;
+    }
+    closedir(dir);
+#else
+    (void)segmentado;
+#endif
+}
+
+static bool crear_directorio(const char* directorio) {
+#ifdef SEGMENTOS_CON_POSIX
+    if (mkdir(directorio, 0755) == 0 || errno == EEXIST) return true;
+#else
+    if (_mkdir(directorio) == 0 || errno == EEXIST) return true;
+#endif
+    fprintf(stderr, "[SEGMENTOS] No se pudo crear el directorio '%s': %s\n", directorio, strerror(errno));
+    return false;
+}
+
+// Un solo proceso a la vez: dos catalogos en memoria se pisarian al escribirse.
+static int bloquear_directorio(const char* directorio) {
+#ifdef SEGMENTOS_CON_POSIX
+    char ruta[MAX_LARGO_RUTA_SEGMENTO];
+    if (!armar_ruta(ruta, directorio, ARCHIVO_BLOQUEO_SEGMENTOS)) return -1;
+    int fd = open(ruta, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "[SEGMENTOS] No se pudo abrir '%s': %s\n", ruta, strerror(errno));
+        return -1;
+    }
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        fprintf(stderr, "[SEGMENTOS] Error: Otro proceso tiene abierto el directorio '%s'.\n", directorio);
+        close(fd);
+        return -1;
+    }
+    return fd;
+#else
+    (void)directorio;
+    return 0;
+#endif
+}
+
+// Politica por niveles: la primera tanda de SEGMENTOS_POR_NIVEL vecinos del mismo nivel, empezando por
+// el nivel mas bajo (las fusiones mas baratas). Solo se fusionan vecinos, asi los doc_id no cambian.
+// Devuelve false si no hay nada que fusionar. Se llama con el mutex tomado.
+static bool elegir_fusion(const IndiceSegmentado* segmentado, size_t* inicio) {
+    bool encontrada = false;
+    int mejor_nivel = 0;
+    size_t corrida = 0;
+    for (size_t i = 0; i < segmentado->cantidad; i++) {
+        int nivel = nivel_de_segmento(documentos_de(segmentado->segmentos[i]));
+        bool mismo_nivel = i > 0 && nivel == nivel_de_segmento(documentos_de(segmentado->segmentos[i - 1]));
+        corrida = mismo_nivel ? corrida + 1 : 1;
+        if (corrida == SEGMENTOS_POR_NIVEL && (!encontrada || nivel < mejor_nivel)) {
+            encontrada = true;
+            mejor_nivel = nivel;
+            *inicio = i + 1 - SEGMENTOS_POR_NIVEL;
+        }
+        if (corrida == SEGMENTOS_POR_NIVEL) corrida = 0; // La siguiente tanda empieza de nuevo.
+    }
+    return encontrada;
+}
+
+// Hace una fusion si la politica la pide. Los archivos se leen y escriben sin el mutex:
+// las consultas siguen con los segmentos viejos hasta que el nuevo entra al catalogo.
+static bool fusionar_una_vez(IndiceSegmentado* segmentado, bool* fallo) {
+    *fallo = false;
+    pthread_mutex_lock(&segmentado->mutex_fusion);
+    pthread_mutex_lock(&segmentado->mutex);
+    size_t inicio = 0;
+    if (!elegir_fusion(segmentado, &inicio)) {
+        pthread_mutex_unlock(&segmentado->mutex);
+        pthread_mutex_unlock(&segmentado->mutex_fusion);
+        return false;
+    }
+    Segmento* tanda[SEGMENTOS_POR_NIVEL];
+    for (size_t i = 0; i < SEGMENTOS_POR_NIVEL; i++) {
+        tanda[i] = segmentado->segmentos[inicio + i];
+        tanda[i]->referencias++;
+    }
+    uint64_t numero = segmentado->proximo_numero++;
+    pthread_mutex_unlock(&segmentado->mutex);
+
+    double antes = segundos_ahora();
+    indiceInvertido* fusionado = leer_indice_en_memoria(tanda[0]->indice);
+    for (size_t i = 1; fusionado && i < SEGMENTOS_POR_NIVEL; i++) {
+        indiceInvertido* siguiente = leer_indice_en_memoria(tanda[i]->indice);
+        bool ok = siguiente && fusionar_indice(fusionado, siguiente);
+        destruir_indice(siguiente);
+        if (!ok) {
+            destruir_indice(fusionado);
+            fusionado = NULL;
+        }
+    }
+    char ruta[MAX_LARGO_RUTA_SEGMENTO];
+    Segmento* nuevo = NULL;
+    if (fusionado && armar_ruta_segmento(ruta, segmentado->directorio, numero) && guardar_indice(fusionado, ruta)) {
+        nuevo = abrir_segmento(segmentado->directorio, numero);
+        if (!nuevo) remove(ruta);
+    }
+    destruir_indice(fusionado);
+
+    pthread_mutex_lock(&segmentado->mutex);
+    // Solo las fusiones sacan segmentos y van de a una: la tanda sigue junta desde 'inicio'.
+    bool ok = nuevo != NULL;
+    uint32_t documentos_nuevos = ok ? documentos_de(nuevo) : 0;
+    if (ok) {
+        size_t restantes = segmentado->cantidad - (inicio + SEGMENTOS_POR_NIVEL);
+        Segmento** lista = segmentado->segmentos;
+        Segmento* reemplazados[SEGMENTOS_POR_NIVEL];
+        memcpy(reemplazados, &lista[inicio], sizeof(reemplazados));
+        lista[inicio] = nuevo;
+        memmove(&lista[inicio + 1], &lista[inicio + SEGMENTOS_POR_NIVEL], restantes * sizeof(Segmento*));
+        segmentado->cantidad -= SEGMENTOS_POR_NIVEL - 1;
+        ok = escribir_catalogo(segmentado->directorio, lista, segmentado->cantidad);
+        if (ok) {
+            for (size_t i = 0; i < SEGMENTOS_POR_NIVEL; i++) {
+                tanda[i]->retirado = true;
+                soltar_segmento(tanda[i]); // La del catalogo.
+            }
+            segmentado->generacion++;
+            segmentado->fusiones++;
+        } else {
+            // El catalogo del disco sigue con la tanda vieja: se deja igual en memoria.
+            memmove(&lista[inicio + SEGMENTOS_POR_NIVEL], &lista[inicio + 1], restantes * sizeof(Segmento*));
+            memcpy(&lista[inicio], reemplazados, sizeof(reemplazados));
+            segmentado->cantidad += SEGMENTOS_POR_NIVEL - 1;
+            nuevo->retirado = true;
+            soltar_segmento(nuevo);
+        }
+    }
+    for (size_t i = 0; i < SEGMENTOS_POR_NIVEL; i++) {
+        soltar_segmento(tanda[i]); // La de esta fusion.
+    }
+    pthread_mutex_unlock(&segmentado->mutex);
+    pthread_mutex_unlock(&segmentado->mutex_fusion);
+
+    if (ok) {
+        REGISTRAR(REGISTRO_INFO, "[SEGMENTOS] Fusionados %d segmentos en 'seg_%08" PRIu64 ".idx' (%u documentos) en %.3f s.\n",
+                  SEGMENTOS_POR_NIVEL, numero, (unsigned)documentos_nuevos, segundos_ahora() - antes);
+    } else {
+        REGISTRAR(REGISTRO_ERROR, "[SEGMENTOS] Fallo la fusion de %d segmentos; quedan como estaban.\n", SEGMENTOS_POR_NIVEL);
+        *fallo = true;
+    }
+    return ok;
+}
+
+static void* hilo_de_fusiones(void* argumento) {
+    IndiceSegmentado* segmentado = (IndiceSegmentado*)argumento;
+#if defined(SEGMENTOS_CON_POSIX) && defined(__linux__)
+    // En Linux la prioridad es de cada hilo: solo este baja, las consultas no.
+    setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), PRIORIDAD_FUSIONES);
+#endif
+    pthread_mutex_lock(&segmentado->mutex);
+    while (!segmentado->terminar) {
+        size_t inicio;
+        if (segmentado->fusion_fallida || !elegir_fusion(segmentado, &inicio)) {
+            pthread_cond_wait(&segmentado->cambio, &segmentado->mutex);
+            continue;
+        }
+        pthread_mutex_unlock(&segmentado->mutex);
+        bool fallo;
+        fusionar_una_vez(segmentado, &fallo);
+        pthread_mutex_lock(&segmentado->mutex);
+        if (fallo) segmentado->fusion_fallida = true;
+    }
+    pthread_mutex_unlock(&segmentado->mutex);
+    return NULL;
+}
+
+// Abre los cursores de los terminos de la consulta en un segmento y anota de que termino es cada uno.
+// En AND devuelve 0 si falta alguno.
+static size_t abrir_cursores_segmento(const indiceInvertido* indice, const ConsultaAnalizada* consulta, bool disyuntiva,
+                                      EspacioConsulta* espacio, uint32_t termino_de_cursor[]) {
+    size_t abiertos = 0;
+    for (int i = 0; i < consulta->cantidad; i++) {
+        if (abrir_cursor_termino(indice, consulta->terminos[i], &espacio->cursores[abiertos])) {
+            espacio->abiertos[abiertos] = &espacio->cursores[abiertos];
+            if (termino_de_cursor) termino_de_cursor[abiertos] = (uint32_t)i;
+            abiertos++;
+        } else if (!disyuntiva) {
+            return 0;
+        }
+    }
+    return abiertos;
+}
+
+// --- Implementación de Funciones Públicas (declaradas en segmentos.h) ---
+
+int nivel_de_segmento(uint32_t documentos) {
+    int nivel = 0;
+    uint64_t limite = DOCUMENTOS_NIVEL_BASE;
+    while (documentos > limite) {
+        limite *= SEGMENTOS_POR_NIVEL;
+        nivel++;
+    }
+    return nivel;
+}
+
+bool es_directorio_de_segmentos(const char* ruta) {
+    if (!ruta) return false;
+    struct stat info;
+    return stat(ruta, &info) == 0 && (info.st_mode & S_IFMT) == S_IFDIR;
+}
+
+IndiceSegmentado* abrir_indice_segmentado(const char* directorio, bool fusionar_en_segundo_plano) {
+    if (!directorio || !crear_directorio(directorio)) {
+        return NULL;
+    }
+    IndiceSegmentado* segmentado = (IndiceSegmentado*)calloc(1, sizeof(IndiceSegmentado));
+    if (!segmentado || !(segmentado->directorio = strdup(directorio))) {
+        perror("[SEGMENTOS] Fallo la memoria para el indice segmentado");
+        free(segmentado);
+        return NULL;
+    }
+    pthread_mutex_init(&segmentado->mutex, NULL);
+    pthread_mutex_init(&segmentado->mutex_fusion, NULL);
+    pthread_cond_init(&segmentado->cambio, NULL);
+    segmentado->descriptor_bloqueo = bloquear_directorio(directorio);
+    if (segmentado->descriptor_bloqueo < 0 || !leer_catalogo(segmentado)) {
+        cerrar_indice_segmentado(segmentado);
+        return NULL;
+    }
+    limpiar_huerfanos(segmentado);
+
+    if (fusionar_en_segundo_plano) {
+        segmentado->con_hilo = pthread_create(&segmentado->hilo_fusiones, NULL, hilo_de_fusiones, segmentado) == 0;
+        if (!segmentado->con_hilo) {
+            REGISTRAR(REGISTRO_AVISO, "[SEGMENTOS] No se pudo crear el hilo de fusiones; los segmentos no se fusionaran.\n");
+        }
+    }
+    uint64_t documentos = 0;
+    for (size_t i = 0; i < segmentado->cantidad; i++) {
+        documentos += documentos_de(segmentado->segmentos[i]);
+    }
+    REGISTRAR(REGISTRO_INFO, "[SEGMENTOS] '%s' abierto: %zu segmento(s) con %" PRIu64 " documentos.\n",
+              directorio, segmentado->cantidad, documentos);
+    return segmentado;
+}
+
+void cerrar_indice_segmentado(IndiceSegmentado* segmentado) {
+    if (!segmentado) return;
+    if (segmentado->con_hilo) {
+        pthread_mutex_lock(&segmentado->mutex);
+        segmentado->terminar = true;
+        pthread_cond_signal(&segmentado->cambio);
+        pthread_mutex_unlock(&segmentado->mutex);
+        pthread_join(segmentado->hilo_fusiones, NULL);
+    }
+    if (segmentado->fusiones > 0) {
+        REGISTRAR(REGISTRO_INFO, "[SEGMENTOS] '%s' cerrado: %" PRIu64 " fusion(es), quedan %zu segmento(s).\n",
+                  segmentado->directorio, segmentado->fusiones, segmentado->cantidad);
+    }
+    for (size_t i = 0; i < segmentado->cantidad; i++) {
+        soltar_segmento(segmentado->segmentos[i]);
+    }
+#ifdef SEGMENTOS_CON_POSIX
+    if (segmentado->descriptor_bloqueo >= 0) close(segmentado->descriptor_bloqueo);
+#endif
+    pthread_cond_destroy(&segmentado->cambio);
+    pthread_mutex_destroy(&segmentado->mutex_fusion);
+    pthread_mutex_destroy(&segmentado->mutex);
+    free(segmentado->segmentos);
+    free(segmentado->directorio);
+    free(segmentado);
+}
+
+bool agregar_segmento(IndiceSegmentado* segmentado, const indiceInvertido* nuevo) {
+    if (!segmentado || !nuevo || nuevo->mapeado) {
+        fprintf(stderr, "[SEGMENTOS] Error: agregar_segmento necesita un indice en memoria.\n");
+        return false;
+    }
+    if (nuevo->documentos->cantidad == 0) {
+        return true;
+    }
+    pthread_mutex_lock(&segmentado->mutex);
+    uint64_t numero = segmentado->proximo_numero++;
+    pthread_mutex_unlock(&segmentado->mutex);
+
+    char ruta[MAX_LARGO_RUTA_SEGMENTO];
+    if (!armar_ruta_segmento(ruta, segmentado->directorio, numero) || !guardar_indice(nuevo, ruta)) {
+        return false;
+    }
+    Segmento* segmento = abrir_segmento(segmentado->directorio, numero);
+    if (!segmento) {
+        remove(ruta);
+        return false;
+    }
+
+    pthread_mutex_lock(&segmentado->mutex);
+    bool ok = asegurar_capacidad(segmentado, segmentado->cantidad + 1);
+    if (ok) {
+        segmentado->segmentos[segmentado->cantidad++] = segmento;
+        ok = escribir_catalogo(segmentado->directorio, segmentado->segmentos, segmentado->cantidad);
+        if (!ok) segmentado->cantidad--;
+    }
+    if (ok) {
+        segmentado->generacion++;
+        segmentado->fusion_fallida = false;
+        pthread_cond_signal(&segmentado->cambio);
+    } else {
+        segmento->retirado = true;
+        soltar_segmento(segmento);
+    }
+    pthread_mutex_unlock(&segmentado->mutex);
+    return ok;
+}
+
+bool agregar_documentos_como_segmento(IndiceSegmentado* segmentado, const char* archivo_documentos, int num_hilos) {
+    if (!segmentado || !archivo_documentos) return false;
+    double antes = segundos_ahora();
+    indiceInvertido* nuevo = crear_indice_silencioso(2048);
+    if (!nuevo) {
+        return false;
+    }
+    bool ok = procesar_archivo_documento_paralelo(archivo_documentos, nuevo, num_hilos);
+    if (!ok) {
+        fprintf(stderr, "[SEGMENTOS] No se pudo procesar '%s' entero; no se agrega.\n", archivo_documentos);
+    }
+    uint32_t documentos = nuevo->documentos->cantidad;
+    ok = ok && agregar_segmento(segmentado, nuevo);
+    destruir_indice(nuevo);
+    if (ok) {
+        REGISTRAR(REGISTRO_INFO, "[SEGMENTOS] %u documentos de '%s' agregados como segmento en %.3f s.\n",
+                  (unsigned)documentos, archivo_documentos, segundos_ahora() - antes);
+    }
+    return ok;
+}
+
+size_t fusionar_segmentos_pendientes(IndiceSegmentado* segmentado) {
+    if (!segmentado) return 0;
+    size_t hechas = 0;
+    bool fallo = false;
+    while (fusionar_una_vez(segmentado, &fallo)) {
+        hechas++;
+    }
+    return hechas;
+}
+
+bool tomar_vista_segmentos(IndiceSegmentado* segmentado, VistaSegmentos* vista) {
+    if (!vista) return false;
+    memset(vista, 0, sizeof(*vista));
+    if (!segmentado) return false;
+    pthread_mutex_lock(&segmentado->mutex);
+    size_t cantidad = segmentado->cantidad;
+    vista->segmentos = (Segmento**)malloc((cantidad ? cantidad : 1) * sizeof(Segmento*));
+    vista->bases = (uint32_t*)malloc((cantidad ? cantidad : 1) * sizeof(uint32_t));
+    if (!vista->segmentos || !vista->bases) {
+        pthread_mutex_unlock(&segmentado->mutex);
+        perror("[SEGMENTOS] Fallo malloc para la vista de segmentos");
+        free(vista->segmentos);
+        free(vista->bases);
+        memset(vista, 0, sizeof(*vista));
+        return false;
+    }
+    for (size_t i = 0; i < cantidad; i++) {
+        Segmento* segmento = segmentado->segmentos[i];
+        segmento->referencias++;
+        vista->segmentos[i] = segmento;
+        vista->bases[i] = vista->total_documentos;
+        vista->total_documentos += documentos_de(segmento);
+        vista->suma_largos += segmento->indice->documentos->suma_largos;
+    }
+    vista->cantidad = cantidad;
+    vista->generacion = segmentado->generacion;
+    pthread_mutex_unlock(&segmentado->mutex);
+    return true;
+}
+
+void soltar_vista_segmentos(IndiceSegmentado* segmentado, VistaSegmentos* vista) {
+    if (!segmentado || !vista) return;
+    pthread_mutex_lock(&segmentado->mutex);
+    for (size_t i = 0; i < vista->cantidad; i++) {
+        soltar_segmento(vista->segmentos[i]);
+    }
+    pthread_mutex_unlock(&segmentado->mutex);
+    free(vista->segmentos);
+    free(vista->bases);
+    memset(vista, 0, sizeof(*vista));
+}
+
+const char* url_documento_segmentos(const VistaSegmentos* vista, uint32_t doc_id) {
+    if (!vista || doc_id >= vista->total_documentos) return NULL;
+    // Busqueda binaria del ultimo segmento cuya base es <= doc_id.
+    size_t bajo = 0, alto = vista->cantidad - 1;
+    while (bajo < alto) {
+        size_t medio = bajo + (alto - bajo + 1) / 2;
+        if (vista->bases[medio] <= doc_id) bajo = medio; else alto = medio - 1;
+    }
+    return url_documento(vista->segmentos[bajo]->indice->documentos, doc_id - vista->bases[bajo]);
+}
+
+uint32_t documentos_con_termino_segmentos(const VistaSegmentos* vista, const char* termino, CursorPosteo* cursor) {
+    uint32_t documentos = 0;
+    if (!vista || !termino || !cursor) return 0;
+    for (size_t s = 0; s < vista->cantidad; s++) {
+        if (abrir_cursor_termino(vista->segmentos[s]->indice, termino, cursor)) {
+            documentos += cursor->cantidad;
+        }
+    }
+    return documentos;
+}
+
+ListaPosteo buscar_conjuntivo_segmentos(const VistaSegmentos* vista, const ConsultaAnalizada* consulta,
+                                        EspacioConsulta* espacio) {
+    ListaPosteo resultado = LISTA_POSTEO_VACIA;
+    if (!vista || !consulta || !espacio || consulta->cantidad == 0) return resultado;
+    for (size_t s = 0; s < vista->cantidad; s++) {
+        size_t abiertos = abrir_cursores_segmento(vista->segmentos[s]->indice, consulta, false, espacio, NULL);
+        if (abiertos == 0) continue;
+        ListaPosteo parcial = intersectar_cursores_posteo(espacio->abiertos, abiertos);
+        bool ok = reservar_lista(&resultado, (size_t)resultado.cantidad + parcial.cantidad);
+        for (uint32_t i = 0; ok && i < parcial.cantidad; i++) {
+            agregar_posteo(&resultado, vista->bases[s] + parcial.doc_ids[i], parcial.frecuencias[i]);
+        }
+        free_list(&parcial);
+        if (!ok) {
+            free_list(&resultado);
+            return resultado;
+        }
+    }
+    return resultado;
+}
+
+size_t buscar_mejores_segmentos(const VistaSegmentos* vista, const ConsultaAnalizada* consulta, bool disyuntiva,
+                                EspacioConsulta* espacio, ResultadoBusqueda* mejores, size_t k,
+                                uint32_t* total_coincidencias, EstadisticasBusqueda* estadisticas) {
+    if (total_coincidencias) *total_coincidencias = 0;
+    if (estadisticas) memset(estadisticas, 0, sizeof(*estadisticas));
+    if (!vista || !consulta || !espacio || !mejores || k == 0 || consulta->cantidad == 0 ||
+        consulta->cantidad > MAX_TERMINOS_INTERSECCION) {
+        return 0;
+    }
+
+    // Primera pasada: el df de cada termino en toda la coleccion (solo se mira el largo de las listas).
+    uint32_t df_coleccion[MAX_TERMINOS_CONSULTA] = { 0 };
+    for (int i = 0; i < consulta->cantidad; i++) {
+        df_coleccion[i] = documentos_con_termino_segmentos(vista, consulta->terminos[i], &espacio->cursores[0]);
+    }
+    ResultadoBusqueda* parciales = (ResultadoBusqueda*)malloc(k * sizeof(ResultadoBusqueda));
+    if (!parciales) {
+        perror("[SEGMENTOS] Fallo malloc para los resultados de un segmento");
+        return 0;
+    }
+
+    ColeccionRanking coleccion;
+    coleccion.total_documentos = vista->total_documentos;
+    coleccion.largo_promedio = vista->total_documentos > 0 ? (double)vista->suma_largos / vista->total_documentos : 0.0;
+    HeapMejores heap;
+    iniciar_heap_mejores(&heap, mejores, k);
+    for (size_t s = 0; s < vista->cantidad; s++) {
+        const indiceInvertido* indice = vista->segmentos[s]->indice;
+        uint32_t termino_de_cursor[MAX_TERMINOS_CONSULTA];
+        size_t abiertos = abrir_cursores_segmento(indice, consulta, disyuntiva, espacio, termino_de_cursor);
+        if (abiertos == 0) continue;
+        for (size_t c = 0; c < abiertos; c++) {
+            coleccion.documentos_con_termino[c] = df_coleccion[termino_de_cursor[c]];
+        }
+        // Las cotas del archivo se calcularon con el largo promedio del segmento.
+        coleccion.escala_cotas = escala_cotas_bm25(largo_promedio_documentos(indice->documentos), coleccion.largo_promedio);
+        // Los documentos de este segmento pierden los empates con los de los anteriores (doc_id mayor):
+        // los que no superan al peor de los k mejores hasta ahora ya no pueden entrar.
+        coleccion.umbral_minimo = heap.cantidad == heap.capacidad ? heap.resultados[0].puntaje : -INFINITY;
+
+        size_t encontrados;
+        if (disyuntiva) {
+            EstadisticasBusqueda del_segmento;
+            encontrados = buscar_mejores_disyuntivo_en_coleccion(indice, espacio->abiertos, abiertos, &coleccion,
+                                                                 parciales, k, &del_segmento);
+            if (estadisticas) {
+                estadisticas->posteos_totales += del_segmento.posteos_totales;
+                estadisticas->posteos_decodificados += del_segmento.posteos_decodificados;
+                estadisticas->documentos_puntuados += del_segmento.documentos_puntuados;
+            }
+        } else {
+            uint32_t coincidencias = 0;
+            encontrados = buscar_mejores_conjuntivo_en_coleccion(indice, espacio->abiertos, abiertos, &coleccion,
+                                                                 &espacio->interseccion, parciales, k, &coincidencias);
+            if (total_coincidencias) *total_coincidencias += coincidencias;
+        }
+        for (size_t i = 0; i < encontrados; i++) {
+            ofrecer_a_heap(&heap, vista->bases[s] + parciales[i].doc_id, parciales[i].puntaje);
+        }
+    }
+    free(parciales);
+    return ordenar_heap_mejores(&heap);
+}
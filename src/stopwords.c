@@ -1,6 +1,7 @@
 #include "includes/stopwords.h"
 
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
@@ -17,6 +18,19 @@ static size_t g_stopwords_capacidad = 0;
 #define CAPACIDAD_INICIAL_STOPWORDS 100
 #define FACTOR_CRECIMIENTO_STOPWORDS 2
 
+// Tabla hash de solo lectura que se arma al terminar cargar_stopwords (sondeo lineal, factor de carga <= 0.25).
+// Antes de tocarla, es_stopword_largo descarta por largo y por primera letra con dos mapas de bits.
+typedef struct {
+    const char* palabra;  // Apunta a g_stopwords_list (NULL = slot vacio).
+    uint32_t hash;
+    uint32_t largo;
+} SlotStopword;
+
+static SlotStopword* g_tabla_stopwords = NULL;
+static size_t g_tabla_mascara = 0;            // Tamanio de la tabla - 1 (potencia de 2).
+static uint64_t g_largos_presentes = 0;       // Bit i encendido: hay stopwords de largo i (el bit 63 junta los de 63 o mas).
+static uint32_t g_primeras_letras[8] = { 0 }; // Bit c encendido: hay stopwords que empiezan con el byte c.
+
 // --- Funciones Estáticas (Ayudantes Internos) ---
 
 /**
@@ -31,6 +45,75 @@ static void stopwords_convertir_a_minusculas(char *cadena) {
     }
 }
 
+// Igual que tolower en el locale "C" (el que usa el programa), pero sin llamar a la libc en cada byte.
+static unsigned char minuscula(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') ? (unsigned char)(c - 'A' + 'a') : c;
+}
+
+// FNV-1a de 32 bits sobre los bytes en minuscula, asi la busqueda no necesita copiar ni convertir la palabra.
+static uint32_t hash_stopword(const char* palabra, size_t largo) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < largo; i++) {
+        h ^= minuscula((unsigned char)palabra[i]);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static uint64_t bit_de_largo(size_t largo) {
+    return (uint64_t)1 << (largo < 63 ? largo : 63);
+}
+
+static bool primera_letra_presente(unsigned char c) {
+    return (g_primeras_letras[c >> 5] >> (c & 31)) & 1u;
+}
+
+static void liberar_tabla_stopwords(void) {
+    free(g_tabla_stopwords);
+    g_tabla_stopwords = NULL;
+    g_tabla_mascara = 0;
+    g_largos_presentes = 0;
+    memset(g_primeras_letras, 0, sizeof(g_primeras_letras));
+}
+
+// Arma la tabla hash y los filtros a partir de g_stopwords_list (ya en minusculas). Los repetidos se ignoran.
+static bool construir_tabla_stopwords(void) {
+    liberar_tabla_stopwords();
+    size_t tamanio = 16;
+    while (tamanio < g_stopwords_cantidad * 4) {
+        tamanio <<= 1;
+    }
+    g_tabla_stopwords = (SlotStopword*)calloc(tamanio, sizeof(SlotStopword));
+    if (g_tabla_stopwords == NULL) {
+        fprintf(stderr, "Error al asignar memoria para la tabla hash de stopwords: %s\n", strerror(errno));
+        return false;
+    }
+    g_tabla_mascara = tamanio - 1;
+
+    for (size_t i = 0; i < g_stopwords_cantidad; ++i) {
+        const char* palabra = g_stopwords_list[i];
+        size_t largo = strlen(palabra);
+        uint32_t hash = hash_stopword(palabra, largo);
+        size_t slot = hash & g_tabla_mascara;
+        bool repetida = false;
+        while (g_tabla_stopwords[slot].palabra != NULL) {
+            if (g_tabla_stopwords[slot].hash == hash && strcmp(g_tabla_stopwords[slot].palabra, palabra) == 0) {
+                repetida = true;
+                break;
+            }
+            slot = (slot + 1) & g_tabla_mascara;
+        }
+        if (repetida) continue;
+        g_tabla_stopwords[slot].palabra = palabra;
+        g_tabla_stopwords[slot].hash = hash;
+        g_tabla_stopwords[slot].largo = (uint32_t)largo;
+        g_largos_presentes |= bit_de_largo(largo);
+        unsigned char primera = (unsigned char)palabra[0];
+        g_primeras_letras[primera >> 5] |= 1u << (primera & 31);
+    }
+    return true;
+}
+
 // --- Implementación de Funciones Públicas ---
 
 bool cargar_stopwords(const char* filename) {
@@ -94,11 +177,16 @@ bool cargar_stopwords(const char* filename) {
 
     fclose(archivo);
 
+    if (!construir_tabla_stopwords()) {
+        return false;
+    }
+
     printf("[STOPWORDS] Se cargaron %zu stopwords desde '%s'.\n", g_stopwords_cantidad, filename);
     return true;
 }
 
 void free_stopwords() {
+    liberar_tabla_stopwords();
     if (g_stopwords_list != NULL) {
         for (size_t i = 0; i < g_stopwords_cantidad; ++i) {
             free(g_stopwords_list[i]);
@@ -115,18 +203,31 @@ void free_stopwords() {
 
 
 bool es_stopword(const char* word) {
-    if (!word || !g_stopwords_list || g_stopwords_cantidad == 0) {
+    if (!word) {
         return false;
     }
+    return es_stopword_largo(word, strlen(word));
+}
 
-    char buffer_palabra_minuscula[256];
-    strncpy(buffer_palabra_minuscula, word, sizeof(buffer_palabra_minuscula) - 1);
-    buffer_palabra_minuscula[sizeof(buffer_palabra_minuscula) - 1] = '\0';
-    stopwords_convertir_a_minusculas(buffer_palabra_minuscula);
-
-    for (size_t i = 0; i < g_stopwords_cantidad; ++i) {
+bool es_stopword_largo(const char* palabra, size_t largo) {
+    if (!palabra || largo == 0 || !g_tabla_stopwords) {
+        return false;
+    }
+    // Filtros baratos antes de calcular el hash: casi todas las palabras del corpus se descartan aqui.
+    if (!(g_largos_presentes & bit_de_largo(largo)) ||
+        !primera_letra_presente(minuscula((unsigned char)palabra[0]))) {
+        return false;
+    }
 
-        if (strcmp(buffer_palabra_minuscula, g_stopwords_list[i]) == 0) {
+    uint32_t hash = hash_stopword(palabra, largo);
+    for (size_t slot = hash & g_tabla_mascara; g_tabla_stopwords[slot].palabra != NULL; slot = (slot + 1) & g_tabla_mascara) {
+        const SlotStopword* candidato = &g_tabla_stopwords[slot];
+        if (candidato->hash != hash || candidato->largo != largo) continue;
+        size_t i = 0;
+        while (i < largo && minuscula((unsigned char)palabra[i]) == (unsigned char)candidato->palabra[i]) {
+            i++;
+        }
+        if (i == largo) {
             return true;
         }
     }